@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "WS2812_drv.h"
 #include "SPI_uDMA_drv.h"
@@ -205,3 +206,57 @@ void rainbowInit(uint8_t ints[][3], uint8_t ui8NumLED)
         }
     }
 }
+
+//*****************************************************************************
+//
+// Add two color values, saturating at 255.
+//
+//*****************************************************************************
+static uint8_t
+spectrumAdd(uint8_t ui8A, uint8_t ui8B)
+{
+    return((ui8A + ui8B > 0xff) ? 0xff : (ui8A + ui8B));
+}
+
+//*****************************************************************************
+//
+// Show a spectrum across an array of LEDs.
+//
+// @input ints[][3] is the array of GRB values
+// @input ui8NumLED is the number of LEDs represented by ints
+// @input pui8Levels is the level of each band, 0 to 255
+// @input ui8NumBands is the number of bands
+// @input ui8Flash is the amount of white to add to every LED
+//
+// @returns none, but values stored in ints are changed.
+//
+//*****************************************************************************
+void spectrumShow(uint8_t ints[][3], uint8_t ui8NumLED,
+                  const uint8_t *pui8Levels, uint8_t ui8NumBands,
+                  uint8_t ui8Flash)
+{
+    int i;
+    int iBand;
+    int iHue;
+    int iLevel;
+
+    for(i=0;i<ui8NumLED;i++)
+    {
+        iBand = (i * ui8NumBands) / ui8NumLED;
+        iLevel = pui8Levels[iBand] + 1;
+
+        //
+        // Walk the hue from red through green to blue across the bands
+        //
+        iHue = (ui8NumBands > 1) ? ((iBand * 255) / (ui8NumBands - 1)) : 0;
+
+        ints[i][0] = (((iHue < 128) ? (iHue * 2) : ((255 - iHue) * 2)) *
+                      iLevel) >> 8;
+        ints[i][1] = ((255 - iHue) * iLevel) >> 8;
+        ints[i][2] = (iHue * iLevel) >> 8;
+
+        ints[i][0] = spectrumAdd(ints[i][0], ui8Flash);
+        ints[i][1] = spectrumAdd(ints[i][1], ui8Flash);
+        ints[i][2] = spectrumAdd(ints[i][2], ui8Flash);
+    }
+}
@@ -62,3 +62,24 @@ rainbowShift(uint8_t *ui8Green, uint8_t *ui8Red, uint8_t *ui8Blue);
 extern void
 rainbowInit(uint8_t ints[][3], uint8_t ui8NumLED);
 
+//*****************************************************************************
+//
+// Show a spectrum across an array of LEDs.
+//
+// The LEDs are split evenly between the bands, bass at the start of the
+// array in red through green to treble in blue, each as bright as its band's
+// level.  The levels would normally come from WSFFTLevel() (see
+// WS2812_fft.h).  On a beat, ui8Flash is added to every channel of every LED.
+//
+// @input ints[][3] is the array of GRB values
+// @input ui8NumLED is the number of LEDs represented by ints
+// @input pui8Levels is the level of each band, 0 to 255
+// @input ui8NumBands is the number of bands
+// @input ui8Flash is the amount of white to add to every LED
+//
+// @returns none, but values stored in ints are changed.
+//
+//*****************************************************************************
+extern void
+spectrumShow(uint8_t ints[][3], uint8_t ui8NumLED, const uint8_t *pui8Levels,
+             uint8_t ui8NumBands, uint8_t ui8Flash);
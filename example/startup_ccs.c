@@ -58,6 +58,7 @@ extern uint32_t __STACK_TOP;
 //*****************************************************************************
 extern void uDMAErrorHandler(void);
 extern void SSI1IntHandler(void);
+extern void PendSVIntHandler(void);
 
 //*****************************************************************************
 //
@@ -84,7 +85,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // SVCall handler
     IntDefaultHandler,                      // Debug monitor handler
     0,                                      // Reserved
-    IntDefaultHandler,                      // The PendSV handler
+    PendSVIntHandler,                       // The PendSV handler
     IntDefaultHandler,                      // The SysTick handler
     IntDefaultHandler,                               // GPIO Port A
     IntDefaultHandler,                               // GPIO Port B
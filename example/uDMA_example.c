@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "inc/hw_memmap.h"
 #include "driverlib/cpu.h"
@@ -18,8 +19,33 @@
 
 #include "WS2812_drv.h"
 #include "SPI_uDMA_drv.h"
+#include "WS2812_sched.h"
+#include "WS2812_timing.h"
 #include "samplePatterns.h"
 
+//*****************************************************************************
+//
+// An array to hold the colors.  30 LEDs for this example, each has a red,
+// green, and blue intensity.  Note that these are actually stored GRB,
+// because WS2812b LEDs are weird.
+//
+//*****************************************************************************
+static uint8_t g_pui8Colors[30][3];
+
+//*****************************************************************************
+//
+// The output array for the SPI bus.  The nature of the timing for the LEDs
+// makes it so we can't just map a single intensity byte onto a single byte
+// to transmit out the SPI peripheral.  Instead, we separate each bit of
+// the intensity to four bits of SPI out.  The WS one wire protocol
+// basically boils down to "110" on the SPI bus is read as a 1 by the LED,
+// "100" is a 0.  We use some macros to figure out how many bytes of SPI
+// array we need to represent each of the 30 LEDs.
+//
+//*****************************************************************************
+static uint8_t g_pui8SPIOut[30][WS2812_SPI_BYTE_PER_CLR *
+                                WS2812_SPI_BIT_WIDTH];
+
 //*****************************************************************************
 //
 // Configure the UART and its pins to A0 and A1, which are routed to the UART
@@ -58,6 +84,32 @@ configureUART(void)
 }
 
 
+//*****************************************************************************
+//
+// The render job.  The scheduler runs this from PendSV each time the SPI
+// buffer has been sent out.
+//
+//*****************************************************************************
+static void
+renderRainbow(void *pvData)
+{
+    int i;
+
+    for(i=0;i<30;i++)
+    {
+        //
+        // Update the RGB colors to the next value in the color wheel
+        //
+        rainbowShift(&(g_pui8Colors[i][0]), &(g_pui8Colors[i][1]),
+                     &(g_pui8Colors[i][2]));
+        //
+        // Update the SPI transmit array to reflect the new RGB values
+        //
+        WSGRBtoSPI(g_pui8SPIOut[i], g_pui8Colors[i][0],
+                   g_pui8Colors[i][1], g_pui8Colors[i][2]);
+    }
+}
+
 //*****************************************************************************
 //
 // This example application demonstrates the use of the WS2812B uDMA library
@@ -69,31 +121,12 @@ int
 main(void)
 {
     //
-    // An array to hold the colors.  30 LEDs for this example, each has a red,
-    // green, and blue intensity.  Note that these are actually stored GRB,
-    // because WS2812b LEDs are weird.
+    // The uDMA library sets this flag each time a transfer is done.  The
+    // scheduler gets the same notification, so nothing here polls it.
     //
-    static uint8_t pui8Colors[30][3];
-
-    //
-    // The output array for the SPI bus.  The nature of the timing for the LEDs
-    // makes it so we can't just map a single intensity byte onto a single byte
-    // to transmit out the SPI peripheral.  Instead, we separate each bit of
-    // the intensity to four bits of SPI out.  The WS one wire protocol
-    // basically boils down to "110" on the SPI bus is read as a 1 by the LED,
-    // "100" is a 0.  We use some macros to figure out how many bytes of SPI
-    // array we need to represent each of the 30 LEDs.
-    //
-    static uint8_t pui8SPIOut[30][WS2812_SPI_BYTE_PER_CLR * 
-                                  WS2812_SPI_BIT_WIDTH];
-
-    //
-    // We'll pass this flag to the uDMA library, which will tell us when each
-    // transfer is done.  This is only necessary if you want the update rate of
-    // the LED strip to be based on how fast the data can be read by the WSB LED
-    //
-    uint8_t ui8SPIDone;
-    int i;
+    static uint8_t ui8SPIDone;
+    static tWSSchedJob sRenderJob;
+    const tWSTiming *psTiming;
 
     //
     // Set the clocking to run from the PLL at 50MHz
@@ -116,40 +149,31 @@ main(void)
     //
     // Initialize the color array to be evenly spaced along the color wheel.
     //
-    rainbowInit(pui8Colors, 30);
+    rainbowInit(g_pui8Colors, 30);
+
+    //
+    // Render on every frame completion.  The render starts once the last
+    // byte of a frame has been read out of the SPI array, and has to be done
+    // before the next frame starts reading it, after the latch.  With the
+    // WS2812B plan at 50MHz the 30 LEDs take about 0.8ms to send and the
+    // latch 0.28ms, so budget the render the latch time.
+    //
+    psTiming = WSTimingActive();
+    WSSchedInit();
+    WSSchedJobAdd(&sRenderJob, renderRainbow, NULL,
+                  (psTiming->ui32BitNs * psTiming->ui16LatchFrames) / 1000);
 
     //
     // Initialize and start the inifinite uDMA transfers
     //
-    InitSPITransfer((uint8_t*)pui8SPIOut, sizeof(pui8SPIOut), &ui8SPIDone);
+    InitSPITransfer((uint8_t*)g_pui8SPIOut, sizeof(g_pui8SPIOut), &ui8SPIDone);
 
     while(1)
     {
         //
-        // Check to see if the SPI buffer is done sending out data
+        // Tell the processor to stop executing instructions and relax.  All
+        // of the work happens in interrupts.
         //
-        if(ui8SPIDone)
-        {
-            ui8SPIDone = 0;
-            for(i=0;i<30;i++)
-            {
-                //
-                // Update the RGB colors to the next value in the color wheel
-                //
-                rainbowShift(&(pui8Colors[i][0]), &(pui8Colors[i][1]),
-                             &(pui8Colors[i][2]));
-                //
-                // Update the SPI transmit array to reflect the new RGB values
-                //
-                WSGRBtoSPI(pui8SPIOut[i], pui8Colors[i][0],
-                           pui8Colors[i][1], pui8Colors[i][2]);
-            }
-
-            //
-            // Tell the processor to stop executing instructions and relax
-            // while the uDMA engine finishes its job.
-            //
-            CPUwfi();
-        }
+        CPUwfi();
     }
 }
@@ -0,0 +1,186 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ADC_uDMA_audio.h"
+#include "SPI_uDMA_drv.h"
+#include "WS2812_trace.h"
+
+#include "driverlib/adc.h"
+#include "driverlib/gpio.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+#include "inc/hw_adc.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+
+//
+// The pin behind each ADC input on the TM4C123
+//
+typedef struct
+{
+    uint32_t ui32Periph;
+    uint32_t ui32Base;
+    uint8_t ui8Pin;
+}
+tADCAudioPin;
+
+static const tADCAudioPin g_psAudioPins[] =
+{
+    { SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_3 },
+    { SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_2 },
+    { SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_1 },
+    { SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_0 },
+    { SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_3 },
+    { SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_2 },
+    { SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_1 },
+    { SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_0 },
+    { SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_5 },
+    { SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_4 },
+    { SYSCTL_PERIPH_GPIOB, GPIO_PORTB_BASE, GPIO_PIN_4 },
+    { SYSCTL_PERIPH_GPIOB, GPIO_PORTB_BASE, GPIO_PIN_5 }
+};
+
+#define NUM_AUDIO_PINS (sizeof(g_psAudioPins) / sizeof(g_psAudioPins[0]))
+
+static uint16_t g_pui16AudioBuf[2][ADC_AUDIO_BLOCK];
+static volatile int8_t g_i8AudioReady = -1;
+static uint32_t g_ui32AudioOverruns;
+
+//*****************************************************************************
+//
+// Arm one half of the ping-pong capture.
+//
+//*****************************************************************************
+static void
+adcAudioArm(uint32_t ui32Select)
+{
+    ROM_uDMAChannelControlSet(UDMA_CHANNEL_ADC3 | ui32Select,
+                              UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_16 | UDMA_ARB_1);
+    ROM_uDMAChannelTransferSet(UDMA_CHANNEL_ADC3 | ui32Select,
+                               UDMA_MODE_PINGPONG,
+                               (void *)(ADC0_BASE + ADC_O_SSFIFO3),
+                               g_pui16AudioBuf[(ui32Select == UDMA_ALT_SELECT) ?
+                                               1 : 0],
+                               ADC_AUDIO_BLOCK);
+}
+
+//*****************************************************************************
+//
+// The interrupt handler for ADC0 sample sequencer 3.  The uDMA controller
+// raises this interrupt each time one half of the capture buffer fills.  That
+// half is handed to ADCAudioBlockGet() and re-armed; it won't be written
+// again until the other half has filled.
+//
+//*****************************************************************************
+void
+ADC0SS3IntHandler(void)
+{
+    int i;
+
+    WSTRACE(WS_TRACE_ISR_ENTER, WS_TRACE_ID_ADC0SS3, 0);
+
+    ROM_ADCIntClear(ADC0_BASE, 3);
+
+    for(i = 0; i < 2; i++)
+    {
+        if(ROM_uDMAChannelModeGet(UDMA_CHANNEL_ADC3 |
+                                  (i ? UDMA_ALT_SELECT : UDMA_PRI_SELECT)) ==
+           UDMA_MODE_STOP)
+        {
+            if(g_i8AudioReady >= 0)
+            {
+                g_ui32AudioOverruns++;
+            }
+            g_i8AudioReady = i;
+            adcAudioArm(i ? UDMA_ALT_SELECT : UDMA_PRI_SELECT);
+        }
+    }
+
+    WSTRACE(WS_TRACE_ISR_EXIT, WS_TRACE_ID_ADC0SS3, 0);
+}
+
+const uint16_t *
+ADCAudioBlockGet(void)
+{
+    int8_t i8Ready;
+
+    ROM_IntDisable(INT_ADC0SS3);
+    i8Ready = g_i8AudioReady;
+    g_i8AudioReady = -1;
+    ROM_IntEnable(INT_ADC0SS3);
+
+    if(i8Ready < 0)
+    {
+        return(NULL);
+    }
+    return(g_pui16AudioBuf[i8Ready]);
+}
+
+uint32_t
+ADCAudioOverrunsGet(void)
+{
+    return(g_ui32AudioOverruns);
+}
+
+void
+InitADCAudio(uint32_t ui32Channel, uint32_t ui32SampleRate)
+{
+    uDMAControllerInit();
+
+    //
+    // Switch the input pin over to the analog function.
+    //
+    if(ui32Channel < NUM_AUDIO_PINS)
+    {
+        ROM_SysCtlPeripheralEnable(g_psAudioPins[ui32Channel].ui32Periph);
+        ROM_GPIOPinTypeADC(g_psAudioPins[ui32Channel].ui32Base,
+                           g_psAudioPins[ui32Channel].ui8Pin);
+    }
+
+    //
+    // Sequencer 3 takes one sample per trigger.  With uDMA enabled the
+    // interrupt flag of the last step becomes the uDMA request, and the
+    // sequencer interrupt only fires when the uDMA transfer completes.
+    //
+    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_ADC0);
+    ROM_ADCSequenceDisable(ADC0_BASE, 3);
+    ROM_ADCSequenceConfigure(ADC0_BASE, 3, ADC_TRIGGER_TIMER, 0);
+    ROM_ADCSequenceStepConfigure(ADC0_BASE, 3, 0, ui32Channel | ADC_CTL_IE |
+                                 ADC_CTL_END);
+    ROM_ADCSequenceEnable(ADC0_BASE, 3);
+    ROM_ADCSequenceDMAEnable(ADC0_BASE, 3);
+
+    //
+    // Timer1A sets the sample rate.  Timer0A belongs to the parallel driver.
+    //
+    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_TIMER1);
+    ROM_TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    ROM_TimerLoadSet(TIMER1_BASE, TIMER_A,
+                     (ROM_SysCtlClockGet() / ui32SampleRate) - 1);
+    ROM_TimerControlTrigger(TIMER1_BASE, TIMER_A, true);
+
+    //
+    // A sample waits in the FIFO for the whole sample period, so the channel
+    // can stay at default priority behind the LED stream.
+    //
+    ROM_uDMAChannelAttributeDisable(UDMA_CHANNEL_ADC3,
+                                    UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_HIGH_PRIORITY |
+                                    UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_REQMASK);
+    adcAudioArm(UDMA_PRI_SELECT);
+    adcAudioArm(UDMA_ALT_SELECT);
+
+    g_i8AudioReady = -1;
+    g_ui32AudioOverruns = 0;
+
+    ROM_IntEnable(INT_ADC0SS3);
+    ROM_IntMasterEnable();
+    ROM_uDMAChannelEnable(UDMA_CHANNEL_ADC3);
+    ROM_TimerEnable(TIMER1_BASE, TIMER_A);
+}
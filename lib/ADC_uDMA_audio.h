@@ -0,0 +1,90 @@
+
+
+#ifndef __ADC_UDMA_AUDIO_H__
+#define __ADC_UDMA_AUDIO_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// Number of samples in each half of the capture buffer.  This is also the
+// FFT size, so it must be a power of two the FFT supports (see WS2812_fft.h).
+//
+#ifndef ADC_AUDIO_BLOCK
+#define ADC_AUDIO_BLOCK         256
+#endif
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Start capturing audio on ADC0.
+//
+// Timer1A triggers sample sequencer 3 at the sample rate, and the ADC0SS3
+// uDMA channel moves each sample into one half of a ping-pong buffer of
+// 2 * ADC_AUDIO_BLOCK samples, using the same control table as the LED
+// drivers.  The CPU only runs when a half fills, to re-arm it.
+//
+// Analysis is not done in the interrupt.  A render job (see WS2812_sched.h)
+// calls ADCAudioBlockGet() and, when a new block is ready, runs the FFT in
+// the gap before the next LED frame is due.
+//
+// ADC0SS3IntHandler must be placed in the ADC Sequence 3 slot of the vector
+// table.
+//
+// @input ui32Channel is the ADC input, one of ADC_CTL_CHn
+// @input ui32SampleRate is the sample rate in Hz
+//
+//*****************************************************************************
+extern void InitADCAudio(uint32_t ui32Channel, uint32_t ui32SampleRate);
+
+//*****************************************************************************
+//
+// Get the most recently completed block of samples
+//
+// Each block is handed out once.  It stays valid until the uDMA controller
+// comes back around to that half, one block time after this returns.
+//
+// @returns ADC_AUDIO_BLOCK 12-bit samples, or NULL if no new block has
+//          completed since the last call
+//
+//*****************************************************************************
+extern const uint16_t *ADCAudioBlockGet(void);
+
+//*****************************************************************************
+//
+// Get the number of blocks that completed without being picked up by
+// ADCAudioBlockGet(), meaning the analysis isn't keeping up.
+//
+//*****************************************************************************
+extern uint32_t ADCAudioOverrunsGet(void);
+
+//*****************************************************************************
+//
+// The interrupt handler for ADC0 sample sequencer 3.
+//
+//*****************************************************************************
+extern void ADC0SS3IntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ADC_UDMA_AUDIO_H__
@@ -0,0 +1,226 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "GPIO_uDMA_drv.h"
+#include "SPI_uDMA_drv.h"
+#include "WS2812_parallel.h"
+#include "WS2812_trace.h"
+
+#include "driverlib/gpio.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+
+//*****************************************************************************
+//
+// The GPIO port driving the strips.  Port B has all eight pins free on the
+// EK-TM4C123GXL.
+//
+//*****************************************************************************
+#ifndef GPIO_PAR_PORT_BASE
+#define GPIO_PAR_PORT_BASE      GPIO_PORTB_BASE
+#define GPIO_PAR_PORT_PERIPH    SYSCTL_PERIPH_GPIOB
+#endif
+
+//
+// Three slots per 1.25us WS bit
+//
+#ifndef GPIO_PAR_SLOT_HZ
+#define GPIO_PAR_SLOT_HZ        2400000
+#endif
+
+//
+// Number of slots the pins are held low between frames, about 83us
+//
+#ifndef GPIO_PAR_LATCH_SLOTS
+#define GPIO_PAR_LATCH_SLOTS    200
+#endif
+
+//
+// The largest transfer a single uDMA control structure can describe
+//
+#define GPIO_PAR_MAX_XFER       1024
+
+static uint8_t *g_pui8ParDoneVar = NULL;
+static uint8_t *g_pui8PortArray;
+static uint8_t g_ui8ParPinMask;
+static bool g_bParLatchArmed;
+static uint32_t g_ui32PortArraySize;
+static uint32_t g_ui32PortNextOffs;
+static const uint8_t g_ui8PortIdle = 0;
+
+//*****************************************************************************
+//
+// Arm the given control structure with whatever comes next in the frame: the
+// next chunk of the port array, or the latch once the whole array has been
+// handed out.
+//
+// Each half is armed one transfer ahead, so when the latch is armed the last
+// chunk of the frame is still going out on the other half.  The arm after
+// that comes from the last chunk finishing, which is when the port array has
+// been read out and the done flag is set.
+//
+//*****************************************************************************
+static void
+gpioArmNext(uint32_t ui32Select)
+{
+    uint32_t ui32Count;
+
+    if(g_bParLatchArmed)
+    {
+        g_bParLatchArmed = false;
+        if(g_pui8ParDoneVar != NULL)
+        {
+            *g_pui8ParDoneVar = 1;
+        }
+    }
+
+    if(g_ui32PortNextOffs < g_ui32PortArraySize)
+    {
+        ui32Count = g_ui32PortArraySize - g_ui32PortNextOffs;
+        if(ui32Count > GPIO_PAR_MAX_XFER)
+        {
+            ui32Count = GPIO_PAR_MAX_XFER;
+        }
+
+        //
+        // Every timer request moves a single byte, so arbitrating after each
+        // item keeps other channels from being starved.
+        //
+        ROM_uDMAChannelControlSet(UDMA_CHANNEL_TMR0A | ui32Select,
+                                  UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                                  UDMA_DST_INC_NONE | UDMA_ARB_1);
+        ROM_uDMAChannelTransferSet(UDMA_CHANNEL_TMR0A | ui32Select,
+                                   UDMA_MODE_PINGPONG,
+                                   g_pui8PortArray + g_ui32PortNextOffs,
+                                   (void *)(GPIO_PAR_PORT_BASE + GPIO_O_DATA +
+                                            (g_ui8ParPinMask << 2)),
+                                   ui32Count);
+        WSTRACE(WS_TRACE_ARMED, WS_TRACE_ID_TIMER0A, ui32Count);
+        g_ui32PortNextOffs += ui32Count;
+    }
+    else
+    {
+        //
+        // Hold the strip pins low long enough for the LEDs to latch the
+        // frame.
+        //
+        ROM_uDMAChannelControlSet(UDMA_CHANNEL_TMR0A | ui32Select,
+                                  UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                                  UDMA_DST_INC_NONE | UDMA_ARB_1);
+        ROM_uDMAChannelTransferSet(UDMA_CHANNEL_TMR0A | ui32Select,
+                                   UDMA_MODE_PINGPONG,
+                                   (void *)&g_ui8PortIdle,
+                                   (void *)(GPIO_PAR_PORT_BASE + GPIO_O_DATA +
+                                            (g_ui8ParPinMask << 2)),
+                                   GPIO_PAR_LATCH_SLOTS);
+        WSTRACE(WS_TRACE_LATCH, WS_TRACE_ID_TIMER0A, 0);
+        g_ui32PortNextOffs = 0;
+        g_bParLatchArmed = true;
+    }
+}
+
+//*****************************************************************************
+//
+// The interrupt handler for Timer0A.  The uDMA controller raises this
+// interrupt when one half of the ping-pong transfer completes.  The other half
+// is already running, so the finished half is re-armed with the next chunk
+// while it goes.
+//
+//*****************************************************************************
+void
+Timer0AIntHandler(void)
+{
+    uint32_t ui32Status;
+
+    WSTRACE(WS_TRACE_ISR_ENTER, WS_TRACE_ID_TIMER0A, 0);
+
+    ui32Status = ROM_TimerIntStatus(TIMER0_BASE, 1);
+    ROM_TimerIntClear(TIMER0_BASE, ui32Status);
+
+    if(ROM_uDMAChannelModeGet(UDMA_CHANNEL_TMR0A | UDMA_PRI_SELECT) ==
+       UDMA_MODE_STOP)
+    {
+        gpioArmNext(UDMA_PRI_SELECT);
+    }
+    if(ROM_uDMAChannelModeGet(UDMA_CHANNEL_TMR0A | UDMA_ALT_SELECT) ==
+       UDMA_MODE_STOP)
+    {
+        gpioArmNext(UDMA_ALT_SELECT);
+    }
+
+    WSTRACE(WS_TRACE_ISR_EXIT, WS_TRACE_ID_TIMER0A, 0);
+}
+
+void
+InitGPIOTransfer(uint8_t *pui8PortData, uint32_t ui32DataSize,
+                 uint8_t ui8PinMask, uint8_t *pui8DoneVar)
+{
+    g_pui8PortArray = pui8PortData;
+    g_ui32PortArraySize = ui32DataSize;
+    g_ui32PortNextOffs = 0;
+    g_bParLatchArmed = false;
+
+    //
+    // The uDMA writes go through the data register's address mask, so only
+    // the strip pins change and the rest of the port is left alone.
+    //
+    g_ui8ParPinMask = ui8PinMask;
+
+    //
+    // Write the fixed high/low slots and turn all LEDs off
+    //
+    WSParallelArrayInit(pui8PortData, ui32DataSize / WS2812_PAR_LED_SIZE,
+                        ui8PinMask);
+
+    uDMAControllerInit();
+
+    //
+    // Configure the strip pins as outputs, idling low.
+    //
+    ROM_SysCtlPeripheralEnable(GPIO_PAR_PORT_PERIPH);
+    ROM_SysCtlPeripheralSleepEnable(GPIO_PAR_PORT_PERIPH);
+    ROM_GPIOPinTypeGPIOOutput(GPIO_PAR_PORT_BASE, ui8PinMask);
+    ROM_GPIOPadConfigSet(GPIO_PAR_PORT_BASE, ui8PinMask, GPIO_STRENGTH_8MA,
+                         GPIO_PIN_TYPE_STD);
+    ROM_GPIOPinWrite(GPIO_PAR_PORT_BASE, ui8PinMask, 0);
+
+    //
+    // Timer0A paces the transfer, one uDMA request per slot.
+    //
+    ROM_SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_TIMER0);
+    ROM_TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
+    ROM_TimerLoadSet(TIMER0_BASE, TIMER_A,
+                     (ROM_SysCtlClockGet() / GPIO_PAR_SLOT_HZ) - 1);
+    ROM_TimerIntEnable(TIMER0_BASE, TIMER_TIMA_DMA);
+    ROM_IntEnable(INT_TIMER0A);
+
+    //
+    // The GPIO port has no FIFO to hide bus latency, so the channel runs at
+    // high priority to keep the slot timing steady.
+    //
+    ROM_uDMAChannelAssign(UDMA_CH18_TIMER0A);
+    ROM_uDMAChannelAttributeDisable(UDMA_CHANNEL_TMR0A,
+                                    UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_REQMASK);
+    ROM_uDMAChannelAttributeEnable(UDMA_CHANNEL_TMR0A,
+                                   UDMA_ATTR_HIGH_PRIORITY);
+
+    //
+    // Prime both halves of the ping-pong transfer.
+    //
+    g_pui8ParDoneVar = pui8DoneVar;
+    *pui8DoneVar = 0;
+    gpioArmNext(UDMA_PRI_SELECT);
+    gpioArmNext(UDMA_ALT_SELECT);
+
+    ROM_IntMasterEnable();
+    ROM_uDMAChannelEnable(UDMA_CHANNEL_TMR0A);
+    ROM_TimerEnable(TIMER0_BASE, TIMER_A);
+}
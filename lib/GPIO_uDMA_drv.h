@@ -0,0 +1,69 @@
+
+
+#ifndef __GPIO_UDMA_DRV_H__
+#define __GPIO_UDMA_DRV_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Kick off the parallel GPIO uDMA transfers.
+//
+// This function will configure Timer0A and the uDMA engine to continually
+// stream a parallel port out array (see WS2812_parallel.h) to the data
+// register of a GPIO port, driving up to eight chains of WS2812b LEDs at once,
+// one per port pin.  Each timer timeout moves one byte, so the timer runs at
+// three times the WS bit rate.  Transfers are split into 1024 byte chunks and
+// run in ping-pong mode, followed by a latch period with all pins held low.
+//
+// Timer0AIntHandler must be placed in the Timer 0 subtimer A slot of the
+// vector table.
+//
+// @input pui8PortData is the array containing the port data to send
+// @input ui32DataSize is the number of bytes the data array can hold
+// @input ui8PinMask is the set of port pins that have a strip attached
+// @input pui8DoneVar is a flag that can be used to determine when an LED frame
+//        has finished transmitting.  This flag will be initialized to 0 on the
+//        first uDMA start, and will be set to 1 each time the uDMA engine
+//        finishes sending the entire port buffer, while the latch goes out,
+//        so the port array can be rewritten until the next frame starts.
+//        Only the pins in ui8PinMask are driven; the rest of the port is
+//        left alone.
+//
+//*****************************************************************************
+extern void InitGPIOTransfer(uint8_t *pui8PortData, uint32_t ui32DataSize,
+                             uint8_t ui8PinMask, uint8_t *pui8DoneVar);
+
+//*****************************************************************************
+//
+// The interrupt handler for Timer0A.  This interrupt occurs each time one of
+// the ping-pong uDMA transfers completes, and re-arms it with the next chunk.
+//
+//*****************************************************************************
+extern void Timer0AIntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GPIO_UDMA_DRV_H__
@@ -0,0 +1,663 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <linux/spi/spidev.h>
+#include "WS2812_drv.h"
+#include "WS2812_flash.h"
+#include "SPI_uDMA_drv.h"
+#include "SPI_spidev_drv.h"
+
+//
+// Where spidev publishes its per-message limit, and the limit to assume if
+// it can't be read
+//
+#define SPIDEV_BUFSIZ_PATH      "/sys/module/spidev/parameters/bufsiz"
+#define SPIDEV_BUFSIZ_DEFAULT   4096
+
+static const char *g_pcDevPath = SPIDEV_DEFAULT_PATH;
+static uint32_t g_ui32DevHz = SPIDEV_DEFAULT_HZ;
+static uint8_t g_ui8DevBits = SPIDEV_DEFAULT_BITS;
+static uint32_t g_ui32DevPeriodNs;
+static int g_iDevMockFd = -1;
+
+static int g_iDevFd = -1;
+static int g_iDevError;
+static pthread_t g_sDevThread;
+static bool g_bDevRunning;
+static volatile bool g_bDevStop;
+
+static uint8_t *g_pui8DevDoneVar;
+static void (*g_pfnFrameDone)(void);
+static uint32_t g_ui32DevLate;
+
+//
+// The prebuilt frame: every transfer, the number of transfers in each
+// message, and the zero bytes of the latch
+//
+static struct spi_ioc_transfer *g_psDevXfer;
+static struct iovec *g_psDevIov;
+static uint8_t *g_pui8DevMsgXfers;
+static uint32_t g_ui32DevNumMsgs;
+static uint8_t *g_pui8DevLatch;
+
+//
+// The SPI array the transfers point into, and the one to switch to at the
+// start of the next frame
+//
+static uint8_t *g_pui8DevData;
+static uint32_t g_ui32DevDataSize;
+static _Atomic(const uint8_t *) g_pui8DevNextData;
+
+//
+// The SPI array given to InitSPITransfer(), and the frame set with
+// SPIFrameSourceSet() to send instead (NULL for the SPI array).  The
+// sending thread picks up a new source at the start of a frame.
+//
+static uint8_t *g_pui8DevArray;
+static uint16_t g_ui16DevArraySize;
+static pthread_mutex_t g_sDevSourceLock = PTHREAD_MUTEX_INITIALIZER;
+static const uint8_t *g_pui8DevSource;
+static uint16_t g_ui16DevSourceSize;
+static atomic_bool g_bDevSourceNew;
+
+//*****************************************************************************
+//
+// Read the largest message spidev will accept.
+//
+//*****************************************************************************
+static uint32_t
+spidevBufsizGet(void)
+{
+    FILE *psFile;
+    unsigned int uiBufsiz;
+
+    psFile = fopen(SPIDEV_BUFSIZ_PATH, "r");
+    if(psFile == NULL)
+    {
+        return(SPIDEV_BUFSIZ_DEFAULT);
+    }
+    if((fscanf(psFile, "%u", &uiBufsiz) != 1) || (uiBufsiz == 0))
+    {
+        uiBufsiz = SPIDEV_BUFSIZ_DEFAULT;
+    }
+    fclose(psFile);
+    return(uiBufsiz);
+}
+
+//*****************************************************************************
+//
+// Release the transfer list and latch buffer.
+//
+//*****************************************************************************
+static void
+spidevFree(void)
+{
+    free(g_psDevXfer);
+    free(g_psDevIov);
+    free(g_pui8DevMsgXfers);
+    free(g_pui8DevLatch);
+    g_psDevXfer = NULL;
+    g_psDevIov = NULL;
+    g_pui8DevMsgXfers = NULL;
+    g_pui8DevLatch = NULL;
+    g_ui32DevNumMsgs = 0;
+}
+
+//*****************************************************************************
+//
+// Build the transfer list for one frame.  The frame is the SPI array followed
+// by the latch, cut into messages of at most bufsiz bytes.  A message that
+// straddles the end of the SPI array holds two transfers, so the list never
+// needs the data copied next to the zeros.
+//
+//*****************************************************************************
+static bool
+spidevBuild(uint8_t *pui8Data, uint32_t ui32DataSize)
+{
+    uint32_t ui32Bufsiz;
+    uint32_t ui32Latch;
+    uint32_t ui32Total;
+    uint32_t ui32Offs;
+    uint32_t ui32End;
+    uint32_t ui32Xfers;
+    uint32_t ui32Len;
+    uint32_t ui32Msg;
+
+    //
+    // Enough words of zeros to hold the line low for the latch time
+    //
+    ui32Latch = (((uint64_t)g_ui32DevHz * SPIDEV_LATCH_US) + 999999) /
+                1000000;
+    ui32Latch = ((ui32Latch + g_ui8DevBits - 1) / g_ui8DevBits) *
+                ((g_ui8DevBits + 7) / 8);
+
+    ui32Bufsiz = spidevBufsizGet();
+    ui32Total = ui32DataSize + ui32Latch;
+    g_ui32DevNumMsgs = (ui32Total + ui32Bufsiz - 1) / ui32Bufsiz;
+
+    g_psDevXfer = calloc(g_ui32DevNumMsgs + 1, sizeof(*g_psDevXfer));
+    g_psDevIov = calloc(g_ui32DevNumMsgs + 1, sizeof(*g_psDevIov));
+    g_pui8DevMsgXfers = calloc(g_ui32DevNumMsgs, 1);
+    g_pui8DevLatch = calloc(ui32Latch, 1);
+    if(!g_psDevXfer || !g_psDevIov || !g_pui8DevMsgXfers || !g_pui8DevLatch)
+    {
+        spidevFree();
+        g_iDevError = ENOMEM;
+        return(false);
+    }
+
+    g_pui8DevData = pui8Data;
+    g_ui32DevDataSize = ui32DataSize;
+    atomic_store(&g_pui8DevNextData, pui8Data);
+
+    ui32Xfers = 0;
+    for(ui32Msg = 0; ui32Msg < g_ui32DevNumMsgs; ui32Msg++)
+    {
+        ui32Offs = ui32Msg * ui32Bufsiz;
+        ui32End = ui32Offs + ui32Bufsiz;
+        if(ui32End > ui32Total)
+        {
+            ui32End = ui32Total;
+        }
+
+        while(ui32Offs < ui32End)
+        {
+            if(ui32Offs < ui32DataSize)
+            {
+                ui32Len = ((ui32End < ui32DataSize) ? ui32End : ui32DataSize) -
+                          ui32Offs;
+                g_psDevIov[ui32Xfers].iov_base = pui8Data + ui32Offs;
+            }
+            else
+            {
+                ui32Len = ui32End - ui32Offs;
+                g_psDevIov[ui32Xfers].iov_base = g_pui8DevLatch +
+                                                 (ui32Offs - ui32DataSize);
+            }
+
+            g_psDevIov[ui32Xfers].iov_len = ui32Len;
+            g_psDevXfer[ui32Xfers].tx_buf =
+                (uintptr_t)g_psDevIov[ui32Xfers].iov_base;
+            g_psDevXfer[ui32Xfers].len = ui32Len;
+            g_psDevXfer[ui32Xfers].speed_hz = g_ui32DevHz;
+            g_psDevXfer[ui32Xfers].bits_per_word = g_ui8DevBits;
+            g_pui8DevMsgXfers[ui32Msg]++;
+            ui32Xfers++;
+            ui32Offs += ui32Len;
+        }
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Point the data transfers at a new SPI array.  The latch transfers are left
+// alone.
+//
+//*****************************************************************************
+static void
+spidevRebase(uint8_t *pui8Data)
+{
+    uint32_t ui32Xfer;
+    uint32_t ui32Offs;
+    uint32_t ui32Msg;
+    uint8_t *pui8Base;
+
+    ui32Xfer = 0;
+    for(ui32Msg = 0; ui32Msg < g_ui32DevNumMsgs; ui32Msg++)
+    {
+        ui32Xfer += g_pui8DevMsgXfers[ui32Msg];
+    }
+
+    while(ui32Xfer--)
+    {
+        pui8Base = g_psDevIov[ui32Xfer].iov_base;
+        if((pui8Base >= g_pui8DevData) &&
+           (pui8Base < (g_pui8DevData + g_ui32DevDataSize)))
+        {
+            ui32Offs = pui8Base - g_pui8DevData;
+            g_psDevIov[ui32Xfer].iov_base = pui8Data + ui32Offs;
+            g_psDevXfer[ui32Xfer].tx_buf = (uintptr_t)(pui8Data + ui32Offs);
+        }
+    }
+
+    g_pui8DevData = pui8Data;
+}
+
+//*****************************************************************************
+//
+// Switch to the frame source set with SPIFrameSourceSet().  A source the size
+// of the current one only needs the transfers pointing at it; any other
+// size needs a new transfer list.
+//
+//*****************************************************************************
+static bool
+spidevSourceSwitch(void)
+{
+    const uint8_t *pui8Source;
+    uint32_t ui32Size;
+
+    pthread_mutex_lock(&g_sDevSourceLock);
+    pui8Source = g_pui8DevSource;
+    ui32Size = g_ui16DevSourceSize;
+    pthread_mutex_unlock(&g_sDevSourceLock);
+
+    if(pui8Source == NULL)
+    {
+        pui8Source = g_pui8DevArray;
+        ui32Size = g_ui16DevArraySize;
+    }
+
+    //
+    // The transfers only ever read from the source.
+    //
+    if(ui32Size == g_ui32DevDataSize)
+    {
+        spidevRebase((uint8_t *)pui8Source);
+        atomic_store(&g_pui8DevNextData, pui8Source);
+        return(true);
+    }
+
+    spidevFree();
+    return(spidevBuild((uint8_t *)pui8Source, ui32Size));
+}
+
+//*****************************************************************************
+//
+// Write one message to the mock descriptor.  A short write can stop part way
+// through a transfer, so carry on from there until the whole message is out.
+//
+//*****************************************************************************
+static bool
+spidevMockWrite(const struct iovec *psIov, uint8_t ui8Count)
+{
+    struct iovec sRest;
+    ssize_t iRet;
+
+    sRest.iov_len = 0;
+    while(ui8Count || sRest.iov_len)
+    {
+        do
+        {
+            if(sRest.iov_len)
+            {
+                iRet = writev(g_iDevMockFd, &sRest, 1);
+            }
+            else
+            {
+                iRet = writev(g_iDevMockFd, psIov, ui8Count);
+            }
+        }
+        while((iRet < 0) && (errno == EINTR));
+
+        if(iRet <= 0)
+        {
+            g_iDevError = (iRet < 0) ? errno : EIO;
+            return(false);
+        }
+
+        if(sRest.iov_len)
+        {
+            sRest.iov_base = (uint8_t *)sRest.iov_base + iRet;
+            sRest.iov_len -= iRet;
+            continue;
+        }
+
+        while(ui8Count && ((size_t)iRet >= psIov->iov_len))
+        {
+            iRet -= psIov->iov_len;
+            psIov++;
+            ui8Count--;
+        }
+        if(iRet)
+        {
+            sRest.iov_base = (uint8_t *)psIov->iov_base + iRet;
+            sRest.iov_len = psIov->iov_len - iRet;
+            psIov++;
+            ui8Count--;
+        }
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Send one frame, message by message.  A message interrupted by a signal is
+// sent again.
+//
+//*****************************************************************************
+static bool
+spidevSendFrame(void)
+{
+    uint32_t ui32Msg;
+    uint32_t ui32Xfer;
+    uint8_t ui8Count;
+    int iRet;
+
+    ui32Xfer = 0;
+    for(ui32Msg = 0; ui32Msg < g_ui32DevNumMsgs; ui32Msg++)
+    {
+        ui8Count = g_pui8DevMsgXfers[ui32Msg];
+        if(g_iDevMockFd >= 0)
+        {
+            if(!spidevMockWrite(&g_psDevIov[ui32Xfer], ui8Count))
+            {
+                return(false);
+            }
+        }
+        else
+        {
+            do
+            {
+                iRet = ioctl(g_iDevFd, SPI_IOC_MESSAGE(ui8Count),
+                             &g_psDevXfer[ui32Xfer]);
+            }
+            while((iRet < 0) && (errno == EINTR));
+
+            if(iRet < 0)
+            {
+                g_iDevError = errno;
+                return(false);
+            }
+        }
+        ui32Xfer += ui8Count;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Add ui32Ns nanoseconds to a timespec.
+//
+//*****************************************************************************
+static void
+spidevTimeAdd(struct timespec *psTime, uint32_t ui32Ns)
+{
+    psTime->tv_nsec += ui32Ns;
+    while(psTime->tv_nsec >= 1000000000)
+    {
+        psTime->tv_nsec -= 1000000000;
+        psTime->tv_sec++;
+    }
+}
+
+//*****************************************************************************
+//
+// The sending thread, standing in for the SSI1 interrupt.  Each frame starts
+// one period after the previous one was due.
+//
+//*****************************************************************************
+static void *
+spidevThread(void *pvArg)
+{
+    struct timespec sNext;
+    struct timespec sLate;
+    struct timespec sNow;
+    uint8_t *pui8Next;
+
+    (void)pvArg;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNext);
+
+    while(!g_bDevStop)
+    {
+        if(atomic_load_explicit(&g_bDevSourceNew, memory_order_relaxed) &&
+           atomic_exchange(&g_bDevSourceNew, false) && !spidevSourceSwitch())
+        {
+            break;
+        }
+
+        pui8Next = (uint8_t *)atomic_load(&g_pui8DevNextData);
+        if(pui8Next != g_pui8DevData)
+        {
+            spidevRebase(pui8Next);
+        }
+
+        if(!spidevSendFrame())
+        {
+            break;
+        }
+
+        *g_pui8DevDoneVar = 1;
+        if(g_pfnFrameDone != NULL)
+        {
+            g_pfnFrameDone();
+        }
+
+        if(g_ui32DevPeriodNs == 0)
+        {
+            continue;
+        }
+
+        spidevTimeAdd(&sNext, g_ui32DevPeriodNs);
+        sLate = sNext;
+        spidevTimeAdd(&sLate, g_ui32DevPeriodNs);
+        clock_gettime(CLOCK_MONOTONIC, &sNow);
+        if((sNow.tv_sec > sLate.tv_sec) ||
+           ((sNow.tv_sec == sLate.tv_sec) && (sNow.tv_nsec > sLate.tv_nsec)))
+        {
+            g_ui32DevLate++;
+            sNext = sNow;
+            continue;
+        }
+
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sNext,
+                              NULL) == EINTR)
+        {
+        }
+    }
+
+    return(NULL);
+}
+
+void
+SPIDevConfigSet(const char *pcPath, uint32_t ui32Hz, uint8_t ui8Bits)
+{
+    g_pcDevPath = pcPath;
+    g_ui32DevHz = ui32Hz;
+    g_ui8DevBits = ui8Bits;
+}
+
+void
+SPIDevFrameRateSet(uint32_t ui32Hz)
+{
+    g_ui32DevPeriodNs = ui32Hz ? (1000000000 / ui32Hz) : 0;
+}
+
+void
+SPIDevMockSet(int iFd)
+{
+    g_iDevMockFd = iFd;
+}
+
+void
+SPIDevDataSet(const uint8_t *pui8SPIData)
+{
+    atomic_store(&g_pui8DevNextData, pui8SPIData);
+}
+
+int
+SPIDevErrorGet(void)
+{
+    return(g_iDevError);
+}
+
+void
+SPIDevStop(void)
+{
+    if(g_bDevRunning)
+    {
+        g_bDevStop = true;
+        pthread_join(g_sDevThread, NULL);
+        g_bDevRunning = false;
+    }
+
+    if(g_iDevFd >= 0)
+    {
+        close(g_iDevFd);
+        g_iDevFd = -1;
+    }
+    spidevFree();
+}
+
+void
+uDMAControllerInit(void)
+{
+}
+
+void
+InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
+                uint8_t *pui8DoneVar)
+{
+    uint8_t *pui8Source;
+    uint32_t ui32Speed;
+    uint8_t ui8Mode;
+    int iErr;
+
+    SPIDevStop();
+    g_iDevError = 0;
+
+    //
+    // Frames come from the SPI array unless a frame source was set first.
+    // With neither there is nothing to send.
+    //
+    if((pui8SPIData == NULL) && (g_pui8DevSource == NULL))
+    {
+        g_iDevError = EINVAL;
+        return;
+    }
+    g_pui8DevArray = pui8SPIData;
+    g_ui16DevArraySize = ui16DataSize;
+    if(pui8SPIData != NULL)
+    {
+        WSArrayInit(pui8SPIData, ui16DataSize);
+    }
+
+    if(g_iDevMockFd < 0)
+    {
+        g_iDevFd = open(g_pcDevPath, O_RDWR);
+        if(g_iDevFd < 0)
+        {
+            g_iDevError = errno;
+            return;
+        }
+
+        ui8Mode = SPI_MODE_0;
+        ui32Speed = g_ui32DevHz;
+        if((ioctl(g_iDevFd, SPI_IOC_WR_MODE, &ui8Mode) < 0) ||
+           (ioctl(g_iDevFd, SPI_IOC_WR_BITS_PER_WORD, &g_ui8DevBits) < 0) ||
+           (ioctl(g_iDevFd, SPI_IOC_WR_MAX_SPEED_HZ, &ui32Speed) < 0))
+        {
+            g_iDevError = errno;
+            SPIDevStop();
+            return;
+        }
+    }
+
+    //
+    // The transfers only ever read from the source.
+    //
+    atomic_store(&g_bDevSourceNew, false);
+    if(g_pui8DevSource != NULL)
+    {
+        pui8Source = (uint8_t *)g_pui8DevSource;
+        ui16DataSize = g_ui16DevSourceSize;
+    }
+    else
+    {
+        pui8Source = pui8SPIData;
+    }
+    if(!spidevBuild(pui8Source, ui16DataSize))
+    {
+        SPIDevStop();
+        return;
+    }
+
+    g_pui8DevDoneVar = pui8DoneVar;
+    *pui8DoneVar = 0;
+    g_ui32DevLate = 0;
+    g_bDevStop = false;
+
+    iErr = pthread_create(&g_sDevThread, NULL, spidevThread, NULL);
+    if(iErr != 0)
+    {
+        g_iDevError = iErr;
+        SPIDevStop();
+        return;
+    }
+    g_bDevRunning = true;
+}
+
+void
+SPIDMAConfigSet(bool bHighPriority, uint32_t ui32Arb, bool bBurstOnly)
+{
+    //
+    // There is no uDMA controller to configure.
+    //
+    (void)bHighPriority;
+    (void)ui32Arb;
+    (void)bBurstOnly;
+}
+
+bool
+SPIFrameSourceSet(const uint8_t *pui8Frame, uint16_t ui16Size)
+{
+    if((pui8Frame == NULL) && g_bDevRunning && (g_pui8DevArray == NULL))
+    {
+        return(false);
+    }
+    if((pui8Frame != NULL) &&
+       ((ui16Size == 0) || !WSFlashFrameCheck(pui8Frame, ui16Size)))
+    {
+        return(false);
+    }
+
+    pthread_mutex_lock(&g_sDevSourceLock);
+    g_pui8DevSource = pui8Frame;
+    g_ui16DevSourceSize = ui16Size;
+    pthread_mutex_unlock(&g_sDevSourceLock);
+    atomic_store(&g_bDevSourceNew, true);
+
+    return(true);
+}
+
+void
+SPIPartialRefreshSet(bool bEnable, uint16_t ui16FullEvery)
+{
+    //
+    // The transfer list is fixed, so frames are always sent whole.
+    //
+    (void)bEnable;
+    (void)ui16FullEvery;
+}
+
+void
+SPIDirtyMark(uint16_t ui16LED)
+{
+    (void)ui16LED;
+}
+
+uint32_t
+SPIUnderrunsGet(void)
+{
+    return(g_ui32DevLate);
+}
+
+void
+SPIFrameCallbackSet(void (*pfnCallback)(void))
+{
+    g_pfnFrameDone = pfnCallback;
+}
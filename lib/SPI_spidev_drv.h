@@ -0,0 +1,151 @@
+
+
+#ifndef __SPI_SPIDEV_DRV_H__
+#define __SPI_SPIDEV_DRV_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Linux spidev output backend.
+//
+// SPI_spidev_drv.c is built in place of SPI_uDMA_drv.c on Linux boards.  It
+// provides InitSPITransfer(), SPIFrameSourceSet(), SPIFrameCallbackSet() and
+// SPIUnderrunsGet() as declared in SPI_uDMA_drv.h, so pixel code written
+// against the uDMA driver runs unchanged.  uDMAControllerInit() and
+// SPIDMAConfigSet() do nothing, and partial refresh is ignored: every frame
+// is sent whole.  A frame source has no 1024 byte limit here, and its bytes
+// are checked against the SPI bytes in use (g_ui8WSSPIHigh and
+// g_ui8WSSPILow), as no timing plan is chosen.
+//
+// Instead of the uDMA ping-pong, a thread sends the SPI array to
+// /dev/spidevX.Y over and over, followed by enough zero bytes to latch, and
+// sleeps until the next frame is due.  Each frame goes out as a few
+// SPI_IOC_MESSAGE calls whose transfers point straight into the SPI array,
+// so nothing is copied or allocated per frame.  A message can hold at most
+// spidev's bufsiz bytes (/sys/module/spidev/parameters/bufsiz, 4096 by
+// default); there may be a short gap on the line between messages, so boot
+// with spidev.bufsiz raised to the frame size to send a frame in one go.
+//
+// The done flag and the frame callback are set and called from the sending
+// thread.
+//
+//*****************************************************************************
+
+//
+// Defaults used by InitSPITransfer() unless changed with SPIDevConfigSet().
+// These match the legacy timing plan in WS2812_timing.c, which the default
+// WS2812_SPI_HIGH and WS2812_SPI_LOW encoding is built for.
+//
+#define SPIDEV_DEFAULT_PATH     "/dev/spidev0.0"
+#define SPIDEV_DEFAULT_HZ       2500000
+#define SPIDEV_DEFAULT_BITS     8
+
+//
+// Length of the low latch after each frame, in microseconds
+//
+#define SPIDEV_LATCH_US         300
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Choose the spidev device and how it is clocked
+//
+// Must be called before InitSPITransfer() to take effect.
+//
+// @input pcPath is the device node, for example "/dev/spidev0.0"
+// @input ui32Hz is the SPI clock rate
+// @input ui8Bits is the number of bits per word
+//
+//*****************************************************************************
+extern void SPIDevConfigSet(const char *pcPath, uint32_t ui32Hz,
+                            uint8_t ui8Bits);
+
+//*****************************************************************************
+//
+// Set the frame rate
+//
+// Frames are started on a fixed schedule against CLOCK_MONOTONIC, so the
+// rate doesn't drift with how long a frame takes to send.  A frame that
+// starts more than one period late is counted by SPIUnderrunsGet() and the
+// schedule restarts from then.
+//
+// @input ui32Hz is the number of frames per second, or 0 to send frames back
+//        to back
+//
+//*****************************************************************************
+extern void SPIDevFrameRateSet(uint32_t ui32Hz);
+
+//*****************************************************************************
+//
+// Send frames to a file descriptor instead of a spidev device
+//
+// Each message is written to the descriptor with writev() in place of the
+// ioctl, one buffer per transfer.  With a pipe, a file or /dev/null this
+// exercises the batching, pacing and callbacks without SPI hardware.  Must
+// be called before InitSPITransfer() to take effect.
+//
+// @input iFd is the descriptor to write to, or -1 to go back to the device
+//
+//*****************************************************************************
+extern void SPIDevMockSet(int iFd);
+
+//*****************************************************************************
+//
+// Send a different SPI array from the next frame on
+//
+// The transfers are pointed at the new array without copying it, so a
+// replay can hand over frames straight from a mapped show file (see
+// WS2812_show.h).  The array must be the size given to InitSPITransfer()
+// and stay readable until the frame after it has started.  It replaces the
+// SPI array, so don't use it while a frame from SPIFrameSourceSet() of
+// another size is being sent.
+//
+// @input pui8SPIData is the SPI array to send
+//
+//*****************************************************************************
+extern void SPIDevDataSet(const uint8_t *pui8SPIData);
+
+//*****************************************************************************
+//
+// Get the reason the backend isn't running
+//
+// @returns the errno of the last failed open, ioctl or write, or 0
+//
+//*****************************************************************************
+extern int SPIDevErrorGet(void);
+
+//*****************************************************************************
+//
+// Stop sending frames
+//
+// Waits for the frame in progress to finish, then closes the device and
+// frees the transfer list.  InitSPITransfer() can be called again afterwards.
+//
+//*****************************************************************************
+extern void SPIDevStop(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SPI_SPIDEV_DRV_H__
@@ -3,6 +3,9 @@
 #include <stddef.h>
 #include "SPI_uDMA_drv.h"
 #include "WS2812_drv.h"
+#include "WS2812_flash.h"
+#include "WS2812_timing.h"
+#include "WS2812_trace.h"
 
 #include "driverlib/gpio.h"
 #include "driverlib/pin_map.h"
@@ -13,6 +16,7 @@
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_ssi.h"
+#include "inc/hw_types.h"
 
 //*****************************************************************************
 //
@@ -33,6 +37,139 @@ unsigned char ucControlTable[1024] __attribute__ ((aligned(1024)));
 static uint8_t *g_pui8DoneVar = NULL;
 static uint8_t *g_pui8SPIArray;
 static uint16_t g_ui16SPIArraySize;
+static bool g_bSPIRunning = false;
+
+//
+// Where frames are sent from: the SPI array, or a const frame in flash set
+// with SPIFrameSourceSet().  A new source is always sent whole once.
+//
+static const uint8_t *g_pui8SPISource;
+static uint16_t g_ui16SPISourceSize;
+static bool g_bSPISourceNew;
+static uint16_t g_ui16SPILatchSize;
+static void (*g_pfnFrameDone)(void);
+static uint32_t g_ui32SPIUnderruns;
+
+//
+// Partial refresh, see SPIPartialRefreshSet().  g_ui16SPIDirtyEnd is one past
+// the highest LED marked since the last frame was armed.
+//
+static bool g_bSPIPartial = false;
+static uint16_t g_ui16SPIFullEvery;
+static uint16_t g_ui16SPISinceFull;
+static volatile uint16_t g_ui16SPIDirtyEnd;
+
+//
+// uDMA settings for the SSI1 TX channel, see SPIDMAConfigSet()
+//
+static uint32_t g_ui32SPIArb = UDMA_ARB_8;
+static bool g_bSPIHighPriority = false;
+static bool g_bSPIBurstOnly = false;
+
+//*****************************************************************************
+//
+// Apply the priority and burst settings to the SSI1 TX channel.
+//
+//*****************************************************************************
+static void
+spiDMAAttrApply(void)
+{
+    if(g_bSPIHighPriority)
+    {
+        ROM_uDMAChannelAttributeEnable(UDMA_CHANNEL_SSI1TX,
+                                       UDMA_ATTR_HIGH_PRIORITY);
+    }
+    else
+    {
+        ROM_uDMAChannelAttributeDisable(UDMA_CHANNEL_SSI1TX,
+                                        UDMA_ATTR_HIGH_PRIORITY);
+    }
+
+    if(g_bSPIBurstOnly)
+    {
+        ROM_uDMAChannelAttributeEnable(UDMA_CHANNEL_SSI1TX,
+                                       UDMA_ATTR_USEBURST);
+    }
+    else
+    {
+        ROM_uDMAChannelAttributeDisable(UDMA_CHANNEL_SSI1TX,
+                                        UDMA_ATTR_USEBURST);
+    }
+}
+
+//*****************************************************************************
+//
+// Work out how many bytes of the SPI array the next frame sends.  With
+// partial refresh on that is the prefix up to the last LED marked dirty, or
+// the whole array when a full refresh is due.
+//
+//*****************************************************************************
+static uint16_t
+spiFrameLength(void)
+{
+    uint32_t ui32Len;
+
+    if(!g_bSPIPartial || g_bSPISourceNew)
+    {
+        g_bSPISourceNew = false;
+        return(g_ui16SPISourceSize);
+    }
+
+    g_ui16SPISinceFull++;
+    if(g_ui16SPIFullEvery && (g_ui16SPISinceFull >= g_ui16SPIFullEvery))
+    {
+        g_ui16SPISinceFull = 0;
+        g_ui16SPIDirtyEnd = 0;
+        return(g_ui16SPISourceSize);
+    }
+
+    ui32Len = (uint32_t)g_ui16SPIDirtyEnd * WS2812_SPI_LED_SIZE;
+    g_ui16SPIDirtyEnd = 0;
+    if(ui32Len > g_ui16SPISourceSize)
+    {
+        ui32Len = g_ui16SPISourceSize;
+    }
+    return(ui32Len);
+}
+
+//*****************************************************************************
+//
+// Arm the latch: enough zero frames to tell the LEDs the frame is complete.
+//
+//*****************************************************************************
+static void
+spiArmLatch(void)
+{
+    static unsigned char ucZero = 0;
+
+    ROM_uDMAChannelControlSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_NONE | g_ui32SPIArb);
+    ROM_uDMAChannelTransferSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
+                               UDMA_MODE_BASIC, &ucZero,
+                               (void *)(SSI1_BASE + SSI_O_DR),
+                               g_ui16SPILatchSize);
+}
+
+//*****************************************************************************
+//
+// Report that the SPI array has been read out and may be rewritten.  Once the
+// last data byte is in the SSI FIFO the latch still has to be sent, which is
+// the head start a render gets before the next frame starts reading.
+//
+//*****************************************************************************
+static void
+spiFrameDone(void)
+{
+    if(g_pui8DoneVar != NULL)
+    {
+        *g_pui8DoneVar = 1;
+    }
+    if(g_pfnFrameDone != NULL)
+    {
+        g_pfnFrameDone();
+    }
+}
 
 //*****************************************************************************
 //
@@ -48,8 +185,10 @@ void
 SSI1IntHandler(void)
 {
     unsigned long ulStatus;
+    uint16_t ui16Len;
     static unsigned char ucPing = 0;
-    static unsigned char ucZero = 0;
+
+    WSTRACE(WS_TRACE_ISR_ENTER, WS_TRACE_ID_SSI1, 0);
 
     //
     // Read the interrupt status of the UART.
@@ -65,6 +204,20 @@ SSI1IntHandler(void)
     //
     ROM_SSIIntClear(SSI1_BASE, ulStatus);
 
+    //
+    // The TX interrupt is only enabled while the frame data is being sent,
+    // and in end of transmission mode it means the FIFO ran dry and the line
+    // went idle.  The uDMA channel still being enabled means the frame wasn't
+    // finished, so the LEDs saw a gap: an underrun.  The interrupt stays
+    // asserted while the FIFO is empty, so leave it off until the next frame.
+    //
+    if((ulStatus & SSI_TXFF) && ROM_uDMAChannelIsEnabled(UDMA_CHANNEL_SSI1TX))
+    {
+        ROM_SSIIntDisable(SSI1_BASE, SSI_TXFF);
+        g_ui32SPIUnderruns++;
+        WSTRACE(WS_TRACE_UNDERRUN, WS_TRACE_ID_SSI1, 0);
+    }
+
     //
     // If the UART0 DMA TX channel is disabled, that means the TX DMA transfer
     // is done.
@@ -77,17 +230,33 @@ SSI1IntHandler(void)
         //
         if(ucPing)
         {
-            ROM_uDMAChannelControlSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
+            //
+            // LEDs past the end of a partial frame keep their colors.  If
+            // nothing changed at all, send another latch instead so frames
+            // keep completing at the same points.
+            //
+            ui16Len = spiFrameLength();
+            if(ui16Len)
+            {
+                ROM_uDMAChannelControlSet(UDMA_CHANNEL_SSI1TX |
+                                          UDMA_PRI_SELECT,
                                           UDMA_SIZE_8 | UDMA_SRC_INC_8 |
-                                          UDMA_DST_INC_NONE | UDMA_ARB_8);
-            ROM_uDMAChannelTransferSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
-                                   UDMA_MODE_BASIC, g_pui8SPIArray,
-                                   (void *)(SSI1_BASE + SSI_O_DR),
-                                   g_ui16SPIArraySize);
-            ucPing = 0;
-            if(g_pui8DoneVar != NULL)
+                                          UDMA_DST_INC_NONE | g_ui32SPIArb);
+                ROM_uDMAChannelTransferSet(UDMA_CHANNEL_SSI1TX |
+                                           UDMA_PRI_SELECT,
+                                           UDMA_MODE_BASIC,
+                                           (void *)g_pui8SPISource,
+                                           (void *)(SSI1_BASE + SSI_O_DR),
+                                           ui16Len);
+                WSTRACE(WS_TRACE_ARMED, WS_TRACE_ID_SSI1, ui16Len);
+                ucPing = 0;
+                ROM_SSIIntEnable(SSI1_BASE, SSI_TXFF);
+            }
+            else
             {
-                *g_pui8DoneVar = 1;
+                spiArmLatch();
+                WSTRACE(WS_TRACE_LATCH, WS_TRACE_ID_SSI1, 0);
+                spiFrameDone();
             }
         }
         else
@@ -95,21 +264,23 @@ SSI1IntHandler(void)
             //
             // Send out enough zero's to inform the LEDs that the previous
             // message is complete.  uDMA is a bit overkill for this... meh.
+            // The number of zero frames comes from the timing plan.  The FIFO
+            // empties at the end of the latch, so stop watching for underruns.
+            // The frame data is all in the FIFO now, so the SPI array is free.
             //
-            ROM_uDMAChannelControlSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
-                                          UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
-                                          UDMA_DST_INC_NONE | UDMA_ARB_8);
-            ROM_uDMAChannelTransferSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
-                                               UDMA_MODE_BASIC, &ucZero,
-                                               (void *)(SSI1_BASE + SSI_O_DR),
-                                               2);
+            ROM_SSIIntDisable(SSI1_BASE, SSI_TXFF);
+            spiArmLatch();
+            WSTRACE(WS_TRACE_LATCH, WS_TRACE_ID_SSI1, 0);
             ucPing = 1;
+            spiFrameDone();
         }
         //
         // The uDMA TX channel must be re-enabled.
         //
         ROM_uDMAChannelEnable(UDMA_CHANNEL_SSI1TX);
     }
+
+    WSTRACE(WS_TRACE_ISR_EXIT, WS_TRACE_ID_SSI1, 0);
 }
 
 //*****************************************************************************
@@ -136,29 +307,120 @@ uDMAErrorHandler(void)
     //
     if(ulStatus)
     {
+        WSTRACE(WS_TRACE_DMA_ERROR, WS_TRACE_ID_UDMAERR, ulStatus);
         uDMAErrorStatusClear();
         //while(1);
     }
 }
 
-
 void
-InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
-                uint8_t *pui8DoneVar)
+SPIDMAConfigSet(bool bHighPriority, uint32_t ui32Arb, bool bBurstOnly)
 {
-    int i;
+    g_bSPIHighPriority = bHighPriority;
+    g_ui32SPIArb = ui32Arb;
+    g_bSPIBurstOnly = bBurstOnly;
 
-    g_pui8DoneVar = pui8DoneVar;
-    g_pui8SPIArray = pui8SPIData;
-    g_ui16SPIArraySize = ui16DataSize;
+    //
+    // The arbitration size is picked up the next time a transfer is armed.
+    // The attributes can change on the fly once the uDMA controller is
+    // running; before that InitSPITransfer() applies them.
+    //
+    if(g_bSPIRunning)
+    {
+        spiDMAAttrApply();
+    }
+}
+
+bool
+SPIFrameSourceSet(const uint8_t *pui8Frame, uint16_t ui16Size)
+{
+    if(pui8Frame == NULL)
+    {
+        if(g_pui8SPIArray == NULL)
+        {
+            return(false);
+        }
+        pui8Frame = g_pui8SPIArray;
+        ui16Size = g_ui16SPIArraySize;
+    }
+    else
+    {
+        //
+        // A frame goes out in a single uDMA transfer, and has to be encoded
+        // with the SPI bytes of the timing plan, which is chosen here if
+        // this comes before InitSPITransfer().
+        //
+        WSTimingActive();
+        if((ui16Size == 0) || (ui16Size > 1024) ||
+           !WSFlashFrameCheck(pui8Frame, ui16Size))
+        {
+            return(false);
+        }
+    }
 
     //
-    // zero out SPI data array
+    // Keep the handler from arming a frame between the two writes.
     //
-    for(i=0;i<ui16DataSize;i++)
+    if(g_bSPIRunning)
     {
-        WSArrayInit(pui8SPIData, ui16DataSize);
+        ROM_IntDisable(INT_SSI1);
+    }
+
+    g_pui8SPISource = pui8Frame;
+    g_ui16SPISourceSize = ui16Size;
+    g_bSPISourceNew = true;
+
+    if(g_bSPIRunning)
+    {
+        ROM_IntEnable(INT_SSI1);
+    }
+
+    return(true);
+}
+
+void
+SPIPartialRefreshSet(bool bEnable, uint16_t ui16FullEvery)
+{
+    g_ui16SPIFullEvery = ui16FullEvery;
+    g_ui16SPISinceFull = 0;
+    g_bSPIPartial = bEnable;
+}
+
+void
+SPIDirtyMark(uint16_t ui16LED)
+{
+    //
+    // If the interrupt takes the mark between the read and the write, the
+    // write can only leave the mark too high, never too low.
+    //
+    if(ui16LED >= g_ui16SPIDirtyEnd)
+    {
+        g_ui16SPIDirtyEnd = ui16LED + 1;
+    }
+}
+
+uint32_t
+SPIUnderrunsGet(void)
+{
+    return(g_ui32SPIUnderruns);
+}
+
+void
+SPIFrameCallbackSet(void (*pfnCallback)(void))
+{
+    g_pfnFrameDone = pfnCallback;
+}
+
+void
+uDMAControllerInit(void)
+{
+    static bool bInitialized = false;
+
+    if(bInitialized)
+    {
+        return;
     }
+    bInitialized = true;
 
     //
     // Enable the uDMA controller at the system level.  Enable it to continue
@@ -182,6 +444,57 @@ InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
     // Point at the control table to use for channel control structures.
     //
     ROM_uDMAControlBaseSet(ucControlTable);
+}
+
+void
+InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
+                uint8_t *pui8DoneVar)
+{
+    const tWSTiming *psTiming;
+
+    //
+    // Frames come from the SPI array unless a flash frame was set first.
+    // With neither there is nothing to send.
+    //
+    if((pui8SPIData == NULL) && (g_pui8SPISource == NULL))
+    {
+        return;
+    }
+
+    g_pui8DoneVar = pui8DoneVar;
+    g_pui8SPIArray = pui8SPIData;
+    g_ui16SPIArraySize = ui16DataSize;
+
+    if(g_pui8SPISource == NULL)
+    {
+        g_pui8SPISource = pui8SPIData;
+        g_ui16SPISourceSize = ui16DataSize;
+    }
+    g_bSPISourceNew = false;
+
+    //
+    // Pick the SSI timing for the current system clock, which also sets the
+    // SPI encoding used below.  A single uDMA transfer sends the latch.
+    //
+    psTiming = WSTimingActive();
+    g_ui16SPILatchSize = psTiming->ui16LatchFrames;
+    if(g_ui16SPILatchSize > 1024)
+    {
+        g_ui16SPILatchSize = 1024;
+    }
+
+    //
+    // zero out SPI data array
+    //
+    if(pui8SPIData != NULL)
+    {
+        WSArrayInit(pui8SPIData, ui16DataSize);
+    }
+
+    //
+    // Bring up the uDMA controller if no other driver has done so already.
+    //
+    uDMAControllerInit();
 
     //
     // Enable the SPI peripheral, and configure it to operate even if the CPU
@@ -198,13 +511,18 @@ InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
     GPIOPinTypeSSI(GPIO_PORTF_BASE, GPIO_PIN_1);
 
     //
-    // Configure the SPI communication parameters.  We could use 4 instead of
-    // 8 here and be more memory efficient (as each spi bit is encoded into 4
-    // bits on the SPI line), but the uDMA only allows for 8 bit increment of
-    // source data
+    // Configure the SPI communication parameters.  Each byte of the SPI
+    // array is one SSI frame and one WS bit; the timing plan picks the frame
+    // size (4 to 8 bits, as the uDMA only allows for 8 bit increment of
+    // source data) and the bit rate.
+    //
+    WSTimingConfigSSI(SSI1_BASE, psTiming);
+
+    //
+    // Have the TX interrupt flag an empty FIFO with the line gone idle,
+    // rather than a half empty one, for the underrun detector.
     //
-    ROM_SSIConfigSetExpClk(SSI1_BASE, ROM_SysCtlClockGet(), SSI_FRF_MOTO_MODE_0,
-                            SSI_MODE_MASTER, 2500000, 8);
+    HWREG(SSI1_BASE + SSI_O_CR1) |= SSI_CR1_EOT;
 
     //
     // Enable the SSI for operation, and enable the uDMA interface for both the
@@ -222,13 +540,14 @@ InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
     ROM_IntEnable(INT_SSI1);
 
     //
-    // Put the attributes in a known state for the uDMA SSI1TX channel.  These
-    // should already be disabled by default.
+    // Put the attributes in a known state for the uDMA SSI1TX channel, then
+    // apply the priority and burst settings from SPIDMAConfigSet().
     //
     ROM_uDMAChannelAttributeDisable(UDMA_CHANNEL_SSI1TX,
                                     UDMA_ATTR_ALTSELECT |
                                     UDMA_ATTR_HIGH_PRIORITY |
                                     UDMA_ATTR_REQMASK);
+    spiDMAAttrApply();
 
     //
     // Configure the control parameters for the SSI TX.  The uDMA SSI TX
@@ -236,16 +555,13 @@ InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
     // The data size is 8 bits.  The source address increment is 8-bit bytes
     // since the data is coming from a uint8_t buffer.  The destination
     // increment is none since the data is to be written to the SSI data
-    // register.  The arbitration size is set to 4, which doesn't matter much
-    // since we're only running one uDMA transfer.  If we were running multiple
-    // transfers through the uDMA engine, we would want to increase this enough
-    // to insure that the full LED strip worth of data goes out before the uDMA
-    // engine services another channel.
-    // TODO: see last sentence.
+    // register.  The arbitration size comes from SPIDMAConfigSet(); with
+    // other uDMA channels busy it decides how many bytes go out before the
+    // controller can service another channel.
     //
     ROM_uDMAChannelControlSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
                               UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE |
-                              UDMA_ARB_8);
+                              g_ui32SPIArb);
 
     //
     // Set up the transfer parameters for the uDMA SSI TX channel.  This will
@@ -255,9 +571,9 @@ InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
     // data register.
     //
     ROM_uDMAChannelTransferSet(UDMA_CHANNEL_SSI1TX | UDMA_PRI_SELECT,
-                               UDMA_MODE_BASIC, pui8SPIData,
+                               UDMA_MODE_BASIC, (void *)g_pui8SPISource,
                                (void *)(SSI1_BASE + SSI_O_DR),
-                               ui16DataSize);
+                               g_ui16SPISourceSize);
 
     *pui8DoneVar = 0;
 
@@ -268,5 +584,7 @@ InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
     //
     ROM_IntMasterEnable();
     ROM_uDMAChannelEnable(UDMA_CHANNEL_SSI1TX);
+    ROM_SSIIntEnable(SSI1_BASE, SSI_TXFF);
+    g_bSPIRunning = true;
 }
 
@@ -14,20 +14,45 @@ extern "C"
 {
 #endif
 
+//*****************************************************************************
+//
+// The control table used by the uDMA controller.  It is shared by every driver
+// that uses a uDMA channel.
+//
+//*****************************************************************************
+extern unsigned char ucControlTable[1024];
+
 //*****************************************************************************
 //
 // Function prototypes
 //
 //*****************************************************************************
 
+//*****************************************************************************
+//
+// Enable the uDMA controller.
+//
+// This function enables the uDMA controller and its error interrupt, and
+// points it at ucControlTable.  It only does the work the first time it is
+// called, so every driver that needs a uDMA channel can call it.
+//
+//*****************************************************************************
+extern void uDMAControllerInit(void);
+
 //*****************************************************************************
 //
 // Kick off the SPI uDMA transfers.
 //
 // This function will configure the uDMA engine and SSI1 peripheral to
-// continually data to a chain of WS2812b LEDs connected to PF1.
+// continually data to a chain of WS2812b LEDs connected to PF1.  The SSI
+// timing and SPI encoding come from WSTimingActive().
 //
-// @input pui8SPIData is the array containing the SPI data to send
+// If SPIFrameSourceSet() was called first, the first frames come from that
+// flash frame instead of the SPI array.  The SPI array may then be NULL, in
+// which case only flash frames are ever sent and no RAM is used for them.
+// With a NULL SPI array and no flash frame nothing is started.
+//
+// @input pui8SPIData is the array containing the SPI data to send, or NULL
 // @input ui16DataSize is the number of bytes the data array can hold
 // @input pui8DoneVar is a flag that can be used to determine when an LED frame
 //        has finished transmitting.  This flag will be initialized to 0 on the
@@ -38,6 +63,108 @@ extern "C"
 extern void InitSPITransfer(uint8_t *pui8SPIData, uint16_t ui16DataSize,
                             uint8_t *pui8DoneVar);
 
+//*****************************************************************************
+//
+// Set how the SSI1 TX uDMA channel competes with other uDMA channels.
+//
+// When UART, ADC or other streams share the uDMA controller, the LED channel
+// must get to the SSI FIFO before it runs dry or the LEDs see a gap in the
+// middle of a frame.  Making the channel high priority puts it ahead of
+// every default priority channel.  Burst only requests with an arbitration
+// size of UDMA_ARB_4 move half a FIFO per request, which keeps bus handoffs
+// aligned with the room in the FIFO.  The defaults are default priority,
+// UDMA_ARB_8 and single requests.  This can be called before or after
+// InitSPITransfer().
+//
+// @input bHighPriority makes the channel high priority
+// @input ui32Arb is the arbitration size, one of UDMA_ARB_n
+// @input bBurstOnly makes the channel ignore single requests
+//
+//*****************************************************************************
+extern void SPIDMAConfigSet(bool bHighPriority, uint32_t ui32Arb,
+                            bool bBurstOnly);
+
+//*****************************************************************************
+//
+// Send frames from a pre-encoded frame in flash.
+//
+// The uDMA channel reads the frame straight from flash, so showing a static
+// scene takes no RAM and no encoding.  The frame must be encoded with the
+// SPI bytes of the timing plan (see WS2812_flash.h and tools/wsflash.c);
+// the plan is chosen here if it hasn't been yet, so select any other plan
+// first.  Calling this before InitSPITransfer() puts a boot frame on the
+// LEDs as soon as the SSI is running.  The change takes effect from the
+// next frame, which is sent whole even with partial refresh on.
+//
+// @input pui8Frame is the encoded frame, or NULL to go back to the SPI array
+// @input ui16Size is the size of the frame in bytes
+//
+// @returns false, leaving the source as it was, if the frame is empty, is
+//          longer than one uDMA transfer (1024 bytes) or holds a byte that
+//          isn't one of the plan's SPI bytes, or if there is no SPI array to
+//          go back to
+//
+//*****************************************************************************
+extern bool SPIFrameSourceSet(const uint8_t *pui8Frame, uint16_t ui16Size);
+
+//*****************************************************************************
+//
+// Turn partial refresh on or off.
+//
+// An LED that a frame doesn't reach keeps its previous color, so with
+// partial refresh on each frame only sends the SPI array up to the highest
+// LED marked with SPIDirtyMark() since the previous frame, followed by the
+// latch.  A frame with nothing marked sends just a latch.  Effects near the
+// start of a long strip then refresh much faster and leave the bus idle the
+// rest of the time.  Every ui16FullEvery frames the whole array is sent
+// anyway, which repairs any LED that missed an update to noise.
+//
+// @input bEnable turns partial refresh on
+// @input ui16FullEvery is how often a full frame is sent, in frames, or 0
+//        for never
+//
+//*****************************************************************************
+extern void SPIPartialRefreshSet(bool bEnable, uint16_t ui16FullEvery);
+
+//*****************************************************************************
+//
+// Mark an LED as changed for partial refresh.
+//
+// Call this after writing the LED's SPI bytes; marking the last LED changed
+// is enough.  It is safe to call while a frame is being sent.
+//
+// @input ui16LED is the index of the changed LED
+//
+//*****************************************************************************
+extern void SPIDirtyMark(uint16_t ui16LED);
+
+//*****************************************************************************
+//
+// Get the number of underruns seen
+//
+// An underrun is the SSI1 TX FIFO running empty while a frame is still being
+// sent, which the LEDs see as a gap in the data.
+//
+//*****************************************************************************
+extern uint32_t SPIUnderrunsGet(void);
+
+//*****************************************************************************
+//
+// Register a function to be called each time a frame finishes transmitting.
+//
+// The function is called from the SSI1 interrupt at the same point the done
+// flag is set, so it should only do a little work (for example pend a lower
+// priority interrupt that does the rendering).  That is when the last byte of
+// the frame has been read from the SPI array, or when a partial refresh frame
+// has nothing to send.  The next frame starts reading the array once the
+// latch has been sent, and a render that writes the LEDs in order stays
+// ahead of it from there.
+//
+// @input pfnCallback is the function to call, or NULL for none
+//
+//*****************************************************************************
+extern void SPIFrameCallbackSet(void (*pfnCallback)(void));
+
 //*****************************************************************************
 //
 // Mark the end of the C bindings section for C++ compilers.
@@ -0,0 +1,461 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "SPI_uDMA_drv.h"
+#include "SPI_uDMA_group.h"
+#include "WS2812_drv.h"
+#include "WS2812_cycles.h"
+#include "WS2812_timing.h"
+
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/rom.h"
+#include "driverlib/ssi.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/udma.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "inc/hw_types.h"
+#include "inc/hw_udma.h"
+
+//
+// The largest transfer a single uDMA control structure can describe
+//
+#define SPI_GROUP_MAX_XFER      1024
+
+//*****************************************************************************
+//
+// The fixed hardware behind each output
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Base;
+    uint32_t ui32Periph;
+    uint32_t ui32Int;
+    uint32_t ui32Channel;
+    uint32_t ui32GPIOPeriph;
+    uint32_t ui32GPIOBase;
+    uint8_t ui8Pin;
+    uint32_t ui32PinConfig;
+}
+tSPIGroupHW;
+
+static const tSPIGroupHW g_psGroupHW[SPI_GROUP_MAX_OUTPUTS] =
+{
+    {
+        SSI0_BASE, SYSCTL_PERIPH_SSI0, INT_SSI0, UDMA_CH11_SSI0TX,
+        SYSCTL_PERIPH_GPIOA, GPIO_PORTA_BASE, GPIO_PIN_5, GPIO_PA5_SSI0TX
+    },
+    {
+        SSI1_BASE, SYSCTL_PERIPH_SSI1, INT_SSI1, UDMA_CH25_SSI1TX,
+        SYSCTL_PERIPH_GPIOF, GPIO_PORTF_BASE, GPIO_PIN_1, GPIO_PF1_SSI1TX
+    },
+    {
+        SSI2_BASE, SYSCTL_PERIPH_SSI2, INT_SSI2, UDMA_CH13_SSI2TX,
+        SYSCTL_PERIPH_GPIOB, GPIO_PORTB_BASE, GPIO_PIN_7, GPIO_PB7_SSI2TX
+    },
+    {
+        SSI3_BASE, SYSCTL_PERIPH_SSI3, INT_SSI3, UDMA_CH15_SSI3TX,
+        SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_3, GPIO_PD3_SSI3TX
+    },
+};
+
+//*****************************************************************************
+//
+// The state of each output
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t *pui8Data;
+    uint16_t ui16Size;
+
+    //
+    // Zero bytes sent ahead of the data this frame, and how much of the
+    // frame (zeros then data) has been handed to the uDMA controller
+    //
+    uint32_t ui32Lead;
+    uint32_t ui32NextOffs;
+    bool pbArmed[2];
+
+    uint32_t ui32DoneStamp;
+}
+tSPIGroupOut;
+
+static tSPIGroupOut g_psGroupOut[SPI_GROUP_MAX_OUTPUTS];
+static uint32_t g_ui32GroupOutputs;
+static uint32_t g_ui32GroupBusy;
+static bool g_bGroupPending;
+static uint8_t *g_pui8GroupDoneVar;
+static uint32_t g_ui32GroupLatch;
+static tSPIGroupStats g_sGroupStats;
+static const uint8_t g_ui8GroupZero = 0;
+
+//*****************************************************************************
+//
+// Arm the given control structure of an output with whatever comes next in
+// the frame: zeros until the lead is used up, then the SPI array.  Returns
+// false once the whole frame has been handed out.
+//
+//*****************************************************************************
+static bool
+groupArmNext(uint32_t ui32Output, uint32_t ui32Select)
+{
+    tSPIGroupOut *psOut;
+    uint32_t ui32Channel;
+    uint32_t ui32Count;
+    uint32_t ui32Total;
+
+    psOut = &g_psGroupOut[ui32Output];
+    ui32Channel = (g_psGroupHW[ui32Output].ui32Channel & 0xFF) | ui32Select;
+    ui32Total = psOut->ui32Lead + psOut->ui16Size;
+
+    if(psOut->ui32NextOffs >= ui32Total)
+    {
+        return(false);
+    }
+
+    if(psOut->ui32NextOffs < psOut->ui32Lead)
+    {
+        ui32Count = psOut->ui32Lead - psOut->ui32NextOffs;
+        if(ui32Count > SPI_GROUP_MAX_XFER)
+        {
+            ui32Count = SPI_GROUP_MAX_XFER;
+        }
+
+        ROM_uDMAChannelControlSet(ui32Channel,
+                                  UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                                  UDMA_DST_INC_NONE | UDMA_ARB_4);
+        ROM_uDMAChannelTransferSet(ui32Channel, UDMA_MODE_PINGPONG,
+                                   (void *)&g_ui8GroupZero,
+                                   (void *)(g_psGroupHW[ui32Output].ui32Base +
+                                            SSI_O_DR), ui32Count);
+    }
+    else
+    {
+        ui32Count = ui32Total - psOut->ui32NextOffs;
+        if(ui32Count > SPI_GROUP_MAX_XFER)
+        {
+            ui32Count = SPI_GROUP_MAX_XFER;
+        }
+
+        ROM_uDMAChannelControlSet(ui32Channel,
+                                  UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                                  UDMA_DST_INC_NONE | UDMA_ARB_4);
+        ROM_uDMAChannelTransferSet(ui32Channel, UDMA_MODE_PINGPONG,
+                                   psOut->pui8Data + (psOut->ui32NextOffs -
+                                                      psOut->ui32Lead),
+                                   (void *)(g_psGroupHW[ui32Output].ui32Base +
+                                            SSI_O_DR), ui32Count);
+    }
+
+    psOut->ui32NextOffs += ui32Count;
+    psOut->pbArmed[(ui32Select == UDMA_ALT_SELECT) ? 1 : 0] = true;
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Start a frame on every output.  All of the control structures are set up
+// first, then every channel is enabled with one register write so they all
+// request their first byte on the same clock.  Called with interrupts
+// disabled or from one of the group's interrupt handlers.
+//
+//*****************************************************************************
+static void
+groupStart(void)
+{
+    tSPIGroupOut *psOut;
+    uint32_t ui32Longest;
+    uint32_t ui32Enable;
+    uint32_t ui32O;
+
+    ui32Longest = 0;
+    for(ui32O = 0; ui32O < SPI_GROUP_MAX_OUTPUTS; ui32O++)
+    {
+        if((g_ui32GroupOutputs & (1 << ui32O)) &&
+           (g_psGroupOut[ui32O].ui16Size > ui32Longest))
+        {
+            ui32Longest = g_psGroupOut[ui32O].ui16Size;
+        }
+    }
+
+    ui32Enable = 0;
+    for(ui32O = 0; ui32O < SPI_GROUP_MAX_OUTPUTS; ui32O++)
+    {
+        if(!(g_ui32GroupOutputs & (1 << ui32O)))
+        {
+            continue;
+        }
+
+        psOut = &g_psGroupOut[ui32O];
+        psOut->ui32Lead = g_ui32GroupLatch + ui32Longest - psOut->ui16Size;
+        psOut->ui32NextOffs = 0;
+        psOut->pbArmed[0] = false;
+        psOut->pbArmed[1] = false;
+
+        ROM_uDMAChannelAttributeDisable(g_psGroupHW[ui32O].ui32Channel & 0xFF,
+                                        UDMA_ATTR_ALTSELECT);
+        groupArmNext(ui32O, UDMA_PRI_SELECT);
+        groupArmNext(ui32O, UDMA_ALT_SELECT);
+
+        ui32Enable |= 1 << (g_psGroupHW[ui32O].ui32Channel & 0x1F);
+    }
+
+    g_ui32GroupBusy = g_ui32GroupOutputs;
+    if(g_pui8GroupDoneVar != NULL)
+    {
+        *g_pui8GroupDoneVar = 0;
+    }
+
+    HWREG(UDMA_ENASET) = ui32Enable;
+}
+
+//*****************************************************************************
+//
+// Every output has finished the frame.  Work out how far apart they
+// finished, and start the next frame if one has been committed.
+//
+//*****************************************************************************
+static void
+groupFrameDone(void)
+{
+    uint32_t ui32First;
+    uint32_t ui32Skew;
+    uint32_t ui32Stamp;
+    uint32_t ui32O;
+    bool bFound;
+
+    bFound = false;
+    ui32First = 0;
+    ui32Skew = 0;
+    for(ui32O = 0; ui32O < SPI_GROUP_MAX_OUTPUTS; ui32O++)
+    {
+        if(!(g_ui32GroupOutputs & (1 << ui32O)))
+        {
+            continue;
+        }
+
+        ui32Stamp = g_psGroupOut[ui32O].ui32DoneStamp;
+        if(!bFound)
+        {
+            ui32First = ui32Stamp;
+            bFound = true;
+        }
+        else if((int32_t)(ui32Stamp - ui32First) < 0)
+        {
+            ui32Skew += ui32First - ui32Stamp;
+            ui32First = ui32Stamp;
+        }
+        else if((ui32Stamp - ui32First) > ui32Skew)
+        {
+            ui32Skew = ui32Stamp - ui32First;
+        }
+    }
+
+    g_sGroupStats.ui32Frames++;
+    g_sGroupStats.ui32SkewLast = ui32Skew;
+    if(ui32Skew > g_sGroupStats.ui32SkewMax)
+    {
+        g_sGroupStats.ui32SkewMax = ui32Skew;
+    }
+
+    if(g_bGroupPending)
+    {
+        g_bGroupPending = false;
+        groupStart();
+    }
+    else if(g_pui8GroupDoneVar != NULL)
+    {
+        *g_pui8GroupDoneVar = 1;
+    }
+}
+
+//*****************************************************************************
+//
+// Service an output's interrupt: re-arm whichever half of the ping-pong
+// transfer finished, and note when the output runs out of frame.
+//
+//*****************************************************************************
+static void
+groupService(uint32_t ui32Output)
+{
+    tSPIGroupOut *psOut;
+    uint32_t ui32Channel;
+    uint32_t ui32Stamp;
+    int i;
+
+    ui32Stamp = WSCycles();
+    ROM_SSIIntClear(g_psGroupHW[ui32Output].ui32Base,
+                    ROM_SSIIntStatus(g_psGroupHW[ui32Output].ui32Base, 1));
+
+    if(!(g_ui32GroupBusy & (1 << ui32Output)))
+    {
+        return;
+    }
+
+    psOut = &g_psGroupOut[ui32Output];
+    ui32Channel = g_psGroupHW[ui32Output].ui32Channel & 0xFF;
+
+    for(i = 0; i < 2; i++)
+    {
+        if(psOut->pbArmed[i] &&
+           (ROM_uDMAChannelModeGet(ui32Channel |
+                                   (i ? UDMA_ALT_SELECT : UDMA_PRI_SELECT)) ==
+            UDMA_MODE_STOP))
+        {
+            psOut->pbArmed[i] = false;
+            groupArmNext(ui32Output, i ? UDMA_ALT_SELECT : UDMA_PRI_SELECT);
+        }
+    }
+
+    if(psOut->pbArmed[0] || psOut->pbArmed[1])
+    {
+        return;
+    }
+
+    psOut->ui32DoneStamp = ui32Stamp;
+    g_ui32GroupBusy &= ~(1 << ui32Output);
+    if(g_ui32GroupBusy == 0)
+    {
+        groupFrameDone();
+    }
+}
+
+void
+SPIGroupSSI0IntHandler(void)
+{
+    groupService(SPI_GROUP_SSI0);
+}
+
+void
+SPIGroupSSI1IntHandler(void)
+{
+    groupService(SPI_GROUP_SSI1);
+}
+
+void
+SPIGroupSSI2IntHandler(void)
+{
+    groupService(SPI_GROUP_SSI2);
+}
+
+void
+SPIGroupSSI3IntHandler(void)
+{
+    groupService(SPI_GROUP_SSI3);
+}
+
+void
+SPIGroupInit(uint8_t *pui8DoneVar)
+{
+    g_ui32GroupOutputs = 0;
+    g_ui32GroupBusy = 0;
+    g_bGroupPending = false;
+    g_sGroupStats.ui32Frames = 0;
+    g_sGroupStats.ui32SkewLast = 0;
+    g_sGroupStats.ui32SkewMax = 0;
+
+    g_pui8GroupDoneVar = pui8DoneVar;
+    if(pui8DoneVar != NULL)
+    {
+        *pui8DoneVar = 1;
+    }
+
+    //
+    // Every output shares the timing plan, and leads with at least a latch
+    // worth of zero frames so a commit straight after the previous frame
+    // still gives the LEDs time to latch.
+    //
+    g_ui32GroupLatch = WSTimingActive()->ui16LatchFrames;
+
+    WSCyclesInit();
+    uDMAControllerInit();
+}
+
+bool
+SPIGroupOutputAdd(uint32_t ui32Output, uint8_t *pui8SPIData,
+                  uint16_t ui16DataSize)
+{
+    const tSPIGroupHW *psHW;
+
+    if(ui32Output >= SPI_GROUP_MAX_OUTPUTS)
+    {
+        return(false);
+    }
+
+    psHW = &g_psGroupHW[ui32Output];
+    g_psGroupOut[ui32Output].pui8Data = pui8SPIData;
+    g_psGroupOut[ui32Output].ui16Size = ui16DataSize;
+
+    WSArrayInit(pui8SPIData, ui16DataSize);
+
+    //
+    // The SSI and its TX pin, set up the same way as InitSPITransfer()
+    //
+    ROM_SysCtlPeripheralEnable(psHW->ui32Periph);
+    ROM_SysCtlPeripheralSleepEnable(psHW->ui32Periph);
+    ROM_SysCtlPeripheralEnable(psHW->ui32GPIOPeriph);
+    GPIOPinConfigure(psHW->ui32PinConfig);
+    GPIOPinTypeSSI(psHW->ui32GPIOBase, psHW->ui8Pin);
+
+    WSTimingConfigSSI(psHW->ui32Base, WSTimingActive());
+    ROM_SSIEnable(psHW->ui32Base);
+    ROM_SSIDMAEnable(psHW->ui32Base, SSI_DMA_TX);
+
+    //
+    // Every output has the same bit rate and FIFO depth, so they all get the
+    // same channel priority; none should be able to hold the others off.
+    //
+    ROM_uDMAChannelAssign(psHW->ui32Channel);
+    ROM_uDMAChannelAttributeDisable(psHW->ui32Channel & 0xFF,
+                                    UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_HIGH_PRIORITY |
+                                    UDMA_ATTR_REQMASK);
+
+    ROM_IntEnable(psHW->ui32Int);
+    ROM_IntMasterEnable();
+
+    g_ui32GroupOutputs |= 1 << ui32Output;
+
+    return(true);
+}
+
+void
+SPIGroupCommit(void)
+{
+    bool bMasked;
+
+    bMasked = ROM_IntMasterDisable();
+
+    if(g_ui32GroupBusy)
+    {
+        g_bGroupPending = true;
+    }
+    else if(g_ui32GroupOutputs)
+    {
+        groupStart();
+    }
+
+    if(!bMasked)
+    {
+        ROM_IntMasterEnable();
+    }
+}
+
+void
+SPIGroupStatsGet(tSPIGroupStats *psStats)
+{
+    bool bMasked;
+
+    bMasked = ROM_IntMasterDisable();
+    *psStats = g_sGroupStats;
+    if(!bMasked)
+    {
+        ROM_IntMasterEnable();
+    }
+}
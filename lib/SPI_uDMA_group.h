@@ -0,0 +1,130 @@
+
+
+#ifndef __SPI_UDMA_GROUP_H__
+#define __SPI_UDMA_GROUP_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Strip groups: several SSI outputs that show each frame together.
+//
+// Every output in the group sends a run of zero bytes followed by its SPI
+// array.  Shorter arrays get a longer run of zeros in front, so every output
+// finishes its data at the same moment and all the strips latch together.
+// A frame is only sent when SPIGroupCommit() is called, and all the uDMA
+// channels are started by a single write to the controller's enable register.
+//
+// Outputs are SSI0 on PA5, SSI1 on PF1, SSI2 on PB7 and SSI3 on PD3, all
+// sent with the timing from WSTimingActive().  The group takes over SSI1
+// from InitSPITransfer(), so don't use both.  Each
+// output in use needs its SPIGroupSSInIntHandler in the vector table.
+//
+//*****************************************************************************
+#define SPI_GROUP_SSI0          0
+#define SPI_GROUP_SSI1          1
+#define SPI_GROUP_SSI2          2
+#define SPI_GROUP_SSI3          3
+#define SPI_GROUP_MAX_OUTPUTS   4
+
+//*****************************************************************************
+//
+// Group statistics.  Skew is the spread, in processor clock cycles, between
+// the outputs finishing their data.  As every output is padded to finish at
+// the same time, this is the start skew plus any interrupt latency, so it is
+// an upper bound.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Frames;
+    uint32_t ui32SkewLast;
+    uint32_t ui32SkewMax;
+}
+tSPIGroupStats;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Set up an empty group
+//
+// @input pui8DoneVar is a flag that is set to 1 each time a frame has been
+//        sent on every output, at which point the SPI arrays may be written
+//        again.  It is initialized to 1, as nothing is being sent yet.
+//
+//*****************************************************************************
+extern void SPIGroupInit(uint8_t *pui8DoneVar);
+
+//*****************************************************************************
+//
+// Add an output to the group
+//
+// This configures the SSI peripheral, its pin and uDMA channel, and turns all
+// of the output's LEDs off in its SPI array.  Outputs can only be added while
+// no frame is being sent.
+//
+// @input ui32Output is the output to add, one of SPI_GROUP_SSIn
+// @input pui8SPIData is the array containing the SPI data to send
+// @input ui16DataSize is the number of bytes the data array holds
+//
+// @returns false if the output is not valid
+//
+//*****************************************************************************
+extern bool SPIGroupOutputAdd(uint32_t ui32Output, uint8_t *pui8SPIData,
+                              uint16_t ui16DataSize);
+
+//*****************************************************************************
+//
+// Send the current SPI arrays on every output
+//
+// If a frame is still being sent, the new one follows as soon as it is done.
+// The SPI arrays must not be written between the commit and the done flag
+// being set.
+//
+//*****************************************************************************
+extern void SPIGroupCommit(void);
+
+//*****************************************************************************
+//
+// Get a copy of the group statistics
+//
+// @input psStats is filled in with the statistics
+//
+//*****************************************************************************
+extern void SPIGroupStatsGet(tSPIGroupStats *psStats);
+
+//*****************************************************************************
+//
+// The interrupt handlers for each output.  The uDMA controller raises these
+// each time one half of an output's ping-pong transfer completes.
+//
+//*****************************************************************************
+extern void SPIGroupSSI0IntHandler(void);
+extern void SPIGroupSSI1IntHandler(void);
+extern void SPIGroupSSI2IntHandler(void);
+extern void SPIGroupSSI3IntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SPI_UDMA_GROUP_H__
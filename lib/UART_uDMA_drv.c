@@ -0,0 +1,300 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_stream.h"
+#include "UART_uDMA_drv.h"
+#include "SPI_uDMA_drv.h"
+#include "WS2812_trace.h"
+
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+
+//
+// The largest transfer a single uDMA control structure can describe
+//
+#define UART_STREAM_MAX_XFER    1024
+
+//
+// What the UART0 interrupt is currently doing
+//
+#define UART_STREAM_HEADER      0
+#define UART_STREAM_PAYLOAD     1
+#define UART_STREAM_TRAILER     2
+
+static tWSStream *g_psStream;
+static void (*g_pfnStreamCommit)(tWSStream *psStream);
+static uint8_t g_ui8StreamState;
+static uint32_t g_ui32StreamNextOffs;
+static bool g_pbStreamArmed[2];
+static uint8_t g_ui8StreamDiscard;
+static uint32_t g_ui32StreamOverruns;
+
+//*****************************************************************************
+//
+// Arm the given control structure with the next chunk of the payload.  The
+// part of the payload that fits in the framebuffer lands there; anything past
+// it is poured into a single dummy byte.  Returns false once the whole payload
+// has been handed out.
+//
+//*****************************************************************************
+static bool
+uartStreamArmNext(uint32_t ui32Select)
+{
+    uint32_t ui32Count;
+    uint32_t ui32Payload;
+    uint32_t ui32Total;
+
+    ui32Payload = g_psStream->ui32PayloadLen;
+    ui32Total = ui32Payload + g_psStream->ui32DiscardLen;
+
+    if(g_ui32StreamNextOffs >= ui32Total)
+    {
+        return(false);
+    }
+
+    if(g_ui32StreamNextOffs < ui32Payload)
+    {
+        ui32Count = ui32Payload - g_ui32StreamNextOffs;
+        if(ui32Count > UART_STREAM_MAX_XFER)
+        {
+            ui32Count = UART_STREAM_MAX_XFER;
+        }
+
+        //
+        // Arbitrate every 4 bytes, half of the RX FIFO trigger level.
+        //
+        ROM_uDMAChannelControlSet(UDMA_CHANNEL_UART0RX | ui32Select,
+                                  UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                                  UDMA_DST_INC_8 | UDMA_ARB_4);
+        ROM_uDMAChannelTransferSet(UDMA_CHANNEL_UART0RX | ui32Select,
+                                   UDMA_MODE_PINGPONG,
+                                   (void *)(UART0_BASE + UART_O_DR),
+                                   g_psStream->pui8Frame +
+                                   g_ui32StreamNextOffs, ui32Count);
+    }
+    else
+    {
+        ui32Count = ui32Total - g_ui32StreamNextOffs;
+        if(ui32Count > UART_STREAM_MAX_XFER)
+        {
+            ui32Count = UART_STREAM_MAX_XFER;
+        }
+
+        ROM_uDMAChannelControlSet(UDMA_CHANNEL_UART0RX | ui32Select,
+                                  UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                                  UDMA_DST_INC_NONE | UDMA_ARB_4);
+        ROM_uDMAChannelTransferSet(UDMA_CHANNEL_UART0RX | ui32Select,
+                                   UDMA_MODE_PINGPONG,
+                                   (void *)(UART0_BASE + UART_O_DR),
+                                   &g_ui8StreamDiscard, ui32Count);
+    }
+
+    g_ui32StreamNextOffs += ui32Count;
+    g_pbStreamArmed[(ui32Select == UDMA_ALT_SELECT) ? 1 : 0] = true;
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Go back to reading header bytes with the CPU.
+//
+//*****************************************************************************
+static void
+uartStreamHeaderMode(uint8_t ui8State)
+{
+    ROM_UARTDMADisable(UART0_BASE, UART_DMA_RX);
+    g_ui8StreamState = ui8State;
+    ROM_UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+}
+
+//*****************************************************************************
+//
+// Hand the payload over to the uDMA controller.  Bytes of the payload that
+// are already sitting in the RX FIFO are picked up by the first request.
+//
+//*****************************************************************************
+static void
+uartStreamPayloadMode(void)
+{
+    ROM_UARTIntDisable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+    g_ui8StreamState = UART_STREAM_PAYLOAD;
+    g_ui32StreamNextOffs = 0;
+
+    uartStreamArmNext(UDMA_PRI_SELECT);
+    uartStreamArmNext(UDMA_ALT_SELECT);
+
+    ROM_uDMAChannelEnable(UDMA_CHANNEL_UART0RX);
+    ROM_UARTDMAEnable(UART0_BASE, UART_DMA_RX);
+}
+
+//*****************************************************************************
+//
+// The payload has been received: either commit the frame or wait for the
+// trailer.
+//
+//*****************************************************************************
+static void
+uartStreamPayloadDone(void)
+{
+    if(WSStreamPayloadDone(g_psStream) == WS_STREAM_COMMIT)
+    {
+        WSTRACE(WS_TRACE_COMMIT, WS_TRACE_ID_UART0,
+                g_psStream->ui32PayloadLen);
+        if(g_pfnStreamCommit)
+        {
+            g_pfnStreamCommit(g_psStream);
+        }
+        uartStreamHeaderMode(UART_STREAM_HEADER);
+    }
+    else
+    {
+        uartStreamHeaderMode(UART_STREAM_TRAILER);
+    }
+}
+
+//*****************************************************************************
+//
+// The interrupt handler for UART0.  While waiting for a header or trailer the
+// receive and receive timeout interrupts bring bytes in to the parser one at a
+// time.  While a payload is being received the uDMA controller raises this
+// interrupt each time one half of the ping-pong transfer completes, and that
+// half is re-armed with the next chunk.
+//
+//*****************************************************************************
+void
+UART0IntHandler(void)
+{
+    uint32_t ui32Status;
+    uint32_t ui32Ret;
+    int32_t i32Char;
+    int i;
+
+    WSTRACE(WS_TRACE_ISR_ENTER, WS_TRACE_ID_UART0, 0);
+
+    ui32Status = ROM_UARTIntStatus(UART0_BASE, 1);
+    ROM_UARTIntClear(UART0_BASE, ui32Status);
+
+    if(ui32Status & UART_INT_OE)
+    {
+        g_ui32StreamOverruns++;
+    }
+
+    if(g_ui8StreamState == UART_STREAM_PAYLOAD)
+    {
+        for(i = 0; i < 2; i++)
+        {
+            if(g_pbStreamArmed[i] &&
+               (ROM_uDMAChannelModeGet(UDMA_CHANNEL_UART0RX |
+                                       (i ? UDMA_ALT_SELECT :
+                                            UDMA_PRI_SELECT)) ==
+                UDMA_MODE_STOP))
+            {
+                g_pbStreamArmed[i] = false;
+                uartStreamArmNext(i ? UDMA_ALT_SELECT : UDMA_PRI_SELECT);
+            }
+        }
+
+        if(g_pbStreamArmed[0] || g_pbStreamArmed[1])
+        {
+            WSTRACE(WS_TRACE_ISR_EXIT, WS_TRACE_ID_UART0, 0);
+            return;
+        }
+
+        uartStreamPayloadDone();
+    }
+
+    //
+    // Header or trailer bytes are read by the CPU.  Stop as soon as a header
+    // is accepted, so the payload bytes behind it are left for the uDMA.
+    //
+    while(g_ui8StreamState != UART_STREAM_PAYLOAD)
+    {
+        i32Char = ROM_UARTCharGetNonBlocking(UART0_BASE);
+        if(i32Char < 0)
+        {
+            break;
+        }
+
+        if(g_ui8StreamState == UART_STREAM_TRAILER)
+        {
+            if(WSStreamTrailerByte(g_psStream, i32Char) == WS_STREAM_COMMIT)
+            {
+                WSTRACE(WS_TRACE_COMMIT, WS_TRACE_ID_UART0,
+                        g_psStream->ui32PayloadLen);
+                if(g_pfnStreamCommit)
+                {
+                    g_pfnStreamCommit(g_psStream);
+                }
+            }
+            g_ui8StreamState = UART_STREAM_HEADER;
+            continue;
+        }
+
+        ui32Ret = WSStreamHeaderByte(g_psStream, i32Char);
+        if(ui32Ret != WS_STREAM_PAYLOAD)
+        {
+            continue;
+        }
+
+        if(g_psStream->ui32PayloadLen || g_psStream->ui32DiscardLen)
+        {
+            uartStreamPayloadMode();
+        }
+        else
+        {
+            uartStreamPayloadDone();
+        }
+    }
+
+    WSTRACE(WS_TRACE_ISR_EXIT, WS_TRACE_ID_UART0, 0);
+}
+
+uint32_t
+UARTStreamOverrunsGet(void)
+{
+    return(g_ui32StreamOverruns);
+}
+
+void
+InitUARTStream(tWSStream *psStream, uint32_t ui32Baud,
+               void (*pfnCommit)(tWSStream *psStream))
+{
+    g_psStream = psStream;
+    g_pfnStreamCommit = pfnCommit;
+    g_ui32StreamOverruns = 0;
+    g_pbStreamArmed[0] = false;
+    g_pbStreamArmed[1] = false;
+
+    uDMAControllerInit();
+
+    //
+    // Keep the UART running while the processor sleeps, switch it to the
+    // stream baud rate, and raise the RX interrupt at half a FIFO so header
+    // bytes don't cost an interrupt each.
+    //
+    ROM_SysCtlPeripheralSleepEnable(SYSCTL_PERIPH_UART0);
+    ROM_UARTConfigSetExpClk(UART0_BASE, 16000000, ui32Baud,
+                            UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                            UART_CONFIG_PAR_NONE);
+    ROM_UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+    ROM_UARTFIFOEnable(UART0_BASE);
+
+    //
+    // Put the attributes in a known state for the uDMA UART0RX channel.
+    //
+    ROM_uDMAChannelAttributeDisable(UDMA_CHANNEL_UART0RX,
+                                    UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_HIGH_PRIORITY |
+                                    UDMA_ATTR_REQMASK);
+
+    uartStreamHeaderMode(UART_STREAM_HEADER);
+
+    ROM_IntEnable(INT_UART0);
+    ROM_IntMasterEnable();
+}
@@ -0,0 +1,72 @@
+
+
+#ifndef __UART_UDMA_DRV_H__
+#define __UART_UDMA_DRV_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Start receiving a frame stream on UART0.
+//
+// This function reconfigures UART0 (already set up by configureUART() in the
+// example) for the given baud rate and starts parsing Adalight/TPM2 packets
+// with the given stream parser (see WS2812_stream.h).  Header and trailer
+// bytes are read by the UART interrupt.  As soon as a header is accepted the
+// RX uDMA channel is switched on in ping-pong mode and the pixel bytes are
+// moved straight into the parser's framebuffer, 1024 bytes per half, without
+// the CPU touching them.
+//
+// UART0IntHandler must be placed in the UART0 slot of the vector table.
+//
+// @input psStream is an initialized stream parser
+// @input ui32Baud is the baud rate.  The UART runs from the 16MHz PIOSC, so
+//        1000000 is the fastest rate available.
+// @input pfnCommit is called from the interrupt handler each time a frame
+//        has been completely received.  The framebuffer is not written again
+//        until the next header arrives, so the callback should encode it
+//        (for example with WSStreamEncode()) or copy it out promptly.
+//
+//*****************************************************************************
+extern void InitUARTStream(tWSStream *psStream, uint32_t ui32Baud,
+                           void (*pfnCommit)(tWSStream *psStream));
+
+//*****************************************************************************
+//
+// Get the number of receive overruns seen on UART0 since InitUARTStream().
+//
+//*****************************************************************************
+extern uint32_t UARTStreamOverrunsGet(void);
+
+//*****************************************************************************
+//
+// The interrupt handler for UART0.
+//
+//*****************************************************************************
+extern void UART0IntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __UART_UDMA_DRV_H__
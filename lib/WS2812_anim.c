@@ -0,0 +1,223 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "WS2812_drv.h"
+#include "WS2812_anim.h"
+
+//*****************************************************************************
+//
+// Read a little endian 16-bit value.
+//
+//*****************************************************************************
+static inline uint16_t
+animRead16(const uint8_t *pui8Data)
+{
+    return(pui8Data[0] | ((uint16_t)pui8Data[1] << 8));
+}
+
+//*****************************************************************************
+//
+// Record a run of changed LEDs, extending the previous span if the two touch
+// and merging into the last span once the table is full.
+//
+//*****************************************************************************
+static void
+animMarkSpan(tWSAnim *psAnim, uint16_t ui16First, uint16_t ui16Count)
+{
+    tWSAnimSpan *psLast;
+
+    if(psAnim->ui32NumSpans)
+    {
+        psLast = &psAnim->psSpans[psAnim->ui32NumSpans - 1];
+
+        if(((psLast->ui16First + psLast->ui16Count) == ui16First) ||
+           (psAnim->ui32NumSpans == WS_ANIM_MAX_SPANS))
+        {
+            psLast->ui16Count = (ui16First + ui16Count) - psLast->ui16First;
+            return;
+        }
+    }
+
+    psAnim->psSpans[psAnim->ui32NumSpans].ui16First = ui16First;
+    psAnim->psSpans[psAnim->ui32NumSpans].ui16Count = ui16Count;
+    psAnim->ui32NumSpans++;
+}
+
+bool
+WSAnimInit(tWSAnim *psAnim, const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    if((ui32Size < WS_ANIM_HDR_SIZE) || (pui8Data[0] != 'W') ||
+       (pui8Data[1] != 'S') || (pui8Data[2] != 'A') || (pui8Data[3] != '1'))
+    {
+        return(false);
+    }
+
+    psAnim->pui8Data = pui8Data;
+    psAnim->pui8End = pui8Data + ui32Size;
+    psAnim->pui8Next = pui8Data + WS_ANIM_HDR_SIZE;
+    psAnim->ui16NumLED = animRead16(pui8Data + 4);
+    psAnim->ui16NumFrames = animRead16(pui8Data + 6);
+    psAnim->ui16PeriodMs = animRead16(pui8Data + 8);
+    psAnim->ui16Frame = 0;
+    psAnim->ui32NumSpans = 0;
+
+    return(psAnim->ui16NumFrames != 0);
+}
+
+uint32_t
+WSAnimNextFrame(tWSAnim *psAnim, uint8_t pui8Colors[][3])
+{
+    const uint8_t *pui8Src;
+    const uint8_t *pui8End;
+    uint32_t ui32Bytes;
+    uint16_t ui16LED;
+    uint16_t ui16Count;
+    uint16_t ui16I;
+    uint8_t ui8Op;
+
+    //
+    // Wrap around after the last frame
+    //
+    if(psAnim->ui16Frame == psAnim->ui16NumFrames)
+    {
+        psAnim->ui16Frame = 0;
+        psAnim->pui8Next = psAnim->pui8Data + WS_ANIM_HDR_SIZE;
+    }
+
+    pui8Src = psAnim->pui8Next;
+    pui8End = psAnim->pui8End;
+    psAnim->ui32NumSpans = 0;
+
+    if(pui8Src >= pui8End)
+    {
+        return(WS_ANIM_ERROR);
+    }
+
+    if(*pui8Src == WS_ANIM_KEY)
+    {
+        ui32Bytes = (uint32_t)psAnim->ui16NumLED * 3;
+        if((uint32_t)(pui8End - pui8Src) < (ui32Bytes + 1))
+        {
+            return(WS_ANIM_ERROR);
+        }
+
+        memcpy(pui8Colors, pui8Src + 1, ui32Bytes);
+        pui8Src += ui32Bytes + 1;
+        animMarkSpan(psAnim, 0, psAnim->ui16NumLED);
+    }
+    else if(*pui8Src == WS_ANIM_DELTA)
+    {
+        pui8Src++;
+        ui16LED = 0;
+
+        while(1)
+        {
+            if(pui8Src >= pui8End)
+            {
+                return(WS_ANIM_ERROR);
+            }
+
+            ui8Op = *pui8Src++;
+            if(ui8Op == WS_ANIM_OP_END)
+            {
+                break;
+            }
+
+            //
+            // Every other op carries a run length that must stay inside the
+            // strip.
+            //
+            if(((pui8End - pui8Src) < 2))
+            {
+                return(WS_ANIM_ERROR);
+            }
+            ui16Count = animRead16(pui8Src);
+            pui8Src += 2;
+            if(((uint32_t)ui16LED + ui16Count) > psAnim->ui16NumLED)
+            {
+                return(WS_ANIM_ERROR);
+            }
+
+            switch(ui8Op)
+            {
+                case WS_ANIM_OP_SKIP:
+                {
+                    break;
+                }
+
+                case WS_ANIM_OP_COPY:
+                {
+                    ui32Bytes = (uint32_t)ui16Count * 3;
+                    if((uint32_t)(pui8End - pui8Src) < ui32Bytes)
+                    {
+                        return(WS_ANIM_ERROR);
+                    }
+                    memcpy(pui8Colors[ui16LED], pui8Src, ui32Bytes);
+                    pui8Src += ui32Bytes;
+                    animMarkSpan(psAnim, ui16LED, ui16Count);
+                    break;
+                }
+
+                case WS_ANIM_OP_FILL:
+                {
+                    if((pui8End - pui8Src) < 3)
+                    {
+                        return(WS_ANIM_ERROR);
+                    }
+                    for(ui16I = ui16LED; ui16I < (ui16LED + ui16Count);
+                        ui16I++)
+                    {
+                        pui8Colors[ui16I][0] = pui8Src[0];
+                        pui8Colors[ui16I][1] = pui8Src[1];
+                        pui8Colors[ui16I][2] = pui8Src[2];
+                    }
+                    pui8Src += 3;
+                    animMarkSpan(psAnim, ui16LED, ui16Count);
+                    break;
+                }
+
+                default:
+                {
+                    return(WS_ANIM_ERROR);
+                }
+            }
+
+            ui16LED += ui16Count;
+        }
+    }
+    else
+    {
+        return(WS_ANIM_ERROR);
+    }
+
+    psAnim->pui8Next = pui8Src;
+    psAnim->ui16Frame++;
+
+    return(psAnim->ui32NumSpans);
+}
+
+void
+WSAnimEncodeChanged(const tWSAnim *psAnim, const uint8_t pui8Colors[][3],
+                    uint8_t *pui8SPIOut)
+{
+    const tWSAnimSpan *psSpan;
+    uint32_t ui32S;
+    uint16_t ui16I;
+    uint8_t *pui8Out;
+
+    for(ui32S = 0; ui32S < psAnim->ui32NumSpans; ui32S++)
+    {
+        psSpan = &psAnim->psSpans[ui32S];
+        pui8Out = pui8SPIOut + ((uint32_t)psSpan->ui16First *
+                                WS2812_SPI_LED_SIZE);
+
+        for(ui16I = psSpan->ui16First;
+            ui16I < (psSpan->ui16First + psSpan->ui16Count); ui16I++)
+        {
+            WSGRBtoSPI(pui8Out, pui8Colors[ui16I][0], pui8Colors[ui16I][1],
+                       pui8Colors[ui16I][2]);
+            pui8Out += WS2812_SPI_LED_SIZE;
+        }
+    }
+}
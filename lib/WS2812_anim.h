@@ -0,0 +1,163 @@
+
+
+#ifndef __WS2812_ANIM_H__
+#define __WS2812_ANIM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Compressed animation format, meant to be stored in flash as a const array
+// (tools/wsanim.c converts raw frame dumps into it).  All multi-byte values
+// are little endian.
+//
+//    header:   'W' 'S' 'A' '1' <u16 LEDs> <u16 frames> <u16 period ms>
+//              <u16 reserved>
+//    frame:    WS_ANIM_KEY followed by LEDs * 3 GRB bytes, or
+//              WS_ANIM_DELTA followed by ops up to WS_ANIM_OP_END
+//
+// Delta ops work on runs of LEDs, relative to the previous frame:
+//
+//    WS_ANIM_OP_SKIP <u16 n>              n LEDs are unchanged
+//    WS_ANIM_OP_COPY <u16 n> <n * GRB>    n LEDs take the given colors
+//    WS_ANIM_OP_FILL <u16 n> <GRB>        n LEDs take one color
+//
+// The first frame must be a keyframe.
+//
+//*****************************************************************************
+#define WS_ANIM_HDR_SIZE        12
+#define WS_ANIM_KEY             'K'
+#define WS_ANIM_DELTA           'D'
+#define WS_ANIM_OP_END          0
+#define WS_ANIM_OP_SKIP         1
+#define WS_ANIM_OP_COPY         2
+#define WS_ANIM_OP_FILL         3
+
+//
+// Number of changed spans tracked per frame.  Frames with more spans than
+// this have their last spans merged together.
+//
+#ifndef WS_ANIM_MAX_SPANS
+#define WS_ANIM_MAX_SPANS       16
+#endif
+
+//
+// Returned by WSAnimNextFrame() when the animation data is corrupt
+//
+#define WS_ANIM_ERROR           0xFFFFFFFF
+
+//*****************************************************************************
+//
+// A run of LEDs changed by the last decoded frame
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16First;
+    uint16_t ui16Count;
+}
+tWSAnimSpan;
+
+//*****************************************************************************
+//
+// Animation playback state
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The animation data, and where the next frame starts
+    //
+    const uint8_t *pui8Data;
+    const uint8_t *pui8End;
+    const uint8_t *pui8Next;
+
+    //
+    // Values from the header
+    //
+    uint16_t ui16NumLED;
+    uint16_t ui16NumFrames;
+    uint16_t ui16PeriodMs;
+
+    //
+    // Index of the next frame to be decoded
+    //
+    uint16_t ui16Frame;
+
+    //
+    // The LEDs changed by the last decoded frame
+    //
+    uint32_t ui32NumSpans;
+    tWSAnimSpan psSpans[WS_ANIM_MAX_SPANS];
+}
+tWSAnim;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Start playing an animation
+//
+// @input psAnim is the playback state to initialize
+// @input pui8Data is the animation data
+// @input ui32Size is the size of the animation data in bytes
+//
+// @returns false if the data does not start with a valid header
+//
+//*****************************************************************************
+extern bool WSAnimInit(tWSAnim *psAnim, const uint8_t *pui8Data,
+                       uint32_t ui32Size);
+
+//*****************************************************************************
+//
+// Decode the next frame into a framebuffer
+//
+// The frame is applied on top of the previous contents of the framebuffer,
+// and the runs of LEDs it changed are recorded in psAnim->psSpans.  After the
+// last frame playback wraps around to the first.
+//
+// @input psAnim is the playback state
+// @input pui8Colors is the GRB framebuffer, at least ui16NumLED long
+//
+// @returns the number of spans changed, or WS_ANIM_ERROR if the data is
+//          corrupt
+//
+//*****************************************************************************
+extern uint32_t WSAnimNextFrame(tWSAnim *psAnim, uint8_t pui8Colors[][3]);
+
+//*****************************************************************************
+//
+// Encode the LEDs changed by the last decoded frame into the SPI array
+//
+// @input psAnim is the playback state
+// @input pui8Colors is the GRB framebuffer
+// @input pui8SPIOut is the entire SPI output data array
+//
+//*****************************************************************************
+extern void WSAnimEncodeChanged(const tWSAnim *psAnim,
+                                const uint8_t pui8Colors[][3],
+                                uint8_t *pui8SPIOut);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_ANIM_H__
@@ -0,0 +1,225 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_blend.h"
+#include "WS2812_simd.h"
+
+//*****************************************************************************
+//
+// Single channel versions of the packed helpers, used for the bytes left over
+// once a framebuffer has been processed four bytes at a time.
+//
+//*****************************************************************************
+static inline uint8_t
+blendDiv255(uint32_t ui32Val)
+{
+    ui32Val += 0x80;
+    return((ui32Val + (ui32Val >> 8)) >> 8);
+}
+
+static inline uint8_t
+blendLerp8(uint8_t ui8A, uint8_t ui8B, uint32_t ui32Weight)
+{
+    return(blendDiv255((ui8A * (255 - ui32Weight)) + (ui8B * ui32Weight)));
+}
+
+//*****************************************************************************
+//
+// Multiply four packed bytes, each treated as a fraction of 255.
+//
+//*****************************************************************************
+static inline uint32_t
+blendMul8x4(uint32_t ui32A, uint32_t ui32B)
+{
+    uint32_t ui32AE, ui32AO, ui32BE, ui32BO;
+
+    WSUnpack8x4(ui32A, &ui32AE, &ui32AO);
+    WSUnpack8x4(ui32B, &ui32BE, &ui32BO);
+
+#ifdef WS_SIMD_ARM
+    //
+    // SMULBB/SMULTT multiply the bottom and top 16-bit lanes directly.
+    //
+    ui32AE = __smulbb(ui32AE, ui32BE) | (__smultt(ui32AE, ui32BE) << 16);
+    ui32AO = __smulbb(ui32AO, ui32BO) | (__smultt(ui32AO, ui32BO) << 16);
+#else
+    ui32AE = ((ui32AE & 0xFFFF) * (ui32BE & 0xFFFF)) |
+             (((ui32AE >> 16) * (ui32BE >> 16)) << 16);
+    ui32AO = ((ui32AO & 0xFFFF) * (ui32BO & 0xFFFF)) |
+             (((ui32AO >> 16) * (ui32BO >> 16)) << 16);
+#endif
+
+    return(WSDiv255x2(ui32AE) | (WSDiv255x2(ui32AO) << 8));
+}
+
+void
+WSBlendLerp(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+            const uint8_t pui8B[][3], uint16_t ui16NumLED, uint8_t ui8Weight)
+{
+    uint8_t *pui8D;
+    const uint8_t *pui8SA;
+    const uint8_t *pui8SB;
+    uint32_t ui32Len;
+    uint32_t ui32I;
+
+    pui8D = pui8Dst[0];
+    pui8SA = pui8A[0];
+    pui8SB = pui8B[0];
+    ui32Len = (uint32_t)ui16NumLED * 3;
+
+    for(ui32I = 0; (ui32I + 4) <= ui32Len; ui32I += 4)
+    {
+        WSStore8x4(pui8D + ui32I, WSLerp8x4(WSLoad8x4(pui8SA + ui32I),
+                                            WSLoad8x4(pui8SB + ui32I),
+                                            ui8Weight));
+    }
+    for(; ui32I < ui32Len; ui32I++)
+    {
+        pui8D[ui32I] = blendLerp8(pui8SA[ui32I], pui8SB[ui32I], ui8Weight);
+    }
+}
+
+void
+WSBlendAdd(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+           const uint8_t pui8B[][3], uint16_t ui16NumLED)
+{
+    uint8_t *pui8D;
+    const uint8_t *pui8SA;
+    const uint8_t *pui8SB;
+    uint32_t ui32Len;
+    uint32_t ui32I;
+    uint32_t ui32Sum;
+
+    pui8D = pui8Dst[0];
+    pui8SA = pui8A[0];
+    pui8SB = pui8B[0];
+    ui32Len = (uint32_t)ui16NumLED * 3;
+
+    for(ui32I = 0; (ui32I + 4) <= ui32Len; ui32I += 4)
+    {
+        WSStore8x4(pui8D + ui32I, WSQAdd8x4(WSLoad8x4(pui8SA + ui32I),
+                                            WSLoad8x4(pui8SB + ui32I)));
+    }
+    for(; ui32I < ui32Len; ui32I++)
+    {
+        ui32Sum = pui8SA[ui32I] + pui8SB[ui32I];
+        pui8D[ui32I] = (ui32Sum > 255) ? 255 : ui32Sum;
+    }
+}
+
+void
+WSBlendMultiply(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+                const uint8_t pui8B[][3], uint16_t ui16NumLED)
+{
+    uint8_t *pui8D;
+    const uint8_t *pui8SA;
+    const uint8_t *pui8SB;
+    uint32_t ui32Len;
+    uint32_t ui32I;
+
+    pui8D = pui8Dst[0];
+    pui8SA = pui8A[0];
+    pui8SB = pui8B[0];
+    ui32Len = (uint32_t)ui16NumLED * 3;
+
+    for(ui32I = 0; (ui32I + 4) <= ui32Len; ui32I += 4)
+    {
+        WSStore8x4(pui8D + ui32I, blendMul8x4(WSLoad8x4(pui8SA + ui32I),
+                                              WSLoad8x4(pui8SB + ui32I)));
+    }
+    for(; ui32I < ui32Len; ui32I++)
+    {
+        pui8D[ui32I] = blendDiv255(pui8SA[ui32I] * pui8SB[ui32I]);
+    }
+}
+
+void
+WSBlendAlpha(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+             const uint8_t pui8B[][3], const uint8_t *pui8Alpha,
+             uint16_t ui16NumLED)
+{
+    uint16_t ui16I;
+    uint32_t ui32Alpha;
+
+    //
+    // The weight changes every three bytes, which doesn't line up with the
+    // four byte words, so this one is done a LED at a time.  Fully opaque and
+    // fully transparent LEDs are common enough to be worth skipping.
+    //
+    for(ui16I = 0; ui16I < ui16NumLED; ui16I++)
+    {
+        ui32Alpha = pui8Alpha[ui16I];
+
+        if(ui32Alpha == 0)
+        {
+            pui8Dst[ui16I][0] = pui8A[ui16I][0];
+            pui8Dst[ui16I][1] = pui8A[ui16I][1];
+            pui8Dst[ui16I][2] = pui8A[ui16I][2];
+        }
+        else if(ui32Alpha == 255)
+        {
+            pui8Dst[ui16I][0] = pui8B[ui16I][0];
+            pui8Dst[ui16I][1] = pui8B[ui16I][1];
+            pui8Dst[ui16I][2] = pui8B[ui16I][2];
+        }
+        else
+        {
+            pui8Dst[ui16I][0] = blendLerp8(pui8A[ui16I][0], pui8B[ui16I][0],
+                                           ui32Alpha);
+            pui8Dst[ui16I][1] = blendLerp8(pui8A[ui16I][1], pui8B[ui16I][1],
+                                           ui32Alpha);
+            pui8Dst[ui16I][2] = blendLerp8(pui8A[ui16I][2], pui8B[ui16I][2],
+                                           ui32Alpha);
+        }
+    }
+}
+
+void
+WSBlendLerpEncode(uint8_t *pui8SPIOut, const uint8_t pui8A[][3],
+                  const uint8_t pui8B[][3], uint16_t ui16NumLED,
+                  uint8_t ui8Weight)
+{
+    uint8_t pui8Mix[12];
+    const uint8_t *pui8SA;
+    const uint8_t *pui8SB;
+    uint16_t ui16I;
+    int i;
+
+    pui8SA = pui8A[0];
+    pui8SB = pui8B[0];
+
+    //
+    // Four LEDs are exactly three words.  Blend them into a small scratch
+    // buffer that stays in registers/stack and encode from there.
+    //
+    for(ui16I = 0; (ui16I + 4) <= ui16NumLED; ui16I += 4)
+    {
+        WSStore8x4(pui8Mix, WSLerp8x4(WSLoad8x4(pui8SA), WSLoad8x4(pui8SB),
+                                      ui8Weight));
+        WSStore8x4(pui8Mix + 4, WSLerp8x4(WSLoad8x4(pui8SA + 4),
+                                          WSLoad8x4(pui8SB + 4), ui8Weight));
+        WSStore8x4(pui8Mix + 8, WSLerp8x4(WSLoad8x4(pui8SA + 8),
+                                          WSLoad8x4(pui8SB + 8), ui8Weight));
+
+        for(i = 0; i < 12; i += 3)
+        {
+            WSGRBtoSPI(pui8SPIOut, pui8Mix[i], pui8Mix[i + 1],
+                       pui8Mix[i + 2]);
+            pui8SPIOut += WS2812_SPI_LED_SIZE;
+        }
+
+        pui8SA += 12;
+        pui8SB += 12;
+    }
+
+    for(; ui16I < ui16NumLED; ui16I++)
+    {
+        WSGRBtoSPI(pui8SPIOut, blendLerp8(pui8SA[0], pui8SB[0], ui8Weight),
+                   blendLerp8(pui8SA[1], pui8SB[1], ui8Weight),
+                   blendLerp8(pui8SA[2], pui8SB[2], ui8Weight));
+        pui8SPIOut += WS2812_SPI_LED_SIZE;
+        pui8SA += 3;
+        pui8SB += 3;
+    }
+}
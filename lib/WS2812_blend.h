@@ -0,0 +1,110 @@
+
+
+#ifndef __WS2812_BLEND_H__
+#define __WS2812_BLEND_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+// All of the blend functions work on GRB framebuffers of ui16NumLED LEDs.  The
+// destination may be the same array as either source.  Weights are 8-bit
+// fixed point: 0 selects the first source, 255 selects the second.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Crossfade between two framebuffers
+//
+// @input pui8Dst is the framebuffer that receives the result
+// @input pui8A is the framebuffer shown at weight 0
+// @input pui8B is the framebuffer shown at weight 255
+// @input ui16NumLED is the number of LEDs in each framebuffer
+// @input ui8Weight is how far to fade from pui8A towards pui8B
+//
+//*****************************************************************************
+extern void WSBlendLerp(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+                        const uint8_t pui8B[][3], uint16_t ui16NumLED,
+                        uint8_t ui8Weight);
+
+//*****************************************************************************
+//
+// Add two framebuffers, saturating each channel at 255
+//
+// @input pui8Dst is the framebuffer that receives the result
+// @input pui8A is the first framebuffer
+// @input pui8B is the second framebuffer
+// @input ui16NumLED is the number of LEDs in each framebuffer
+//
+//*****************************************************************************
+extern void WSBlendAdd(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+                       const uint8_t pui8B[][3], uint16_t ui16NumLED);
+
+//*****************************************************************************
+//
+// Multiply two framebuffers, treating each channel as a fraction of 255
+//
+// @input pui8Dst is the framebuffer that receives the result
+// @input pui8A is the first framebuffer
+// @input pui8B is the second framebuffer
+// @input ui16NumLED is the number of LEDs in each framebuffer
+//
+//*****************************************************************************
+extern void WSBlendMultiply(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+                            const uint8_t pui8B[][3], uint16_t ui16NumLED);
+
+//*****************************************************************************
+//
+// Draw one framebuffer over another with a per-LED alpha
+//
+// @input pui8Dst is the framebuffer that receives the result
+// @input pui8A is the background framebuffer
+// @input pui8B is the foreground framebuffer
+// @input pui8Alpha is the opacity of each LED of pui8B
+// @input ui16NumLED is the number of LEDs in each framebuffer
+//
+//*****************************************************************************
+extern void WSBlendAlpha(uint8_t pui8Dst[][3], const uint8_t pui8A[][3],
+                         const uint8_t pui8B[][3], const uint8_t *pui8Alpha,
+                         uint16_t ui16NumLED);
+
+//*****************************************************************************
+//
+// Crossfade between two framebuffers straight into the SPI array
+//
+// This function does the same work as WSBlendLerp() followed by encoding
+// each LED, but in a single pass without writing a blended framebuffer.
+//
+// @input pui8SPIOut is the SPI output data array for the first LED
+// @input pui8A is the framebuffer shown at weight 0
+// @input pui8B is the framebuffer shown at weight 255
+// @input ui16NumLED is the number of LEDs in each framebuffer
+// @input ui8Weight is how far to fade from pui8A towards pui8B
+//
+//*****************************************************************************
+extern void WSBlendLerpEncode(uint8_t *pui8SPIOut, const uint8_t pui8A[][3],
+                              const uint8_t pui8B[][3], uint16_t ui16NumLED,
+                              uint8_t ui8Weight);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_BLEND_H__
@@ -0,0 +1,144 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_calib.h"
+
+//*****************************************************************************
+//
+// Apply a gain to an 8-bit channel.
+//
+//*****************************************************************************
+static inline uint8_t
+calibApply(uint8_t ui8Color, uint8_t ui8Gain)
+{
+    return(((uint32_t)ui8Color * (ui8Gain + 1)) >> 8);
+}
+
+void
+WSCalibInit(tWSCalib *psCalib, const tWSCalibRun *psRuns,
+            uint16_t ui16NumRuns)
+{
+    psCalib->psRuns = psRuns;
+    psCalib->ui16NumRuns = ui16NumRuns;
+
+    WSCalibSeek(psCalib, 0);
+}
+
+void
+WSCalibSeek(tWSCalib *psCalib, uint16_t ui16LED)
+{
+    uint16_t ui16Skip;
+    uint16_t ui16Run;
+
+    psCalib->ui16LED = ui16LED;
+    ui16Skip = ui16LED;
+
+    for(ui16Run = 0; ui16Run < psCalib->ui16NumRuns; ui16Run++)
+    {
+        if(ui16Skip < psCalib->psRuns[ui16Run].ui16Count)
+        {
+            psCalib->ui16Run = ui16Run;
+            psCalib->ui16Left = psCalib->psRuns[ui16Run].ui16Count - ui16Skip;
+            return;
+        }
+        ui16Skip -= psCalib->psRuns[ui16Run].ui16Count;
+    }
+
+    //
+    // The LED is past the end of the table.
+    //
+    psCalib->ui16Run = psCalib->ui16NumRuns;
+    psCalib->ui16Left = 0;
+}
+
+void
+WSCalibSetLEDColors(tWSCalib *psCalib, uint8_t *pui8SPILEDs,
+                    uint16_t ui16LED, uint8_t ui8Green, uint8_t ui8Red,
+                    uint8_t ui8Blue)
+{
+    const uint8_t *pui8Gain;
+
+    if(psCalib->ui16LED != ui16LED)
+    {
+        WSCalibSeek(psCalib, ui16LED);
+    }
+    pui8Gain = WSCalibNext(psCalib);
+
+    WSSetLEDColors(pui8SPILEDs, ui16LED, calibApply(ui8Green, pui8Gain[0]),
+                   calibApply(ui8Red, pui8Gain[1]),
+                   calibApply(ui8Blue, pui8Gain[2]));
+}
+
+void
+WSCalibEncode(tWSCalib *psCalib, const uint8_t pui8Colors[][3],
+              uint8_t *pui8SPIOut, uint16_t ui16First, uint16_t ui16Count)
+{
+    const uint8_t *pui8Gain;
+    uint32_t ui32End;
+    uint16_t ui16LED;
+
+    if(psCalib->ui16LED != ui16First)
+    {
+        WSCalibSeek(psCalib, ui16First);
+    }
+
+    pui8SPIOut += (uint32_t)ui16First * WS2812_SPI_LED_SIZE;
+    ui32End = (uint32_t)ui16First + ui16Count;
+
+    for(ui16LED = ui16First; ui16LED < ui32End; ui16LED++)
+    {
+        pui8Gain = WSCalibNext(psCalib);
+        WSGRBtoSPI(pui8SPIOut, calibApply(pui8Colors[ui16LED][0], pui8Gain[0]),
+                   calibApply(pui8Colors[ui16LED][1], pui8Gain[1]),
+                   calibApply(pui8Colors[ui16LED][2], pui8Gain[2]));
+        pui8SPIOut += WS2812_SPI_LED_SIZE;
+    }
+}
+
+uint16_t
+WSCalibCompress(const uint8_t pui8Gains[][3], uint16_t ui16NumLED,
+                uint8_t ui8Tolerance, tWSCalibRun *psRuns,
+                uint16_t ui16MaxRuns)
+{
+    tWSCalibRun *psRun;
+    uint16_t ui16NumRuns;
+    uint16_t ui16LED;
+    int32_t i32Diff;
+    bool bFits;
+    int i;
+
+    ui16NumRuns = 0;
+    psRun = NULL;
+
+    for(ui16LED = 0; ui16LED < ui16NumLED; ui16LED++)
+    {
+        bFits = (psRun != NULL) && (psRun->ui16Count != 0xFFFF);
+        for(i = 0; bFits && (i < 3); i++)
+        {
+            i32Diff = (int32_t)pui8Gains[ui16LED][i] - psRun->pui8Gain[i];
+            if((i32Diff > ui8Tolerance) || (-i32Diff > ui8Tolerance))
+            {
+                bFits = false;
+            }
+        }
+
+        if(bFits)
+        {
+            psRun->ui16Count++;
+            continue;
+        }
+
+        if(ui16NumRuns == ui16MaxRuns)
+        {
+            return(0);
+        }
+        psRun = &psRuns[ui16NumRuns++];
+        psRun->ui16Count = 1;
+        psRun->pui8Gain[0] = pui8Gains[ui16LED][0];
+        psRun->pui8Gain[1] = pui8Gains[ui16LED][1];
+        psRun->pui8Gain[2] = pui8Gains[ui16LED][2];
+    }
+
+    return(ui16NumRuns);
+}
@@ -0,0 +1,235 @@
+
+
+#ifndef __WS2812_CALIB_H__
+#define __WS2812_CALIB_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Per-LED color uniformity correction.
+//
+// LEDs from different batches, or different parts of a long run, differ in
+// brightness per channel.  Correcting them needs a gain per LED per channel,
+// but LEDs from the same batch and segment share gains, so the table is
+// kept as runs: a count of LEDs and the G, R and B gains they share.  A strip
+// made of a handful of batches then needs a few runs instead of three bytes
+// per LED, and the table can live in flash.
+//
+// A cursor walks the runs in step with the encoder, so applying the gains is
+// a run counter decrement and three multiplies per LED, with no lookup and
+// no extra pass over the framebuffer.  Starting somewhere else costs a walk
+// over the runs up to that LED.
+//
+// The benchmark in tests/test_calib.c measures the cycles this adds per LED
+// with WSCycles(), encoding in order with and without WSCalibEncode().  It
+// reads the DWT counter on a target and the time stamp counter on a host;
+// on x86 the gains add a few cycles to the 50 or so WSGRBtoSPI() takes.
+//
+// A gain of g scales a channel by (g + 1) / 256, so 255 leaves it unchanged.
+// Gains only dim; the brightest LEDs are brought down to match the rest.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// A run of LEDs that share the same gains
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16Count;
+    uint8_t pui8Gain[3];
+}
+tWSCalibRun;
+
+//*****************************************************************************
+//
+// A cursor into a calibration table.  LEDs past the end of the table are
+// left uncorrected.
+//
+//*****************************************************************************
+typedef struct
+{
+    const tWSCalibRun *psRuns;
+    uint16_t ui16NumRuns;
+
+    //
+    // The run the next LED is in, the LEDs left in it, and the index of the
+    // next LED
+    //
+    uint16_t ui16Run;
+    uint16_t ui16Left;
+    uint16_t ui16LED;
+}
+tWSCalib;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Initialize a calibration cursor at the first LED
+//
+// @input psCalib is the cursor to initialize
+// @input psRuns is the table of runs, which must stay valid
+// @input ui16NumRuns is the number of runs in the table
+//
+//*****************************************************************************
+extern void WSCalibInit(tWSCalib *psCalib, const tWSCalibRun *psRuns,
+                        uint16_t ui16NumRuns);
+
+//*****************************************************************************
+//
+// Move a calibration cursor to an LED
+//
+// @input psCalib is the cursor
+// @input ui16LED is the LED index the next gains are for
+//
+//*****************************************************************************
+extern void WSCalibSeek(tWSCalib *psCalib, uint16_t ui16LED);
+
+//*****************************************************************************
+//
+// Get the gains of the next LED and step past it
+//
+// @input psCalib is the cursor
+//
+// @returns the G, R and B gains of the LED
+//
+//*****************************************************************************
+static inline const uint8_t *
+WSCalibNext(tWSCalib *psCalib)
+{
+    static const uint8_t pui8Unity[3] = { 255, 255, 255 };
+    const uint8_t *pui8Gain;
+
+    psCalib->ui16LED++;
+
+    //
+    // Skip over finished runs; the loop only goes round more than once for
+    // runs of zero LEDs.
+    //
+    while(psCalib->ui16Left == 0)
+    {
+        if((psCalib->ui16Run + 1) >= psCalib->ui16NumRuns)
+        {
+            psCalib->ui16Run = psCalib->ui16NumRuns;
+            return(pui8Unity);
+        }
+        psCalib->ui16Run++;
+        psCalib->ui16Left = psCalib->psRuns[psCalib->ui16Run].ui16Count;
+    }
+
+    pui8Gain = psCalib->psRuns[psCalib->ui16Run].pui8Gain;
+    psCalib->ui16Left--;
+
+    return(pui8Gain);
+}
+
+//*****************************************************************************
+//
+// Set the colors of an LED with its calibration applied
+//
+// This is WSSetLEDColors() with the gains applied first.  Setting LEDs in
+// increasing order keeps the cursor in step; any other order seeks.
+//
+// @input psCalib is the cursor
+// @input pui8SPILEDs is the entire SPI output data array
+// @input ui16LED is the index of the LED whose color is to be modified
+// @input ui8Green is the green value to be displayed on that LED
+// @input ui8Red is the red value to be displayed on that LED
+// @input ui8Blue is the blue value to be displayed on that LED
+//
+//*****************************************************************************
+extern void WSCalibSetLEDColors(tWSCalib *psCalib, uint8_t *pui8SPILEDs,
+                                uint16_t ui16LED, uint8_t ui8Green,
+                                uint8_t ui8Red, uint8_t ui8Blue);
+
+//*****************************************************************************
+//
+// Encode a range of a framebuffer with calibration applied
+//
+// @input psCalib is the cursor
+// @input pui8Colors is the GRB framebuffer
+// @input pui8SPIOut is the entire SPI output data array
+// @input ui16First is the first LED to encode
+// @input ui16Count is the number of LEDs to encode
+//
+//*****************************************************************************
+extern void WSCalibEncode(tWSCalib *psCalib, const uint8_t pui8Colors[][3],
+                          uint8_t *pui8SPIOut, uint16_t ui16First,
+                          uint16_t ui16Count);
+
+//*****************************************************************************
+//
+// Build a calibration table from per-LED gains
+//
+// Neighbouring LEDs whose gains are all within ui8Tolerance of the first LED
+// of the current run join that run and take its gains.  This is meant to be
+// run once, on a host or at start up, with the measured gains.
+//
+// @input pui8Gains is the G, R and B gain of each LED
+// @input ui16NumLED is the number of LEDs
+// @input ui8Tolerance is how far a gain may be from its run's gain
+// @input psRuns receives the runs
+// @input ui16MaxRuns is the number of entries in psRuns
+//
+// @returns the number of runs, or 0 if psRuns is too small
+//
+//*****************************************************************************
+extern uint16_t WSCalibCompress(const uint8_t pui8Gains[][3],
+                                uint16_t ui16NumLED, uint8_t ui8Tolerance,
+                                tWSCalibRun *psRuns, uint16_t ui16MaxRuns);
+
+//*****************************************************************************
+//
+// Pipeline stage that applies the calibration
+//
+// The cursor follows the pipeline's LED index, seeking when the pipeline is
+// started somewhere other than where the last run stopped.  Put this ahead
+// of WSStageDither() so the fraction the gains leave is dithered.
+//
+// @input pvData points to a tWSCalib, which the stage advances.
+//
+//*****************************************************************************
+static inline void
+WSStageCalib(const void *pvData, uint16_t *pui16Pix, uint16_t ui16LED)
+{
+    tWSCalib *psCalib;
+    const uint8_t *pui8Gain;
+
+    psCalib = (tWSCalib *)pvData;
+    if(psCalib->ui16LED != ui16LED)
+    {
+        WSCalibSeek(psCalib, ui16LED);
+    }
+    pui8Gain = WSCalibNext(psCalib);
+
+    pui16Pix[0] = ((uint32_t)pui16Pix[0] * (pui8Gain[0] + 1)) >> 8;
+    pui16Pix[1] = ((uint32_t)pui16Pix[1] * (pui8Gain[1] + 1)) >> 8;
+    pui16Pix[2] = ((uint32_t)pui16Pix[2] * (pui8Gain[2] + 1)) >> 8;
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_CALIB_H__
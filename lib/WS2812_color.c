@@ -0,0 +1,171 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "WS2812_color.h"
+#include "WS2812_simd.h"
+
+//*****************************************************************************
+//
+// Sine table, floor(127.5 + 127.5 * sin(2 * pi * i / 256) + 0.5)
+//
+//*****************************************************************************
+const uint8_t g_pui8WSSin8[256] =
+{
+    0x80, 0x83, 0x86, 0x89, 0x8C, 0x8F, 0x92, 0x95, 0x98, 0x9B, 0x9E, 0xA2,
+    0xA5, 0xA7, 0xAA, 0xAD, 0xB0, 0xB3, 0xB6, 0xB9, 0xBC, 0xBE, 0xC1, 0xC4,
+    0xC6, 0xC9, 0xCB, 0xCE, 0xD0, 0xD3, 0xD5, 0xD7, 0xDA, 0xDC, 0xDE, 0xE0,
+    0xE2, 0xE4, 0xE6, 0xE8, 0xEA, 0xEB, 0xED, 0xEE, 0xF0, 0xF1, 0xF3, 0xF4,
+    0xF5, 0xF6, 0xF8, 0xF9, 0xFA, 0xFA, 0xFB, 0xFC, 0xFD, 0xFD, 0xFE, 0xFE,
+    0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFE, 0xFE, 0xFD,
+    0xFD, 0xFC, 0xFB, 0xFA, 0xFA, 0xF9, 0xF8, 0xF6, 0xF5, 0xF4, 0xF3, 0xF1,
+    0xF0, 0xEE, 0xED, 0xEB, 0xEA, 0xE8, 0xE6, 0xE4, 0xE2, 0xE0, 0xDE, 0xDC,
+    0xDA, 0xD7, 0xD5, 0xD3, 0xD0, 0xCE, 0xCB, 0xC9, 0xC6, 0xC4, 0xC1, 0xBE,
+    0xBC, 0xB9, 0xB6, 0xB3, 0xB0, 0xAD, 0xAA, 0xA7, 0xA5, 0xA2, 0x9E, 0x9B,
+    0x98, 0x95, 0x92, 0x8F, 0x8C, 0x89, 0x86, 0x83, 0x80, 0x7C, 0x79, 0x76,
+    0x73, 0x70, 0x6D, 0x6A, 0x67, 0x64, 0x61, 0x5D, 0x5A, 0x58, 0x55, 0x52,
+    0x4F, 0x4C, 0x49, 0x46, 0x43, 0x41, 0x3E, 0x3B, 0x39, 0x36, 0x34, 0x31,
+    0x2F, 0x2C, 0x2A, 0x28, 0x25, 0x23, 0x21, 0x1F, 0x1D, 0x1B, 0x19, 0x17,
+    0x15, 0x14, 0x12, 0x11, 0x0F, 0x0E, 0x0C, 0x0B, 0x0A, 0x09, 0x07, 0x06,
+    0x05, 0x05, 0x04, 0x03, 0x02, 0x02, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x02, 0x02, 0x03, 0x04, 0x05,
+    0x05, 0x06, 0x07, 0x09, 0x0A, 0x0B, 0x0C, 0x0E, 0x0F, 0x11, 0x12, 0x14,
+    0x15, 0x17, 0x19, 0x1B, 0x1D, 0x1F, 0x21, 0x23, 0x25, 0x28, 0x2A, 0x2C,
+    0x2F, 0x31, 0x34, 0x36, 0x39, 0x3B, 0x3E, 0x41, 0x43, 0x46, 0x49, 0x4C,
+    0x4F, 0x52, 0x55, 0x58, 0x5A, 0x5D, 0x61, 0x64, 0x67, 0x6A, 0x6D, 0x70,
+    0x73, 0x76, 0x79, 0x7C
+};
+
+void
+WSColorNScale8(uint8_t pui8Colors[][3], uint16_t ui16NumLED,
+               uint8_t ui8Scale)
+{
+    uint8_t *pui8C;
+    uint32_t ui32Len;
+    uint32_t ui32I;
+
+    pui8C = pui8Colors[0];
+    ui32Len = (uint32_t)ui16NumLED * 3;
+
+    for(ui32I = 0; (ui32I + 4) <= ui32Len; ui32I += 4)
+    {
+        WSStore8x4(pui8C + ui32I, WSScale8x4(WSLoad8x4(pui8C + ui32I),
+                                             ui8Scale + 1));
+    }
+    for(; ui32I < ui32Len; ui32I++)
+    {
+        pui8C[ui32I] = WSScale8(pui8C[ui32I], ui8Scale);
+    }
+}
+
+void
+WSColorFade(uint8_t pui8Colors[][3], uint16_t ui16NumLED, uint8_t ui8Amount)
+{
+    WSColorNScale8(pui8Colors, ui16NumLED, 255 - ui8Amount);
+}
+
+void
+WSColorQAdd(uint8_t pui8Colors[][3], uint16_t ui16NumLED, uint8_t ui8Green,
+            uint8_t ui8Red, uint8_t ui8Blue)
+{
+    uint8_t pui8Pattern[12];
+    uint32_t pui32Add[3];
+    uint8_t *pui8C;
+    uint32_t ui32Len;
+    uint32_t ui32I;
+    uint32_t ui32Phase;
+
+    //
+    // The color repeats every three bytes and the words every four, so the
+    // words to add repeat every twelve bytes.
+    //
+    for(ui32I = 0; ui32I < 12; ui32I += 3)
+    {
+        pui8Pattern[ui32I] = ui8Green;
+        pui8Pattern[ui32I + 1] = ui8Red;
+        pui8Pattern[ui32I + 2] = ui8Blue;
+    }
+    pui32Add[0] = WSLoad8x4(pui8Pattern);
+    pui32Add[1] = WSLoad8x4(pui8Pattern + 4);
+    pui32Add[2] = WSLoad8x4(pui8Pattern + 8);
+
+    pui8C = pui8Colors[0];
+    ui32Len = (uint32_t)ui16NumLED * 3;
+    ui32Phase = 0;
+
+    for(ui32I = 0; (ui32I + 4) <= ui32Len; ui32I += 4)
+    {
+        WSStore8x4(pui8C + ui32I, WSQAdd8x4(WSLoad8x4(pui8C + ui32I),
+                                            pui32Add[ui32Phase]));
+        ui32Phase = (ui32Phase == 2) ? 0 : (ui32Phase + 1);
+    }
+    for(; ui32I < ui32Len; ui32I++)
+    {
+        pui8C[ui32I] = WSQAdd8(pui8C[ui32I], pui8Pattern[ui32I % 3]);
+    }
+}
+
+void
+WSColorBlur1D(uint8_t pui8Colors[][3], uint16_t ui16NumLED, uint8_t ui8Amount)
+{
+    uint8_t pui8Tail[14];
+    uint8_t *pui8C;
+    uint32_t ui32Len;
+    uint32_t ui32I;
+    uint32_t ui32K;
+    uint32_t ui32Prev;
+    uint32_t ui32Cur;
+    uint32_t ui32Next;
+    uint32_t ui32Left;
+    uint32_t ui32Right;
+    uint8_t ui8Keep;
+    uint8_t ui8Seep;
+
+    ui8Keep = 255 - ui8Amount;
+    ui8Seep = ui8Amount >> 1;
+
+    pui8C = pui8Colors[0];
+    ui32Len = (uint32_t)ui16NumLED * 3;
+
+    //
+    // The blur is done in place, so the original bytes either side of the
+    // word being worked on are kept in a sliding window of three words.  The
+    // same channel of the neighbouring LEDs is three bytes either way, which
+    // is shifted out of the window (bytes are little endian in a word).  The
+    // three terms never add up to more than 255, so a plain add can't carry
+    // between bytes.
+    //
+    ui32Prev = 0;
+    ui32Cur = (ui32Len >= 4) ? WSLoad8x4(pui8C) : 0;
+
+    for(ui32I = 0; (ui32I + 8) <= ui32Len; ui32I += 4)
+    {
+        ui32Next = WSLoad8x4(pui8C + ui32I + 4);
+        ui32Left = (ui32Prev >> 8) | (ui32Cur << 24);
+        ui32Right = (ui32Cur >> 24) | (ui32Next << 8);
+
+        WSStore8x4(pui8C + ui32I, WSScale8x4(ui32Cur, ui8Keep + 1) +
+                                  WSScale8x4(ui32Left, ui8Seep + 1) +
+                                  WSScale8x4(ui32Right, ui8Seep + 1));
+
+        ui32Prev = ui32Cur;
+        ui32Cur = ui32Next;
+    }
+
+    //
+    // Up to seven bytes are left.  Gather them with the three original bytes
+    // before them and black after them, and finish one byte at a time.
+    //
+    memset(pui8Tail, 0, sizeof(pui8Tail));
+    pui8Tail[0] = ui32Prev >> 8;
+    pui8Tail[1] = ui32Prev >> 16;
+    pui8Tail[2] = ui32Prev >> 24;
+    memcpy(pui8Tail + 3, pui8C + ui32I, ui32Len - ui32I);
+
+    for(ui32K = 0; ui32I < ui32Len; ui32I++, ui32K++)
+    {
+        pui8C[ui32I] = WSScale8(pui8Tail[ui32K + 3], ui8Keep) +
+                       WSScale8(pui8Tail[ui32K], ui8Seep) +
+                       WSScale8(pui8Tail[ui32K + 6], ui8Seep);
+    }
+}
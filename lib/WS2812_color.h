@@ -0,0 +1,162 @@
+
+
+#ifndef __WS2812_COLOR_H__
+#define __WS2812_COLOR_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// 8-bit fixed-point color math for effects.
+//
+// The single value helpers are inline.  The span functions work in place on
+// GRB framebuffers, four bytes at a time with the packed helpers from
+// WS2812_simd.h (Cortex-M4 packed byte instructions, or SWAR arithmetic on
+// other targets), and give exactly the same results as the single value
+// helpers applied to each channel.
+//
+// A scale of s multiplies by (s + 1) / 256, so 255 leaves a value unchanged
+// and 0 takes anything below 256 to 0.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// One full cycle of a sine wave from 0 to 255, starting at 128:
+// floor(127.5 + 127.5 * sin(2 * pi * i / 256) + 0.5)
+//
+//*****************************************************************************
+extern const uint8_t g_pui8WSSin8[256];
+
+//*****************************************************************************
+//
+// Scale a value by (ui8Scale + 1) / 256
+//
+//*****************************************************************************
+static inline uint8_t
+WSScale8(uint8_t ui8Val, uint8_t ui8Scale)
+{
+    return(((uint32_t)ui8Val * (ui8Scale + 1)) >> 8);
+}
+
+//*****************************************************************************
+//
+// Add two values, saturating at 255
+//
+//*****************************************************************************
+static inline uint8_t
+WSQAdd8(uint8_t ui8A, uint8_t ui8B)
+{
+    uint32_t ui32Sum;
+
+    ui32Sum = ui8A + ui8B;
+    return((ui32Sum > 255) ? 255 : ui32Sum);
+}
+
+//*****************************************************************************
+//
+// Subtract two values, saturating at 0
+//
+//*****************************************************************************
+static inline uint8_t
+WSQSub8(uint8_t ui8A, uint8_t ui8B)
+{
+    return((ui8A > ui8B) ? (ui8A - ui8B) : 0);
+}
+
+//*****************************************************************************
+//
+// Sine and cosine of an angle in 256ths of a turn, 0 to 255 centred on 128
+//
+//*****************************************************************************
+static inline uint8_t
+WSSin8(uint8_t ui8Theta)
+{
+    return(g_pui8WSSin8[ui8Theta]);
+}
+
+static inline uint8_t
+WSCos8(uint8_t ui8Theta)
+{
+    return(g_pui8WSSin8[(uint8_t)(ui8Theta + 64)]);
+}
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Scale every channel of a span of LEDs
+//
+// @input pui8Colors is the GRB framebuffer, modified in place
+// @input ui16NumLED is the number of LEDs
+// @input ui8Scale is the scale, as for WSScale8()
+//
+//*****************************************************************************
+extern void WSColorNScale8(uint8_t pui8Colors[][3], uint16_t ui16NumLED,
+                           uint8_t ui8Scale);
+
+//*****************************************************************************
+//
+// Fade a span of LEDs towards black
+//
+// @input pui8Colors is the GRB framebuffer, modified in place
+// @input ui16NumLED is the number of LEDs
+// @input ui8Amount is how much to fade, 0 for none and 255 for all the way
+//
+//*****************************************************************************
+extern void WSColorFade(uint8_t pui8Colors[][3], uint16_t ui16NumLED,
+                        uint8_t ui8Amount);
+
+//*****************************************************************************
+//
+// Add a color to every LED of a span, saturating each channel at 255
+//
+// @input pui8Colors is the GRB framebuffer, modified in place
+// @input ui16NumLED is the number of LEDs
+// @input ui8Green is the green value to add
+// @input ui8Red is the red value to add
+// @input ui8Blue is the blue value to add
+//
+//*****************************************************************************
+extern void WSColorQAdd(uint8_t pui8Colors[][3], uint16_t ui16NumLED,
+                        uint8_t ui8Green, uint8_t ui8Red, uint8_t ui8Blue);
+
+//*****************************************************************************
+//
+// Blur a span of LEDs with their neighbours
+//
+// Each LED keeps a scale of 255 - ui8Amount of itself and takes a scale of
+// ui8Amount / 2 from each neighbour, so nothing can overflow.  LEDs past
+// either end of the span count as black.
+//
+// @input pui8Colors is the GRB framebuffer, modified in place
+// @input ui16NumLED is the number of LEDs
+// @input ui8Amount is how much to blur
+//
+//*****************************************************************************
+extern void WSColorBlur1D(uint8_t pui8Colors[][3], uint16_t ui16NumLED,
+                          uint8_t ui8Amount);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_COLOR_H__
@@ -0,0 +1,70 @@
+
+
+#ifndef __WS2812_CYCLES_H__
+#define __WS2812_CYCLES_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Cortex-M4 DWT cycle counter, used to timestamp and measure with single
+// clock resolution.  TivaWare does not define the DWT registers.
+//
+//*****************************************************************************
+#define WS_CYCLES_DEMCR         0xE000EDFC
+#define WS_CYCLES_DEMCR_TRCENA  0x01000000
+#define WS_CYCLES_DWT_CTRL      0xE0001000
+#define WS_CYCLES_DWT_CYCCNTENA 0x00000001
+#define WS_CYCLES_DWT_CYCCNT    0xE0001004
+
+//
+// How the registers are reached.  A host build can point this somewhere else
+// to supply its own clock.
+//
+#ifndef WS_CYCLES_REG
+#define WS_CYCLES_REG(ui32Addr) (*(volatile uint32_t *)(ui32Addr))
+#endif
+
+//*****************************************************************************
+//
+// Start the cycle counter running.  It is safe to call this more than once.
+//
+//*****************************************************************************
+static inline void
+WSCyclesInit(void)
+{
+    WS_CYCLES_REG(WS_CYCLES_DEMCR) |= WS_CYCLES_DEMCR_TRCENA;
+    WS_CYCLES_REG(WS_CYCLES_DWT_CTRL) |= WS_CYCLES_DWT_CYCCNTENA;
+}
+
+//*****************************************************************************
+//
+// Read the cycle counter.  It wraps every 2^32 clocks, so only differences
+// between two readings are meaningful.
+//
+//*****************************************************************************
+static inline uint32_t
+WSCycles(void)
+{
+    return(WS_CYCLES_REG(WS_CYCLES_DWT_CYCCNT));
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_CYCLES_H__
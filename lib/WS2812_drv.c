@@ -3,15 +3,15 @@
 #include <stddef.h>
 #include "WS2812_drv.h"
 
-#include "driverlib/gpio.h"
-#include "driverlib/pin_map.h"
-#include "driverlib/rom.h"
-#include "driverlib/ssi.h"
-#include "driverlib/sysctl.h"
-#include "driverlib/udma.h"
-#include "inc/hw_ints.h"
-#include "inc/hw_memmap.h"
-#include "inc/hw_ssi.h"
+uint8_t g_ui8WSSPIHigh = WS2812_SPI_HIGH;
+uint8_t g_ui8WSSPILow = WS2812_SPI_LOW;
+
+void
+WSEncodingSet(uint8_t ui8High, uint8_t ui8Low)
+{
+    g_ui8WSSPIHigh = ui8High;
+    g_ui8WSSPILow = ui8Low;
+}
 
 void
 WStoSPI(uint8_t *pi8SPIData, uint8_t ui8Color)
@@ -25,11 +25,11 @@ WStoSPI(uint8_t *pi8SPIData, uint8_t ui8Color)
     {
         if(ui8Color & (0x80 >> i))
         {
-            pi8SPIData[i] = WS2812_SPI_HIGH;
+            pi8SPIData[i] = g_ui8WSSPIHigh;
         }
         else
         {
-            pi8SPIData[i] = WS2812_SPI_LOW;
+            pi8SPIData[i] = g_ui8WSSPILow;
         }
     }
 
@@ -97,7 +97,7 @@ WSArrayInit(uint8_t *pi8SPIData, uint16_t ui16Len)
     
     for(i=0;i<ui16Len;i++)
     {
-        pi8SPIData[i] = WS2812_SPI_LOW;
+        pi8SPIData[i] = g_ui8WSSPILow;
         //
         // 4 bit implementation
         //
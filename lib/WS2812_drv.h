@@ -27,6 +27,18 @@ extern "C"
 #define WS2812_SPI_BYTE_PER_CLR 3
 #define WS2812_SPI_BYTE_PER_LED WS2812_SPI_BYTE_PER_CLR * 3
 
+//
+// Number of bytes one LED occupies in the SPI output array
+//
+#define WS2812_SPI_LED_SIZE     (WS2812_SPI_BYTE_PER_CLR * WS2812_SPI_BIT_WIDTH)
+
+//
+// The SPI bytes currently used for a WS one and zero.  These start out as
+// WS2812_SPI_HIGH and WS2812_SPI_LOW and are changed with WSEncodingSet().
+//
+extern uint8_t g_ui8WSSPIHigh;
+extern uint8_t g_ui8WSSPILow;
+
 //*****************************************************************************
 //
 // Function prototypes
@@ -48,6 +60,20 @@ extern "C"
 //*****************************************************************************
 extern void WSArrayInit(uint8_t *pi8SPIData, uint16_t ui16Len);
 
+//*****************************************************************************
+//
+// Change the SPI bytes used to encode a WS one and zero
+//
+// This must match the SSI frame size and bit rate the SPI array is sent at;
+// see WS2812_timing.h.  SPI arrays encoded before the change need to be
+// encoded again.
+//
+// @input ui8High is the SPI byte sent for a one
+// @input ui8Low is the SPI byte sent for a zero
+//
+//*****************************************************************************
+extern void WSEncodingSet(uint8_t ui8High, uint8_t ui8Low);
+
 //*****************************************************************************
 //
 // Write a color byte to a set of SPI out bytes
@@ -89,6 +115,26 @@ extern void WStoSPI(uint8_t *pi8SPIData, uint8_t ui8Color);
 extern void WSGRBtoSPI(uint8_t *pi8SPIData, uint8_t ui8Green, uint8_t ui8Red,
             uint8_t ui8Blue);
 
+//*****************************************************************************
+//
+// Set the green, red and blue values for an LED in the WS2812b chain
+//
+// This function takes three 1 byte color values, an LED position in the
+// WS2812b chain, and an SPI data array.  It determines what location in the
+// SPI data array the specified LED is located, then translates the color
+// values to the bits needed on the SPI array and writes them to the proper
+// location in the SPI data array.
+//
+// @input pui8SPILEDs is the entire SPI output data array
+// @input ui16LED is the index of the LED whose color is to be modified
+// @input ui8Green is the green value to be displayed on that LED
+// @input ui8Red is the red value to be displayed on that LED
+// @input ui8Blue is the blue value to be displayed on that LED
+//
+//*****************************************************************************
+extern void WSSetLEDColors(uint8_t *pi8SPILEDs, uint16_t ui16LED,
+                           uint8_t ui8Green, uint8_t ui8Red, uint8_t ui8Blue);
+
 //*****************************************************************************
 //
 // Write a green color byte to a set of SPI out bytes
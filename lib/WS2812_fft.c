@@ -0,0 +1,333 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "WS2812_fft.h"
+
+//
+// Number of table steps in a full turn
+//
+#define FFT_TURN                1024
+
+//
+// A quarter turn of sin() in Q15, FFT_TURN / 4 + 1 entries
+//
+static const int16_t g_pi16FFTSine[(FFT_TURN / 4) + 1] =
+{
+        0,   201,   402,   603,   804,  1005,  1206,  1407,
+     1608,  1809,  2009,  2210,  2411,  2611,  2811,  3012,
+     3212,  3412,  3612,  3812,  4011,  4211,  4410,  4609,
+     4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,
+     6393,  6590,  6787,  6983,  7180,  7376,  7571,  7767,
+     7962,  8157,  8351,  8546,  8740,  8933,  9127,  9319,
+     9512,  9704,  9896, 10088, 10279, 10469, 10660, 10850,
+    11039, 11228, 11417, 11605, 11793, 11980, 12167, 12354,
+    12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828,
+    14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+    15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673,
+    16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358,
+    19520, 19681, 19841, 20001, 20160, 20318, 20475, 20632,
+    20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+    22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028,
+    23170, 23312, 23453, 23593, 23732, 23870, 24008, 24144,
+    24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199,
+    26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+    27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002,
+    28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803,
+    28899, 28993, 29086, 29178, 29269, 29359, 29448, 29535,
+    29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784,
+    30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298,
+    31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737,
+    31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099,
+    32138, 32177, 32214, 32251, 32286, 32319, 32352, 32383,
+    32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718,
+    32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+    32767
+};
+
+//*****************************************************************************
+//
+// sin() of ui16Angle / FFT_TURN of a turn, in Q15.
+//
+//*****************************************************************************
+static int32_t
+fftSin(uint16_t ui16Angle)
+{
+    uint16_t ui16Step;
+
+    ui16Angle &= FFT_TURN - 1;
+    ui16Step = ui16Angle & ((FFT_TURN / 4) - 1);
+
+    switch(ui16Angle / (FFT_TURN / 4))
+    {
+        case 0:
+            return(g_pi16FFTSine[ui16Step]);
+        case 1:
+            return(g_pi16FFTSine[(FFT_TURN / 4) - ui16Step]);
+        case 2:
+            return(-g_pi16FFTSine[ui16Step]);
+        default:
+            return(-g_pi16FFTSine[(FFT_TURN / 4) - ui16Step]);
+    }
+}
+
+//*****************************************************************************
+//
+// cos() of ui16Angle / FFT_TURN of a turn, in Q15.
+//
+//*****************************************************************************
+static int32_t
+fftCos(uint16_t ui16Angle)
+{
+    return(fftSin(ui16Angle + (FFT_TURN / 4)));
+}
+
+//*****************************************************************************
+//
+// Reverse the low ui8Bits bits of ui16Index.
+//
+//*****************************************************************************
+static uint16_t
+fftBitReverse(uint16_t ui16Index, uint8_t ui8Bits)
+{
+    uint16_t ui16Rev;
+
+    ui16Rev = 0;
+    while(ui8Bits--)
+    {
+        ui16Rev = (ui16Rev << 1) | (ui16Index & 1);
+        ui16Index >>= 1;
+    }
+    return(ui16Rev);
+}
+
+bool
+WSFFTInit(tWSFFT *psFFT, int16_t *pi16Re, int16_t *pi16Im, uint8_t ui8Log2N)
+{
+    if((ui8Log2N < WS_FFT_LOG2N_MIN) || (ui8Log2N > WS_FFT_LOG2N_MAX))
+    {
+        return(false);
+    }
+
+    psFFT->pi16Re = pi16Re;
+    psFFT->pi16Im = pi16Im;
+    psFFT->ui8Log2N = ui8Log2N;
+    psFFT->ui16N = 1 << ui8Log2N;
+    return(true);
+}
+
+void
+WSFFTLoadADC(tWSFFT *psFFT, const uint16_t *pui16Samples)
+{
+    uint32_t ui32Sum;
+    int32_t i32Mean;
+    int32_t i32Sample;
+    int32_t i32Window;
+    uint16_t ui16Step;
+    uint16_t i;
+
+    ui32Sum = 0;
+    for(i = 0; i < psFFT->ui16N; i++)
+    {
+        ui32Sum += pui16Samples[i];
+    }
+    i32Mean = ui32Sum >> psFFT->ui8Log2N;
+
+    //
+    // 12-bit samples shifted up by 3 stay within Q15 after the DC is taken
+    // out.  The Hann window is (1 - cos) / 2.
+    //
+    ui16Step = FFT_TURN >> psFFT->ui8Log2N;
+    for(i = 0; i < psFFT->ui16N; i++)
+    {
+        i32Sample = ((int32_t)pui16Samples[i] - i32Mean) * 8;
+        i32Window = (32768 - fftCos(i * ui16Step)) >> 1;
+        psFFT->pi16Re[i] = (i32Sample * i32Window) >> 15;
+        psFFT->pi16Im[i] = 0;
+    }
+}
+
+void
+WSFFTRun(tWSFFT *psFFT)
+{
+    int16_t *pi16Re;
+    int16_t *pi16Im;
+    int16_t i16Swap;
+    int32_t i32WRe;
+    int32_t i32WIm;
+    int32_t i32TRe;
+    int32_t i32TIm;
+    int32_t i32Re;
+    int32_t i32Im;
+    uint16_t ui16Half;
+    uint16_t ui16Step;
+    uint16_t ui16Rev;
+    uint16_t i;
+    uint16_t j;
+    uint16_t k;
+
+    pi16Re = psFFT->pi16Re;
+    pi16Im = psFFT->pi16Im;
+
+    //
+    // Put the input in bit reversed order.
+    //
+    for(i = 0; i < psFFT->ui16N; i++)
+    {
+        ui16Rev = fftBitReverse(i, psFFT->ui8Log2N);
+        if(ui16Rev > i)
+        {
+            i16Swap = pi16Re[i];
+            pi16Re[i] = pi16Re[ui16Rev];
+            pi16Re[ui16Rev] = i16Swap;
+            i16Swap = pi16Im[i];
+            pi16Im[i] = pi16Im[ui16Rev];
+            pi16Im[ui16Rev] = i16Swap;
+        }
+    }
+
+    //
+    // Butterflies, one stage per doubling of the span.  The twiddle for
+    // butterfly j of a span is e^(-2 pi i j / span).
+    //
+    for(ui16Half = 1; ui16Half < psFFT->ui16N; ui16Half <<= 1)
+    {
+        ui16Step = FFT_TURN / (ui16Half * 2);
+        for(j = 0; j < ui16Half; j++)
+        {
+            i32WRe = fftCos(j * ui16Step);
+            i32WIm = -fftSin(j * ui16Step);
+            for(i = j; i < psFFT->ui16N; i += ui16Half * 2)
+            {
+                k = i + ui16Half;
+                i32TRe = ((pi16Re[k] * i32WRe) - (pi16Im[k] * i32WIm)) >> 15;
+                i32TIm = ((pi16Re[k] * i32WIm) + (pi16Im[k] * i32WRe)) >> 15;
+                i32Re = pi16Re[i];
+                i32Im = pi16Im[i];
+                pi16Re[i] = (i32Re + i32TRe) >> 1;
+                pi16Im[i] = (i32Im + i32TIm) >> 1;
+                pi16Re[k] = (i32Re - i32TRe) >> 1;
+                pi16Im[k] = (i32Im - i32TIm) >> 1;
+            }
+        }
+    }
+}
+
+void
+WSFFTBands(const tWSFFT *psFFT, uint32_t *pui32Power, uint8_t ui8NumBands)
+{
+    uint32_t ui32Pos;
+    uint32_t ui32Sum;
+    uint16_t ui16Half;
+    uint16_t ui16Lo;
+    uint16_t ui16Hi;
+    uint16_t i;
+    uint8_t ui8Band;
+
+    ui16Half = psFFT->ui16N / 2;
+    ui16Lo = 1;
+
+    for(ui8Band = 0; ui8Band < ui8NumBands; ui8Band++)
+    {
+        //
+        // The upper edge is Half ^ ((band + 1) / bands).  The exponent is
+        // kept in 8.8 fixed point and 2^frac is approximated by 1 + frac,
+        // which is plenty for band edges.
+        //
+        ui32Pos = ((uint32_t)(ui8Band + 1) * (psFFT->ui8Log2N - 1) * 256) /
+                  ui8NumBands;
+        ui16Hi = ((1 << (ui32Pos >> 8)) * (256 + (ui32Pos & 0xFF))) >> 8;
+
+        //
+        // Every band gets at least one bin, without starving the ones above.
+        //
+        if(ui16Hi <= ui16Lo)
+        {
+            ui16Hi = ui16Lo + 1;
+        }
+        if(ui16Hi > ui16Half - (ui8NumBands - ui8Band - 1))
+        {
+            ui16Hi = ui16Half - (ui8NumBands - ui8Band - 1);
+        }
+        if(ui8Band == ui8NumBands - 1)
+        {
+            ui16Hi = ui16Half;
+        }
+
+        ui32Sum = 0;
+        for(i = ui16Lo; i < ui16Hi; i++)
+        {
+            ui32Sum += (((int32_t)psFFT->pi16Re[i] * psFFT->pi16Re[i]) +
+                        ((int32_t)psFFT->pi16Im[i] * psFFT->pi16Im[i])) /
+                       (ui16Hi - ui16Lo);
+        }
+        pui32Power[ui8Band] = ui32Sum;
+        ui16Lo = ui16Hi;
+    }
+}
+
+uint8_t
+WSFFTLevel(uint32_t ui32Power)
+{
+    uint8_t ui8Msb;
+
+    if(ui32Power < 2)
+    {
+        return(0);
+    }
+
+    ui8Msb = 31;
+    while(!(ui32Power & 0x80000000))
+    {
+        ui32Power <<= 1;
+        ui8Msb--;
+    }
+
+    //
+    // The three bits below the leading one are the fraction.
+    //
+    return((ui8Msb * 8) + ((ui32Power >> 28) & 7));
+}
+
+void
+WSBeatInit(tWSBeat *psBeat, uint8_t ui8Threshold, uint8_t ui8Hold)
+{
+    psBeat->ui32Avg = 0;
+    psBeat->ui8Threshold = ui8Threshold;
+    psBeat->ui8Hold = ui8Hold;
+    psBeat->ui8HoldLeft = ui8Hold;
+}
+
+bool
+WSBeatUpdate(tWSBeat *psBeat, uint32_t ui32Energy)
+{
+    bool bBeat;
+
+    bBeat = false;
+    if(psBeat->ui8HoldLeft)
+    {
+        psBeat->ui8HoldLeft--;
+    }
+    else if(((uint64_t)ui32Energy * 16) >
+            ((uint64_t)psBeat->ui32Avg * psBeat->ui8Threshold))
+    {
+        bBeat = true;
+        psBeat->ui8HoldLeft = psBeat->ui8Hold;
+    }
+
+    //
+    // The average follows the energy with a time constant of 8 blocks.
+    //
+    if(ui32Energy > psBeat->ui32Avg)
+    {
+        psBeat->ui32Avg += (ui32Energy - psBeat->ui32Avg) / 8;
+    }
+    else
+    {
+        psBeat->ui32Avg -= (psBeat->ui32Avg - ui32Energy) / 8;
+    }
+
+    return(bBeat);
+}
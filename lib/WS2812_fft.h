@@ -0,0 +1,166 @@
+
+
+#ifndef __WS2812_FFT_H__
+#define __WS2812_FFT_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// Transform sizes supported, as log2 of the number of points
+//
+#define WS_FFT_LOG2N_MIN        4
+#define WS_FFT_LOG2N_MAX        10
+
+//*****************************************************************************
+//
+// A Q15 fixed-point FFT.  The real and imaginary arrays are supplied by the
+// caller and hold 1 << ui8Log2N points each.
+//
+//*****************************************************************************
+typedef struct
+{
+    int16_t *pi16Re;
+    int16_t *pi16Im;
+    uint16_t ui16N;
+    uint8_t ui8Log2N;
+}
+tWSFFT;
+
+//*****************************************************************************
+//
+// Beat detector state.  A beat is an energy more than ui8Threshold / 16 times
+// the running average, after which ui8Hold blocks must pass before the next.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Avg;
+    uint8_t ui8Threshold;
+    uint8_t ui8Hold;
+    uint8_t ui8HoldLeft;
+}
+tWSBeat;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Initialize an FFT
+//
+// @input psFFT is the FFT to initialize
+// @input pi16Re is the array of real parts, 1 << ui8Log2N entries
+// @input pi16Im is the array of imaginary parts, 1 << ui8Log2N entries
+// @input ui8Log2N is log2 of the number of points, WS_FFT_LOG2N_MIN to
+//        WS_FFT_LOG2N_MAX
+//
+// @returns false if ui8Log2N is out of range
+//
+//*****************************************************************************
+extern bool WSFFTInit(tWSFFT *psFFT, int16_t *pi16Re, int16_t *pi16Im,
+                      uint8_t ui8Log2N);
+
+//*****************************************************************************
+//
+// Load a block of 12-bit ADC samples into the FFT
+//
+// The DC offset of the block is removed, the samples are scaled to Q15 with
+// headroom and a Hann window is applied.  The imaginary parts are cleared.
+//
+// @input psFFT is the FFT to load
+// @input pui16Samples is ui16N raw ADC samples
+//
+//*****************************************************************************
+extern void WSFFTLoadADC(tWSFFT *psFFT, const uint16_t *pui16Samples);
+
+//*****************************************************************************
+//
+// Run the forward transform in place
+//
+// This is a radix-2 decimation in time transform.  Every stage halves its
+// results so nothing can overflow, which leaves the output scaled by 1/N.
+//
+// @input psFFT is the loaded FFT
+//
+//*****************************************************************************
+extern void WSFFTRun(tWSFFT *psFFT);
+
+//*****************************************************************************
+//
+// Sum the transform output into log spaced frequency bands
+//
+// Bins 1 to N/2 - 1 are split into ui8NumBands bands whose edges grow
+// geometrically, each at least one bin wide, so the low bands resolve bass
+// and the high bands cover the wider treble octaves.  The DC bin is skipped.
+//
+// @input psFFT is the transformed FFT
+// @input pui32Power receives the mean power (re^2 + im^2) of each band
+// @input ui8NumBands is the number of bands, at most N/2 - 1
+//
+//*****************************************************************************
+extern void WSFFTBands(const tWSFFT *psFFT, uint32_t *pui32Power,
+                       uint8_t ui8NumBands);
+
+//*****************************************************************************
+//
+// Convert a band power to an 8-bit level
+//
+// The level is 8 * log2(power), about 0.38dB per step, so a pattern can map
+// it straight to brightness.
+//
+// @input ui32Power is the band power from WSFFTBands()
+//
+// @returns the level, 0 to 255
+//
+//*****************************************************************************
+extern uint8_t WSFFTLevel(uint32_t ui32Power);
+
+//*****************************************************************************
+//
+// Initialize a beat detector
+//
+// @input psBeat is the detector to initialize
+// @input ui8Threshold is how far above the average an energy must be to count
+//        as a beat, in sixteenths (24 is 1.5 times)
+// @input ui8Hold is the number of blocks ignored after a beat
+//
+//*****************************************************************************
+extern void WSBeatInit(tWSBeat *psBeat, uint8_t ui8Threshold,
+                       uint8_t ui8Hold);
+
+//*****************************************************************************
+//
+// Feed a block's energy to the beat detector
+//
+// Typically this is the power of the lowest band or two.
+//
+// @input psBeat is the detector
+// @input ui32Energy is the energy of the latest block
+//
+// @returns true if the block is a beat
+//
+//*****************************************************************************
+extern bool WSBeatUpdate(tWSBeat *psBeat, uint32_t ui32Energy);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_FFT_H__
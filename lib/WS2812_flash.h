@@ -0,0 +1,95 @@
+
+
+#ifndef __WS2812_FLASH_H__
+#define __WS2812_FLASH_H__
+
+//*****************************************************************************
+//
+// Compile time encoding of LED colors into SPI bytes, for const frames that
+// the linker places in flash and SPIFrameSourceSet() sends without copying.
+//
+// Each macro expands to a list of initializers, so a frame is written as
+//
+//    const uint8_t g_pui8Idle[] =
+//    {
+//        WS_FLASH_LED(0x00, 0x40, 0x00),
+//        WS_FLASH_LED(0x10, 0x10, 0x10),
+//        ...
+//    };
+//
+// The encoding is WS2812_SPI_HIGH and WS2812_SPI_LOW unless WS_FLASH_HIGH
+// and WS_FLASH_LOW are defined first; it has to match the SPI bytes the
+// timing plan selects (see WS2812_timing.h).  The defaults only match the
+// legacy plan.  At 50MHz the WS2812B plan sends 7 bit frames of 0x7C for a
+// one and 0x60 for a zero, so frames for it are built with
+//
+//    #define WS_FLASH_HIGH           0x7C
+//    #define WS_FLASH_LOW            0x60
+//    #include "WS2812_flash.h"
+//
+// or with wsflash -s 0x7C,0x60.  "make -C tests bench" lists the plan for
+// other clocks.  SPIFrameSourceSet() checks each frame with
+// WSFlashFrameCheck() and refuses one built for another plan.
+//
+// For larger frames and animations, tools/wsflash.c generates the arrays
+// from raw frame dumps.
+//
+//*****************************************************************************
+
+#ifndef WS_FLASH_HIGH
+#define WS_FLASH_HIGH           WS2812_SPI_HIGH
+#define WS_FLASH_LOW            WS2812_SPI_LOW
+#endif
+
+//
+// The SPI byte for bit b (7 is the most significant) of color c
+//
+#define WS_FLASH_BIT(c, b)      ((((c) >> (b)) & 1) ? WS_FLASH_HIGH :         \
+                                                     WS_FLASH_LOW)
+
+//
+// The WS2812_SPI_BIT_WIDTH SPI bytes for one color byte, most significant
+// bit first
+//
+#define WS_FLASH_COLOR(c)       WS_FLASH_BIT(c, 7), WS_FLASH_BIT(c, 6),       \
+                                WS_FLASH_BIT(c, 5), WS_FLASH_BIT(c, 4),       \
+                                WS_FLASH_BIT(c, 3), WS_FLASH_BIT(c, 2),       \
+                                WS_FLASH_BIT(c, 1), WS_FLASH_BIT(c, 0)
+
+//
+// The WS2812_SPI_LED_SIZE SPI bytes for one LED, in the chain's GRB order
+//
+#define WS_FLASH_LED(g, r, b)   WS_FLASH_COLOR(g), WS_FLASH_COLOR(r),         \
+                                WS_FLASH_COLOR(b)
+
+//
+// An LED that is off
+//
+#define WS_FLASH_OFF            WS_FLASH_LED(0, 0, 0)
+
+//*****************************************************************************
+//
+// Check an encoded frame against the SPI bytes in use
+//
+// @input pui8Frame is the encoded frame
+// @input ui16Size is the size of the frame in bytes
+//
+// @returns true if every byte is g_ui8WSSPIHigh or g_ui8WSSPILow
+//
+//*****************************************************************************
+static inline bool
+WSFlashFrameCheck(const uint8_t *pui8Frame, uint16_t ui16Size)
+{
+    uint16_t i;
+
+    for(i = 0; i < ui16Size; i++)
+    {
+        if((pui8Frame[i] != g_ui8WSSPIHigh) && (pui8Frame[i] != g_ui8WSSPILow))
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+#endif // __WS2812_FLASH_H__
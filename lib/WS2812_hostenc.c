@@ -0,0 +1,516 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "WS2812_drv.h"
+#include "WS2812_hostenc.h"
+
+#if defined(WS_ENC_NO_SIMD)
+#define ENC_KERNEL              "table"
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define ENC_KERNEL              "avx2"
+#define ENC_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ENC_KERNEL              "sse2"
+#define ENC_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ENC_KERNEL              "neon"
+#define ENC_NEON
+#else
+#define ENC_KERNEL              "table"
+#endif
+
+//
+// Size of a cache line, so the threads' lists don't share one
+//
+#define ENC_LINE                64
+
+//*****************************************************************************
+//
+// A unit of work: a run of LEDs from one strip.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Strip;
+    uint16_t ui16First;
+    uint16_t ui16Count;
+}
+tWSEncTask;
+
+//*****************************************************************************
+//
+// A thread's list of tasks, [head, tail) of the frame's task array, packed
+// into one word as tail << 32 | head so taking from either end is a single
+// compare-and-swap.
+//
+//*****************************************************************************
+typedef struct
+{
+    _Alignas(ENC_LINE) _Atomic uint64_t ui64Range;
+}
+tWSEncQueue;
+
+struct tWSEncPool
+{
+    pthread_t *psThreads;
+    uint32_t ui32Threads;
+    tWSEncQueue *psQueues;
+    tWSEncTask *psTasks;
+    uint32_t ui32MaxTasks;
+    const tWSEncStrip *psStrips;
+    _Atomic uint32_t ui32Remaining;
+    pthread_mutex_t sLock;
+    pthread_cond_t sStart;
+    pthread_cond_t sDone;
+    uint32_t ui32Generation;
+    bool bQuit;
+};
+
+//
+// Each color byte's eight SPI bytes, for the table kernel and the tails of
+// the SIMD kernels
+//
+static uint64_t g_pui64EncTable[256];
+static uint8_t g_ui8EncTableHigh;
+static uint8_t g_ui8EncTableLow;
+static bool g_bEncTableValid;
+
+//*****************************************************************************
+//
+// Rebuild the lookup table if the encoding has changed since it was built.
+// Only called while no encoder threads are running.
+//
+//*****************************************************************************
+static void
+encTableUpdate(void)
+{
+    uint8_t pui8Bytes[WS2812_SPI_BIT_WIDTH];
+    int i;
+
+    if(g_bEncTableValid && (g_ui8EncTableHigh == g_ui8WSSPIHigh) &&
+       (g_ui8EncTableLow == g_ui8WSSPILow))
+    {
+        return;
+    }
+
+    for(i = 0; i < 256; i++)
+    {
+        WStoSPI(pui8Bytes, i);
+        memcpy(&g_pui64EncTable[i], pui8Bytes, sizeof(pui8Bytes));
+    }
+    g_ui8EncTableHigh = g_ui8WSSPIHigh;
+    g_ui8EncTableLow = g_ui8WSSPILow;
+    g_bEncTableValid = true;
+}
+
+//*****************************************************************************
+//
+// Encode ui32Len color bytes.  The SIMD kernels spread each color byte over
+// eight lanes, test one bit per lane and select the high or low SPI byte.
+//
+//*****************************************************************************
+static void
+encKernel(uint8_t *pui8SPI, const uint8_t *pui8Src, uint32_t ui32Len)
+{
+    uint32_t i;
+
+    i = 0;
+
+#if defined(ENC_AVX2)
+    const __m256i sBits = _mm256_set1_epi64x(0x0102040810204080LL);
+    const __m256i sHigh = _mm256_set1_epi8(g_ui8EncTableHigh);
+    const __m256i sLow = _mm256_set1_epi8(g_ui8EncTableLow);
+    __m256i sSel;
+
+    for(; (i + 4) <= ui32Len; i += 4)
+    {
+        sSel = _mm256_set_epi64x(pui8Src[i + 3] * 0x0101010101010101LL,
+                                 pui8Src[i + 2] * 0x0101010101010101LL,
+                                 pui8Src[i + 1] * 0x0101010101010101LL,
+                                 pui8Src[i] * 0x0101010101010101LL);
+        sSel = _mm256_cmpeq_epi8(_mm256_and_si256(sSel, sBits), sBits);
+        _mm256_storeu_si256((__m256i *)(pui8SPI + (i * 8)),
+                            _mm256_blendv_epi8(sLow, sHigh, sSel));
+    }
+#elif defined(ENC_SSE2)
+    const __m128i sBits = _mm_set1_epi64x(0x0102040810204080LL);
+    const __m128i sHigh = _mm_set1_epi8(g_ui8EncTableHigh);
+    const __m128i sLow = _mm_set1_epi8(g_ui8EncTableLow);
+    __m128i psSpread[8];
+    __m128i sSrc;
+    __m128i sSel;
+    int j;
+
+    //
+    // Sixteen color bytes at a time, spread out to eight copies of each by
+    // unpacking the register with itself three times.
+    //
+    for(; (i + 16) <= ui32Len; i += 16)
+    {
+        sSrc = _mm_loadu_si128((const __m128i *)(pui8Src + i));
+        psSpread[0] = _mm_unpacklo_epi8(sSrc, sSrc);
+        psSpread[4] = _mm_unpackhi_epi8(sSrc, sSrc);
+        psSpread[2] = _mm_unpackhi_epi16(psSpread[0], psSpread[0]);
+        psSpread[0] = _mm_unpacklo_epi16(psSpread[0], psSpread[0]);
+        psSpread[6] = _mm_unpackhi_epi16(psSpread[4], psSpread[4]);
+        psSpread[4] = _mm_unpacklo_epi16(psSpread[4], psSpread[4]);
+        for(j = 0; j < 8; j += 2)
+        {
+            psSpread[j + 1] = _mm_unpackhi_epi32(psSpread[j], psSpread[j]);
+            psSpread[j] = _mm_unpacklo_epi32(psSpread[j], psSpread[j]);
+        }
+
+        for(j = 0; j < 8; j++)
+        {
+            sSel = _mm_cmpeq_epi8(_mm_and_si128(psSpread[j], sBits), sBits);
+            _mm_storeu_si128((__m128i *)(pui8SPI + (i * 8) + (j * 16)),
+                             _mm_or_si128(_mm_and_si128(sSel, sHigh),
+                                          _mm_andnot_si128(sSel, sLow)));
+        }
+    }
+#elif defined(ENC_NEON)
+    static const uint8_t pui8Bits[16] =
+    {
+        0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+        0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01
+    };
+    const uint8x16_t sBits = vld1q_u8(pui8Bits);
+    const uint8x16_t sHigh = vdupq_n_u8(g_ui8EncTableHigh);
+    const uint8x16_t sLow = vdupq_n_u8(g_ui8EncTableLow);
+    uint8x16_t sSel;
+
+    for(; (i + 2) <= ui32Len; i += 2)
+    {
+        sSel = vcombine_u8(vdup_n_u8(pui8Src[i]), vdup_n_u8(pui8Src[i + 1]));
+        sSel = vtstq_u8(sSel, sBits);
+        vst1q_u8(pui8SPI + (i * 8), vbslq_u8(sSel, sHigh, sLow));
+    }
+#endif
+
+    for(; i < ui32Len; i++)
+    {
+        memcpy(pui8SPI + (i * 8), &g_pui64EncTable[pui8Src[i]], 8);
+    }
+}
+
+//*****************************************************************************
+//
+// Encode one task.
+//
+//*****************************************************************************
+static void
+encTaskRun(const tWSEncPool *psPool, const tWSEncTask *psTask)
+{
+    const tWSEncStrip *psStrip;
+
+    psStrip = &psPool->psStrips[psTask->ui32Strip];
+    encKernel(psStrip->pui8SPI + (psTask->ui16First * WS2812_SPI_LED_SIZE),
+              psStrip->pui8Colors[psTask->ui16First],
+              psTask->ui16Count * 3);
+}
+
+//*****************************************************************************
+//
+// Take a task from the front of a list (bSteal false) or the back (true).
+// Returns the index of the task, or -1 if the list is empty.
+//
+//*****************************************************************************
+static int32_t
+encQueueTake(tWSEncQueue *psQueue, bool bSteal)
+{
+    uint64_t ui64Range;
+    uint32_t ui32Head;
+    uint32_t ui32Tail;
+
+    ui64Range = atomic_load_explicit(&psQueue->ui64Range,
+                                     memory_order_acquire);
+    do
+    {
+        ui32Head = (uint32_t)ui64Range;
+        ui32Tail = (uint32_t)(ui64Range >> 32);
+        if(ui32Head >= ui32Tail)
+        {
+            return(-1);
+        }
+    }
+    while(!atomic_compare_exchange_weak_explicit(
+              &psQueue->ui64Range, &ui64Range,
+              bSteal ? (((uint64_t)(ui32Tail - 1) << 32) | ui32Head) :
+                       (ui64Range + 1),
+              memory_order_acq_rel, memory_order_acquire));
+
+    return(bSteal ? (int32_t)(ui32Tail - 1) : (int32_t)ui32Head);
+}
+
+//*****************************************************************************
+//
+// Work through this thread's own list, then steal from the others until
+// every list is empty.  The thread finishing the last task of the frame wakes
+// the caller.
+//
+//*****************************************************************************
+static void
+encWork(tWSEncPool *psPool, uint32_t ui32Self)
+{
+    uint32_t ui32Victim;
+    uint32_t ui32Done;
+    int32_t i32Task;
+
+    ui32Done = 0;
+    while((i32Task = encQueueTake(&psPool->psQueues[ui32Self], false)) >= 0)
+    {
+        encTaskRun(psPool, &psPool->psTasks[i32Task]);
+        ui32Done++;
+    }
+
+    for(ui32Victim = 1; ui32Victim < psPool->ui32Threads; ui32Victim++)
+    {
+        tWSEncQueue *psVictim;
+
+        psVictim = &psPool->psQueues[(ui32Self + ui32Victim) %
+                                     psPool->ui32Threads];
+        while((i32Task = encQueueTake(psVictim, true)) >= 0)
+        {
+            encTaskRun(psPool, &psPool->psTasks[i32Task]);
+            ui32Done++;
+        }
+    }
+
+    if(ui32Done &&
+       (atomic_fetch_sub_explicit(&psPool->ui32Remaining, ui32Done,
+                                  memory_order_acq_rel) == ui32Done))
+    {
+        pthread_mutex_lock(&psPool->sLock);
+        pthread_cond_broadcast(&psPool->sDone);
+        pthread_mutex_unlock(&psPool->sLock);
+    }
+}
+
+//*****************************************************************************
+//
+// An encoder thread.  It sleeps until the next frame is posted.
+//
+//*****************************************************************************
+static void *
+encThread(void *pvArg)
+{
+    tWSEncPool *psPool;
+    uint32_t ui32Self;
+    uint32_t ui32Seen;
+
+    psPool = (tWSEncPool *)((void **)pvArg)[0];
+    ui32Self = (uint32_t)(uintptr_t)((void **)pvArg)[1];
+    free(pvArg);
+
+    ui32Seen = 0;
+    while(1)
+    {
+        pthread_mutex_lock(&psPool->sLock);
+        while(!psPool->bQuit && (psPool->ui32Generation == ui32Seen))
+        {
+            pthread_cond_wait(&psPool->sStart, &psPool->sLock);
+        }
+        ui32Seen = psPool->ui32Generation;
+        if(psPool->bQuit)
+        {
+            pthread_mutex_unlock(&psPool->sLock);
+            return(NULL);
+        }
+        pthread_mutex_unlock(&psPool->sLock);
+
+        encWork(psPool, ui32Self);
+    }
+}
+
+tWSEncPool *
+WSEncPoolCreate(uint32_t ui32Threads, uint32_t ui32MaxTasks)
+{
+    tWSEncPool *psPool;
+    void **ppvArg;
+    uint32_t i;
+
+    if(ui32Threads == 0)
+    {
+        return(NULL);
+    }
+
+    psPool = calloc(1, sizeof(tWSEncPool));
+    if(psPool == NULL)
+    {
+        return(NULL);
+    }
+    psPool->ui32Threads = ui32Threads;
+    psPool->ui32MaxTasks = ui32MaxTasks;
+    psPool->psTasks = calloc(ui32MaxTasks ? ui32MaxTasks : 1,
+                             sizeof(tWSEncTask));
+    psPool->psQueues = aligned_alloc(ENC_LINE,
+                                     ui32Threads * sizeof(tWSEncQueue));
+    psPool->psThreads = calloc(ui32Threads, sizeof(pthread_t));
+    if(!psPool->psTasks || !psPool->psQueues || !psPool->psThreads)
+    {
+        free(psPool->psTasks);
+        free(psPool->psQueues);
+        free(psPool->psThreads);
+        free(psPool);
+        return(NULL);
+    }
+    for(i = 0; i < ui32Threads; i++)
+    {
+        atomic_init(&psPool->psQueues[i].ui64Range, 0);
+    }
+    atomic_init(&psPool->ui32Remaining, 0);
+    pthread_mutex_init(&psPool->sLock, NULL);
+    pthread_cond_init(&psPool->sStart, NULL);
+    pthread_cond_init(&psPool->sDone, NULL);
+
+    //
+    // Thread 0 is whoever calls WSEncPoolEncode().
+    //
+    for(i = 1; i < ui32Threads; i++)
+    {
+        ppvArg = malloc(2 * sizeof(void *));
+        if(ppvArg != NULL)
+        {
+            ppvArg[0] = psPool;
+            ppvArg[1] = (void *)(uintptr_t)i;
+            if(pthread_create(&psPool->psThreads[i], NULL, encThread,
+                              ppvArg) == 0)
+            {
+                continue;
+            }
+            free(ppvArg);
+        }
+
+        //
+        // Run with the threads that did start.
+        //
+        psPool->ui32Threads = i;
+        break;
+    }
+
+    return(psPool);
+}
+
+void
+WSEncPoolDestroy(tWSEncPool *psPool)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&psPool->sLock);
+    psPool->bQuit = true;
+    pthread_cond_broadcast(&psPool->sStart);
+    pthread_mutex_unlock(&psPool->sLock);
+
+    for(i = 1; i < psPool->ui32Threads; i++)
+    {
+        pthread_join(psPool->psThreads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&psPool->sLock);
+    pthread_cond_destroy(&psPool->sStart);
+    pthread_cond_destroy(&psPool->sDone);
+    free(psPool->psTasks);
+    free(psPool->psQueues);
+    free(psPool->psThreads);
+    free(psPool);
+}
+
+bool
+WSEncPoolEncode(tWSEncPool *psPool, const tWSEncStrip *psStrips,
+                uint32_t ui32NumStrips)
+{
+    uint32_t ui32Tasks;
+    uint32_t ui32Strip;
+    uint32_t ui32Head;
+    uint32_t ui32Tail;
+    uint32_t i;
+    uint16_t ui16First;
+    uint16_t ui16Count;
+
+    //
+    // Cut the strips into chunks.
+    //
+    ui32Tasks = 0;
+    for(ui32Strip = 0; ui32Strip < ui32NumStrips; ui32Strip++)
+    {
+        for(ui16First = 0; ui16First < psStrips[ui32Strip].ui16NumLED;
+            ui16First += ui16Count)
+        {
+            ui16Count = psStrips[ui32Strip].ui16NumLED - ui16First;
+            if(ui16Count > WS_ENC_CHUNK_LEDS)
+            {
+                ui16Count = WS_ENC_CHUNK_LEDS;
+            }
+            if(ui32Tasks == psPool->ui32MaxTasks)
+            {
+                return(false);
+            }
+            psPool->psTasks[ui32Tasks].ui32Strip = ui32Strip;
+            psPool->psTasks[ui32Tasks].ui16First = ui16First;
+            psPool->psTasks[ui32Tasks].ui16Count = ui16Count;
+            ui32Tasks++;
+        }
+    }
+
+    if(ui32Tasks == 0)
+    {
+        return(true);
+    }
+
+    encTableUpdate();
+    psPool->psStrips = psStrips;
+
+    //
+    // Deal the chunks out in equal contiguous runs, so neighbouring chunks
+    // of a strip usually stay on one thread.  A thread still on its way out
+    // of the last frame can take a chunk as soon as its list is stored, so
+    // the count has to be in place first.
+    //
+    atomic_store_explicit(&psPool->ui32Remaining, ui32Tasks,
+                          memory_order_release);
+    for(i = 0; i < psPool->ui32Threads; i++)
+    {
+        ui32Head = (uint32_t)(((uint64_t)ui32Tasks * i) / psPool->ui32Threads);
+        ui32Tail = (uint32_t)(((uint64_t)ui32Tasks * (i + 1)) /
+                              psPool->ui32Threads);
+        atomic_store_explicit(&psPool->psQueues[i].ui64Range,
+                              ((uint64_t)ui32Tail << 32) | ui32Head,
+                              memory_order_release);
+    }
+
+    pthread_mutex_lock(&psPool->sLock);
+    psPool->ui32Generation++;
+    pthread_cond_broadcast(&psPool->sStart);
+    pthread_mutex_unlock(&psPool->sLock);
+
+    encWork(psPool, 0);
+
+    pthread_mutex_lock(&psPool->sLock);
+    while(atomic_load_explicit(&psPool->ui32Remaining, memory_order_acquire))
+    {
+        pthread_cond_wait(&psPool->sDone, &psPool->sLock);
+    }
+    pthread_mutex_unlock(&psPool->sLock);
+
+    return(true);
+}
+
+void
+WSEncodeBytes(uint8_t *pui8SPI, const uint8_t *pui8Src, uint32_t ui32Len)
+{
+    encTableUpdate();
+    encKernel(pui8SPI, pui8Src, ui32Len);
+}
+
+const char *
+WSEncKernelName(void)
+{
+    return(ENC_KERNEL);
+}
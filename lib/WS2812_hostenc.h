@@ -0,0 +1,140 @@
+
+
+#ifndef __WS2812_HOSTENC_H__
+#define __WS2812_HOSTENC_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Multi-threaded encoder for Linux hosts driving many strips.
+//
+// Each frame, every strip is cut into chunks of WS_ENC_CHUNK_LEDS LEDs and
+// the chunks are dealt out evenly to the pool's threads.  A thread works
+// through its own chunks from the front; once it runs out it steals from the
+// back of the other threads' lists.  Taking and stealing are a single
+// compare-and-swap on the owner's list, and every chunk writes its own part
+// of its strip's SPI array, so nothing is locked while encoding.  The
+// threads only meet at the start and end of each frame.
+//
+// The encode kernel uses AVX2, SSE2 or NEON when the compiler targets them,
+// and a lookup table otherwise.  Define WS_ENC_NO_SIMD to always use the
+// table.  The kernels honour WSEncodingSet().
+//
+//*****************************************************************************
+
+//
+// Number of LEDs in each unit of work
+//
+#ifndef WS_ENC_CHUNK_LEDS
+#define WS_ENC_CHUNK_LEDS       128
+#endif
+
+//*****************************************************************************
+//
+// One strip to encode: its GRB framebuffer and the SPI array it is encoded
+// into, WS2812_SPI_LED_SIZE bytes per LED.
+//
+//*****************************************************************************
+typedef struct
+{
+    const uint8_t (*pui8Colors)[3];
+    uint8_t *pui8SPI;
+    uint16_t ui16NumLED;
+}
+tWSEncStrip;
+
+//
+// The thread pool.  Only the encoder looks inside.
+//
+typedef struct tWSEncPool tWSEncPool;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Start a pool of encoder threads
+//
+// @input ui32Threads is the number of threads encoding, including the one
+//        that calls WSEncPoolEncode()
+// @input ui32MaxTasks is the largest number of chunks a frame may have; a
+//        strip of n LEDs has (n + WS_ENC_CHUNK_LEDS - 1) / WS_ENC_CHUNK_LEDS
+//
+// @returns the pool, or NULL if it couldn't be created
+//
+//*****************************************************************************
+extern tWSEncPool *WSEncPoolCreate(uint32_t ui32Threads,
+                                   uint32_t ui32MaxTasks);
+
+//*****************************************************************************
+//
+// Stop the pool's threads and free it
+//
+// @input psPool is the pool from WSEncPoolCreate()
+//
+//*****************************************************************************
+extern void WSEncPoolDestroy(tWSEncPool *psPool);
+
+//*****************************************************************************
+//
+// Encode a frame for every strip
+//
+// The calling thread joins in and returns once every strip is encoded.
+//
+// @input psPool is the pool from WSEncPoolCreate()
+// @input psStrips is the array of strips
+// @input ui32NumStrips is the number of strips
+//
+// @returns false if the frame has more chunks than the pool was created for,
+//          in which case nothing is encoded
+//
+//*****************************************************************************
+extern bool WSEncPoolEncode(tWSEncPool *psPool, const tWSEncStrip *psStrips,
+                            uint32_t ui32NumStrips);
+
+//*****************************************************************************
+//
+// Encode a run of color bytes on the calling thread
+//
+// Each byte becomes WS2812_SPI_BIT_WIDTH SPI bytes, most significant bit
+// first, exactly as WStoSPI() would write them.
+//
+// @input pui8SPI receives ui32Len * WS2812_SPI_BIT_WIDTH bytes
+// @input pui8Src is the color bytes
+// @input ui32Len is the number of color bytes
+//
+//*****************************************************************************
+extern void WSEncodeBytes(uint8_t *pui8SPI, const uint8_t *pui8Src,
+                          uint32_t ui32Len);
+
+//*****************************************************************************
+//
+// Get the name of the encode kernel built in: "avx2", "sse2", "neon" or
+// "table".
+//
+//*****************************************************************************
+extern const char *WSEncKernelName(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_HOSTENC_H__
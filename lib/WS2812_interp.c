@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_blend.h"
+#include "WS2812_interp.h"
+
+//*****************************************************************************
+//
+// Work out the lerp weight of the output frame for the current step, and
+// start encoding it from the first LED.
+//
+//*****************************************************************************
+static void
+interpStartFrame(tWSInterp *psInterp)
+{
+    psInterp->ui8Weight = ((uint32_t)psInterp->ui16Step * 255) /
+                          psInterp->ui16Steps;
+    psInterp->ui16Pos = 0;
+}
+
+void
+WSInterpInit(tWSInterp *psInterp, uint8_t *pui8Frames, uint16_t ui16NumLED,
+             uint16_t ui16Steps)
+{
+    uint32_t ui32FrameSize;
+
+    ui32FrameSize = (uint32_t)ui16NumLED * 3;
+
+    psInterp->pui8From = (uint8_t (*)[3])pui8Frames;
+    psInterp->pui8To = (uint8_t (*)[3])(pui8Frames + ui32FrameSize);
+    psInterp->pui8Target = (uint8_t (*)[3])(pui8Frames + (ui32FrameSize * 2));
+    psInterp->ui16NumLED = ui16NumLED;
+    psInterp->ui16Steps = ui16Steps ? ui16Steps : 1;
+    psInterp->ui16Step = 0;
+
+    interpStartFrame(psInterp);
+}
+
+void
+WSInterpPush(tWSInterp *psInterp)
+{
+    uint8_t (*pui8Old)[3];
+
+    //
+    // If the push comes early, part way through a fade, flatten the current
+    // output frame into the keyframe being faded from so the new fade starts
+    // exactly where the output is now.  Otherwise the keyframe that was
+    // being faded to is already what is on the LEDs.
+    //
+    if(psInterp->ui8Weight == 255)
+    {
+        pui8Old = psInterp->pui8From;
+        psInterp->pui8From = psInterp->pui8To;
+    }
+    else
+    {
+        if(psInterp->ui8Weight)
+        {
+            WSBlendLerp(psInterp->pui8From,
+                        (const uint8_t (*)[3])psInterp->pui8From,
+                        (const uint8_t (*)[3])psInterp->pui8To,
+                        psInterp->ui16NumLED, psInterp->ui8Weight);
+        }
+        pui8Old = psInterp->pui8To;
+    }
+
+    psInterp->pui8To = psInterp->pui8Target;
+    psInterp->pui8Target = pui8Old;
+    psInterp->ui16Step = 0;
+
+    interpStartFrame(psInterp);
+}
+
+void
+WSInterpAdvance(tWSInterp *psInterp)
+{
+    if(psInterp->ui16Step < psInterp->ui16Steps)
+    {
+        psInterp->ui16Step++;
+    }
+
+    interpStartFrame(psInterp);
+}
+
+bool
+WSInterpRender(tWSInterp *psInterp, uint8_t *pui8SPIOut, uint16_t ui16MaxLEDs)
+{
+    uint16_t ui16Pos;
+    uint16_t ui16Count;
+
+    ui16Pos = psInterp->ui16Pos;
+    ui16Count = psInterp->ui16NumLED - ui16Pos;
+    if(ui16Count > ui16MaxLEDs)
+    {
+        ui16Count = ui16MaxLEDs;
+    }
+
+    if(ui16Count)
+    {
+        WSBlendLerpEncode(pui8SPIOut + ((uint32_t)ui16Pos *
+                                        WS2812_SPI_LED_SIZE),
+                          (const uint8_t (*)[3])&psInterp->pui8From[ui16Pos],
+                          (const uint8_t (*)[3])&psInterp->pui8To[ui16Pos],
+                          ui16Count, psInterp->ui8Weight);
+        psInterp->ui16Pos = ui16Pos + ui16Count;
+    }
+
+    return(psInterp->ui16Pos == psInterp->ui16NumLED);
+}
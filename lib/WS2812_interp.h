@@ -0,0 +1,156 @@
+
+
+#ifndef __WS2812_INTERP_H__
+#define __WS2812_INTERP_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Frame interpolation lets the LEDs refresh at the bus rate while effects are
+// rendered at a lower rate.  Three GRB framebuffers are rotated: the two most
+// recent keyframes being faded between, and one the renderer is drawing the
+// next keyframe into.  Every transmitted frame is a fixed-point lerp between
+// the two keyframes, encoded straight into the SPI array a chunk at a time.
+//
+// A typical main loop:
+//
+//    if(ui8SPIDone)
+//    {
+//        ui8SPIDone = 0;
+//        WSInterpAdvance(&sInterp);
+//    }
+//    if(!WSInterpRender(&sInterp, pui8SPIOut, 64))
+//    {
+//        continue;
+//    }
+//    ... render a bit more of WSInterpTarget(&sInterp), and when the
+//        keyframe is finished call WSInterpPush(&sInterp)
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Interpolator state
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The keyframe being faded from, the keyframe being faded to, and the
+    // keyframe being rendered
+    //
+    uint8_t (*pui8From)[3];
+    uint8_t (*pui8To)[3];
+    uint8_t (*pui8Target)[3];
+
+    uint16_t ui16NumLED;
+
+    //
+    // Number of transmitted frames per keyframe, and how far through the
+    // current keyframe interval the output is
+    //
+    uint16_t ui16Steps;
+    uint16_t ui16Step;
+
+    //
+    // The weight of the output frame being encoded, and how many of its LEDs
+    // have been encoded so far
+    //
+    uint8_t ui8Weight;
+    uint16_t ui16Pos;
+}
+tWSInterp;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Initialize an interpolator
+//
+// @input psInterp is the interpolator to initialize
+// @input pui8Frames is storage for three GRB framebuffers of ui16NumLED LEDs
+//        each, for example uint8_t pui8Frames[3][NUM_LEDS][3].  The first two
+//        should hold the starting image.
+// @input ui16NumLED is the number of LEDs
+// @input ui16Steps is the number of transmitted frames per rendered keyframe,
+//        the bus frame rate divided by the render frame rate
+//
+//*****************************************************************************
+extern void WSInterpInit(tWSInterp *psInterp, uint8_t *pui8Frames,
+                         uint16_t ui16NumLED, uint16_t ui16Steps);
+
+//*****************************************************************************
+//
+// Get the framebuffer the next keyframe should be rendered into
+//
+//*****************************************************************************
+static inline uint8_t
+(*WSInterpTarget(tWSInterp *psInterp))[3]
+{
+    return(psInterp->pui8Target);
+}
+
+//*****************************************************************************
+//
+// Hand over a finished keyframe
+//
+// The output frame currently on the LEDs becomes the one faded from, and the
+// newly rendered keyframe becomes the one faded to, so there is no visible
+// jump even if the previous fade had not finished.  Encoding of the output
+// frame restarts from the first LED.
+//
+// @input psInterp is the interpolator
+//
+//*****************************************************************************
+extern void WSInterpPush(tWSInterp *psInterp);
+
+//*****************************************************************************
+//
+// Move on to the next output frame
+//
+// Call this once per transmitted frame.  If the renderer falls behind, the
+// output holds on the newest keyframe until the next one is pushed.
+//
+// @input psInterp is the interpolator
+//
+//*****************************************************************************
+extern void WSInterpAdvance(tWSInterp *psInterp);
+
+//*****************************************************************************
+//
+// Encode part of the current output frame
+//
+// @input psInterp is the interpolator
+// @input pui8SPIOut is the entire SPI output data array
+// @input ui16MaxLEDs is the most LEDs to encode in this call
+//
+// @returns true once the whole output frame has been encoded
+//
+//*****************************************************************************
+extern bool WSInterpRender(tWSInterp *psInterp, uint8_t *pui8SPIOut,
+                           uint16_t ui16MaxLEDs);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_INTERP_H__
@@ -0,0 +1,322 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "WS2812_drv.h"
+#include "WS2812_matrix.h"
+
+//*****************************************************************************
+//
+// Copy an already encoded LED into ui16Count consecutive LEDs of the SPI
+// array, starting at LED ui16First.  The copy doubles in size each pass so a
+// long run costs only a handful of memcpy calls.
+//
+//*****************************************************************************
+static void
+matrixCopyLED(uint8_t *pui8SPILEDs, uint16_t ui16First, uint16_t ui16Count,
+              const uint8_t *pui8Encoded)
+{
+    uint8_t *pui8Dst;
+    uint32_t ui32Done;
+    uint32_t ui32Chunk;
+
+    if(ui16Count == 0)
+    {
+        return;
+    }
+
+    pui8Dst = pui8SPILEDs + ((uint32_t)ui16First * WS2812_SPI_LED_SIZE);
+    memcpy(pui8Dst, pui8Encoded, WS2812_SPI_LED_SIZE);
+
+    for(ui32Done = 1; ui32Done < ui16Count; ui32Done += ui32Chunk)
+    {
+        ui32Chunk = ui16Count - ui32Done;
+        if(ui32Chunk > ui32Done)
+        {
+            ui32Chunk = ui32Done;
+        }
+        memcpy(pui8Dst + (ui32Done * WS2812_SPI_LED_SIZE), pui8Dst,
+               ui32Chunk * WS2812_SPI_LED_SIZE);
+    }
+}
+
+//*****************************************************************************
+//
+// Clip a span starting at *pui16Pos with length *pui16Len to [0, ui16Limit).
+// Returns false if nothing is left to draw.
+//
+//*****************************************************************************
+static bool
+matrixClip(uint16_t *pui16Pos, uint16_t *pui16Len, uint16_t ui16Limit)
+{
+    if(*pui16Pos >= ui16Limit)
+    {
+        return(false);
+    }
+    if(*pui16Len > (ui16Limit - *pui16Pos))
+    {
+        *pui16Len = ui16Limit - *pui16Pos;
+    }
+    return(*pui16Len != 0);
+}
+
+//*****************************************************************************
+//
+// Fill a horizontal (bVertical false) or vertical line of pixels that has
+// already been clipped to the surface, one contiguous LED run at a time.
+//
+//*****************************************************************************
+static void
+matrixFillLine(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs,
+               uint16_t ui16X, uint16_t ui16Y, uint16_t ui16Len,
+               bool bVertical, const uint8_t *pui8Encoded)
+{
+    uint16_t ui16Run;
+    uint16_t ui16Pos;
+    uint16_t ui16End;
+    uint16_t ui16ChunkEnd;
+    uint16_t ui16First;
+    uint16_t ui16Last;
+
+    ui16Run = bVertical ? psMatrix->ui16RunY : psMatrix->ui16RunX;
+    ui16Pos = bVertical ? ui16Y : ui16X;
+    ui16End = ui16Pos + ui16Len;
+
+    while(ui16Pos < ui16End)
+    {
+        //
+        // Stop at the end of the current run, or the end of the line
+        //
+        ui16ChunkEnd = ((ui16Pos / ui16Run) + 1) * ui16Run;
+        if(ui16ChunkEnd > ui16End)
+        {
+            ui16ChunkEnd = ui16End;
+        }
+
+        if(bVertical)
+        {
+            ui16First = WSMatrixIndex(psMatrix, ui16X, ui16Pos);
+            ui16Last = WSMatrixIndex(psMatrix, ui16X, ui16ChunkEnd - 1);
+        }
+        else
+        {
+            ui16First = WSMatrixIndex(psMatrix, ui16Pos, ui16Y);
+            ui16Last = WSMatrixIndex(psMatrix, ui16ChunkEnd - 1, ui16Y);
+        }
+
+        //
+        // Serpentine runs go backwards, but a fill doesn't care which way the
+        // run is walked.
+        //
+        matrixCopyLED(pui8SPILEDs, (ui16First < ui16Last) ? ui16First :
+                      ui16Last, ui16ChunkEnd - ui16Pos, pui8Encoded);
+
+        ui16Pos = ui16ChunkEnd;
+    }
+}
+
+bool
+WSMatrixInit(tWSMatrix *psMatrix, uint16_t *pui16Map, uint16_t ui16Width,
+             uint16_t ui16Height, uint16_t ui16TileWidth,
+             uint16_t ui16TileHeight, uint32_t ui32Flags)
+{
+    uint16_t ui16X;
+    uint16_t ui16Y;
+    uint16_t ui16TilesAcross;
+    uint16_t ui16TileX;
+    uint16_t ui16TileY;
+    uint16_t ui16Major;
+    uint16_t ui16Minor;
+    uint16_t ui16MinorLen;
+    uint32_t ui32Tile;
+
+    if((ui16Width == 0) || (ui16Height == 0) || (ui16TileWidth == 0) ||
+       (ui16TileHeight == 0) || (ui16Width % ui16TileWidth) ||
+       (ui16Height % ui16TileHeight) ||
+       (((uint32_t)ui16Width * ui16Height) > 0x10000))
+    {
+        return(false);
+    }
+
+    psMatrix->ui16Width = ui16Width;
+    psMatrix->ui16Height = ui16Height;
+    psMatrix->pui16Map = pui16Map;
+
+    ui16TilesAcross = ui16Width / ui16TileWidth;
+
+    for(ui16Y = 0; ui16Y < ui16Height; ui16Y++)
+    {
+        for(ui16X = 0; ui16X < ui16Width; ui16X++)
+        {
+            //
+            // Figure out which tile the pixel is in, and where that tile sits
+            // in the chain.
+            //
+            ui16TileX = ui16X / ui16TileWidth;
+            ui16TileY = ui16Y / ui16TileHeight;
+            if((ui32Flags & WS_MATRIX_TILE_SERPENTINE) && (ui16TileY & 1))
+            {
+                ui16TileX = ui16TilesAcross - 1 - ui16TileX;
+            }
+            ui32Tile = ((uint32_t)ui16TileY * ui16TilesAcross) + ui16TileX;
+
+            //
+            // Then where the pixel sits inside of the tile
+            //
+            if(ui32Flags & WS_MATRIX_COLUMNS)
+            {
+                ui16Major = ui16X % ui16TileWidth;
+                ui16Minor = ui16Y % ui16TileHeight;
+                ui16MinorLen = ui16TileHeight;
+            }
+            else
+            {
+                ui16Major = ui16Y % ui16TileHeight;
+                ui16Minor = ui16X % ui16TileWidth;
+                ui16MinorLen = ui16TileWidth;
+            }
+            if((ui32Flags & WS_MATRIX_SERPENTINE) && (ui16Major & 1))
+            {
+                ui16Minor = ui16MinorLen - 1 - ui16Minor;
+            }
+
+            pui16Map[((uint32_t)ui16Y * ui16Width) + ui16X] =
+                (ui32Tile * ui16TileWidth * ui16TileHeight) +
+                ((uint32_t)ui16Major * ui16MinorLen) + ui16Minor;
+        }
+    }
+
+    //
+    // Rows (or columns) are only contiguous within a tile
+    //
+    if(ui32Flags & WS_MATRIX_COLUMNS)
+    {
+        psMatrix->ui16RunX = 1;
+        psMatrix->ui16RunY = ui16TileHeight;
+    }
+    else
+    {
+        psMatrix->ui16RunX = ui16TileWidth;
+        psMatrix->ui16RunY = 1;
+    }
+
+    return(true);
+}
+
+void
+WSMatrixFillRow(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs,
+                uint16_t ui16X, uint16_t ui16Y, uint16_t ui16Len,
+                uint8_t ui8Green, uint8_t ui8Red, uint8_t ui8Blue)
+{
+    uint8_t pui8Encoded[WS2812_SPI_LED_SIZE];
+
+    if((ui16Y >= psMatrix->ui16Height) ||
+       !matrixClip(&ui16X, &ui16Len, psMatrix->ui16Width))
+    {
+        return;
+    }
+
+    WSGRBtoSPI(pui8Encoded, ui8Green, ui8Red, ui8Blue);
+    matrixFillLine(psMatrix, pui8SPILEDs, ui16X, ui16Y, ui16Len, false,
+                   pui8Encoded);
+}
+
+void
+WSMatrixFillRect(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs,
+                 uint16_t ui16X, uint16_t ui16Y, uint16_t ui16W,
+                 uint16_t ui16H, uint8_t ui8Green, uint8_t ui8Red,
+                 uint8_t ui8Blue)
+{
+    uint8_t pui8Encoded[WS2812_SPI_LED_SIZE];
+    uint16_t ui16I;
+
+    if(!matrixClip(&ui16X, &ui16W, psMatrix->ui16Width) ||
+       !matrixClip(&ui16Y, &ui16H, psMatrix->ui16Height))
+    {
+        return;
+    }
+
+    WSGRBtoSPI(pui8Encoded, ui8Green, ui8Red, ui8Blue);
+
+    if(psMatrix->ui16RunY > psMatrix->ui16RunX)
+    {
+        for(ui16I = 0; ui16I < ui16W; ui16I++)
+        {
+            matrixFillLine(psMatrix, pui8SPILEDs, ui16X + ui16I, ui16Y, ui16H,
+                           true, pui8Encoded);
+        }
+    }
+    else
+    {
+        for(ui16I = 0; ui16I < ui16H; ui16I++)
+        {
+            matrixFillLine(psMatrix, pui8SPILEDs, ui16X, ui16Y + ui16I, ui16W,
+                           false, pui8Encoded);
+        }
+    }
+}
+
+void
+WSMatrixBlit(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs, uint16_t ui16X,
+             uint16_t ui16Y, const uint8_t pui8Src[][3], uint16_t ui16W,
+             uint16_t ui16H)
+{
+    uint16_t ui16SrcW;
+    uint16_t ui16ClipW;
+    uint16_t ui16ClipH;
+    uint16_t ui16Row;
+    uint16_t ui16Pos;
+    uint16_t ui16End;
+    uint16_t ui16ChunkEnd;
+    uint16_t ui16First;
+    uint16_t ui16Last;
+    int32_t i32Step;
+    uint8_t *pui8Dst;
+    const uint8_t (*pui8Pix)[3];
+
+    ui16SrcW = ui16W;
+    ui16ClipW = ui16W;
+    ui16ClipH = ui16H;
+    if(!matrixClip(&ui16X, &ui16ClipW, psMatrix->ui16Width) ||
+       !matrixClip(&ui16Y, &ui16ClipH, psMatrix->ui16Height))
+    {
+        return;
+    }
+
+    //
+    // Blits are always walked along the source rows.  Column wired panels
+    // fall back to one run per pixel, which is still correct.
+    //
+    for(ui16Row = 0; ui16Row < ui16ClipH; ui16Row++)
+    {
+        pui8Pix = &pui8Src[(uint32_t)ui16Row * ui16SrcW];
+        ui16Pos = ui16X;
+        ui16End = ui16X + ui16ClipW;
+
+        while(ui16Pos < ui16End)
+        {
+            ui16ChunkEnd = ((ui16Pos / psMatrix->ui16RunX) + 1) *
+                           psMatrix->ui16RunX;
+            if(ui16ChunkEnd > ui16End)
+            {
+                ui16ChunkEnd = ui16End;
+            }
+
+            ui16First = WSMatrixIndex(psMatrix, ui16Pos, ui16Y + ui16Row);
+            ui16Last = WSMatrixIndex(psMatrix, ui16ChunkEnd - 1,
+                                     ui16Y + ui16Row);
+            i32Step = (ui16Last < ui16First) ? -WS2812_SPI_LED_SIZE :
+                                               WS2812_SPI_LED_SIZE;
+
+            pui8Dst = pui8SPILEDs + ((uint32_t)ui16First *
+                                     WS2812_SPI_LED_SIZE);
+            for(; ui16Pos < ui16ChunkEnd; ui16Pos++)
+            {
+                WSGRBtoSPI(pui8Dst, (*pui8Pix)[0], (*pui8Pix)[1],
+                           (*pui8Pix)[2]);
+                pui8Pix++;
+                pui8Dst += i32Step;
+            }
+        }
+    }
+}
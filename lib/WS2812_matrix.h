@@ -0,0 +1,210 @@
+
+
+#ifndef __WS2812_MATRIX_H__
+#define __WS2812_MATRIX_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Layout flags that can be passed to WSMatrixInit().  A panel is made up of
+// one or more tiles that are chained one after another.  Inside each tile the
+// LEDs either run along rows (the default) or along columns, and may reverse
+// direction on every other row/column (serpentine wiring).  Tiles themselves
+// are chained along the rows of tiles, optionally reversing direction on every
+// other row of tiles.
+//
+//*****************************************************************************
+#define WS_MATRIX_ROWS              0x00
+#define WS_MATRIX_COLUMNS           0x01
+#define WS_MATRIX_SERPENTINE        0x02
+#define WS_MATRIX_TILE_SERPENTINE   0x04
+
+//
+// Number of uint16_t entries needed for the index map of a matrix
+//
+#define WS_MATRIX_MAP_SIZE(w, h)    ((w) * (h))
+
+//*****************************************************************************
+//
+// A 2D surface mapped onto a chain of WS2812b LEDs.  All members are filled
+// in by WSMatrixInit() and should be treated as read only.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Size of the surface in pixels
+    //
+    uint16_t ui16Width;
+    uint16_t ui16Height;
+
+    //
+    // Length of the aligned runs of pixels along x (or y) that map to
+    // consecutive LEDs in the chain.  A value of 1 means that direction has
+    // no contiguous runs.
+    //
+    uint16_t ui16RunX;
+    uint16_t ui16RunY;
+
+    //
+    // Index map, pui16Map[y * ui16Width + x] is the LED at (x, y)
+    //
+    uint16_t *pui16Map;
+}
+tWSMatrix;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Generate the index map for a 2D LED surface
+//
+// This function fills in the (x, y) to LED index table for the requested
+// layout and records which directions have contiguous runs of LEDs, so that
+// the span functions below can walk the SPI array linearly.  For a plain
+// panel pass the panel size as the tile size.
+//
+// @input psMatrix is the matrix to initialize
+// @input pui16Map is storage for WS_MATRIX_MAP_SIZE(ui16Width, ui16Height)
+//        entries
+// @input ui16Width is the width of the surface in pixels
+// @input ui16Height is the height of the surface in pixels
+// @input ui16TileWidth is the width of one tile in pixels
+// @input ui16TileHeight is the height of one tile in pixels
+// @input ui32Flags is a logical OR of the WS_MATRIX_* layout flags
+//
+// @returns false if the tile size does not evenly divide the surface
+//
+//*****************************************************************************
+extern bool WSMatrixInit(tWSMatrix *psMatrix, uint16_t *pui16Map,
+                         uint16_t ui16Width, uint16_t ui16Height,
+                         uint16_t ui16TileWidth, uint16_t ui16TileHeight,
+                         uint32_t ui32Flags);
+
+//*****************************************************************************
+//
+// Look up the LED index of a pixel
+//
+// @input psMatrix is the matrix
+// @input ui16X is the column of the pixel
+// @input ui16Y is the row of the pixel
+//
+// @returns the index of the LED in the chain
+//
+//*****************************************************************************
+static inline uint16_t
+WSMatrixIndex(const tWSMatrix *psMatrix, uint16_t ui16X, uint16_t ui16Y)
+{
+    return(psMatrix->pui16Map[(uint32_t)ui16Y * psMatrix->ui16Width + ui16X]);
+}
+
+//*****************************************************************************
+//
+// Set the color of a single pixel
+//
+// @input psMatrix is the matrix
+// @input pui8SPILEDs is the entire SPI output data array
+// @input ui16X is the column of the pixel
+// @input ui16Y is the row of the pixel
+// @input ui8Green is the green value to be displayed on that pixel
+// @input ui8Red is the red value to be displayed on that pixel
+// @input ui8Blue is the blue value to be displayed on that pixel
+//
+//*****************************************************************************
+static inline void
+WSMatrixSetPixel(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs,
+                 uint16_t ui16X, uint16_t ui16Y, uint8_t ui8Green,
+                 uint8_t ui8Red, uint8_t ui8Blue)
+{
+    WSSetLEDColors(pui8SPILEDs, WSMatrixIndex(psMatrix, ui16X, ui16Y),
+                   ui8Green, ui8Red, ui8Blue);
+}
+
+//*****************************************************************************
+//
+// Fill part of a row with a single color
+//
+// The color is encoded once and then copied into each contiguous run of LEDs
+// the row covers.  Pixels outside of the surface are clipped.
+//
+// @input psMatrix is the matrix
+// @input pui8SPILEDs is the entire SPI output data array
+// @input ui16X is the first column to fill
+// @input ui16Y is the row to fill
+// @input ui16Len is the number of pixels to fill
+// @input ui8Green, ui8Red, ui8Blue is the fill color
+//
+//*****************************************************************************
+extern void WSMatrixFillRow(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs,
+                            uint16_t ui16X, uint16_t ui16Y, uint16_t ui16Len,
+                            uint8_t ui8Green, uint8_t ui8Red, uint8_t ui8Blue);
+
+//*****************************************************************************
+//
+// Fill a rectangle with a single color
+//
+// The rectangle is walked along whichever direction has the longest runs of
+// consecutive LEDs, so that column wired panels are filled a column at a
+// time.  Pixels outside of the surface are clipped.
+//
+// @input psMatrix is the matrix
+// @input pui8SPILEDs is the entire SPI output data array
+// @input ui16X is the left column of the rectangle
+// @input ui16Y is the top row of the rectangle
+// @input ui16W is the width of the rectangle
+// @input ui16H is the height of the rectangle
+// @input ui8Green, ui8Red, ui8Blue is the fill color
+//
+//*****************************************************************************
+extern void WSMatrixFillRect(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs,
+                             uint16_t ui16X, uint16_t ui16Y, uint16_t ui16W,
+                             uint16_t ui16H, uint8_t ui8Green, uint8_t ui8Red,
+                             uint8_t ui8Blue);
+
+//*****************************************************************************
+//
+// Copy a block of GRB pixels onto the surface
+//
+// The source is a row-major array of ui16W * ui16H GRB triplets.  Each run of
+// consecutive LEDs is encoded straight into the SPI array, walking forwards or
+// backwards to follow serpentine rows.  Pixels outside of the surface are
+// clipped.
+//
+// @input psMatrix is the matrix
+// @input pui8SPILEDs is the entire SPI output data array
+// @input ui16X is the left column of the destination
+// @input ui16Y is the top row of the destination
+// @input pui8Src is the source pixel array
+// @input ui16W is the width of the source in pixels
+// @input ui16H is the height of the source in pixels
+//
+//*****************************************************************************
+extern void WSMatrixBlit(const tWSMatrix *psMatrix, uint8_t *pui8SPILEDs,
+                         uint16_t ui16X, uint16_t ui16Y,
+                         const uint8_t pui8Src[][3], uint16_t ui16W,
+                         uint16_t ui16H);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_MATRIX_H__
@@ -0,0 +1,330 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_noise.h"
+
+//*****************************************************************************
+//
+// Perlin's permutation, used to hash lattice points to gradients
+//
+//*****************************************************************************
+static const uint8_t g_pui8NoisePerm[256] =
+{
+    0x97, 0xA0, 0x89, 0x5B, 0x5A, 0x0F, 0x83, 0x0D, 0xC9, 0x5F, 0x60, 0x35,
+    0xC2, 0xE9, 0x07, 0xE1, 0x8C, 0x24, 0x67, 0x1E, 0x45, 0x8E, 0x08, 0x63,
+    0x25, 0xF0, 0x15, 0x0A, 0x17, 0xBE, 0x06, 0x94, 0xF7, 0x78, 0xEA, 0x4B,
+    0x00, 0x1A, 0xC5, 0x3E, 0x5E, 0xFC, 0xDB, 0xCB, 0x75, 0x23, 0x0B, 0x20,
+    0x39, 0xB1, 0x21, 0x58, 0xED, 0x95, 0x38, 0x57, 0xAE, 0x14, 0x7D, 0x88,
+    0xAB, 0xA8, 0x44, 0xAF, 0x4A, 0xA5, 0x47, 0x86, 0x8B, 0x30, 0x1B, 0xA6,
+    0x4D, 0x92, 0x9E, 0xE7, 0x53, 0x6F, 0xE5, 0x7A, 0x3C, 0xD3, 0x85, 0xE6,
+    0xDC, 0x69, 0x5C, 0x29, 0x37, 0x2E, 0xF5, 0x28, 0xF4, 0x66, 0x8F, 0x36,
+    0x41, 0x19, 0x3F, 0xA1, 0x01, 0xD8, 0x50, 0x49, 0xD1, 0x4C, 0x84, 0xBB,
+    0xD0, 0x59, 0x12, 0xA9, 0xC8, 0xC4, 0x87, 0x82, 0x74, 0xBC, 0x9F, 0x56,
+    0xA4, 0x64, 0x6D, 0xC6, 0xAD, 0xBA, 0x03, 0x40, 0x34, 0xD9, 0xE2, 0xFA,
+    0x7C, 0x7B, 0x05, 0xCA, 0x26, 0x93, 0x76, 0x7E, 0xFF, 0x52, 0x55, 0xD4,
+    0xCF, 0xCE, 0x3B, 0xE3, 0x2F, 0x10, 0x3A, 0x11, 0xB6, 0xBD, 0x1C, 0x2A,
+    0xDF, 0xB7, 0xAA, 0xD5, 0x77, 0xF8, 0x98, 0x02, 0x2C, 0x9A, 0xA3, 0x46,
+    0xDD, 0x99, 0x65, 0x9B, 0xA7, 0x2B, 0xAC, 0x09, 0x81, 0x16, 0x27, 0xFD,
+    0x13, 0x62, 0x6C, 0x6E, 0x4F, 0x71, 0xE0, 0xE8, 0xB2, 0xB9, 0x70, 0x68,
+    0xDA, 0xF6, 0x61, 0xE4, 0xFB, 0x22, 0xF2, 0xC1, 0xEE, 0xD2, 0x90, 0x0C,
+    0xBF, 0xB3, 0xA2, 0xF1, 0x51, 0x33, 0x91, 0xEB, 0xF9, 0x0E, 0xEF, 0x6B,
+    0x31, 0xC0, 0xD6, 0x1F, 0xB5, 0xC7, 0x6A, 0x9D, 0xB8, 0x54, 0xCC, 0xB0,
+    0x73, 0x79, 0x32, 0x2D, 0x7F, 0x04, 0x96, 0xFE, 0x8A, 0xEC, 0xCD, 0x5D,
+    0xDE, 0x72, 0x43, 0x1D, 0x18, 0x48, 0xF3, 0x8D, 0x80, 0xC3, 0x4E, 0x42,
+    0xD7, 0x3D, 0x9C, 0xB4
+};
+
+//*****************************************************************************
+//
+// Quintic fade curve, 256 * (6t^5 - 15t^4 + 10t^3) for t = i / 256
+//
+//*****************************************************************************
+static const uint8_t g_pui8NoiseFade[256] =
+{
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x02,
+    0x02, 0x02, 0x02, 0x03, 0x03, 0x03, 0x03, 0x04, 0x04, 0x04, 0x05, 0x05,
+    0x06, 0x06, 0x07, 0x07, 0x08, 0x08, 0x09, 0x09, 0x0A, 0x0A, 0x0B, 0x0C,
+    0x0C, 0x0D, 0x0E, 0x0F, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x16, 0x17, 0x18, 0x19, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22,
+    0x24, 0x25, 0x26, 0x27, 0x29, 0x2A, 0x2B, 0x2D, 0x2E, 0x2F, 0x31, 0x32,
+    0x34, 0x35, 0x37, 0x38, 0x3A, 0x3B, 0x3D, 0x3E, 0x40, 0x42, 0x43, 0x45,
+    0x46, 0x48, 0x4A, 0x4B, 0x4D, 0x4F, 0x51, 0x52, 0x54, 0x56, 0x58, 0x59,
+    0x5B, 0x5D, 0x5F, 0x60, 0x62, 0x64, 0x66, 0x68, 0x6A, 0x6B, 0x6D, 0x6F,
+    0x71, 0x73, 0x75, 0x77, 0x79, 0x7A, 0x7C, 0x7E, 0x80, 0x82, 0x84, 0x86,
+    0x87, 0x89, 0x8B, 0x8D, 0x8F, 0x91, 0x93, 0x95, 0x96, 0x98, 0x9A, 0x9C,
+    0x9E, 0xA0, 0xA1, 0xA3, 0xA5, 0xA7, 0xA8, 0xAA, 0xAC, 0xAE, 0xAF, 0xB1,
+    0xB3, 0xB5, 0xB6, 0xB8, 0xBA, 0xBB, 0xBD, 0xBE, 0xC0, 0xC2, 0xC3, 0xC5,
+    0xC6, 0xC8, 0xC9, 0xCB, 0xCC, 0xCE, 0xCF, 0xD1, 0xD2, 0xD3, 0xD5, 0xD6,
+    0xD7, 0xD9, 0xDA, 0xDB, 0xDC, 0xDE, 0xDF, 0xE0, 0xE1, 0xE2, 0xE3, 0xE4,
+    0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF, 0xF0,
+    0xF1, 0xF1, 0xF2, 0xF3, 0xF4, 0xF4, 0xF5, 0xF6, 0xF6, 0xF7, 0xF7, 0xF8,
+    0xF8, 0xF9, 0xF9, 0xFA, 0xFA, 0xFB, 0xFB, 0xFC, 0xFC, 0xFC, 0xFD, 0xFD,
+    0xFD, 0xFD, 0xFE, 0xFE, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF
+};
+
+//*****************************************************************************
+//
+// Gradients with 64 as 1.0: slopes of 1/8 to 1 either way in 1D, the axes
+// and diagonals in 2D, and the twelve cube edges (four repeated) in 3D.
+//
+//*****************************************************************************
+static const int8_t g_pi8NoiseGrad1[16] =
+{
+    8, 16, 24, 32, 40, 48, 56, 64, -8, -16, -24, -32, -40, -48, -56, -64
+};
+
+static const int8_t g_pi8NoiseGrad2[8][2] =
+{
+    { 64, 0 }, { -64, 0 }, { 0, 64 }, { 0, -64 },
+    { 45, 45 }, { -45, 45 }, { 45, -45 }, { -45, -45 }
+};
+
+static const int8_t g_pi8NoiseGrad3[16][3] =
+{
+    { 64, 64, 0 }, { -64, 64, 0 }, { 64, -64, 0 }, { -64, -64, 0 },
+    { 64, 0, 64 }, { -64, 0, 64 }, { 64, 0, -64 }, { -64, 0, -64 },
+    { 0, 64, 64 }, { 0, -64, 64 }, { 0, 64, -64 }, { 0, -64, -64 },
+    { 64, 64, 0 }, { -64, 64, 0 }, { 0, -64, 64 }, { 0, -64, -64 }
+};
+
+//*****************************************************************************
+//
+// Scale from the interpolated noise, where 1.0 is 1 << 14, to output steps
+// away from 128, again with 1.0 as 1 << 14.  The 1D and 2D noise peak at 0.5
+// and about 0.71, so those gains just reach 0 and 255.  3D noise rarely gets
+// near its peak of 1.0, so it is scaled up a little and clamped.
+//
+//*****************************************************************************
+static const uint16_t g_pui16NoiseGain[3] = { 254, 180, 140 };
+
+//*****************************************************************************
+//
+// Fold the corners of x cell ui8X into the lines for the near and far x
+// edges.  The y and z corners are weighted by the row's fade weights, so
+// each edge becomes sum(weight * gradient . offset), which is linear in the
+// offset from the edge in x.
+//
+//*****************************************************************************
+static void
+noiseCell(tWSNoiseRow *psRow, uint8_t ui8X)
+{
+    const int8_t *pi8Grad;
+    int32_t pi32Slope[2];
+    int32_t pi32Const[2];
+    int32_t i32WY;
+    int32_t i32WZ;
+    int32_t i32W;
+    int32_t i32DY;
+    int32_t i32DZ;
+    int32_t i32Dot;
+    uint32_t ui32Corners;
+    uint32_t ui32C;
+    uint32_t ui32Side;
+    uint8_t ui8Hash;
+
+    pi32Slope[0] = pi32Slope[1] = 0;
+    pi32Const[0] = pi32Const[1] = 0;
+    ui32Corners = 1 << (psRow->ui8Dims - 1);
+
+    for(ui32C = 0; ui32C < ui32Corners; ui32C++)
+    {
+        //
+        // Weight and offset of this y, z corner
+        //
+        i32WY = g_pui8NoiseFade[psRow->ui8DY];
+        i32DY = psRow->ui8DY;
+        if(!(ui32C & 1))
+        {
+            i32WY = 256 - i32WY;
+        }
+        else
+        {
+            i32DY -= 256;
+        }
+        i32WZ = g_pui8NoiseFade[psRow->ui8DZ];
+        i32DZ = psRow->ui8DZ;
+        if(!(ui32C & 2))
+        {
+            i32WZ = 256 - i32WZ;
+        }
+        else
+        {
+            i32DZ -= 256;
+        }
+
+        for(ui32Side = 0; ui32Side < 2; ui32Side++)
+        {
+            ui8Hash = g_pui8NoisePerm[(uint8_t)(ui8X + ui32Side)];
+
+            if(psRow->ui8Dims == 1)
+            {
+                pi32Slope[ui32Side] += g_pi8NoiseGrad1[ui8Hash & 15] * 256;
+                pi32Const[ui32Side] -= ui32Side *
+                                       g_pi8NoiseGrad1[ui8Hash & 15] * 256;
+                continue;
+            }
+
+            ui8Hash = g_pui8NoisePerm[(uint8_t)(ui8Hash + psRow->ui8Y +
+                                                (ui32C & 1))];
+            if(psRow->ui8Dims == 2)
+            {
+                i32W = i32WY;
+                pi8Grad = g_pi8NoiseGrad2[ui8Hash & 7];
+                i32Dot = pi8Grad[1] * i32DY;
+            }
+            else
+            {
+                i32W = (i32WY * i32WZ) >> 8;
+                ui8Hash = g_pui8NoisePerm[(uint8_t)(ui8Hash + psRow->ui8Z +
+                                                    (ui32C >> 1))];
+                pi8Grad = g_pi8NoiseGrad3[ui8Hash & 15];
+                i32Dot = (pi8Grad[1] * i32DY) + (pi8Grad[2] * i32DZ);
+            }
+            i32Dot -= ui32Side * pi8Grad[0] * 256;
+
+            pi32Slope[ui32Side] += i32W * pi8Grad[0];
+            pi32Const[ui32Side] += (i32W * i32Dot) >> 8;
+        }
+    }
+
+    psRow->i32ASlope = pi32Slope[0];
+    psRow->i32AConst = pi32Const[0];
+    psRow->i32BSlope = pi32Slope[1];
+    psRow->i32BConst = pi32Const[1];
+    psRow->ui8Cell = ui8X;
+    psRow->bCell = true;
+}
+
+//*****************************************************************************
+//
+// Produce the next sample of a row and step past it.
+//
+//*****************************************************************************
+static inline uint8_t
+noiseNext(tWSNoiseRow *psRow)
+{
+    int32_t i32A;
+    int32_t i32B;
+    int32_t i32N;
+    uint32_t ui32DX;
+    uint8_t ui8X;
+
+    ui8X = psRow->ui32X >> 16;
+    ui32DX = (psRow->ui32X >> 8) & 0xFF;
+    psRow->ui32X += psRow->ui32Step;
+
+    if(!psRow->bCell || (ui8X != psRow->ui8Cell))
+    {
+        noiseCell(psRow, ui8X);
+    }
+
+    i32A = psRow->i32AConst + ((psRow->i32ASlope * (int32_t)ui32DX) >> 8);
+    i32B = psRow->i32BConst + ((psRow->i32BSlope * (int32_t)ui32DX) >> 8);
+    i32N = i32A + (((i32B - i32A) * g_pui8NoiseFade[ui32DX]) >> 8);
+
+    i32N = 128 + ((i32N * g_pui16NoiseGain[psRow->ui8Dims - 1]) >> 14);
+    if(i32N < 0)
+    {
+        return(0);
+    }
+    if(i32N > 255)
+    {
+        return(255);
+    }
+    return(i32N);
+}
+
+void
+WSNoiseRowInit(tWSNoiseRow *psRow, uint8_t ui8Dims, uint32_t ui32X,
+               uint32_t ui32Y, uint32_t ui32Z, uint32_t ui32Step)
+{
+    if(ui8Dims < 1)
+    {
+        ui8Dims = 1;
+    }
+    if(ui8Dims > 3)
+    {
+        ui8Dims = 3;
+    }
+
+    psRow->ui32X = ui32X;
+    psRow->ui32Step = ui32Step;
+    psRow->ui8Y = ui32Y >> 16;
+    psRow->ui8DY = ui32Y >> 8;
+    psRow->ui8Z = ui32Z >> 16;
+    psRow->ui8DZ = ui32Z >> 8;
+    psRow->ui8Dims = ui8Dims;
+    psRow->bCell = false;
+}
+
+void
+WSNoiseRowFill(tWSNoiseRow *psRow, uint8_t *pui8Dst, uint16_t ui16Count,
+               uint8_t ui8Stride)
+{
+    while(ui16Count--)
+    {
+        *pui8Dst = noiseNext(psRow);
+        pui8Dst += ui8Stride;
+    }
+}
+
+void
+WSNoiseRowPalette(tWSNoiseRow *psRow, uint8_t pui8Colors[][3],
+                  uint16_t ui16Count, const uint8_t pui8Palette[16][3])
+{
+    const uint8_t *pui8Lo;
+    const uint8_t *pui8Hi;
+    uint32_t ui32Frac;
+    uint16_t ui16I;
+    uint8_t ui8N;
+    int i;
+
+    for(ui16I = 0; ui16I < ui16Count; ui16I++)
+    {
+        //
+        // The top four bits pick the entry and the bottom four blend towards
+        // the next one.  The last entry isn't blended past.
+        //
+        ui8N = noiseNext(psRow);
+        pui8Lo = pui8Palette[ui8N >> 4];
+        pui8Hi = pui8Palette[(ui8N >> 4) + ((ui8N < 0xF0) ? 1 : 0)];
+        ui32Frac = ui8N & 0x0F;
+
+        for(i = 0; i < 3; i++)
+        {
+            pui8Colors[ui16I][i] = pui8Lo[i] +
+                                   ((((int32_t)pui8Hi[i] - pui8Lo[i]) *
+                                     (int32_t)ui32Frac) >> 4);
+        }
+    }
+}
+
+uint8_t
+WSNoise1D(uint32_t ui32X)
+{
+    tWSNoiseRow sRow;
+
+    WSNoiseRowInit(&sRow, 1, ui32X, 0, 0, 0);
+    return(noiseNext(&sRow));
+}
+
+uint8_t
+WSNoise2D(uint32_t ui32X, uint32_t ui32Y)
+{
+    tWSNoiseRow sRow;
+
+    WSNoiseRowInit(&sRow, 2, ui32X, ui32Y, 0, 0);
+    return(noiseNext(&sRow));
+}
+
+uint8_t
+WSNoise3D(uint32_t ui32X, uint32_t ui32Y, uint32_t ui32Z)
+{
+    tWSNoiseRow sRow;
+
+    WSNoiseRowInit(&sRow, 3, ui32X, ui32Y, ui32Z, 0);
+    return(noiseNext(&sRow));
+}
@@ -0,0 +1,159 @@
+
+
+#ifndef __WS2812_NOISE_H__
+#define __WS2812_NOISE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Fixed-point gradient noise for fire, water and cloud effects.
+//
+// This is Perlin's gradient noise in integer arithmetic.  Coordinates are
+// Q16.16 lattice cells, the lattice repeats every 256 cells, gradients and
+// the quintic fade curve come from tables, and the result is 0 to 255.
+//
+// Noise is produced a row at a time: the samples of a strip, or of one row
+// of a matrix, step along x at a fixed y and z (the third coordinate is
+// usually time).  While the row stays inside a lattice cell the corner
+// gradients and the y and z interpolation don't change, so they are folded
+// into two straight lines in x once per cell.  Each sample then only costs
+// two multiplies, a fade lookup and a lerp.
+//
+//*****************************************************************************
+
+//
+// One lattice cell in Q16.16
+//
+#define WS_NOISE_ONE            0x10000
+
+//*****************************************************************************
+//
+// A row of noise samples in progress
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Position of the next sample and the step between samples, in Q16.16
+    //
+    uint32_t ui32X;
+    uint32_t ui32Step;
+
+    //
+    // The fixed y and z of the row: lattice cell, position within the cell
+    // in 256ths, and number of dimensions in use (1 to 3)
+    //
+    uint8_t ui8Y;
+    uint8_t ui8Z;
+    uint8_t ui8DY;
+    uint8_t ui8DZ;
+    uint8_t ui8Dims;
+
+    //
+    // The x cell the lines below are for, and whether they have been set
+    //
+    uint8_t ui8Cell;
+    bool bCell;
+
+    //
+    // The noise interpolated to the near (A) and far (B) x edges of the
+    // cell, each a line in x: slope * dx + constant
+    //
+    int32_t i32ASlope;
+    int32_t i32AConst;
+    int32_t i32BSlope;
+    int32_t i32BConst;
+}
+tWSNoiseRow;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Start a row of noise samples
+//
+// @input psRow is the row to start
+// @input ui8Dims is the number of dimensions, 1 to 3; y and z are ignored
+//        past it
+// @input ui32X is x of the first sample, in Q16.16
+// @input ui32Y is y of the row, in Q16.16
+// @input ui32Z is z of the row, in Q16.16
+// @input ui32Step is the distance in x between samples, in Q16.16
+//
+//*****************************************************************************
+extern void WSNoiseRowInit(tWSNoiseRow *psRow, uint8_t ui8Dims,
+                           uint32_t ui32X, uint32_t ui32Y, uint32_t ui32Z,
+                           uint32_t ui32Step);
+
+//*****************************************************************************
+//
+// Write the next samples of a row to a byte array
+//
+// With a stride of 3 this fills one channel of a GRB framebuffer.
+//
+// @input psRow is the row
+// @input pui8Dst is where the first sample goes
+// @input ui16Count is the number of samples
+// @input ui8Stride is the distance in bytes between samples in pui8Dst
+//
+//*****************************************************************************
+extern void WSNoiseRowFill(tWSNoiseRow *psRow, uint8_t *pui8Dst,
+                           uint16_t ui16Count, uint8_t ui8Stride);
+
+//*****************************************************************************
+//
+// Write the next samples of a row to a framebuffer through a palette
+//
+// The palette has 16 GRB entries spread evenly over the noise range, and
+// samples between two entries are blended, so a black - red - yellow -
+// white palette gives fire.
+//
+// @input psRow is the row
+// @input pui8Colors is where the first sample goes in the GRB framebuffer
+// @input ui16Count is the number of samples
+// @input pui8Palette is the 16 entry GRB palette
+//
+//*****************************************************************************
+extern void WSNoiseRowPalette(tWSNoiseRow *psRow, uint8_t pui8Colors[][3],
+                              uint16_t ui16Count,
+                              const uint8_t pui8Palette[16][3]);
+
+//*****************************************************************************
+//
+// Evaluate noise at a single point
+//
+// This sets up a cell for one sample, so use a row for anything more.
+//
+// @input ui32X, ui32Y and ui32Z are the point, in Q16.16
+//
+// @returns the noise, 0 to 255
+//
+//*****************************************************************************
+extern uint8_t WSNoise1D(uint32_t ui32X);
+extern uint8_t WSNoise2D(uint32_t ui32X, uint32_t ui32Y);
+extern uint8_t WSNoise3D(uint32_t ui32X, uint32_t ui32Y, uint32_t ui32Z);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_NOISE_H__
@@ -0,0 +1,100 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_parallel.h"
+
+void
+WSTranspose8(const uint8_t *pui8In, uint8_t *pui8Out, uint32_t ui32Stride)
+{
+    uint32_t ui32X;
+    uint32_t ui32Y;
+    uint32_t ui32T;
+
+    //
+    // Load the strips in reverse so that strip s ends up on port pin s.  This
+    // is the classic shift-and-mask transpose: swap 1x1, then 2x2, then 4x4
+    // bit blocks.
+    //
+    ui32X = ((uint32_t)pui8In[7] << 24) | ((uint32_t)pui8In[6] << 16) |
+            ((uint32_t)pui8In[5] << 8) | pui8In[4];
+    ui32Y = ((uint32_t)pui8In[3] << 24) | ((uint32_t)pui8In[2] << 16) |
+            ((uint32_t)pui8In[1] << 8) | pui8In[0];
+
+    ui32T = (ui32X ^ (ui32X >> 7)) & 0x00AA00AA;
+    ui32X = ui32X ^ ui32T ^ (ui32T << 7);
+    ui32T = (ui32Y ^ (ui32Y >> 7)) & 0x00AA00AA;
+    ui32Y = ui32Y ^ ui32T ^ (ui32T << 7);
+
+    ui32T = (ui32X ^ (ui32X >> 14)) & 0x0000CCCC;
+    ui32X = ui32X ^ ui32T ^ (ui32T << 14);
+    ui32T = (ui32Y ^ (ui32Y >> 14)) & 0x0000CCCC;
+    ui32Y = ui32Y ^ ui32T ^ (ui32T << 14);
+
+    ui32T = (ui32X & 0xF0F0F0F0) | ((ui32Y >> 4) & 0x0F0F0F0F);
+    ui32Y = ((ui32X << 4) & 0xF0F0F0F0) | (ui32Y & 0x0F0F0F0F);
+    ui32X = ui32T;
+
+    pui8Out[0] = ui32X >> 24;
+    pui8Out[ui32Stride] = ui32X >> 16;
+    pui8Out[2 * ui32Stride] = ui32X >> 8;
+    pui8Out[3 * ui32Stride] = ui32X;
+    pui8Out[4 * ui32Stride] = ui32Y >> 24;
+    pui8Out[5 * ui32Stride] = ui32Y >> 16;
+    pui8Out[6 * ui32Stride] = ui32Y >> 8;
+    pui8Out[7 * ui32Stride] = ui32Y;
+}
+
+void
+WSParallelArrayInit(uint8_t *pui8PortData, uint16_t ui16NumLED,
+                    uint8_t ui8PinMask)
+{
+    uint32_t ui32I;
+    uint32_t ui32Bits;
+
+    ui32Bits = (uint32_t)ui16NumLED * 8 * 3;
+
+    for(ui32I = 0; ui32I < ui32Bits; ui32I++)
+    {
+        pui8PortData[0] = ui8PinMask;
+        pui8PortData[1] = 0;
+        pui8PortData[2] = 0;
+        pui8PortData += WS2812_PAR_SLOT_PER_BIT;
+    }
+}
+
+void
+WSParallelEncode(uint8_t *pui8PortData,
+                 const uint8_t (* const ppui8Colors[])[3],
+                 uint16_t ui16First, uint16_t ui16Count)
+{
+    uint8_t pui8In[WS2812_PAR_STRIPS];
+    uint8_t *pui8Out;
+    uint32_t ui32LED;
+    uint32_t ui32Clr;
+    uint32_t ui32S;
+
+    //
+    // Start at slot 1 of the first bit of the first LED
+    //
+    pui8Out = pui8PortData + ((uint32_t)ui16First * WS2812_PAR_LED_SIZE) + 1;
+
+    for(ui32LED = ui16First; ui32LED < (uint32_t)ui16First + ui16Count;
+        ui32LED++)
+    {
+        for(ui32Clr = 0; ui32Clr < 3; ui32Clr++)
+        {
+            //
+            // Gather this color byte from each strip, then spread its bits
+            // across the eight data slots for the color.
+            //
+            for(ui32S = 0; ui32S < WS2812_PAR_STRIPS; ui32S++)
+            {
+                pui8In[ui32S] = ppui8Colors[ui32S] ?
+                                ppui8Colors[ui32S][ui32LED][ui32Clr] : 0;
+            }
+
+            WSTranspose8(pui8In, pui8Out, WS2812_PAR_SLOT_PER_BIT);
+            pui8Out += 8 * WS2812_PAR_SLOT_PER_BIT;
+        }
+    }
+}
@@ -0,0 +1,98 @@
+
+
+#ifndef __WS2812_PARALLEL_H__
+#define __WS2812_PARALLEL_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// In parallel mode each GPIO port pin drives its own strip, and every WS bit
+// is sent as three port writes (slots):
+//
+//    slot 0: all active pins high
+//    slot 1: pins whose bit is a 1 stay high, the rest go low
+//    slot 2: all pins low
+//
+// Slots 0 and 2 never change, so they are written once by
+// WSParallelArrayInit() and the encoder only fills in slot 1.
+//
+//*****************************************************************************
+#define WS2812_PAR_STRIPS       8
+#define WS2812_PAR_SLOT_PER_BIT 3
+#define WS2812_PAR_LED_SIZE     (WS2812_PAR_SLOT_PER_BIT * 8 * 3)
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Transpose an 8x8 bit matrix
+//
+// This function takes one byte from each of eight strips and produces the
+// eight port bytes for those bits, most significant bit first.  Bit s of
+// output byte b is bit (7 - b) of pui8In[s].  Output bytes are written
+// ui32Stride bytes apart so they can land directly in slot 1 of each WS bit.
+//
+// @input pui8In is the eight input bytes, one per strip
+// @input pui8Out is where the first output byte is written
+// @input ui32Stride is the distance in bytes between output bytes
+//
+//*****************************************************************************
+extern void WSTranspose8(const uint8_t *pui8In, uint8_t *pui8Out,
+                         uint32_t ui32Stride);
+
+//*****************************************************************************
+//
+// Initialize a parallel port out array to all LEDs off
+//
+// This function writes the fixed high and low slots for every WS bit and sets
+// all data slots to 0.
+//
+// @input pui8PortData is the array containing the port data to send
+// @input ui16NumLED is the number of LEDs per strip the array holds
+// @input ui8PinMask is the set of port pins that have a strip attached
+//
+//*****************************************************************************
+extern void WSParallelArrayInit(uint8_t *pui8PortData, uint16_t ui16NumLED,
+                                uint8_t ui8PinMask);
+
+//*****************************************************************************
+//
+// Encode eight GRB framebuffers into a parallel port out array
+//
+// Strip s is driven by port pin s.  A NULL framebuffer leaves that pin low
+// for the encoded range.
+//
+// @input pui8PortData is the entire port output data array
+// @input ppui8Colors is an array of eight GRB framebuffers
+// @input ui16First is the first LED to encode
+// @input ui16Count is the number of LEDs to encode
+//
+//*****************************************************************************
+extern void WSParallelEncode(uint8_t *pui8PortData,
+                             const uint8_t (* const ppui8Colors[])[3],
+                             uint16_t ui16First, uint16_t ui16Count);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_PARALLEL_H__
@@ -0,0 +1,276 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "WS2812_drv.h"
+#include "WS2812_simd.h"
+#include "WS2812_particle.h"
+
+//*****************************************************************************
+//
+// Grow the dirty span to cover the given LED.
+//
+//*****************************************************************************
+static inline void
+particleMarkDirty(tWSParticlePool *psPool, uint16_t ui16LED)
+{
+    if(ui16LED < psPool->ui16DirtyFirst)
+    {
+        psPool->ui16DirtyFirst = ui16LED;
+    }
+    if(ui16LED > psPool->ui16DirtyLast)
+    {
+        psPool->ui16DirtyLast = ui16LED;
+    }
+}
+
+//*****************************************************************************
+//
+// Whether a Q16.16 position lies on the strip.
+//
+//*****************************************************************************
+static inline bool
+particleOnStrip(const tWSParticlePool *psPool, int32_t i32Pos)
+{
+    return((i32Pos >= 0) && ((i32Pos >> 16) < psPool->ui16NumLED));
+}
+
+//*****************************************************************************
+//
+// Saturating add of a packed GRB word into one LED.
+//
+//*****************************************************************************
+static inline void
+particleAddLED(uint8_t *pui8LED, uint32_t ui32GRB)
+{
+    uint32_t ui32Val;
+
+    ui32Val = pui8LED[0] | ((uint32_t)pui8LED[1] << 8) |
+              ((uint32_t)pui8LED[2] << 16);
+    ui32Val = WSQAdd8x4(ui32Val, ui32GRB);
+    pui8LED[0] = ui32Val;
+    pui8LED[1] = ui32Val >> 8;
+    pui8LED[2] = ui32Val >> 16;
+}
+
+void
+WSParticleInit(tWSParticlePool *psPool, tWSParticle *psParticles,
+               uint16_t ui16Capacity, uint16_t ui16NumLED)
+{
+    uint16_t ui16I;
+
+    if(ui16Capacity >= WS_PARTICLE_NONE)
+    {
+        ui16Capacity = WS_PARTICLE_NONE - 1;
+    }
+
+    psPool->psParticles = psParticles;
+    psPool->ui16Capacity = ui16Capacity;
+    psPool->ui16NumLED = ui16NumLED;
+    psPool->ui16Live = WS_PARTICLE_NONE;
+    psPool->ui16NumLive = 0;
+    psPool->i32Gravity = 0;
+    psPool->ui8Drag = 0;
+    psPool->ui16DirtyFirst = WS_PARTICLE_NONE;
+    psPool->ui16DirtyLast = 0;
+
+    //
+    // Chain every particle onto the free list
+    //
+    for(ui16I = 0; ui16I < ui16Capacity; ui16I++)
+    {
+        psParticles[ui16I].ui16Next = ui16I + 1;
+    }
+    if(ui16Capacity)
+    {
+        psParticles[ui16Capacity - 1].ui16Next = WS_PARTICLE_NONE;
+    }
+    psPool->ui16Free = ui16Capacity ? 0 : WS_PARTICLE_NONE;
+}
+
+tWSParticle *
+WSParticleSpawn(tWSParticlePool *psPool, int32_t i32Pos, int32_t i32Vel,
+                const uint8_t *pui8Color, uint8_t ui8Life, uint8_t ui8Decay)
+{
+    tWSParticle *psPart;
+    uint16_t ui16Idx;
+
+    ui16Idx = psPool->ui16Free;
+    if((ui16Idx == WS_PARTICLE_NONE) || !particleOnStrip(psPool, i32Pos))
+    {
+        return(NULL);
+    }
+
+    psPart = &psPool->psParticles[ui16Idx];
+    psPool->ui16Free = psPart->ui16Next;
+
+    psPart->i32Pos = i32Pos;
+    psPart->i32Vel = i32Vel;
+    psPart->pui8Color[0] = pui8Color[0];
+    psPart->pui8Color[1] = pui8Color[1];
+    psPart->pui8Color[2] = pui8Color[2];
+    psPart->ui8Life = ui8Life;
+    psPart->ui8Decay = ui8Decay;
+    psPart->ui16Drawn = WS_PARTICLE_NONE;
+
+    psPart->ui16Next = psPool->ui16Live;
+    psPool->ui16Live = ui16Idx;
+    psPool->ui16NumLive++;
+
+    return(psPart);
+}
+
+uint16_t
+WSParticleBurst(tWSParticlePool *psPool, int32_t i32Pos, uint16_t ui16Count,
+                int32_t i32Speed, const uint8_t *pui8Color, uint8_t ui8Life,
+                uint8_t ui8Decay)
+{
+    int32_t i32Vel;
+    int32_t i32Step;
+    uint16_t ui16I;
+
+    if((ui16Count == 0) || !particleOnStrip(psPool, i32Pos))
+    {
+        return(0);
+    }
+
+    i32Vel = (ui16Count > 1) ? -i32Speed : 0;
+    i32Step = (ui16Count > 1) ? ((2 * i32Speed) / (ui16Count - 1)) : 0;
+
+    for(ui16I = 0; ui16I < ui16Count; ui16I++)
+    {
+        if(!WSParticleSpawn(psPool, i32Pos, i32Vel, pui8Color, ui8Life,
+                            ui8Decay))
+        {
+            break;
+        }
+        i32Vel += i32Step;
+    }
+
+    return(ui16I);
+}
+
+void
+WSParticleUpdate(tWSParticlePool *psPool, uint8_t pui8Colors[][3])
+{
+    tWSParticle *psPart;
+    uint16_t *pui16Link;
+    uint16_t ui16Idx;
+    int32_t i32Vel;
+    bool bDead;
+
+    psPool->ui16DirtyFirst = WS_PARTICLE_NONE;
+    psPool->ui16DirtyLast = 0;
+
+    pui16Link = &psPool->ui16Live;
+    while((ui16Idx = *pui16Link) != WS_PARTICLE_NONE)
+    {
+        psPart = &psPool->psParticles[ui16Idx];
+
+        //
+        // Erase what was drawn last frame.  Any other particle sharing these
+        // LEDs is redrawn by the next render anyway.
+        //
+        if(psPart->ui16Drawn != WS_PARTICLE_NONE)
+        {
+            memset(pui8Colors[psPart->ui16Drawn], 0, 3);
+            particleMarkDirty(psPool, psPart->ui16Drawn);
+            if((psPart->ui16Drawn + 1) < psPool->ui16NumLED)
+            {
+                memset(pui8Colors[psPart->ui16Drawn + 1], 0, 3);
+                particleMarkDirty(psPool, psPart->ui16Drawn + 1);
+            }
+            psPart->ui16Drawn = WS_PARTICLE_NONE;
+        }
+
+        i32Vel = psPart->i32Vel + psPool->i32Gravity;
+        i32Vel -= (i32Vel * psPool->ui8Drag) / 256;
+        psPart->i32Vel = i32Vel;
+        psPart->i32Pos += i32Vel;
+
+        bDead = (!particleOnStrip(psPool, psPart->i32Pos) ||
+                 (psPart->ui8Life <= psPart->ui8Decay));
+        psPart->ui8Life -= psPart->ui8Decay;
+
+        if(bDead)
+        {
+            //
+            // Unlink from the live list and push onto the free list
+            //
+            *pui16Link = psPart->ui16Next;
+            psPart->ui16Next = psPool->ui16Free;
+            psPool->ui16Free = ui16Idx;
+            psPool->ui16NumLive--;
+        }
+        else
+        {
+            pui16Link = &psPart->ui16Next;
+        }
+    }
+}
+
+void
+WSParticleRender(tWSParticlePool *psPool, uint8_t pui8Colors[][3])
+{
+    tWSParticle *psPart;
+    uint32_t ui32Color;
+    uint32_t ui32Frac;
+    uint32_t ui32Life;
+    uint16_t ui16Idx;
+    uint16_t ui16LED;
+
+    for(ui16Idx = psPool->ui16Live; ui16Idx != WS_PARTICLE_NONE;
+        ui16Idx = psPart->ui16Next)
+    {
+        psPart = &psPool->psParticles[ui16Idx];
+
+        ui16LED = psPart->i32Pos >> 16;
+        ui32Frac = (psPart->i32Pos >> 8) & 0xFF;
+        ui32Color = psPart->pui8Color[0] |
+                    ((uint32_t)psPart->pui8Color[1] << 8) |
+                    ((uint32_t)psPart->pui8Color[2] << 16);
+
+        //
+        // Map life 0-255 onto a 0-256 scale so a fresh particle is drawn at
+        // full brightness, then share it between the two nearest LEDs.
+        //
+        ui32Life = psPart->ui8Life + (psPart->ui8Life >> 7);
+
+        particleAddLED(pui8Colors[ui16LED],
+                       WSScale8x4(ui32Color,
+                                  (ui32Life * (256 - ui32Frac)) >> 8));
+        particleMarkDirty(psPool, ui16LED);
+
+        if((ui32Frac != 0) && ((ui16LED + 1) < psPool->ui16NumLED))
+        {
+            particleAddLED(pui8Colors[ui16LED + 1],
+                           WSScale8x4(ui32Color, (ui32Life * ui32Frac) >> 8));
+            particleMarkDirty(psPool, ui16LED + 1);
+        }
+
+        psPart->ui16Drawn = ui16LED;
+    }
+}
+
+void
+WSParticleEncodeDirty(const tWSParticlePool *psPool,
+                      const uint8_t pui8Colors[][3], uint8_t *pui8SPIOut)
+{
+    uint16_t ui16I;
+    uint8_t *pui8Out;
+
+    if(psPool->ui16DirtyFirst > psPool->ui16DirtyLast)
+    {
+        return;
+    }
+
+    pui8Out = pui8SPIOut + ((uint32_t)psPool->ui16DirtyFirst *
+                            WS2812_SPI_LED_SIZE);
+    for(ui16I = psPool->ui16DirtyFirst; ui16I <= psPool->ui16DirtyLast;
+        ui16I++)
+    {
+        WSGRBtoSPI(pui8Out, pui8Colors[ui16I][0], pui8Colors[ui16I][1],
+                   pui8Colors[ui16I][2]);
+        pui8Out += WS2812_SPI_LED_SIZE;
+    }
+}
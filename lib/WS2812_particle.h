@@ -0,0 +1,248 @@
+
+
+#ifndef __WS2812_PARTICLE_H__
+#define __WS2812_PARTICLE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Particle effect engine for sparks, comets and fireworks.
+//
+// Particles come from a fixed pool supplied by the caller and are handed out
+// and returned through a free list, so nothing is allocated at run time.
+// Positions and velocities are Q16.16 fixed-point LEDs, and each particle
+// fades by its own decay every update.  Particles are splatted additively
+// across the two LEDs nearest their position.
+//
+// The engine owns its framebuffer, which must start out black.  Rather than
+// clearing the whole strip every frame, each particle erases the LEDs it lit
+// last time, so updating and rendering cost is proportional to the number of
+// live particles, not the number of LEDs.  The run of LEDs touched is
+// reported so only that part of the SPI array needs encoding.
+//
+// Each frame:
+//
+//    WSParticleUpdate(&sPool, pui8Colors);
+//    ... spawn new particles
+//    WSParticleRender(&sPool, pui8Colors);
+//    WSParticleEncodeDirty(&sPool, pui8Colors, pui8SPIOut);
+//
+//*****************************************************************************
+
+//
+// Marks the end of a particle list, and a particle that isn't drawn
+//
+#define WS_PARTICLE_NONE        0xFFFF
+
+//
+// One LED in Q16.16
+//
+#define WS_PARTICLE_ONE         0x10000
+
+//*****************************************************************************
+//
+// A particle
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Position and velocity in Q16.16 LEDs, velocity per update
+    //
+    int32_t i32Pos;
+    int32_t i32Vel;
+
+    //
+    // Full brightness GRB color, current brightness, and the brightness lost
+    // every update
+    //
+    uint8_t pui8Color[3];
+    uint8_t ui8Life;
+    uint8_t ui8Decay;
+
+    //
+    // The first of the two LEDs lit last frame, and the next particle in
+    // whichever list this one is on
+    //
+    uint16_t ui16Drawn;
+    uint16_t ui16Next;
+}
+tWSParticle;
+
+//*****************************************************************************
+//
+// A particle pool
+//
+//*****************************************************************************
+typedef struct
+{
+    tWSParticle *psParticles;
+    uint16_t ui16Capacity;
+    uint16_t ui16NumLED;
+
+    //
+    // Heads of the free and live lists
+    //
+    uint16_t ui16Free;
+    uint16_t ui16Live;
+    uint16_t ui16NumLive;
+
+    //
+    // Added to every velocity each update (Q16.16), and the fraction of
+    // velocity lost each update out of 256
+    //
+    int32_t i32Gravity;
+    uint8_t ui8Drag;
+
+    //
+    // The run of LEDs changed by the last update and render
+    //
+    uint16_t ui16DirtyFirst;
+    uint16_t ui16DirtyLast;
+}
+tWSParticlePool;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Initialize a particle pool
+//
+// @input psPool is the pool to initialize
+// @input psParticles is storage for the particles
+// @input ui16Capacity is the number of particles psParticles can hold
+// @input ui16NumLED is the number of LEDs in the framebuffer
+//
+//*****************************************************************************
+extern void WSParticleInit(tWSParticlePool *psPool, tWSParticle *psParticles,
+                           uint16_t ui16Capacity, uint16_t ui16NumLED);
+
+//*****************************************************************************
+//
+// Set the forces applied to every particle
+//
+// @input psPool is the pool
+// @input i32Gravity is added to each velocity every update, in Q16.16 LEDs
+// @input ui8Drag is how much of each velocity is lost every update, out of
+//        256
+//
+//*****************************************************************************
+static inline void
+WSParticleForcesSet(tWSParticlePool *psPool, int32_t i32Gravity,
+                    uint8_t ui8Drag)
+{
+    psPool->i32Gravity = i32Gravity;
+    psPool->ui8Drag = ui8Drag;
+}
+
+//*****************************************************************************
+//
+// Get the number of live particles
+//
+//*****************************************************************************
+static inline uint16_t
+WSParticleLiveCount(const tWSParticlePool *psPool)
+{
+    return(psPool->ui16NumLive);
+}
+
+//*****************************************************************************
+//
+// Launch a particle
+//
+// @input psPool is the pool
+// @input i32Pos is the starting position in Q16.16 LEDs
+// @input i32Vel is the velocity in Q16.16 LEDs per update
+// @input pui8Color is the GRB color at full brightness
+// @input ui8Life is the starting brightness
+// @input ui8Decay is the brightness lost every update
+//
+// @returns the particle, or NULL if the pool is exhausted or i32Pos is off
+//          the strip
+//
+//*****************************************************************************
+extern tWSParticle *WSParticleSpawn(tWSParticlePool *psPool, int32_t i32Pos,
+                                    int32_t i32Vel, const uint8_t *pui8Color,
+                                    uint8_t ui8Life, uint8_t ui8Decay);
+
+//*****************************************************************************
+//
+// Launch a firework style burst of particles spread evenly between -i32Speed
+// and i32Speed
+//
+// @input psPool is the pool
+// @input i32Pos is the centre of the burst in Q16.16 LEDs
+// @input ui16Count is the number of particles
+// @input i32Speed is the fastest particle's speed in Q16.16 LEDs per update
+// @input pui8Color is the GRB color at full brightness
+// @input ui8Life is the starting brightness
+// @input ui8Decay is the brightness lost every update
+//
+// @returns the number of particles launched, which is less than ui16Count
+//          if the pool ran out, or 0 if i32Pos is off the strip
+//
+//*****************************************************************************
+extern uint16_t WSParticleBurst(tWSParticlePool *psPool, int32_t i32Pos,
+                                uint16_t ui16Count, int32_t i32Speed,
+                                const uint8_t *pui8Color, uint8_t ui8Life,
+                                uint8_t ui8Decay);
+
+//*****************************************************************************
+//
+// Erase the particles from the framebuffer and move them on one step
+//
+// Particles that have faded out or left the strip are returned to the pool.
+//
+// @input psPool is the pool
+// @input pui8Colors is the GRB framebuffer owned by the pool
+//
+//*****************************************************************************
+extern void WSParticleUpdate(tWSParticlePool *psPool, uint8_t pui8Colors[][3]);
+
+//*****************************************************************************
+//
+// Draw the live particles into the framebuffer
+//
+// @input psPool is the pool
+// @input pui8Colors is the GRB framebuffer owned by the pool
+//
+//*****************************************************************************
+extern void WSParticleRender(tWSParticlePool *psPool, uint8_t pui8Colors[][3]);
+
+//*****************************************************************************
+//
+// Encode the LEDs changed by the last update and render into the SPI array
+//
+// @input psPool is the pool
+// @input pui8Colors is the GRB framebuffer owned by the pool
+// @input pui8SPIOut is the entire SPI output data array
+//
+//*****************************************************************************
+extern void WSParticleEncodeDirty(const tWSParticlePool *psPool,
+                                  const uint8_t pui8Colors[][3],
+                                  uint8_t *pui8SPIOut);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_PARTICLE_H__
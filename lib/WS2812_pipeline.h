@@ -0,0 +1,264 @@
+
+
+#ifndef __WS2812_PIPELINE_H__
+#define __WS2812_PIPELINE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// A render pipeline reads each LED of a GRB framebuffer once, runs it through
+// a list of per-pixel stages, and encodes the result into the SPI array once.
+// While a pixel is in the pipeline its channels are held as 8.8 fixed point,
+// so stages like brightness and gamma keep the fraction they would otherwise
+// throw away, and WSStageDither() can turn it into temporal dithering.
+//
+// There are two ways to build a pipeline:
+//
+// 1) At compile time, with WS_PIPELINE_DEFINE().  The stages are inline
+//    functions, so the compiler fuses them into one loop body:
+//
+//        WS_PIPELINE_DEFINE(renderFrame,
+//                           WS_STAGE(WSStageGamma, g_pui16WSGamma22);
+//                           WS_STAGE(WSStageScale, &sPower.ui16Scale);
+//                           WS_STAGE(WSStageDither, &ui8Frame))
+//
+//        renderFrame(pui8Colors, pui8SPIOut, 0, NUM_LEDS);
+//
+// 2) At run time, with a table of tWSStage entries passed to
+//    WSPipelineRun().  This costs one indirect call per stage per pixel but
+//    lets the stage list change while running.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// A pipeline stage.  pui16Pix holds the G, R and B channels of LED ui16LED
+// in 8.8 fixed point (0x0000 - 0xFF00) and is modified in place.
+//
+//*****************************************************************************
+typedef void (*tWSStageFn)(const void *pvData, uint16_t *pui16Pix,
+                           uint16_t ui16LED);
+
+//
+// One entry of a run time stage table
+//
+typedef struct
+{
+    tWSStageFn pfnStage;
+    const void *pvData;
+}
+tWSStage;
+
+//
+// Data for WSStageBlend()
+//
+typedef struct
+{
+    //
+    // The framebuffer to blend towards, indexed by the same LED index as the
+    // pipeline source
+    //
+    const uint8_t (*pui8Colors)[3];
+
+    //
+    // 0 leaves the pixel as is, 255 replaces it with pui8Colors
+    //
+    uint8_t ui8Weight;
+}
+tWSStageBlend;
+
+//*****************************************************************************
+//
+// A 2.2 gamma curve in 8.8 fixed point, for use with WSStageGamma()
+//
+//*****************************************************************************
+extern const uint16_t g_pui16WSGamma22[256];
+
+//*****************************************************************************
+//
+// Scale all channels by a brightness factor
+//
+// @input pvData points to a uint16_t scale out of 256.  The power limiter's
+//        tWSPower.ui16Scale can be used directly.
+//
+//*****************************************************************************
+static inline void
+WSStageScale(const void *pvData, uint16_t *pui16Pix, uint16_t ui16LED)
+{
+    uint32_t ui32Scale;
+
+    (void)ui16LED;
+    ui32Scale = *(const uint16_t *)pvData;
+    pui16Pix[0] = (pui16Pix[0] * ui32Scale) >> 8;
+    pui16Pix[1] = (pui16Pix[1] * ui32Scale) >> 8;
+    pui16Pix[2] = (pui16Pix[2] * ui32Scale) >> 8;
+}
+
+//*****************************************************************************
+//
+// Apply a lookup table curve to all channels
+//
+// @input pvData points to a 256 entry uint16_t table indexed by the integer
+//        part of each channel, such as g_pui16WSGamma22.
+//
+//*****************************************************************************
+static inline void
+WSStageGamma(const void *pvData, uint16_t *pui16Pix, uint16_t ui16LED)
+{
+    const uint16_t *pui16Table;
+
+    (void)ui16LED;
+    pui16Table = (const uint16_t *)pvData;
+    pui16Pix[0] = pui16Table[pui16Pix[0] >> 8];
+    pui16Pix[1] = pui16Table[pui16Pix[1] >> 8];
+    pui16Pix[2] = pui16Table[pui16Pix[2] >> 8];
+}
+
+//*****************************************************************************
+//
+// Blend towards a second framebuffer
+//
+// @input pvData points to a tWSStageBlend.
+//
+//*****************************************************************************
+static inline void
+WSStageBlend(const void *pvData, uint16_t *pui16Pix, uint16_t ui16LED)
+{
+    const tWSStageBlend *psBlend;
+    uint32_t ui32W;
+    uint32_t ui32Inv;
+    int i;
+
+    psBlend = (const tWSStageBlend *)pvData;
+    ui32W = psBlend->ui8Weight;
+    ui32Inv = 255 - ui32W;
+
+    for(i = 0; i < 3; i++)
+    {
+        pui16Pix[i] = ((pui16Pix[i] * ui32Inv) +
+                       ((uint32_t)psBlend->pui8Colors[ui16LED][i] << 8) *
+                       ui32W) / 255;
+    }
+}
+
+//*****************************************************************************
+//
+// Round the 8.8 channels to 8 bits with ordered temporal dithering
+//
+// Each LED gets a threshold from a four step pattern that is offset by the
+// LED index and the frame count, so a fraction that would be lost to
+// truncation shows up as a proportional duty cycle over four frames.  This
+// should be the last stage.
+//
+// @input pvData points to a uint8_t frame counter, incremented by the
+//        caller once per frame.
+//
+//*****************************************************************************
+static inline void
+WSStageDither(const void *pvData, uint16_t *pui16Pix, uint16_t ui16LED)
+{
+    static const uint8_t pui8Threshold[4] = { 0x20, 0xA0, 0xE0, 0x60 };
+    uint32_t ui32Thresh;
+    uint32_t ui32Val;
+    int i;
+
+    ui32Thresh = pui8Threshold[(ui16LED + *(const uint8_t *)pvData) & 3];
+
+    for(i = 0; i < 3; i++)
+    {
+        ui32Val = (pui16Pix[i] + ui32Thresh) & 0x1FF00;
+        pui16Pix[i] = (ui32Val > 0xFF00) ? 0xFF00 : ui32Val;
+    }
+}
+
+//*****************************************************************************
+//
+// Add a stage to a WS_PIPELINE_DEFINE() stage list
+//
+//*****************************************************************************
+#define WS_STAGE(pfnStage, pvData)                                            \
+    (pfnStage)((pvData), pui16Pix, ui32LED)
+
+//*****************************************************************************
+//
+// Define a fused pipeline function
+//
+// This expands to a function with the signature
+//
+//    void name(const uint8_t pui8Src[][3], uint8_t *pui8SPIOut,
+//              uint16_t ui16First, uint16_t ui16Count)
+//
+// which runs LEDs ui16First to ui16First + ui16Count - 1 of pui8Src through
+// the stages and encodes them into pui8SPIOut, which is the entire SPI output
+// data array.  Stages is a list of WS_STAGE() statements separated by
+// semicolons.
+//
+//*****************************************************************************
+#define WS_PIPELINE_DEFINE(name, stages)                                      \
+void                                                                          \
+name(const uint8_t pui8Src[][3], uint8_t *pui8SPIOut, uint16_t ui16First,     \
+     uint16_t ui16Count)                                                      \
+{                                                                             \
+    uint16_t pui16Pix[3];                                                     \
+    uint32_t ui32LED;                                                         \
+    uint32_t ui32End;                                                         \
+                                                                              \
+    pui8SPIOut += (uint32_t)ui16First * WS2812_SPI_LED_SIZE;                  \
+    ui32End = (uint32_t)ui16First + ui16Count;                                \
+                                                                              \
+    for(ui32LED = ui16First; ui32LED < ui32End; ui32LED++)                    \
+    {                                                                         \
+        pui16Pix[0] = pui8Src[ui32LED][0] << 8;                               \
+        pui16Pix[1] = pui8Src[ui32LED][1] << 8;                               \
+        pui16Pix[2] = pui8Src[ui32LED][2] << 8;                               \
+                                                                              \
+        stages;                                                               \
+                                                                              \
+        WSGRBtoSPI(pui8SPIOut, pui16Pix[0] >> 8, pui16Pix[1] >> 8,            \
+                   pui16Pix[2] >> 8);                                         \
+        pui8SPIOut += WS2812_SPI_LED_SIZE;                                    \
+    }                                                                         \
+}
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Run a range of LEDs through a run time stage table
+//
+// @input psStages is the table of stages, run in order
+// @input ui32NumStages is the number of entries in psStages
+// @input pui8Src is the GRB framebuffer
+// @input pui8SPIOut is the entire SPI output data array
+// @input ui16First is the first LED to process
+// @input ui16Count is the number of LEDs to process
+//
+//*****************************************************************************
+extern void WSPipelineRun(const tWSStage *psStages, uint32_t ui32NumStages,
+                          const uint8_t pui8Src[][3], uint8_t *pui8SPIOut,
+                          uint16_t ui16First, uint16_t ui16Count);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_PIPELINE_H__
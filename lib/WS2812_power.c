@@ -0,0 +1,175 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_power.h"
+
+//*****************************************************************************
+//
+// Estimate the current drawn by the frame described by the running sums, in
+// milliamps.
+//
+//*****************************************************************************
+static uint32_t
+powerEstimate(const tWSPower *psPower)
+{
+    uint64_t ui64uA;
+    int i;
+
+    ui64uA = (uint64_t)psPower->ui16NumLED * psPower->ui32IdleuA;
+    for(i = 0; i < 3; i++)
+    {
+        ui64uA += ((uint64_t)psPower->pui32Sum[i] * psPower->pui32ClruA[i]) /
+                  255;
+    }
+
+    return((uint32_t)(ui64uA / 1000));
+}
+
+void
+WSPowerInit(tWSPower *psPower, const uint8_t pui8Colors[][3],
+            uint16_t ui16NumLED, uint32_t ui32BudgetmA)
+{
+    psPower->ui16NumLED = ui16NumLED;
+    psPower->ui32BudgetmA = ui32BudgetmA;
+    psPower->ui32RequestmA = 0;
+    psPower->ui16Scale = WS_POWER_SCALE_FULL;
+    psPower->ui32LimitedFrames = 0;
+
+    WSPowerCurrentSet(psPower, WS_POWER_DEFAULT_CLR_UA,
+                      WS_POWER_DEFAULT_CLR_UA, WS_POWER_DEFAULT_CLR_UA,
+                      WS_POWER_DEFAULT_IDLE_UA);
+    WSPowerRecount(psPower, pui8Colors);
+}
+
+void
+WSPowerCurrentSet(tWSPower *psPower, uint32_t ui32GreenuA, uint32_t ui32ReduA,
+                  uint32_t ui32BlueuA, uint32_t ui32IdleuA)
+{
+    psPower->pui32ClruA[0] = ui32GreenuA;
+    psPower->pui32ClruA[1] = ui32ReduA;
+    psPower->pui32ClruA[2] = ui32BlueuA;
+    psPower->ui32IdleuA = ui32IdleuA;
+}
+
+void
+WSPowerBudgetSet(tWSPower *psPower, uint32_t ui32BudgetmA)
+{
+    psPower->ui32BudgetmA = ui32BudgetmA;
+}
+
+void
+WSPowerRecount(tWSPower *psPower, const uint8_t pui8Colors[][3])
+{
+    uint16_t ui16I;
+
+    psPower->pui32Sum[0] = 0;
+    psPower->pui32Sum[1] = 0;
+    psPower->pui32Sum[2] = 0;
+
+    for(ui16I = 0; ui16I < psPower->ui16NumLED; ui16I++)
+    {
+        psPower->pui32Sum[0] += pui8Colors[ui16I][0];
+        psPower->pui32Sum[1] += pui8Colors[ui16I][1];
+        psPower->pui32Sum[2] += pui8Colors[ui16I][2];
+    }
+}
+
+uint16_t
+WSPowerScaleUpdate(tWSPower *psPower)
+{
+    uint32_t ui32IdlemA;
+    uint32_t ui32Scale;
+
+    //
+    // Work out how much of the budget is left once every LED's quiescent
+    // current is paid for, and scale the colors to fit in it.
+    //
+    psPower->ui32RequestmA = powerEstimate(psPower);
+    ui32IdlemA = ((uint32_t)psPower->ui16NumLED * psPower->ui32IdleuA) / 1000;
+
+    if(psPower->ui32RequestmA <= psPower->ui32BudgetmA)
+    {
+        ui32Scale = WS_POWER_SCALE_FULL;
+    }
+    else if(psPower->ui32BudgetmA <= ui32IdlemA)
+    {
+        ui32Scale = 0;
+    }
+    else
+    {
+        ui32Scale = ((psPower->ui32BudgetmA - ui32IdlemA) *
+                     WS_POWER_SCALE_FULL) /
+                    (psPower->ui32RequestmA - ui32IdlemA);
+    }
+
+    psPower->ui16Scale = ui32Scale;
+    return(ui32Scale);
+}
+
+void
+WSPowerFrameEncoded(tWSPower *psPower)
+{
+    if(psPower->ui16Scale != WS_POWER_SCALE_FULL)
+    {
+        psPower->ui32LimitedFrames++;
+    }
+}
+
+uint16_t
+WSPowerEncode(tWSPower *psPower, const uint8_t pui8Colors[][3],
+              uint8_t *pui8SPIOut)
+{
+    uint32_t ui32Scale;
+    uint16_t ui16I;
+
+    ui32Scale = WSPowerScaleUpdate(psPower);
+
+    if(ui32Scale == WS_POWER_SCALE_FULL)
+    {
+        for(ui16I = 0; ui16I < psPower->ui16NumLED; ui16I++)
+        {
+            WSGRBtoSPI(pui8SPIOut, pui8Colors[ui16I][0], pui8Colors[ui16I][1],
+                       pui8Colors[ui16I][2]);
+            pui8SPIOut += WS2812_SPI_LED_SIZE;
+        }
+    }
+    else
+    {
+        for(ui16I = 0; ui16I < psPower->ui16NumLED; ui16I++)
+        {
+            WSGRBtoSPI(pui8SPIOut,
+                       (pui8Colors[ui16I][0] * ui32Scale) >> 8,
+                       (pui8Colors[ui16I][1] * ui32Scale) >> 8,
+                       (pui8Colors[ui16I][2] * ui32Scale) >> 8);
+            pui8SPIOut += WS2812_SPI_LED_SIZE;
+        }
+    }
+
+    WSPowerFrameEncoded(psPower);
+
+    return(ui32Scale);
+}
+
+void
+WSPowerStatsGet(const tWSPower *psPower, tWSPowerStats *psStats)
+{
+    uint32_t ui32IdlemA;
+
+    ui32IdlemA = ((uint32_t)psPower->ui16NumLED * psPower->ui32IdleuA) / 1000;
+
+    psStats->ui32RequestmA = psPower->ui32RequestmA;
+    psStats->ui16Scale = psPower->ui16Scale;
+    psStats->ui32LimitedFrames = psPower->ui32LimitedFrames;
+
+    if(psPower->ui32RequestmA > ui32IdlemA)
+    {
+        psStats->ui32OutputmA = ui32IdlemA +
+                                (((psPower->ui32RequestmA - ui32IdlemA) *
+                                  psPower->ui16Scale) / WS_POWER_SCALE_FULL);
+    }
+    else
+    {
+        psStats->ui32OutputmA = psPower->ui32RequestmA;
+    }
+}
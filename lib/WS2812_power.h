@@ -0,0 +1,249 @@
+
+
+#ifndef __WS2812_POWER_H__
+#define __WS2812_POWER_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Default current draw of one LED, in microamps.  These are typical numbers
+// for a 5V WS2812b; override them with WSPowerCurrentSet().
+//
+//*****************************************************************************
+#define WS_POWER_DEFAULT_CLR_UA     20000
+#define WS_POWER_DEFAULT_IDLE_UA    1000
+
+//
+// Brightness scale that leaves colors untouched
+//
+#define WS_POWER_SCALE_FULL         256
+
+//*****************************************************************************
+//
+// Power budget state for one LED chain.  The per-channel sums are kept up to
+// date by WSPowerSetLED(), so the current estimate never needs a pass over
+// the framebuffer.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Configuration
+    //
+    uint16_t ui16NumLED;
+    uint32_t ui32BudgetmA;
+    uint32_t pui32ClruA[3];
+    uint32_t ui32IdleuA;
+
+    //
+    // Running sums of each GRB channel over the framebuffer
+    //
+    uint32_t pui32Sum[3];
+
+    //
+    // Results of the last WSPowerScaleUpdate(), and the number of frames
+    // encoded with a factor below full
+    //
+    uint32_t ui32RequestmA;
+    uint16_t ui16Scale;
+    uint32_t ui32LimitedFrames;
+}
+tWSPower;
+
+//*****************************************************************************
+//
+// Power limiter statistics, as returned by WSPowerStatsGet()
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Estimated current of the frame as rendered
+    //
+    uint32_t ui32RequestmA;
+
+    //
+    // Estimated current of the frame as sent, after limiting
+    //
+    uint32_t ui32OutputmA;
+
+    //
+    // Brightness factor applied to the last frame, out of
+    // WS_POWER_SCALE_FULL
+    //
+    uint16_t ui16Scale;
+
+    //
+    // Number of frames that had to be scaled down
+    //
+    uint32_t ui32LimitedFrames;
+}
+tWSPowerStats;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Initialize a power limiter
+//
+// This function sets the budget and seeds the per-channel sums from the
+// current contents of the framebuffer.  This is the only time the whole
+// framebuffer is read by the limiter.
+//
+// @input psPower is the limiter to initialize
+// @input pui8Colors is the GRB framebuffer
+// @input ui16NumLED is the number of LEDs in the framebuffer
+// @input ui32BudgetmA is the current the LEDs may draw, in milliamps
+//
+//*****************************************************************************
+extern void WSPowerInit(tWSPower *psPower, const uint8_t pui8Colors[][3],
+                        uint16_t ui16NumLED, uint32_t ui32BudgetmA);
+
+//*****************************************************************************
+//
+// Set the current model used by the limiter
+//
+// @input psPower is the limiter
+// @input ui32GreenuA is the current of a green channel at full brightness
+// @input ui32ReduA is the current of a red channel at full brightness
+// @input ui32BlueuA is the current of a blue channel at full brightness
+// @input ui32IdleuA is the current of one LED with all channels off
+//
+//*****************************************************************************
+extern void WSPowerCurrentSet(tWSPower *psPower, uint32_t ui32GreenuA,
+                              uint32_t ui32ReduA, uint32_t ui32BlueuA,
+                              uint32_t ui32IdleuA);
+
+//*****************************************************************************
+//
+// Change the current budget
+//
+// @input psPower is the limiter
+// @input ui32BudgetmA is the current the LEDs may draw, in milliamps
+//
+//*****************************************************************************
+extern void WSPowerBudgetSet(tWSPower *psPower, uint32_t ui32BudgetmA);
+
+//*****************************************************************************
+//
+// Re-seed the per-channel sums from the framebuffer
+//
+// Only needed if the framebuffer was written without going through
+// WSPowerSetLED(), for example by a bulk copy.
+//
+// @input psPower is the limiter
+// @input pui8Colors is the GRB framebuffer
+//
+//*****************************************************************************
+extern void WSPowerRecount(tWSPower *psPower, const uint8_t pui8Colors[][3]);
+
+//*****************************************************************************
+//
+// Set the color of an LED in the framebuffer
+//
+// This function writes the new color to the framebuffer and adjusts the
+// running sums by the difference from the old color.
+//
+// @input psPower is the limiter
+// @input pui8Colors is the GRB framebuffer
+// @input ui16LED is the index of the LED whose color is to be modified
+// @input ui8Green, ui8Red, ui8Blue is the new color
+//
+//*****************************************************************************
+static inline void
+WSPowerSetLED(tWSPower *psPower, uint8_t pui8Colors[][3], uint16_t ui16LED,
+              uint8_t ui8Green, uint8_t ui8Red, uint8_t ui8Blue)
+{
+    uint8_t *pui8Pix;
+
+    pui8Pix = pui8Colors[ui16LED];
+    psPower->pui32Sum[0] += (uint32_t)ui8Green - pui8Pix[0];
+    psPower->pui32Sum[1] += (uint32_t)ui8Red - pui8Pix[1];
+    psPower->pui32Sum[2] += (uint32_t)ui8Blue - pui8Pix[2];
+    pui8Pix[0] = ui8Green;
+    pui8Pix[1] = ui8Red;
+    pui8Pix[2] = ui8Blue;
+}
+
+//*****************************************************************************
+//
+// Work out the brightness factor for the current frame
+//
+// This function updates the current estimate from the running sums and
+// stores the resulting factor in psPower->ui16Scale, where it can be picked up
+// by a render pipeline stage (see WSStageScale() in WS2812_pipeline.h).  Call
+// it before encoding; it can be called again if the frame changes.
+// WSPowerEncode() calls it itself.
+//
+// @input psPower is the limiter
+//
+// @returns the brightness factor, out of WS_POWER_SCALE_FULL
+//
+//*****************************************************************************
+extern uint16_t WSPowerScaleUpdate(tWSPower *psPower);
+
+//*****************************************************************************
+//
+// Count a frame encoded with the current brightness factor
+//
+// This updates the limited frame count in the statistics.  WSPowerEncode()
+// calls it itself; a render pipeline that uses psPower->ui16Scale should call
+// it once for each frame it encodes.
+//
+// @input psPower is the limiter
+//
+//*****************************************************************************
+extern void WSPowerFrameEncoded(tWSPower *psPower);
+
+//*****************************************************************************
+//
+// Encode the framebuffer into the SPI array within the power budget
+//
+// The brightness factor is worked out from the running sums, then applied to
+// each color as it is encoded, so limiting costs no extra pass over the
+// framebuffer.
+//
+// @input psPower is the limiter
+// @input pui8Colors is the GRB framebuffer
+// @input pui8SPIOut is the entire SPI output data array
+//
+// @returns the brightness factor applied, out of WS_POWER_SCALE_FULL
+//
+//*****************************************************************************
+extern uint16_t WSPowerEncode(tWSPower *psPower, const uint8_t pui8Colors[][3],
+                              uint8_t *pui8SPIOut);
+
+//*****************************************************************************
+//
+// Get the power limiter statistics
+//
+// @input psPower is the limiter
+// @input psStats is filled in with the statistics
+//
+//*****************************************************************************
+extern void WSPowerStatsGet(const tWSPower *psPower, tWSPowerStats *psStats);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_POWER_H__
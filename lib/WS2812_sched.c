@@ -0,0 +1,166 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "SPI_uDMA_drv.h"
+#include "WS2812_cycles.h"
+#include "WS2812_sched.h"
+#include "WS2812_trace.h"
+
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "inc/hw_ints.h"
+
+static tWSSchedJob *g_ppsSchedJobs[WS_SCHED_MAX_JOBS];
+static uint32_t g_ui32SchedNumJobs;
+static uint32_t g_ui32SchedCyclesPerUs;
+
+//
+// Frame completion count and time stamp, written by the frame complete
+// interrupt, and the last frame count the jobs were run for
+//
+static volatile uint32_t g_ui32SchedFrame;
+static volatile uint32_t g_ui32SchedStamp;
+static uint32_t g_ui32SchedSeen;
+
+static tWSSchedStats g_sSchedStats;
+
+void
+WSSchedInit(void)
+{
+    g_ui32SchedNumJobs = 0;
+    g_ui32SchedFrame = 0;
+    g_ui32SchedSeen = 0;
+    g_sSchedStats.ui32Frames = 0;
+    g_sSchedStats.ui32Missed = 0;
+    g_sSchedStats.ui32LatencyLast = 0;
+    g_sSchedStats.ui32LatencyMax = 0;
+    g_ui32SchedCyclesPerUs = ROM_SysCtlClockGet() / 1000000;
+
+    WSCyclesInit();
+
+    //
+    // PendSV sits below every peripheral interrupt so rendering never holds
+    // off the uDMA or UART handlers.
+    //
+    ROM_IntPrioritySet(FAULT_PENDSV, 0xE0);
+
+    SPIFrameCallbackSet(WSSchedFrameDone);
+}
+
+bool
+WSSchedJobAdd(tWSSchedJob *psJob, void (*pfnJob)(void *pvData), void *pvData,
+              uint32_t ui32BudgetUs)
+{
+    if(g_ui32SchedNumJobs == WS_SCHED_MAX_JOBS)
+    {
+        return(false);
+    }
+
+    psJob->pfnJob = pfnJob;
+    psJob->pvData = pvData;
+    psJob->ui32Budget = ui32BudgetUs * g_ui32SchedCyclesPerUs;
+    psJob->ui32Runs = 0;
+    psJob->ui32Overruns = 0;
+    psJob->ui32Skips = 0;
+    psJob->ui32CyclesLast = 0;
+    psJob->ui32CyclesMax = 0;
+    psJob->bSkipNext = false;
+
+    g_ppsSchedJobs[g_ui32SchedNumJobs++] = psJob;
+
+    return(true);
+}
+
+void
+WSSchedFrameDone(void)
+{
+    g_ui32SchedStamp = WSCycles();
+    g_ui32SchedFrame++;
+    ROM_IntPendSet(FAULT_PENDSV);
+}
+
+void
+WSSchedStatsGet(tWSSchedStats *psStats)
+{
+    bool bMasked;
+
+    bMasked = ROM_IntMasterDisable();
+    *psStats = g_sSchedStats;
+    psStats->ui32Frames = g_ui32SchedFrame;
+    if(!bMasked)
+    {
+        ROM_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+// The PendSV handler.  This runs once for every frame completion, or once for
+// several if the jobs took longer than a frame, and calls each registered job
+// in turn.  A frame that completes while the jobs are running pends PendSV
+// again, so the handler runs again as soon as it returns.
+//
+//*****************************************************************************
+void
+PendSVIntHandler(void)
+{
+    tWSSchedJob *psJob;
+    uint32_t ui32Frame;
+    uint32_t ui32Start;
+    uint32_t ui32Cycles;
+    uint32_t ui32J;
+
+    WSTRACE(WS_TRACE_ISR_ENTER, WS_TRACE_ID_PENDSV, 0);
+
+    ui32Start = WSCycles();
+    ui32Frame = g_ui32SchedFrame;
+
+    //
+    // Latency is only meaningful for the newest frame; older ones were missed
+    // outright.
+    //
+    ui32Cycles = ui32Start - g_ui32SchedStamp;
+    g_sSchedStats.ui32LatencyLast = ui32Cycles;
+    if(ui32Cycles > g_sSchedStats.ui32LatencyMax)
+    {
+        g_sSchedStats.ui32LatencyMax = ui32Cycles;
+    }
+    if((ui32Frame - g_ui32SchedSeen) > 1)
+    {
+        g_sSchedStats.ui32Missed += (ui32Frame - g_ui32SchedSeen) - 1;
+    }
+    g_ui32SchedSeen = ui32Frame;
+
+    for(ui32J = 0; ui32J < g_ui32SchedNumJobs; ui32J++)
+    {
+        psJob = g_ppsSchedJobs[ui32J];
+
+        if(psJob->bSkipNext)
+        {
+            psJob->bSkipNext = false;
+            psJob->ui32Skips++;
+            continue;
+        }
+
+        WSTRACE(WS_TRACE_RENDER_START, ui32J, 0);
+        ui32Start = WSCycles();
+        psJob->pfnJob(psJob->pvData);
+        ui32Cycles = WSCycles() - ui32Start;
+        WSTRACE(WS_TRACE_RENDER_END, ui32J, 0);
+
+        psJob->ui32Runs++;
+        psJob->ui32CyclesLast = ui32Cycles;
+        if(ui32Cycles > psJob->ui32CyclesMax)
+        {
+            psJob->ui32CyclesMax = ui32Cycles;
+        }
+        if(psJob->ui32Budget && (ui32Cycles > psJob->ui32Budget))
+        {
+            psJob->ui32Overruns++;
+            psJob->bSkipNext = true;
+        }
+    }
+
+    WSTRACE(WS_TRACE_ISR_EXIT, WS_TRACE_ID_PENDSV, 0);
+}
@@ -0,0 +1,153 @@
+
+
+#ifndef __WS2812_SCHED_H__
+#define __WS2812_SCHED_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Frame driven render scheduler.
+//
+// When the SPI driver finishes a frame, the SSI1 interrupt pends PendSV at the
+// lowest priority and returns.  PendSVIntHandler() then runs the registered
+// jobs straight away, one after the other, while the main loop does nothing
+// but sleep.  Every job has a cycle budget.  A job that runs over it is
+// counted and skipped on the following frame, so the SPI array keeps its
+// previous contents and the last good frame is shown again while the bus
+// catches up.
+//
+// PendSVIntHandler() must be placed in the PendSV entry of the vector table.
+//
+//*****************************************************************************
+
+//
+// Number of jobs that can be registered
+//
+#ifndef WS_SCHED_MAX_JOBS
+#define WS_SCHED_MAX_JOBS       4
+#endif
+
+//*****************************************************************************
+//
+// A render job and its run time statistics.  The statistics are in processor
+// clock cycles.
+//
+//*****************************************************************************
+typedef struct
+{
+    void (*pfnJob)(void *pvData);
+    void *pvData;
+    uint32_t ui32Budget;
+
+    uint32_t ui32Runs;
+    uint32_t ui32Overruns;
+    uint32_t ui32Skips;
+    uint32_t ui32CyclesLast;
+    uint32_t ui32CyclesMax;
+
+    //
+    // Set when the last run went over budget
+    //
+    bool bSkipNext;
+}
+tWSSchedJob;
+
+//*****************************************************************************
+//
+// Scheduler statistics.  Latency is measured in processor clock cycles from
+// the end of a frame to the start of the first job.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Frames completed by the bus, and frames that completed while the jobs
+    // for an earlier frame were still running
+    //
+    uint32_t ui32Frames;
+    uint32_t ui32Missed;
+
+    uint32_t ui32LatencyLast;
+    uint32_t ui32LatencyMax;
+}
+tWSSchedStats;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Set up the scheduler
+//
+// Starts the cycle counter, drops PendSV to the lowest priority, and registers
+// for frame completion with the SPI driver.
+//
+//*****************************************************************************
+extern void WSSchedInit(void);
+
+//*****************************************************************************
+//
+// Register a render job
+//
+// Jobs run in the order they were added.
+//
+// @input psJob is the job to fill in, which must stay valid
+// @input pfnJob is the function to call once per frame
+// @input pvData is passed to pfnJob
+// @input ui32BudgetUs is how long the job may take, in microseconds
+//
+// @returns false if WS_SCHED_MAX_JOBS jobs are already registered
+//
+//*****************************************************************************
+extern bool WSSchedJobAdd(tWSSchedJob *psJob, void (*pfnJob)(void *pvData),
+                          void *pvData, uint32_t ui32BudgetUs);
+
+//*****************************************************************************
+//
+// Tell the scheduler a frame has finished
+//
+// WSSchedInit() registers this with the SPI driver.  Other output drivers can
+// call it from their own frame complete interrupt.
+//
+//*****************************************************************************
+extern void WSSchedFrameDone(void);
+
+//*****************************************************************************
+//
+// Get a copy of the scheduler statistics
+//
+// @input psStats is filled in with the statistics
+//
+//*****************************************************************************
+extern void WSSchedStatsGet(tWSSchedStats *psStats);
+
+//*****************************************************************************
+//
+// The PendSV handler that runs the jobs
+//
+//*****************************************************************************
+extern void PendSVIntHandler(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_SCHED_H__
@@ -0,0 +1,402 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "WS2812_drv.h"
+#include "WS2812_hostenc.h"
+#include "WS2812_shm.h"
+
+//
+// Marks a region that has been fully set up
+//
+#define SHM_MAGIC               0x4D485357
+
+//
+// The lane state word: the index of the middle frame, and whether it holds
+// a frame the consumer hasn't taken yet
+//
+#define SHM_MIDDLE_M            0x03
+#define SHM_NEW                 0x04
+
+//
+// Size of a cache line, so lanes written by different processes don't share
+// one
+//
+#define SHM_LINE                64
+#define SHM_ALIGN(x)            (((x) + SHM_LINE - 1) & ~(size_t)(SHM_LINE - 1))
+
+//*****************************************************************************
+//
+// The start of the region.
+//
+//*****************************************************************************
+typedef struct
+{
+    _Atomic uint32_t ui32Magic;
+    uint16_t ui16NumLED;
+    uint16_t ui16NumLanes;
+    uint32_t ui32FrameSize;
+}
+tShmHeader;
+
+//*****************************************************************************
+//
+// The shared part of a lane.  The LED run and ui8Back are only written by
+// the owner, and each frame's sequence number and stamp only while the frame
+// is the owner's back frame.
+//
+//*****************************************************************************
+typedef struct
+{
+    _Alignas(SHM_LINE) _Atomic uint32_t ui32Owner;
+    _Atomic uint32_t ui32State;
+    uint16_t ui16First;
+    uint16_t ui16Count;
+    uint8_t ui8Back;
+    uint32_t ui32Seq;
+    uint32_t pui32FrameSeq[3];
+    uint64_t pui64FrameStamp[3];
+}
+tShmLane;
+
+//*****************************************************************************
+//
+// Find a lane's control block and one of its frames.
+//
+//*****************************************************************************
+static tShmLane *
+shmLane(const tWSShm *psShm, uint16_t ui16Lane)
+{
+    return((tShmLane *)((uint8_t *)psShm->pvBase +
+                        SHM_ALIGN(sizeof(tShmHeader))) + ui16Lane);
+}
+
+static uint8_t *
+shmFrame(const tWSShm *psShm, uint16_t ui16Lane, uint8_t ui8Frame)
+{
+    const tShmHeader *psHeader;
+
+    psHeader = (const tShmHeader *)psShm->pvBase;
+    return((uint8_t *)psShm->pvBase + SHM_ALIGN(sizeof(tShmHeader)) +
+           (psShm->ui16NumLanes * sizeof(tShmLane)) +
+           (((ui16Lane * 3) + ui8Frame) * (size_t)psHeader->ui32FrameSize));
+}
+
+//*****************************************************************************
+//
+// Check whether a lane's owner is still running.  A process we may not
+// signal is still running.
+//
+//*****************************************************************************
+static bool
+shmOwnerLive(uint32_t ui32Owner)
+{
+    return((ui32Owner != 0) &&
+           ((kill(ui32Owner, 0) == 0) || (errno != ESRCH)));
+}
+
+uint64_t
+WSShmNow(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(((uint64_t)sNow.tv_sec * 1000000000) + sNow.tv_nsec);
+}
+
+bool
+WSShmCreate(tWSShm *psShm, const char *pcName, uint16_t ui16NumLED,
+            uint16_t ui16NumLanes)
+{
+    tShmHeader *psHeader;
+    tShmLane *psLane;
+    uint32_t ui32FrameSize;
+    uint16_t i;
+    int iFd;
+
+    if((ui16NumLanes == 0) || (ui16NumLanes > WS_SHM_MAX_LANES))
+    {
+        errno = EINVAL;
+        return(false);
+    }
+
+    memset(psShm, 0, sizeof(tWSShm));
+    ui32FrameSize = SHM_ALIGN(ui16NumLED * 3);
+    psShm->szSize = SHM_ALIGN(sizeof(tShmHeader)) +
+                    (ui16NumLanes * sizeof(tShmLane)) +
+                    (ui16NumLanes * 3 * (size_t)ui32FrameSize);
+
+    shm_unlink(pcName);
+    iFd = shm_open(pcName, O_RDWR | O_CREAT | O_EXCL, 0666);
+    if(iFd < 0)
+    {
+        return(false);
+    }
+    if(ftruncate(iFd, psShm->szSize) < 0)
+    {
+        close(iFd);
+        shm_unlink(pcName);
+        return(false);
+    }
+    psShm->pvBase = mmap(NULL, psShm->szSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, iFd, 0);
+    close(iFd);
+    if(psShm->pvBase == MAP_FAILED)
+    {
+        shm_unlink(pcName);
+        return(false);
+    }
+
+    psShm->pcName = pcName;
+    psShm->bCreator = true;
+    psShm->ui16NumLED = ui16NumLED;
+    psShm->ui16NumLanes = ui16NumLanes;
+    psShm->ui16Lane = WS_SHM_NO_LANE;
+
+    //
+    // The new region is zeroed, so every frame is black.  The consumer holds
+    // frame 0, frame 1 starts in the middle and producers draw into frame 2.
+    //
+    psHeader = (tShmHeader *)psShm->pvBase;
+    psHeader->ui16NumLED = ui16NumLED;
+    psHeader->ui16NumLanes = ui16NumLanes;
+    psHeader->ui32FrameSize = ui32FrameSize;
+    for(i = 0; i < ui16NumLanes; i++)
+    {
+        psLane = shmLane(psShm, i);
+        atomic_init(&psLane->ui32Owner, 0);
+        atomic_init(&psLane->ui32State, 1);
+        psLane->ui8Back = 2;
+        psShm->pui8Front[i] = 0;
+    }
+    atomic_store_explicit(&psHeader->ui32Magic, SHM_MAGIC,
+                          memory_order_release);
+
+    return(true);
+}
+
+bool
+WSShmAttach(tWSShm *psShm, const char *pcName)
+{
+    tShmHeader *psHeader;
+    struct stat sStat;
+    int iFd;
+
+    memset(psShm, 0, sizeof(tWSShm));
+
+    iFd = shm_open(pcName, O_RDWR, 0);
+    if(iFd < 0)
+    {
+        return(false);
+    }
+    if((fstat(iFd, &sStat) < 0) ||
+       ((size_t)sStat.st_size < SHM_ALIGN(sizeof(tShmHeader))))
+    {
+        close(iFd);
+        errno = EINVAL;
+        return(false);
+    }
+    psShm->szSize = sStat.st_size;
+    psShm->pvBase = mmap(NULL, psShm->szSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, iFd, 0);
+    close(iFd);
+    if(psShm->pvBase == MAP_FAILED)
+    {
+        return(false);
+    }
+
+    //
+    // A region caught half way through WSShmCreate() isn't usable yet.
+    //
+    psHeader = (tShmHeader *)psShm->pvBase;
+    if(atomic_load_explicit(&psHeader->ui32Magic, memory_order_acquire) !=
+       SHM_MAGIC)
+    {
+        munmap(psShm->pvBase, psShm->szSize);
+        errno = EAGAIN;
+        return(false);
+    }
+
+    psShm->pcName = pcName;
+    psShm->ui16NumLED = psHeader->ui16NumLED;
+    psShm->ui16NumLanes = psHeader->ui16NumLanes;
+    psShm->ui16Lane = WS_SHM_NO_LANE;
+    return(true);
+}
+
+bool
+WSShmLaneClaim(tWSShm *psShm, uint16_t ui16Lane, uint16_t ui16First,
+               uint16_t ui16Count)
+{
+    tShmLane *psLane;
+    tShmLane *psOther;
+    uint32_t ui32Owner;
+    uint16_t ui16L;
+
+    if((ui16Lane >= psShm->ui16NumLanes) ||
+       ((ui16First + ui16Count) > psShm->ui16NumLED))
+    {
+        return(false);
+    }
+
+    //
+    // Take the lane if it's free, or if its owner has gone away without
+    // releasing it.
+    //
+    psLane = shmLane(psShm, ui16Lane);
+    ui32Owner = atomic_load(&psLane->ui32Owner);
+    if(shmOwnerLive(ui32Owner) ||
+       !atomic_compare_exchange_strong(&psLane->ui32Owner, &ui32Owner,
+                                       (uint32_t)getpid()))
+    {
+        return(false);
+    }
+
+    psLane->ui16First = ui16First;
+    psLane->ui16Count = ui16Count;
+
+    //
+    // Give the lane back if its run overlaps a live lane's.  The run is
+    // written before the check, so of two overlapping claims made at once
+    // at least one sees the other.
+    //
+    atomic_thread_fence(memory_order_seq_cst);
+    for(ui16L = 0; ui16L < psShm->ui16NumLanes; ui16L++)
+    {
+        psOther = shmLane(psShm, ui16L);
+        if((ui16L != ui16Lane) &&
+           shmOwnerLive(atomic_load(&psOther->ui32Owner)) &&
+           (ui16First < (psOther->ui16First + psOther->ui16Count)) &&
+           (psOther->ui16First < (ui16First + ui16Count)))
+        {
+            atomic_store(&psLane->ui32Owner, 0);
+            return(false);
+        }
+    }
+
+    psShm->ui16Lane = ui16Lane;
+    return(true);
+}
+
+void
+WSShmLaneRelease(tWSShm *psShm)
+{
+    if(psShm->ui16Lane != WS_SHM_NO_LANE)
+    {
+        atomic_store(&shmLane(psShm, psShm->ui16Lane)->ui32Owner, 0);
+        psShm->ui16Lane = WS_SHM_NO_LANE;
+    }
+}
+
+uint8_t
+(*WSShmFrameGet(tWSShm *psShm))[3]
+{
+    tShmLane *psLane;
+
+    psLane = shmLane(psShm, psShm->ui16Lane);
+    return((uint8_t (*)[3])shmFrame(psShm, psShm->ui16Lane, psLane->ui8Back));
+}
+
+void
+WSShmPublish(tWSShm *psShm)
+{
+    tShmLane *psLane;
+    uint32_t ui32Old;
+    uint8_t ui8Back;
+
+    psLane = shmLane(psShm, psShm->ui16Lane);
+    ui8Back = psLane->ui8Back;
+
+    psLane->ui32Seq++;
+    psLane->pui32FrameSeq[ui8Back] = psLane->ui32Seq;
+    psLane->pui64FrameStamp[ui8Back] = WSShmNow();
+
+    //
+    // The back frame becomes the middle one, and whatever was in the middle,
+    // taken by the consumer or not, becomes the new back frame.
+    //
+    ui32Old = atomic_exchange_explicit(&psLane->ui32State,
+                                       ui8Back | SHM_NEW,
+                                       memory_order_acq_rel);
+    psLane->ui8Back = ui32Old & SHM_MIDDLE_M;
+}
+
+uint16_t
+WSShmConsume(tWSShm *psShm, uint8_t *pui8SPI, uint64_t *pui64Stamp)
+{
+    tShmLane *psLane;
+    uint64_t ui64Oldest;
+    uint32_t ui32State;
+    uint32_t ui32Seq;
+    uint16_t ui16Lanes;
+    uint16_t i;
+    uint8_t ui8Front;
+
+    ui16Lanes = 0;
+    ui64Oldest = UINT64_MAX;
+
+    for(i = 0; i < psShm->ui16NumLanes; i++)
+    {
+        psLane = shmLane(psShm, i);
+        if(!(atomic_load_explicit(&psLane->ui32State, memory_order_relaxed) &
+             SHM_NEW))
+        {
+            continue;
+        }
+
+        //
+        // Trade the frame we hold for the newest one.
+        //
+        ui32State = atomic_exchange_explicit(&psLane->ui32State,
+                                             psShm->pui8Front[i],
+                                             memory_order_acq_rel);
+        ui8Front = ui32State & SHM_MIDDLE_M;
+        psShm->pui8Front[i] = ui8Front;
+
+        ui32Seq = psLane->pui32FrameSeq[ui8Front];
+        if((ui32Seq - psShm->pui32Seq[i]) > 1)
+        {
+            psShm->ui32Dropped += ui32Seq - psShm->pui32Seq[i] - 1;
+        }
+        psShm->pui32Seq[i] = ui32Seq;
+        if(psLane->pui64FrameStamp[ui8Front] < ui64Oldest)
+        {
+            ui64Oldest = psLane->pui64FrameStamp[ui8Front];
+        }
+
+        WSEncodeBytes(pui8SPI + (psLane->ui16First * WS2812_SPI_LED_SIZE),
+                      shmFrame(psShm, i, ui8Front) + (psLane->ui16First * 3),
+                      psLane->ui16Count * 3);
+        ui16Lanes++;
+    }
+
+    if(pui64Stamp != NULL)
+    {
+        *pui64Stamp = ui64Oldest;
+    }
+    return(ui16Lanes);
+}
+
+void
+WSShmClose(tWSShm *psShm)
+{
+    WSShmLaneRelease(psShm);
+    if(psShm->pvBase != NULL)
+    {
+        munmap(psShm->pvBase, psShm->szSize);
+        psShm->pvBase = NULL;
+    }
+    if(psShm->bCreator)
+    {
+        shm_unlink(psShm->pcName);
+        psShm->bCreator = false;
+    }
+}
@@ -0,0 +1,202 @@
+
+
+#ifndef __WS2812_SHM_H__
+#define __WS2812_SHM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Shared memory framebuffer for Linux hosts with several pixel producers.
+//
+// The output process creates a POSIX shared memory region holding one lane
+// per producer.  A producer process attaches, claims a lane and a run of
+// LEDs, and draws into a full-strip GRB frame of which only its run is
+// shown.  Each lane is triple buffered: the producer draws into its back
+// frame while the consumer encodes from its front frame, and publishing
+// swaps the back frame with the middle one in a single atomic exchange.
+// Nobody waits on anybody; a frame published before the consumer got to the
+// previous one replaces it and is counted as dropped.
+//
+// Each publish also bumps the lane's sequence number and stamps the frame
+// with CLOCK_MONOTONIC, so the consumer can report drops and end to end
+// latency.  The consumer encodes straight from the shared frame into the
+// SPI array with WSEncodeBytes() (see WS2812_hostenc.h).
+//
+//*****************************************************************************
+
+//
+// Most lanes a region can have
+//
+#define WS_SHM_MAX_LANES        16
+
+//
+// No lane claimed
+//
+#define WS_SHM_NO_LANE          0xFFFF
+
+//*****************************************************************************
+//
+// A process's view of a region.  The consumer keeps which frame it holds
+// for every lane; a producer keeps its lane.
+//
+//*****************************************************************************
+typedef struct
+{
+    void *pvBase;
+    size_t szSize;
+    const char *pcName;
+    bool bCreator;
+    uint16_t ui16NumLED;
+    uint16_t ui16NumLanes;
+    uint16_t ui16Lane;
+    uint8_t pui8Front[WS_SHM_MAX_LANES];
+    uint32_t pui32Seq[WS_SHM_MAX_LANES];
+    uint32_t ui32Dropped;
+}
+tWSShm;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Create a region, as the consumer
+//
+// An existing region of the same name is replaced.
+//
+// @input psShm is the handle to fill in
+// @input pcName is the shared memory name, for example "/ws2812"; it must
+//        stay valid until WSShmClose()
+// @input ui16NumLED is the number of LEDs in the strip
+// @input ui16NumLanes is the number of lanes, at most WS_SHM_MAX_LANES
+//
+// @returns false if the region couldn't be created, with errno set
+//
+//*****************************************************************************
+extern bool WSShmCreate(tWSShm *psShm, const char *pcName,
+                        uint16_t ui16NumLED, uint16_t ui16NumLanes);
+
+//*****************************************************************************
+//
+// Attach to a region, as a producer
+//
+// @input psShm is the handle to fill in
+// @input pcName is the name the consumer created the region with
+//
+// @returns false if there is no such region, with errno set
+//
+//*****************************************************************************
+extern bool WSShmAttach(tWSShm *psShm, const char *pcName);
+
+//*****************************************************************************
+//
+// Claim a lane
+//
+// A lane whose owner has exited can be claimed again.  Lanes held by live
+// processes never share an LED.
+//
+// @input psShm is an attached handle
+// @input ui16Lane is the lane to claim
+// @input ui16First is the first LED the lane shows
+// @input ui16Count is the number of LEDs the lane shows
+//
+// @returns false if the lane is out of range, the LEDs don't fit or overlap
+//          those of a lane a live process holds, or another live process
+//          owns the lane
+//
+//*****************************************************************************
+extern bool WSShmLaneClaim(tWSShm *psShm, uint16_t ui16Lane,
+                           uint16_t ui16First, uint16_t ui16Count);
+
+//*****************************************************************************
+//
+// Give up the claimed lane
+//
+// @input psShm is an attached handle with a lane
+//
+//*****************************************************************************
+extern void WSShmLaneRelease(tWSShm *psShm);
+
+//*****************************************************************************
+//
+// Get the frame to draw into
+//
+// The frame is indexed by LED across the whole strip.  It holds whatever
+// was drawn two publishes ago, not the last frame.
+//
+// @input psShm is an attached handle with a lane
+//
+// @returns the GRB back frame
+//
+//*****************************************************************************
+extern uint8_t (*WSShmFrameGet(tWSShm *psShm))[3];
+
+//*****************************************************************************
+//
+// Publish the frame from WSShmFrameGet()
+//
+// The frame returned by the next WSShmFrameGet() is a different one.
+//
+// @input psShm is an attached handle with a lane
+//
+//*****************************************************************************
+extern void WSShmPublish(tWSShm *psShm);
+
+//*****************************************************************************
+//
+// Encode every lane that has published since the last call
+//
+// @input psShm is the consumer's handle
+// @input pui8SPI is the SPI array of the whole strip
+// @input pui64Stamp receives the publish time of the oldest frame encoded,
+//        in CLOCK_MONOTONIC nanoseconds.  May be NULL.
+//
+// @returns the number of lanes encoded
+//
+//*****************************************************************************
+extern uint16_t WSShmConsume(tWSShm *psShm, uint8_t *pui8SPI,
+                             uint64_t *pui64Stamp);
+
+//*****************************************************************************
+//
+// Get the current CLOCK_MONOTONIC time in nanoseconds, for latency sums
+// against the stamps from WSShmConsume().
+//
+//*****************************************************************************
+extern uint64_t WSShmNow(void);
+
+//*****************************************************************************
+//
+// Unmap the region
+//
+// The consumer's close also removes the name; producers that are still
+// attached keep their mapping.
+//
+// @input psShm is the handle
+//
+//*****************************************************************************
+extern void WSShmClose(tWSShm *psShm);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_SHM_H__
@@ -0,0 +1,220 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "WS2812_drv.h"
+#include "WS2812_show.h"
+
+//*****************************************************************************
+//
+// Read little endian values out of the mapping.
+//
+//*****************************************************************************
+static uint16_t
+showGet16(const uint8_t *pui8Data)
+{
+    return(pui8Data[0] | (pui8Data[1] << 8));
+}
+
+static uint32_t
+showGet32(const uint8_t *pui8Data)
+{
+    return(pui8Data[0] | ((uint32_t)pui8Data[1] << 8) |
+           ((uint32_t)pui8Data[2] << 16) | ((uint32_t)pui8Data[3] << 24));
+}
+
+//*****************************************************************************
+//
+// Pass advice for a run of frames to the kernel, clipped to the show.
+//
+//*****************************************************************************
+static void
+showAdvise(const tWSShow *psShow, uint32_t ui32First, uint32_t ui32Count,
+           int iAdvice)
+{
+    if(ui32First >= psShow->ui32NumFrames)
+    {
+        return;
+    }
+    if(ui32Count > (psShow->ui32NumFrames - ui32First))
+    {
+        ui32Count = psShow->ui32NumFrames - ui32First;
+    }
+
+    madvise((void *)(psShow->pui8Map + psShow->ui32DataOffs +
+                     ((size_t)ui32First * psShow->ui32Stride)),
+            (size_t)ui32Count * psShow->ui32Stride, iAdvice);
+}
+
+//*****************************************************************************
+//
+// Check that the header and strip table describe a show that fits the file.
+//
+//*****************************************************************************
+static bool
+showValidate(const tWSShow *psShow)
+{
+    const uint8_t *pui8Strip;
+    uint32_t ui32Len;
+    uint16_t i;
+
+    if((psShow->ui16NumStrips == 0) || (psShow->ui32NumFrames == 0) ||
+       (psShow->ui32Stride == 0) ||
+       (psShow->ui32Stride % WS_SHOW_ALIGN) ||
+       (psShow->ui32DataOffs % WS_SHOW_ALIGN) ||
+       (psShow->ui32DataOffs < (WS_SHOW_HDR_SIZE +
+                                ((uint32_t)psShow->ui16NumStrips *
+                                 WS_SHOW_STRIP_SIZE))) ||
+       (psShow->szSize < psShow->ui32DataOffs) ||
+       (((psShow->szSize - psShow->ui32DataOffs) / psShow->ui32Stride) <
+        psShow->ui32NumFrames))
+    {
+        return(false);
+    }
+
+    for(i = 0; i < psShow->ui16NumStrips; i++)
+    {
+        pui8Strip = psShow->pui8Map + WS_SHOW_HDR_SIZE +
+                    (i * WS_SHOW_STRIP_SIZE);
+        ui32Len = showGet16(pui8Strip) *
+                  ((psShow->ui16Flags & WS_SHOW_ENCODED) ?
+                   WS2812_SPI_LED_SIZE : 3);
+        if((showGet32(pui8Strip + 4) > psShow->ui32Stride) ||
+           (ui32Len > (psShow->ui32Stride - showGet32(pui8Strip + 4))))
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+bool
+WSShowOpen(tWSShow *psShow, const char *pcPath)
+{
+    struct stat sStat;
+    void *pvMap;
+    int iFd;
+
+    memset(psShow, 0, sizeof(tWSShow));
+
+    iFd = open(pcPath, O_RDONLY);
+    if(iFd < 0)
+    {
+        return(false);
+    }
+    if(fstat(iFd, &sStat) < 0)
+    {
+        close(iFd);
+        return(false);
+    }
+    if((size_t)sStat.st_size < WS_SHOW_HDR_SIZE)
+    {
+        close(iFd);
+        errno = EINVAL;
+        return(false);
+    }
+
+    pvMap = mmap(NULL, sStat.st_size, PROT_READ, MAP_SHARED, iFd, 0);
+    close(iFd);
+    if(pvMap == MAP_FAILED)
+    {
+        return(false);
+    }
+    psShow->pui8Map = pvMap;
+    psShow->szSize = sStat.st_size;
+
+    if(memcmp(psShow->pui8Map, "WSS1", 4))
+    {
+        WSShowClose(psShow);
+        errno = EINVAL;
+        return(false);
+    }
+    psShow->ui16NumStrips = showGet16(psShow->pui8Map + 4);
+    psShow->ui16Flags = showGet16(psShow->pui8Map + 6);
+    psShow->ui32NumFrames = showGet32(psShow->pui8Map + 8);
+    psShow->ui32PeriodUs = showGet32(psShow->pui8Map + 12);
+    psShow->ui32Stride = showGet32(psShow->pui8Map + 16);
+    psShow->ui32DataOffs = showGet32(psShow->pui8Map + 20);
+    psShow->ui8SPIHigh = psShow->pui8Map[24];
+    psShow->ui8SPILow = psShow->pui8Map[25];
+    psShow->ui32Frame = psShow->ui32NumFrames;
+
+    if(!showValidate(psShow))
+    {
+        WSShowClose(psShow);
+        errno = EINVAL;
+        return(false);
+    }
+
+    madvise(pvMap, psShow->szSize, MADV_SEQUENTIAL);
+    showAdvise(psShow, 0, WS_SHOW_READAHEAD, MADV_WILLNEED);
+    return(true);
+}
+
+void
+WSShowClose(tWSShow *psShow)
+{
+    if(psShow->pui8Map != NULL)
+    {
+        munmap((void *)psShow->pui8Map, psShow->szSize);
+        psShow->pui8Map = NULL;
+    }
+}
+
+uint32_t
+WSShowFrameNext(tWSShow *psShow)
+{
+    uint32_t ui32Prev;
+
+    ui32Prev = psShow->ui32Frame;
+    psShow->ui32Frame = (ui32Prev + 1 < psShow->ui32NumFrames) ?
+                        (ui32Prev + 1) : 0;
+
+    //
+    // The frame before is finished with, even if a backend is still sending
+    // the one before that: the pages come back from the page cache if they
+    // are touched again.  Only the frame entering the window needs asking
+    // for; at the wrap the start of the show is asked for again.
+    //
+    if(ui32Prev < psShow->ui32NumFrames)
+    {
+        showAdvise(psShow, ui32Prev, 1, MADV_DONTNEED);
+    }
+    if(psShow->ui32Frame == 0)
+    {
+        showAdvise(psShow, 0, WS_SHOW_READAHEAD, MADV_WILLNEED);
+    }
+    else
+    {
+        showAdvise(psShow, psShow->ui32Frame + WS_SHOW_READAHEAD - 1, 1,
+                   MADV_WILLNEED);
+    }
+
+    return(psShow->ui32Frame);
+}
+
+const uint8_t *
+WSShowStripGet(const tWSShow *psShow, uint16_t ui16Strip,
+               uint16_t *pui16NumLED)
+{
+    const uint8_t *pui8Strip;
+    uint32_t ui32Frame;
+
+    ui32Frame = (psShow->ui32Frame < psShow->ui32NumFrames) ?
+                psShow->ui32Frame : 0;
+    pui8Strip = psShow->pui8Map + WS_SHOW_HDR_SIZE +
+                (ui16Strip * WS_SHOW_STRIP_SIZE);
+    if(pui16NumLED != NULL)
+    {
+        *pui16NumLED = showGet16(pui8Strip);
+    }
+
+    return(psShow->pui8Map + psShow->ui32DataOffs +
+           ((size_t)ui32Frame * psShow->ui32Stride) + showGet32(pui8Strip + 4));
+}
@@ -0,0 +1,170 @@
+
+
+#ifndef __WS2812_SHOW_H__
+#define __WS2812_SHOW_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Show file format, for replaying pre-rendered frames on Linux hosts
+// (tools/wsshow.c converts raw frame dumps into it).  All multi-byte values
+// are little endian.
+//
+//    header:   'W' 'S' 'S' '1' <u16 strips> <u16 flags> <u32 frames>
+//              <u32 period us> <u32 frame stride> <u32 data offset>
+//              <u8 SPI high> <u8 SPI low> <u16 reserved> <u32 reserved>
+//    strips:   per strip <u16 LEDs> <u16 reserved> <u32 offset in frame>
+//    frames:   frame n starts at data offset + n * frame stride
+//
+// With WS_SHOW_ENCODED set, each strip's slice of a frame is its SPI array,
+// WS2812_SPI_LED_SIZE bytes per LED, encoded with the SPI high and low bytes
+// in the header.  Otherwise it is LEDs * 3 GRB bytes.  The data offset and
+// frame stride are multiples of WS_SHOW_ALIGN, so every frame starts on a
+// page and can be handed to the kernel or an output backend as it is.
+//
+//*****************************************************************************
+#define WS_SHOW_HDR_SIZE        32
+#define WS_SHOW_STRIP_SIZE      8
+#define WS_SHOW_ALIGN           4096
+#define WS_SHOW_ENCODED         0x0001
+
+//
+// Number of frames past the current one the replay asks the kernel to read
+// ahead
+//
+#ifndef WS_SHOW_READAHEAD
+#define WS_SHOW_READAHEAD       8
+#endif
+
+//*****************************************************************************
+//
+// An open show file
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The mapped file
+    //
+    const uint8_t *pui8Map;
+    size_t szSize;
+
+    //
+    // Values from the header
+    //
+    uint16_t ui16NumStrips;
+    uint16_t ui16Flags;
+    uint32_t ui32NumFrames;
+    uint32_t ui32PeriodUs;
+    uint32_t ui32Stride;
+    uint32_t ui32DataOffs;
+    uint8_t ui8SPIHigh;
+    uint8_t ui8SPILow;
+
+    //
+    // The frame handed out by the last WSShowFrameNext()
+    //
+    uint32_t ui32Frame;
+}
+tWSShow;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Map a show file
+//
+// The whole file is mapped read only and the kernel is told it will be read
+// sequentially.
+//
+// @input psShow is the show to open
+// @input pcPath is the show file
+//
+// @returns false if the file can't be mapped or isn't a valid show, with
+//          errno set
+//
+//*****************************************************************************
+extern bool WSShowOpen(tWSShow *psShow, const char *pcPath);
+
+//*****************************************************************************
+//
+// Unmap a show file
+//
+// @input psShow is the open show
+//
+//*****************************************************************************
+extern void WSShowClose(tWSShow *psShow);
+
+//*****************************************************************************
+//
+// Move to the next frame, wrapping at the end of the show
+//
+// Pages for the next WS_SHOW_READAHEAD frames are requested with
+// MADV_WILLNEED and the pages of the frame before this one are dropped
+// with MADV_DONTNEED, so a show larger than RAM plays from the page cache
+// with a small resident set.  The first call returns frame 0.
+//
+// @input psShow is the open show
+//
+// @returns the index of the frame now current
+//
+//*****************************************************************************
+extern uint32_t WSShowFrameNext(tWSShow *psShow);
+
+//*****************************************************************************
+//
+// Get one strip's slice of the current frame
+//
+// The slice points into the mapping; nothing is copied.
+//
+// @input psShow is the open show
+// @input ui16Strip is the strip
+// @input pui16NumLED receives the number of LEDs in the strip.  May be NULL.
+//
+// @returns the strip's SPI array (WS_SHOW_ENCODED) or GRB framebuffer
+//
+//*****************************************************************************
+extern const uint8_t *WSShowStripGet(const tWSShow *psShow,
+                                     uint16_t ui16Strip,
+                                     uint16_t *pui16NumLED);
+
+//*****************************************************************************
+//
+// Get when a frame is due, relative to the start of the show
+//
+// @input psShow is the open show
+// @input ui32Frame is the frame
+//
+// @returns the time in microseconds
+//
+//*****************************************************************************
+static inline uint64_t
+WSShowFrameTime(const tWSShow *psShow, uint32_t ui32Frame)
+{
+    return((uint64_t)ui32Frame * psShow->ui32PeriodUs);
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_SHOW_H__
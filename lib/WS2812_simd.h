@@ -0,0 +1,178 @@
+
+
+#ifndef __WS2812_SIMD_H__
+#define __WS2812_SIMD_H__
+
+#include <string.h>
+
+//*****************************************************************************
+//
+// Packed byte helpers shared by the color processing modules.  Each helper
+// works on four 8-bit values held in one 32-bit word.  On Cortex-M4 the
+// packed SIMD instructions are used through the ACLE intrinsics; everywhere
+// else (including host builds) the same results are computed with plain
+// 32-bit SWAR arithmetic.
+//
+//*****************************************************************************
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#define WS_SIMD_ARM             1
+#endif
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Load or store four bytes from a possibly unaligned address.  The Cortex-M4
+// handles unaligned LDR/STR, so these compile to a single instruction.
+//
+//*****************************************************************************
+static inline uint32_t
+WSLoad8x4(const uint8_t *pui8Src)
+{
+    uint32_t ui32Val;
+
+    memcpy(&ui32Val, pui8Src, sizeof(ui32Val));
+    return(ui32Val);
+}
+
+static inline void
+WSStore8x4(uint8_t *pui8Dst, uint32_t ui32Val)
+{
+    memcpy(pui8Dst, &ui32Val, sizeof(ui32Val));
+}
+
+//*****************************************************************************
+//
+// Saturating add of four packed bytes
+//
+//*****************************************************************************
+static inline uint32_t
+WSQAdd8x4(uint32_t ui32A, uint32_t ui32B)
+{
+#ifdef WS_SIMD_ARM
+    return(__uqadd8(ui32A, ui32B));
+#else
+    uint32_t ui32Sum;
+    uint32_t ui32Carry;
+
+    //
+    // Add the low seven bits of each byte, fix up the top bit, then saturate
+    // every byte that carried out.
+    //
+    ui32Sum = ((ui32A & 0x7F7F7F7F) + (ui32B & 0x7F7F7F7F)) ^
+              ((ui32A ^ ui32B) & 0x80808080);
+    ui32Carry = ((ui32A & ui32B) | ((ui32A | ui32B) & ~ui32Sum)) & 0x80808080;
+    return(ui32Sum | ((ui32Carry >> 7) * 0xFF));
+#endif
+}
+
+//*****************************************************************************
+//
+// Saturating subtract of four packed bytes
+//
+//*****************************************************************************
+static inline uint32_t
+WSQSub8x4(uint32_t ui32A, uint32_t ui32B)
+{
+#ifdef WS_SIMD_ARM
+    return(__uqsub8(ui32A, ui32B));
+#else
+    uint32_t ui32Diff;
+    uint32_t ui32Borrow;
+
+    ui32Diff = ((ui32A | 0x80808080) - (ui32B & 0x7F7F7F7F)) ^
+               ((ui32A ^ ~ui32B) & 0x80808080);
+    ui32Borrow = ((~ui32A & ui32B) | (~(ui32A ^ ui32B) & ui32Diff)) &
+                 0x80808080;
+    return(ui32Diff & ~((ui32Borrow >> 7) * 0xFF));
+#endif
+}
+
+//*****************************************************************************
+//
+// Split four packed bytes into two words of two 16-bit lanes: bytes 0 and 2
+// in *pui32Even, bytes 1 and 3 in *pui32Odd.
+//
+//*****************************************************************************
+static inline void
+WSUnpack8x4(uint32_t ui32A, uint32_t *pui32Even, uint32_t *pui32Odd)
+{
+#ifdef WS_SIMD_ARM
+    *pui32Even = __uxtb16(ui32A);
+    *pui32Odd = __uxtb16(__ror(ui32A, 8));
+#else
+    *pui32Even = ui32A & 0x00FF00FF;
+    *pui32Odd = (ui32A >> 8) & 0x00FF00FF;
+#endif
+}
+
+//*****************************************************************************
+//
+// Divide both 16-bit lanes of a word by 255 with rounding, leaving the
+// results in the low byte of each lane.  Each lane must hold no more than
+// 255 * 255.
+//
+//*****************************************************************************
+static inline uint32_t
+WSDiv255x2(uint32_t ui32Lanes)
+{
+    ui32Lanes += 0x00800080;
+    return(((ui32Lanes + ((ui32Lanes >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF);
+}
+
+//*****************************************************************************
+//
+// Linear interpolation of four packed bytes: ui8Weight of 0 gives ui32A, 255
+// gives ui32B.
+//
+//*****************************************************************************
+static inline uint32_t
+WSLerp8x4(uint32_t ui32A, uint32_t ui32B, uint32_t ui32Weight)
+{
+    uint32_t ui32AE, ui32AO, ui32BE, ui32BO;
+    uint32_t ui32Inv;
+
+    ui32Inv = 255 - ui32Weight;
+    WSUnpack8x4(ui32A, &ui32AE, &ui32AO);
+    WSUnpack8x4(ui32B, &ui32BE, &ui32BO);
+
+    return(WSDiv255x2((ui32AE * ui32Inv) + (ui32BE * ui32Weight)) |
+           (WSDiv255x2((ui32AO * ui32Inv) + (ui32BO * ui32Weight)) << 8));
+}
+
+//*****************************************************************************
+//
+// Scale four packed bytes by ui32Scale / 256, where ui32Scale is 0 to 256.
+//
+//*****************************************************************************
+static inline uint32_t
+WSScale8x4(uint32_t ui32A, uint32_t ui32Scale)
+{
+    uint32_t ui32Even, ui32Odd;
+
+    WSUnpack8x4(ui32A, &ui32Even, &ui32Odd);
+
+    return(((ui32Even * ui32Scale) >> 8 & 0x00FF00FF) |
+           ((ui32Odd * ui32Scale) & 0xFF00FF00));
+}
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_SIMD_H__
@@ -0,0 +1,283 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "WS2812_drv.h"
+#include "WS2812_stream.h"
+
+//
+// Phases of a packet as tracked by WSStreamFeed()
+//
+#define STREAM_PHASE_HEADER     0
+#define STREAM_PHASE_PAYLOAD    1
+#define STREAM_PHASE_DISCARD    2
+#define STREAM_PHASE_TRAILER    3
+
+//
+// TPM2 framing bytes
+//
+#define TPM2_START              0xC9
+#define TPM2_DATA_FRAME         0xDA
+#define TPM2_END                0x36
+
+//*****************************************************************************
+//
+// Work out the payload split once a header has been accepted.
+//
+//*****************************************************************************
+static uint32_t
+streamAccept(tWSStream *psStream, uint32_t ui32Len, uint8_t ui8TrailerLen)
+{
+    psStream->ui8HdrLen = 0;
+    psStream->ui8TrailerLen = ui8TrailerLen;
+
+    if(ui32Len > psStream->ui32FrameSize)
+    {
+        psStream->ui32PayloadLen = psStream->ui32FrameSize;
+        psStream->ui32DiscardLen = ui32Len - psStream->ui32FrameSize;
+    }
+    else
+    {
+        psStream->ui32PayloadLen = ui32Len;
+        psStream->ui32DiscardLen = 0;
+    }
+
+    return(WS_STREAM_PAYLOAD);
+}
+
+void
+WSStreamInit(tWSStream *psStream, uint8_t *pui8Frame, uint32_t ui32FrameSize)
+{
+    memset(psStream, 0, sizeof(*psStream));
+    psStream->pui8Frame = pui8Frame;
+    psStream->ui32FrameSize = ui32FrameSize;
+}
+
+uint32_t
+WSStreamHeaderByte(tWSStream *psStream, uint8_t ui8Byte)
+{
+    static const uint8_t pui8Magic[3] = { 'A', 'd', 'a' };
+    uint8_t *pui8Hdr;
+    uint32_t ui32Count;
+
+    pui8Hdr = psStream->pui8Hdr;
+
+    //
+    // Look for the start of a header
+    //
+    if(psStream->ui8HdrLen == 0)
+    {
+        if(ui8Byte == pui8Magic[0])
+        {
+            psStream->ui8Protocol = WS_STREAM_ADALIGHT;
+        }
+        else if(ui8Byte == TPM2_START)
+        {
+            psStream->ui8Protocol = WS_STREAM_TPM2;
+        }
+        else
+        {
+            return(WS_STREAM_MORE);
+        }
+
+        pui8Hdr[psStream->ui8HdrLen++] = ui8Byte;
+        return(WS_STREAM_MORE);
+    }
+
+    pui8Hdr[psStream->ui8HdrLen++] = ui8Byte;
+
+    if(psStream->ui8Protocol == WS_STREAM_ADALIGHT)
+    {
+        if(psStream->ui8HdrLen <= 3)
+        {
+            //
+            // A broken magic may itself be the start of the next header.
+            //
+            if(ui8Byte != pui8Magic[psStream->ui8HdrLen - 1])
+            {
+                psStream->ui8HdrLen = 0;
+                return(WSStreamHeaderByte(psStream, ui8Byte));
+            }
+            return(WS_STREAM_MORE);
+        }
+
+        if(psStream->ui8HdrLen < 6)
+        {
+            return(WS_STREAM_MORE);
+        }
+
+        if(pui8Hdr[5] != (pui8Hdr[3] ^ pui8Hdr[4] ^ 0x55))
+        {
+            psStream->ui8HdrLen = 0;
+            psStream->ui32Errors++;
+            return(WS_STREAM_ERROR);
+        }
+
+        ui32Count = (((uint32_t)pui8Hdr[3] << 8) | pui8Hdr[4]) + 1;
+        return(streamAccept(psStream, ui32Count * 3, 0));
+    }
+    else
+    {
+        //
+        // Only data frames carry pixels; other packet types are skipped.
+        //
+        if(psStream->ui8HdrLen == 2)
+        {
+            if(ui8Byte != TPM2_DATA_FRAME)
+            {
+                psStream->ui8HdrLen = 0;
+                return(WSStreamHeaderByte(psStream, ui8Byte));
+            }
+            return(WS_STREAM_MORE);
+        }
+
+        if(psStream->ui8HdrLen < 4)
+        {
+            return(WS_STREAM_MORE);
+        }
+
+        return(streamAccept(psStream,
+                            ((uint32_t)pui8Hdr[2] << 8) | pui8Hdr[3], 1));
+    }
+}
+
+uint32_t
+WSStreamPayloadDone(tWSStream *psStream)
+{
+    if(psStream->ui8TrailerLen)
+    {
+        return(WS_STREAM_MORE);
+    }
+
+    psStream->ui32Frames++;
+    return(WS_STREAM_COMMIT);
+}
+
+uint32_t
+WSStreamTrailerByte(tWSStream *psStream, uint8_t ui8Byte)
+{
+    //
+    // TPM2 is the only protocol with a trailer, a single end byte.
+    //
+    psStream->ui8TrailerLen = 0;
+
+    if(ui8Byte != TPM2_END)
+    {
+        psStream->ui32Errors++;
+        return(WS_STREAM_ERROR);
+    }
+
+    psStream->ui32Frames++;
+    return(WS_STREAM_COMMIT);
+}
+
+uint32_t
+WSStreamFeed(tWSStream *psStream, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    uint32_t ui32Frames;
+    uint32_t ui32Chunk;
+
+    ui32Frames = 0;
+
+    while(1)
+    {
+        //
+        // Move on to the next phase as soon as the current one is complete,
+        // which for an empty payload is straight away.
+        //
+        if((psStream->ui8Phase == STREAM_PHASE_PAYLOAD) &&
+           (psStream->ui32Pos == psStream->ui32PayloadLen))
+        {
+            psStream->ui32Pos = 0;
+            psStream->ui8Phase = STREAM_PHASE_DISCARD;
+        }
+        if((psStream->ui8Phase == STREAM_PHASE_DISCARD) &&
+           (psStream->ui32Pos == psStream->ui32DiscardLen))
+        {
+            if(WSStreamPayloadDone(psStream) == WS_STREAM_COMMIT)
+            {
+                ui32Frames++;
+                psStream->ui8Phase = STREAM_PHASE_HEADER;
+            }
+            else
+            {
+                psStream->ui8Phase = STREAM_PHASE_TRAILER;
+            }
+        }
+
+        if(ui32Len == 0)
+        {
+            break;
+        }
+
+        switch(psStream->ui8Phase)
+        {
+            case STREAM_PHASE_HEADER:
+            {
+                if(WSStreamHeaderByte(psStream, *pui8Data) ==
+                   WS_STREAM_PAYLOAD)
+                {
+                    psStream->ui32Pos = 0;
+                    psStream->ui8Phase = STREAM_PHASE_PAYLOAD;
+                }
+                ui32Chunk = 1;
+                break;
+            }
+
+            case STREAM_PHASE_PAYLOAD:
+            {
+                ui32Chunk = psStream->ui32PayloadLen - psStream->ui32Pos;
+                if(ui32Chunk > ui32Len)
+                {
+                    ui32Chunk = ui32Len;
+                }
+                memcpy(psStream->pui8Frame + psStream->ui32Pos, pui8Data,
+                       ui32Chunk);
+                psStream->ui32Pos += ui32Chunk;
+                break;
+            }
+
+            case STREAM_PHASE_DISCARD:
+            {
+                ui32Chunk = psStream->ui32DiscardLen - psStream->ui32Pos;
+                if(ui32Chunk > ui32Len)
+                {
+                    ui32Chunk = ui32Len;
+                }
+                psStream->ui32Pos += ui32Chunk;
+                break;
+            }
+
+            default:
+            {
+                if(WSStreamTrailerByte(psStream, *pui8Data) ==
+                   WS_STREAM_COMMIT)
+                {
+                    ui32Frames++;
+                }
+                psStream->ui8Phase = STREAM_PHASE_HEADER;
+                ui32Chunk = 1;
+                break;
+            }
+        }
+
+        pui8Data += ui32Chunk;
+        ui32Len -= ui32Chunk;
+    }
+
+    return(ui32Frames);
+}
+
+void
+WSStreamEncode(uint8_t *pui8SPIOut, const uint8_t *pui8Frame,
+               uint16_t ui16NumLED)
+{
+    uint16_t ui16I;
+
+    for(ui16I = 0; ui16I < ui16NumLED; ui16I++)
+    {
+        WSGRBtoSPI(pui8SPIOut, pui8Frame[1], pui8Frame[0], pui8Frame[2]);
+        pui8SPIOut += WS2812_SPI_LED_SIZE;
+        pui8Frame += 3;
+    }
+}
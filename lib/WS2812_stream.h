@@ -0,0 +1,188 @@
+
+
+#ifndef __WS2812_STREAM_H__
+#define __WS2812_STREAM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Streaming frame parser for the Adalight and TPM2 serial protocols.
+//
+// The parser only ever looks at header and trailer bytes.  Once a header has
+// been accepted it reports where the payload should go and how long it is,
+// and the caller (normally the UART uDMA driver) moves the pixel bytes
+// straight into the framebuffer.  Pixel bytes stay in wire order, which is RGB
+// for both protocols; WSStreamEncode() swaps them into GRB while encoding.
+//
+//    Adalight: 'A' 'd' 'a' <count-1 hi> <count-1 lo> <hi ^ lo ^ 0x55>
+//              followed by count RGB triplets
+//    TPM2:     0xC9 0xDA <len hi> <len lo> followed by len bytes and 0x36
+//
+//*****************************************************************************
+#define WS_STREAM_ADALIGHT      0
+#define WS_STREAM_TPM2          1
+
+//
+// Return values of WSStreamHeaderByte() and WSStreamTrailerByte()
+//
+#define WS_STREAM_MORE          0
+#define WS_STREAM_PAYLOAD       1
+#define WS_STREAM_COMMIT        2
+#define WS_STREAM_ERROR         3
+
+//*****************************************************************************
+//
+// Parser state.  The payload members are valid after WSStreamHeaderByte()
+// returns WS_STREAM_PAYLOAD.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The framebuffer payloads are received into
+    //
+    uint8_t *pui8Frame;
+    uint32_t ui32FrameSize;
+
+    //
+    // Header parsing state
+    //
+    uint8_t ui8Protocol;
+    uint8_t ui8HdrLen;
+    uint8_t pui8Hdr[6];
+
+    //
+    // Number of payload bytes that fit in the framebuffer, and the number
+    // that follow them and must be thrown away
+    //
+    uint32_t ui32PayloadLen;
+    uint32_t ui32DiscardLen;
+
+    //
+    // Number of trailer bytes still expected after the payload
+    //
+    uint8_t ui8TrailerLen;
+
+    //
+    // Position within the current packet, used by WSStreamFeed()
+    //
+    uint8_t ui8Phase;
+    uint32_t ui32Pos;
+
+    //
+    // Statistics
+    //
+    uint32_t ui32Frames;
+    uint32_t ui32Errors;
+}
+tWSStream;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Initialize a stream parser
+//
+// @input psStream is the parser to initialize
+// @input pui8Frame is the framebuffer payloads are received into
+// @input ui32FrameSize is the size of the framebuffer in bytes
+//
+//*****************************************************************************
+extern void WSStreamInit(tWSStream *psStream, uint8_t *pui8Frame,
+                         uint32_t ui32FrameSize);
+
+//*****************************************************************************
+//
+// Feed one header byte to the parser
+//
+// Bytes that can't start or continue a header are skipped, so the parser
+// resynchronizes on its own after line noise.
+//
+// @input psStream is the parser
+// @input ui8Byte is the byte received
+//
+// @returns WS_STREAM_PAYLOAD when a header has been accepted and the payload
+//          should be received, WS_STREAM_ERROR if a header failed its check,
+//          otherwise WS_STREAM_MORE
+//
+//*****************************************************************************
+extern uint32_t WSStreamHeaderByte(tWSStream *psStream, uint8_t ui8Byte);
+
+//*****************************************************************************
+//
+// Tell the parser that the payload has been received
+//
+// @input psStream is the parser
+//
+// @returns WS_STREAM_COMMIT if the frame is complete, or WS_STREAM_MORE if a
+//          trailer must be checked with WSStreamTrailerByte() first
+//
+//*****************************************************************************
+extern uint32_t WSStreamPayloadDone(tWSStream *psStream);
+
+//*****************************************************************************
+//
+// Feed one trailer byte to the parser
+//
+// @input psStream is the parser
+// @input ui8Byte is the byte received
+//
+// @returns WS_STREAM_COMMIT if the frame is complete, WS_STREAM_ERROR if the
+//          trailer is wrong, otherwise WS_STREAM_MORE
+//
+//*****************************************************************************
+extern uint32_t WSStreamTrailerByte(tWSStream *psStream, uint8_t ui8Byte);
+
+//*****************************************************************************
+//
+// Parse a block of received bytes, copying payloads into the framebuffer
+//
+// This is the copying counterpart of the uDMA path, for use on a host or
+// when no uDMA channel is available.
+//
+// @input psStream is the parser
+// @input pui8Data is the received bytes
+// @input ui32Len is the number of bytes received
+//
+// @returns the number of frames completed
+//
+//*****************************************************************************
+extern uint32_t WSStreamFeed(tWSStream *psStream, const uint8_t *pui8Data,
+                             uint32_t ui32Len);
+
+//*****************************************************************************
+//
+// Encode a received RGB frame into the SPI array
+//
+// @input pui8SPIOut is the entire SPI output data array
+// @input pui8Frame is the received frame, in wire (RGB) order
+// @input ui16NumLED is the number of LEDs to encode
+//
+//*****************************************************************************
+extern void WSStreamEncode(uint8_t *pui8SPIOut, const uint8_t *pui8Frame,
+                           uint16_t ui16NumLED);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_STREAM_H__
@@ -0,0 +1,268 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_timing.h"
+
+#include "driverlib/rom.h"
+#include "driverlib/ssi.h"
+#include "driverlib/sysctl.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "inc/hw_types.h"
+
+//
+// Limits of the SSI clock dividers and frame size
+//
+#define TIMING_PRESCALE_MAX     254
+#define TIMING_SCR_MAX          255
+#define TIMING_FRAME_MIN        4
+#define TIMING_FRAME_MAX        8
+
+//*****************************************************************************
+//
+// Datasheet figures.  The WS2812B and SK6812 specify each high and low time
+// as nominal +/-150ns and the whole bit as 1.25us +/-600ns; the WS2813 gives
+// min/max ranges directly.  The shortest low time is that of a one, as a
+// zero has a shorter high time in the same bit.  Reset times are for current
+// production parts.
+//
+//*****************************************************************************
+const tWSChipTiming g_sWSTimingWS2812B =
+{
+    250, 550, 650, 950, 300, 650, 1850, 280
+};
+
+const tWSChipTiming g_sWSTimingSK6812 =
+{
+    150, 450, 450, 750, 450, 650, 1850, 80
+};
+
+const tWSChipTiming g_sWSTimingWS2813 =
+{
+    220, 380, 580, 1000, 220, 800, 1420, 280
+};
+
+//
+// The timing the SPI driver shipped with: 2.5MHz, 8 bit frames.  A zero
+// prescaler leaves the dividers to the library.
+//
+static const tWSTiming g_sWSTimingLegacy =
+{
+    0, 0, 2500000, 8, WS2812_SPI_HIGH, WS2812_SPI_LOW, 3200, 2
+};
+
+static tWSTiming g_sWSTimingActive;
+static bool g_bWSTimingSelected;
+
+//*****************************************************************************
+//
+// Check that ui32Bits SSI bits of ui32Div system clocks each last between
+// ui16MinNs and ui16MaxNs.  Compared in clock cycles times 1e9 so nothing is
+// rounded.
+//
+//*****************************************************************************
+static bool
+timingFits(uint32_t ui32SysClock, uint32_t ui32Div, uint32_t ui32Bits,
+           uint16_t ui16MinNs, uint16_t ui16MaxNs)
+{
+    uint64_t ui64Time;
+
+    ui64Time = (uint64_t)ui32Bits * ui32Div * 1000000000;
+
+    return((ui64Time >= ((uint64_t)ui16MinNs * ui32SysClock)) &&
+           (ui64Time <= ((uint64_t)ui16MaxNs * ui32SysClock)));
+}
+
+//*****************************************************************************
+//
+// How far a high time is from the middle of its range, in the same units as
+// timingFits(), used to pick between plans of equal speed.
+//
+//*****************************************************************************
+static uint64_t
+timingOffCentre(uint32_t ui32SysClock, uint32_t ui32Div, uint32_t ui32Bits,
+                uint16_t ui16MinNs, uint16_t ui16MaxNs)
+{
+    uint64_t ui64Time;
+    uint64_t ui64Mid;
+
+    ui64Time = (uint64_t)ui32Bits * ui32Div * 2000000000;
+    ui64Mid = ((uint64_t)ui16MinNs + ui16MaxNs) * ui32SysClock;
+
+    return((ui64Time > ui64Mid) ? (ui64Time - ui64Mid) : (ui64Mid - ui64Time));
+}
+
+bool
+WSTimingPlan(uint32_t ui32SysClock, const tWSChipTiming *psChip,
+             tWSTiming *psTiming)
+{
+    uint64_t ui64Off;
+    uint64_t ui64BestOff;
+    uint32_t ui32BestPeriod;
+    uint32_t ui32Div;
+    uint32_t ui32Bits;
+    uint32_t ui32K0;
+    uint32_t ui32K1;
+    uint32_t ui32Pre;
+    uint32_t ui32Ns;
+    bool bFound;
+
+    bFound = false;
+    ui32BestPeriod = 0;
+    ui64BestOff = 0;
+
+    //
+    // Every split of the SSI clock divider into an even prescaler and a
+    // serial clock rate gives the same bit time, so search the total divider
+    // and split it afterwards.  Once the divider alone makes the shortest
+    // frame longer than the longest allowed bit, nothing further can fit.
+    //
+    for(ui32Div = 2;
+        timingFits(ui32SysClock, ui32Div, TIMING_FRAME_MIN, 0,
+                   psChip->ui16BitMax) &&
+        (ui32Div <= (TIMING_PRESCALE_MAX * (TIMING_SCR_MAX + 1)));
+        ui32Div += 2)
+    {
+        for(ui32Pre = 2; ui32Pre <= TIMING_PRESCALE_MAX; ui32Pre += 2)
+        {
+            if(((ui32Div % ui32Pre) == 0) &&
+               ((ui32Div / ui32Pre) <= (TIMING_SCR_MAX + 1)))
+            {
+                break;
+            }
+        }
+        if(ui32Pre > TIMING_PRESCALE_MAX)
+        {
+            continue;
+        }
+
+        for(ui32Bits = TIMING_FRAME_MIN; ui32Bits <= TIMING_FRAME_MAX;
+            ui32Bits++)
+        {
+            if(bFound && ((ui32Bits * ui32Div) > ui32BestPeriod))
+            {
+                break;
+            }
+            if(!timingFits(ui32SysClock, ui32Div, ui32Bits,
+                           psChip->ui16BitMin, psChip->ui16BitMax))
+            {
+                continue;
+            }
+
+            //
+            // At least one low bit is needed so consecutive ones are seen
+            // as separate pulses.
+            //
+            for(ui32K0 = 1; ui32K0 < ui32Bits; ui32K0++)
+            {
+                if(!timingFits(ui32SysClock, ui32Div, ui32K0,
+                               psChip->ui16T0HMin, psChip->ui16T0HMax))
+                {
+                    continue;
+                }
+
+                for(ui32K1 = ui32K0 + 1; ui32K1 < ui32Bits; ui32K1++)
+                {
+                    if(!timingFits(ui32SysClock, ui32Div, ui32K1,
+                                   psChip->ui16T1HMin, psChip->ui16T1HMax) ||
+                       !timingFits(ui32SysClock, ui32Div, ui32Bits - ui32K1,
+                                   psChip->ui16TLMin, 0xFFFF))
+                    {
+                        continue;
+                    }
+
+                    ui64Off = timingOffCentre(ui32SysClock, ui32Div, ui32K0,
+                                              psChip->ui16T0HMin,
+                                              psChip->ui16T0HMax) +
+                              timingOffCentre(ui32SysClock, ui32Div, ui32K1,
+                                              psChip->ui16T1HMin,
+                                              psChip->ui16T1HMax);
+
+                    if(bFound && (((ui32Bits * ui32Div) > ui32BestPeriod) ||
+                                  (((ui32Bits * ui32Div) == ui32BestPeriod) &&
+                                   (ui64Off >= ui64BestOff))))
+                    {
+                        continue;
+                    }
+
+                    bFound = true;
+                    ui32BestPeriod = ui32Bits * ui32Div;
+                    ui64BestOff = ui64Off;
+
+                    psTiming->ui16Prescale = ui32Pre;
+                    psTiming->ui16SCR = (ui32Div / ui32Pre) - 1;
+                    psTiming->ui32BitRate = ui32SysClock / ui32Div;
+                    psTiming->ui8FrameBits = ui32Bits;
+                    psTiming->ui8High = ((1 << ui32K1) - 1) <<
+                                        (ui32Bits - ui32K1);
+                    psTiming->ui8Low = ((1 << ui32K0) - 1) <<
+                                       (ui32Bits - ui32K0);
+                }
+            }
+        }
+    }
+
+    if(!bFound)
+    {
+        return(false);
+    }
+
+    ui32Ns = (uint32_t)(((uint64_t)ui32BestPeriod * 1000000000) /
+                        ui32SysClock);
+    psTiming->ui32BitNs = ui32Ns;
+    psTiming->ui16LatchFrames = (((uint32_t)psChip->ui16ResetUs * 1000) +
+                                 ui32Ns - 1) / ui32Ns;
+
+    return(true);
+}
+
+void
+WSTimingSelect(const tWSTiming *psTiming)
+{
+    g_sWSTimingActive = *psTiming;
+    g_bWSTimingSelected = true;
+    WSEncodingSet(psTiming->ui8High, psTiming->ui8Low);
+}
+
+const tWSTiming *
+WSTimingActive(void)
+{
+    tWSTiming sPlan;
+
+    if(!g_bWSTimingSelected)
+    {
+        if(WSTimingPlan(ROM_SysCtlClockGet(), &g_sWSTimingWS2812B, &sPlan))
+        {
+            WSTimingSelect(&sPlan);
+        }
+        else
+        {
+            WSTimingSelect(&g_sWSTimingLegacy);
+        }
+    }
+
+    return(&g_sWSTimingActive);
+}
+
+void
+WSTimingConfigSSI(uint32_t ui32Base, const tWSTiming *psTiming)
+{
+    //
+    // Let the library set up the mode and frame size, then write the exact
+    // dividers; its own divider search only approximates the bit rate.
+    //
+    ROM_SSIConfigSetExpClk(ui32Base, ROM_SysCtlClockGet(),
+                           SSI_FRF_MOTO_MODE_0, SSI_MODE_MASTER,
+                           psTiming->ui32BitRate, psTiming->ui8FrameBits);
+    if(psTiming->ui16Prescale == 0)
+    {
+        return;
+    }
+
+    HWREG(ui32Base + SSI_O_CPSR) = psTiming->ui16Prescale;
+    HWREG(ui32Base + SSI_O_CR0) = ((HWREG(ui32Base + SSI_O_CR0) &
+                                    ~SSI_CR0_SCR_M) |
+                                   ((uint32_t)psTiming->ui16SCR <<
+                                    SSI_CR0_SCR_S));
+}
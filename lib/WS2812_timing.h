@@ -0,0 +1,155 @@
+
+
+#ifndef __WS2812_TIMING_H__
+#define __WS2812_TIMING_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// SSI timing planner.
+//
+// Each byte of the SPI array is sent as one SSI frame of 4 to 8 bits and
+// makes up one WS bit: a one or zero is a run of high SSI bits followed by
+// low ones.  Given the system clock and a chip's timing limits, the planner
+// picks the frame size, the number of high bits for a one and a zero, and the
+// SSI clock prescaler and serial clock rate that give the shortest WS bit
+// whose high times, low time and bit period are all within the limits.
+//
+// The SPI drivers plan for WS2812B timing at the current system clock unless
+// a plan is selected with WSTimingSelect() before they are started.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Timing limits of an LED chip, in nanoseconds, and its reset time in
+// microseconds
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16T0HMin;
+    uint16_t ui16T0HMax;
+    uint16_t ui16T1HMin;
+    uint16_t ui16T1HMax;
+    uint16_t ui16TLMin;
+    uint16_t ui16BitMin;
+    uint16_t ui16BitMax;
+    uint16_t ui16ResetUs;
+}
+tWSChipTiming;
+
+//*****************************************************************************
+//
+// An SSI timing plan
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // SSI clock prescale divisor (even, 2 to 254) and serial clock rate
+    // (0 to 255).  The SSI bit rate is the system clock divided by
+    // ui16Prescale * (1 + ui16SCR).  A prescaler of 0 means the dividers
+    // are left to SSIConfigSetExpClk() for ui32BitRate.
+    //
+    uint16_t ui16Prescale;
+    uint16_t ui16SCR;
+    uint32_t ui32BitRate;
+
+    //
+    // SSI frame size in bits, and the SPI bytes for a WS one and zero
+    //
+    uint8_t ui8FrameBits;
+    uint8_t ui8High;
+    uint8_t ui8Low;
+
+    //
+    // Length of a WS bit in nanoseconds, and the number of all zero frames
+    // needed to latch
+    //
+    uint32_t ui32BitNs;
+    uint16_t ui16LatchFrames;
+}
+tWSTiming;
+
+//*****************************************************************************
+//
+// Timing limits of the supported chips, from their datasheets
+//
+//*****************************************************************************
+extern const tWSChipTiming g_sWSTimingWS2812B;
+extern const tWSChipTiming g_sWSTimingSK6812;
+extern const tWSChipTiming g_sWSTimingWS2813;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Work out the fastest SSI timing for a chip
+//
+// @input ui32SysClock is the system clock in Hz
+// @input psChip is the chip's timing limits
+// @input psTiming is filled in with the plan
+//
+// @returns false if no SSI setting meets the limits at this clock
+//
+//*****************************************************************************
+extern bool WSTimingPlan(uint32_t ui32SysClock, const tWSChipTiming *psChip,
+                         tWSTiming *psTiming);
+
+//*****************************************************************************
+//
+// Make a plan the one the SPI drivers use, and switch the SPI encoding to it
+//
+// @input psTiming is the plan
+//
+//*****************************************************************************
+extern void WSTimingSelect(const tWSTiming *psTiming);
+
+//*****************************************************************************
+//
+// Get the plan the SPI drivers use
+//
+// If no plan has been selected, a WS2812B plan for the current system clock
+// is made and selected.  Should that fail, the original fixed 2.5MHz 8 bit
+// timing is used.
+//
+//*****************************************************************************
+extern const tWSTiming *WSTimingActive(void);
+
+//*****************************************************************************
+//
+// Configure an SSI peripheral as an SPI master sending with a plan's timing
+//
+// The SSI must be disabled.
+//
+// @input ui32Base is the SSI base address
+// @input psTiming is the plan
+//
+//*****************************************************************************
+extern void WSTimingConfigSSI(uint32_t ui32Base, const tWSTiming *psTiming);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_TIMING_H__
@@ -0,0 +1,121 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_cycles.h"
+#include "WS2812_trace.h"
+
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "inc/hw_memmap.h"
+
+static tWSTraceRecord g_psTrace[WS_TRACE_SIZE];
+
+//
+// Total number of events recorded since the buffer was last cleared.  The
+// newest record is at g_ui32TraceCount - 1, modulo the buffer size.
+//
+static uint32_t g_ui32TraceCount;
+static bool g_bTraceOn;
+
+//*****************************************************************************
+//
+// Send a little endian 32-bit value.
+//
+//*****************************************************************************
+static void
+tracePut32(uint32_t ui32Val)
+{
+    int i;
+
+    for(i = 0; i < 4; i++)
+    {
+        ROM_UARTCharPut(WS_TRACE_UART_BASE, ui32Val & 0xFF);
+        ui32Val >>= 8;
+    }
+}
+
+void
+WSTraceInit(void)
+{
+    WSCyclesInit();
+
+    g_ui32TraceCount = 0;
+    g_bTraceOn = true;
+}
+
+void
+WSTraceEvent(uint8_t ui8Event, uint8_t ui8Id, uint16_t ui16Arg)
+{
+    tWSTraceRecord *psRec;
+    bool bMasked;
+
+    //
+    // Claim the slot and stamp it with interrupts off, so a nested handler
+    // can neither take the same slot nor land an earlier time stamp after
+    // this one.
+    //
+    bMasked = ROM_IntMasterDisable();
+    if(!g_bTraceOn)
+    {
+        if(!bMasked)
+        {
+            ROM_IntMasterEnable();
+        }
+        return;
+    }
+    psRec = &g_psTrace[g_ui32TraceCount++ & (WS_TRACE_SIZE - 1)];
+    psRec->ui32Cycles = WSCycles();
+    psRec->ui8Event = ui8Event;
+    psRec->ui8Id = ui8Id;
+    psRec->ui16Arg = ui16Arg;
+    if(!bMasked)
+    {
+        ROM_IntMasterEnable();
+    }
+}
+
+void
+WSTraceDrain(void)
+{
+    const tWSTraceRecord *psRec;
+    uint32_t ui32Count;
+    uint32_t ui32Records;
+    uint32_t ui32I;
+    bool bMasked;
+
+    bMasked = ROM_IntMasterDisable();
+    g_bTraceOn = false;
+    ui32Count = g_ui32TraceCount;
+    if(!bMasked)
+    {
+        ROM_IntMasterEnable();
+    }
+
+    ui32Records = (ui32Count > WS_TRACE_SIZE) ? WS_TRACE_SIZE : ui32Count;
+
+    ROM_UARTCharPut(WS_TRACE_UART_BASE, 'W');
+    ROM_UARTCharPut(WS_TRACE_UART_BASE, 'S');
+    ROM_UARTCharPut(WS_TRACE_UART_BASE, 'T');
+    ROM_UARTCharPut(WS_TRACE_UART_BASE, '1');
+    tracePut32(ROM_SysCtlClockGet());
+    tracePut32(ui32Records);
+    tracePut32(ui32Count - ui32Records);
+
+    //
+    // Oldest record first
+    //
+    for(ui32I = ui32Count - ui32Records; ui32I != ui32Count; ui32I++)
+    {
+        psRec = &g_psTrace[ui32I & (WS_TRACE_SIZE - 1)];
+        tracePut32(psRec->ui32Cycles);
+        ROM_UARTCharPut(WS_TRACE_UART_BASE, psRec->ui8Event);
+        ROM_UARTCharPut(WS_TRACE_UART_BASE, psRec->ui8Id);
+        ROM_UARTCharPut(WS_TRACE_UART_BASE, psRec->ui16Arg & 0xFF);
+        ROM_UARTCharPut(WS_TRACE_UART_BASE, psRec->ui16Arg >> 8);
+    }
+
+    g_ui32TraceCount = 0;
+    g_bTraceOn = true;
+}
@@ -0,0 +1,146 @@
+
+
+#ifndef __WS2812_TRACE_H__
+#define __WS2812_TRACE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Binary event trace.
+//
+// Drivers and the scheduler record compact, cycle counter stamped events with
+// WSTRACE() into a RAM ring buffer.  The oldest events are overwritten once
+// the buffer is full, so after a stutter it holds the moments leading up to
+// it.  WSTraceDrain() stops recording and writes the buffer out of a UART in
+// binary for tools/wstrace.c to turn into a timeline and histograms.
+//
+// Tracing is only compiled in when WS2812_TRACE is defined; otherwise
+// WSTRACE() expands to nothing.
+//
+// The drained dump is little endian:
+//
+//    header:   'W' 'S' 'T' '1' <u32 clock Hz> <u32 records> <u32 dropped>
+//    record:   <u32 cycles> <u8 event> <u8 id> <u16 arg>
+//
+//*****************************************************************************
+
+//
+// Events.  The id and arg of each event are described alongside it.
+//
+#define WS_TRACE_ISR_ENTER      1       // id = WS_TRACE_ID_*
+#define WS_TRACE_ISR_EXIT       2       // id = WS_TRACE_ID_*
+#define WS_TRACE_ARMED          3       // id = WS_TRACE_ID_*, arg = bytes
+#define WS_TRACE_LATCH          4       // id = WS_TRACE_ID_*
+#define WS_TRACE_COMMIT         5       // arg = frame bytes received
+#define WS_TRACE_RENDER_START   6       // id = job index
+#define WS_TRACE_RENDER_END     7       // id = job index
+#define WS_TRACE_DMA_ERROR      8       // arg = error status
+#define WS_TRACE_UNDERRUN       9       // id = WS_TRACE_ID_*
+#define WS_TRACE_USER           128     // first event free for applications
+
+//
+// Interrupt handlers and outputs
+//
+#define WS_TRACE_ID_SSI1        0
+#define WS_TRACE_ID_UART0       1
+#define WS_TRACE_ID_TIMER0A     2
+#define WS_TRACE_ID_PENDSV      3
+#define WS_TRACE_ID_UDMAERR     4
+#define WS_TRACE_ID_ADC0SS3     5
+
+//
+// Number of records in the ring buffer, which must be a power of two
+//
+#ifndef WS_TRACE_SIZE
+#define WS_TRACE_SIZE           256
+#endif
+
+//
+// The UART the trace is drained through
+//
+#ifndef WS_TRACE_UART_BASE
+#define WS_TRACE_UART_BASE      UART0_BASE
+#endif
+
+//*****************************************************************************
+//
+// A trace record
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Cycles;
+    uint8_t ui8Event;
+    uint8_t ui8Id;
+    uint16_t ui16Arg;
+}
+tWSTraceRecord;
+
+//*****************************************************************************
+//
+// Record an event, if tracing is compiled in
+//
+//*****************************************************************************
+#ifdef WS2812_TRACE
+#define WSTRACE(ui8Event, ui8Id, ui16Arg)                                     \
+        WSTraceEvent((ui8Event), (ui8Id), (ui16Arg))
+#else
+#define WSTRACE(ui8Event, ui8Id, ui16Arg)                                     \
+        do { } while(0)
+#endif
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Clear the trace buffer and start recording
+//
+//*****************************************************************************
+extern void WSTraceInit(void);
+
+//*****************************************************************************
+//
+// Record an event.  Use WSTRACE() rather than calling this directly.
+//
+// @input ui8Event is the event, one of WS_TRACE_*
+// @input ui8Id identifies the source of the event
+// @input ui16Arg is an event specific value
+//
+//*****************************************************************************
+extern void WSTraceEvent(uint8_t ui8Event, uint8_t ui8Id, uint16_t ui16Arg);
+
+//*****************************************************************************
+//
+// Stop recording and write the trace out of WS_TRACE_UART_BASE
+//
+// The UART must already be configured.  This busy waits on the UART, so call
+// it from the main loop rather than an interrupt handler.  Recording starts
+// again, with an empty buffer, once the dump has been sent.
+//
+//*****************************************************************************
+extern void WSTraceDrain(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_TRACE_H__
@@ -0,0 +1,167 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "SPI_uDMA_drv.h"
+#include "WS2812_drv.h"
+#include "WS2812_zone.h"
+
+void
+WSZoneInit(tWSZoneMap *psMap, tWSZone *psZones, uint8_t ui8MaxZones,
+           uint8_t pui8Colors[][3], uint8_t *pui8SPIOut, uint16_t ui16NumLED)
+{
+    psMap->psZones = psZones;
+    psMap->ui8MaxZones = ui8MaxZones;
+    psMap->ui8NumZones = 0;
+    psMap->pui8Colors = pui8Colors;
+    psMap->pui8SPIOut = pui8SPIOut;
+    psMap->ui16NumLED = ui16NumLED;
+}
+
+uint8_t
+WSZoneAdd(tWSZoneMap *psMap, uint16_t ui16First, uint16_t ui16NumLED,
+          uint16_t ui16Period,
+          bool (*pfnRender)(uint8_t pui8Colors[][3], uint16_t ui16NumLED,
+                            void *pvData),
+          void *pvData)
+{
+    tWSZone *psZone;
+    uint8_t ui8Z;
+
+    if((psMap->ui8NumZones == psMap->ui8MaxZones) ||
+       (psMap->ui8NumZones == WS_ZONE_NONE) || (ui16NumLED == 0) ||
+       (((uint32_t)ui16First + ui16NumLED) > psMap->ui16NumLED))
+    {
+        return(WS_ZONE_NONE);
+    }
+
+    for(ui8Z = 0; ui8Z < psMap->ui8NumZones; ui8Z++)
+    {
+        psZone = &psMap->psZones[ui8Z];
+        if((ui16First < (psZone->ui16First + psZone->ui16NumLED)) &&
+           (psZone->ui16First < (ui16First + ui16NumLED)))
+        {
+            return(WS_ZONE_NONE);
+        }
+    }
+
+    psZone = &psMap->psZones[psMap->ui8NumZones];
+    psZone->pfnRender = pfnRender;
+    psZone->pvData = pvData;
+    psZone->ui16First = ui16First;
+    psZone->ui16NumLED = ui16NumLED;
+    psZone->ui16Period = ui16Period;
+    psZone->ui16Wait = 0;
+    psZone->bRender = true;
+    psZone->bDirty = true;
+    psZone->ui32Renders = 0;
+
+    return(psMap->ui8NumZones++);
+}
+
+void
+WSZonePeriodSet(tWSZoneMap *psMap, uint8_t ui8Zone, uint16_t ui16Period)
+{
+    psMap->psZones[ui8Zone].ui16Period = ui16Period;
+    psMap->psZones[ui8Zone].ui16Wait = ui16Period;
+}
+
+void
+WSZoneDirtySet(tWSZoneMap *psMap, uint8_t ui8Zone)
+{
+    psMap->psZones[ui8Zone].bRender = true;
+    psMap->psZones[ui8Zone].bDirty = true;
+}
+
+uint8_t
+WSZoneFind(const tWSZoneMap *psMap, uint16_t ui16LED)
+{
+    const tWSZone *psZone;
+    uint8_t ui8Z;
+
+    for(ui8Z = 0; ui8Z < psMap->ui8NumZones; ui8Z++)
+    {
+        psZone = &psMap->psZones[ui8Z];
+        if((ui16LED >= psZone->ui16First) &&
+           ((ui16LED - psZone->ui16First) < psZone->ui16NumLED))
+        {
+            return(ui8Z);
+        }
+    }
+
+    return(WS_ZONE_NONE);
+}
+
+uint8_t
+WSZoneTick(tWSZoneMap *psMap)
+{
+    tWSZone *psZone;
+    uint8_t (*pui8Colors)[3];
+    uint8_t *pui8Out;
+    uint16_t ui16I;
+    uint8_t ui8Encoded;
+    uint8_t ui8Z;
+
+    ui8Encoded = 0;
+
+    for(ui8Z = 0; ui8Z < psMap->ui8NumZones; ui8Z++)
+    {
+        psZone = &psMap->psZones[ui8Z];
+
+        //
+        // A periodic zone counts down to its next render; a zone with no
+        // period waits for WSZoneDirtySet().
+        //
+        if(psZone->ui16Period)
+        {
+            if(psZone->ui16Wait)
+            {
+                psZone->ui16Wait--;
+            }
+            if(psZone->ui16Wait == 0)
+            {
+                psZone->ui16Wait = psZone->ui16Period;
+                psZone->bRender = true;
+            }
+        }
+
+        if(!psZone->bRender)
+        {
+            continue;
+        }
+        psZone->bRender = false;
+
+        pui8Colors = &psMap->pui8Colors[psZone->ui16First];
+        if(psZone->pfnRender(pui8Colors, psZone->ui16NumLED,
+                             psZone->pvData))
+        {
+            psZone->bDirty = true;
+        }
+        psZone->ui32Renders++;
+
+        if(!psZone->bDirty)
+        {
+            continue;
+        }
+        psZone->bDirty = false;
+
+        pui8Out = psMap->pui8SPIOut +
+                  ((uint32_t)psZone->ui16First * WS2812_SPI_LED_SIZE);
+        for(ui16I = 0; ui16I < psZone->ui16NumLED; ui16I++)
+        {
+            WSGRBtoSPI(pui8Out, pui8Colors[ui16I][0], pui8Colors[ui16I][1],
+                       pui8Colors[ui16I][2]);
+            pui8Out += WS2812_SPI_LED_SIZE;
+        }
+        SPIDirtyMark(psZone->ui16First + psZone->ui16NumLED - 1);
+
+        ui8Encoded++;
+    }
+
+    return(ui8Encoded);
+}
+
+void
+WSZoneJob(void *pvMap)
+{
+    WSZoneTick((tWSZoneMap *)pvMap);
+}
@@ -0,0 +1,210 @@
+
+
+#ifndef __WS2812_ZONE_H__
+#define __WS2812_ZONE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Zone manager for running several effects on one strip.
+//
+// A zone is a run of LEDs with its own render function and frame period.
+// WSZoneTick() is called once per bus frame, usually as a scheduler job with
+// WSZoneJob().  It only calls the render functions of the zones that are due,
+// and only encodes the LEDs of zones that report a change, so the cost of a
+// frame follows the number of busy zones rather than the length of the strip.
+// Each encoded zone is passed to SPIDirtyMark(), so partial refresh also
+// works.
+//
+// Zones share one GRB framebuffer and SPI array, and each render function
+// gets a pointer to its own first LED, so an effect doesn't need to know
+// where on the strip its zone is.
+//
+//*****************************************************************************
+
+//
+// Returned by WSZoneAdd() and WSZoneFind() when there is no zone
+//
+#define WS_ZONE_NONE            0xFF
+
+//*****************************************************************************
+//
+// A zone
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Renders the zone's LEDs and returns true if any of them changed
+    //
+    bool (*pfnRender)(uint8_t pui8Colors[][3], uint16_t ui16NumLED,
+                      void *pvData);
+    void *pvData;
+
+    uint16_t ui16First;
+    uint16_t ui16NumLED;
+
+    //
+    // Frames between renders, 0 when the zone is only rendered on request,
+    // and frames left until the next render
+    //
+    uint16_t ui16Period;
+    uint16_t ui16Wait;
+
+    //
+    // Set when the zone must be rendered on the next frame, and when its LEDs
+    // must be encoded whether or not the render changed them
+    //
+    bool bRender;
+    bool bDirty;
+
+    uint32_t ui32Renders;
+}
+tWSZone;
+
+//*****************************************************************************
+//
+// A set of zones over one strip
+//
+//*****************************************************************************
+typedef struct
+{
+    tWSZone *psZones;
+    uint8_t ui8MaxZones;
+    uint8_t ui8NumZones;
+
+    uint8_t (*pui8Colors)[3];
+    uint8_t *pui8SPIOut;
+    uint16_t ui16NumLED;
+}
+tWSZoneMap;
+
+//*****************************************************************************
+//
+// Function prototypes
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Initialize a zone map with no zones
+//
+// @input psMap is the map to initialize
+// @input psZones is the array of zones to use, which must stay valid
+// @input ui8MaxZones is the number of entries in psZones
+// @input pui8Colors is the GRB framebuffer of the whole strip
+// @input pui8SPIOut is the SPI array of the whole strip
+// @input ui16NumLED is the number of LEDs in the strip
+//
+//*****************************************************************************
+extern void WSZoneInit(tWSZoneMap *psMap, tWSZone *psZones,
+                       uint8_t ui8MaxZones, uint8_t pui8Colors[][3],
+                       uint8_t *pui8SPIOut, uint16_t ui16NumLED);
+
+//*****************************************************************************
+//
+// Add a zone
+//
+// The new zone is rendered and encoded on the next frame.
+//
+// @input psMap is the zone map
+// @input ui16First is the first LED of the zone
+// @input ui16NumLED is the number of LEDs in the zone
+// @input ui16Period is the number of frames between renders, or 0 to render
+//        only when WSZoneDirtySet() is called
+// @input pfnRender is the render function
+// @input pvData is passed to pfnRender
+//
+// @returns the zone number, or WS_ZONE_NONE if the map is full or the LEDs
+//          are off the strip or already in another zone
+//
+//*****************************************************************************
+extern uint8_t WSZoneAdd(tWSZoneMap *psMap, uint16_t ui16First,
+                         uint16_t ui16NumLED, uint16_t ui16Period,
+                         bool (*pfnRender)(uint8_t pui8Colors[][3],
+                                           uint16_t ui16NumLED,
+                                           void *pvData),
+                         void *pvData);
+
+//*****************************************************************************
+//
+// Change how often a zone is rendered
+//
+// The next render is due ui16Period frames from now.
+//
+// @input psMap is the zone map
+// @input ui8Zone is the zone number
+// @input ui16Period is the number of frames between renders, or 0 to render
+//        only when WSZoneDirtySet() is called
+//
+//*****************************************************************************
+extern void WSZonePeriodSet(tWSZoneMap *psMap, uint8_t ui8Zone,
+                            uint16_t ui16Period);
+
+//*****************************************************************************
+//
+// Have a zone rendered and encoded on the next frame
+//
+// Use this when an effect's settings change, or when something other than
+// the render function wrote to the zone's LEDs.
+//
+// @input psMap is the zone map
+// @input ui8Zone is the zone number
+//
+//*****************************************************************************
+extern void WSZoneDirtySet(tWSZoneMap *psMap, uint8_t ui8Zone);
+
+//*****************************************************************************
+//
+// Find the zone an LED belongs to
+//
+// @input psMap is the zone map
+// @input ui16LED is the LED index on the strip
+//
+// @returns the zone number, or WS_ZONE_NONE if the LED is in no zone
+//
+//*****************************************************************************
+extern uint8_t WSZoneFind(const tWSZoneMap *psMap, uint16_t ui16LED);
+
+//*****************************************************************************
+//
+// Render and encode the zones that are due
+//
+// Call this once per bus frame.
+//
+// @input psMap is the zone map
+//
+// @returns the number of zones encoded
+//
+//*****************************************************************************
+extern uint8_t WSZoneTick(tWSZoneMap *psMap);
+
+//*****************************************************************************
+//
+// WSZoneTick() in the form of a scheduler job
+//
+// @input pvMap is the zone map
+//
+//*****************************************************************************
+extern void WSZoneJob(void *pvMap);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __WS2812_ZONE_H__
@@ -0,0 +1 @@
+#include "wssim.h"
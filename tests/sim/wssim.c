@@ -0,0 +1,952 @@
+//*****************************************************************************
+//
+// wssim - host simulation of the TM4C123 SSI transmitters, uDMA controller
+// and interrupts, for testing the SSI drivers.  See wssim.h.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wssim.h"
+
+#define SIM_NUM_SSI             4
+#define SIM_FIFO_DEPTH          8
+#define SIM_NUM_REGS            64
+#define SIM_MAX_XFER            1024
+
+//
+// SSI burst requests are raised with at least this many free FIFO entries
+//
+#define SIM_SSI_BURST           4
+
+//*****************************************************************************
+//
+// One SSI transmitter
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Base;
+    uint32_t ui32Periph;
+    uint32_t ui32Int;
+    uint32_t ui32Channel;
+
+    bool bClocked;
+    bool bEnabled;
+    bool bDMA;
+    uint32_t ui32IntMask;
+
+    uint8_t pui8Fifo[SIM_FIFO_DEPTH];
+    uint32_t ui32Head;
+    uint32_t ui32Count;
+
+    bool bBusy;
+    uint64_t ui64ShiftEnd;
+
+    //
+    // Control register 1, looked at on every clock
+    //
+    volatile uint32_t *pui32CR1;
+
+    tWSSimWire sWire;
+}
+tSimSSI;
+
+//*****************************************************************************
+//
+// One uDMA control structure, and one channel
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Control;
+    uint32_t ui32Mode;
+    const uint8_t *pui8Src;
+    uint32_t ui32Dst;
+    uint32_t ui32Left;
+}
+tSimStruct;
+
+typedef struct
+{
+    tSimStruct psStruct[2];
+    bool bEnabled;
+    bool bAlt;
+    uint32_t ui32Attr;
+
+    //
+    // A channel with a request that never goes away, standing in for other
+    // traffic on the controller
+    //
+    bool bHog;
+    uint32_t ui32HogArb;
+}
+tSimChannel;
+
+static tWSSimConfig g_sConfig;
+static uint64_t g_ui64Now;
+static uint32_t g_ui32Faults;
+
+static struct
+{
+    uint32_t ui32Addr;
+    uint32_t ui32Val;
+}
+g_psRegs[SIM_NUM_REGS];
+static uint32_t g_ui32NumRegs;
+
+static tSimSSI g_psSSI[SIM_NUM_SSI];
+static tSimChannel g_psChannel[WSSIM_NUM_CHANNELS];
+static bool g_bDMAClocked;
+static bool g_bDMAEnabled;
+static uint64_t g_ui64DMAFree;
+static volatile uint32_t *g_pui32EnaSet;
+
+static void (*g_ppfnHandler[WSSIM_NUM_INTS])(void);
+static bool g_pbIntEnabled[WSSIM_NUM_INTS];
+static bool g_pbIntPending[WSSIM_NUM_INTS];
+static uint64_t g_pui64IntRaised[WSSIM_NUM_INTS];
+static uint8_t g_pui8IntPriority[WSSIM_NUM_INTS];
+static uint64_t g_ui64CPUFree;
+
+//
+// Priority of the handler running, above any real priority in thread mode
+//
+static uint32_t g_ui32ActivePri = 0x100;
+
+//*****************************************************************************
+//
+// Record a use of the hardware that would fault or misbehave on the part.
+//
+//*****************************************************************************
+static void
+simFault(const char *pcWhat)
+{
+    fprintf(stderr, "wssim: %s at clock %llu\n", pcWhat,
+            (unsigned long long)g_ui64Now);
+    g_ui32Faults++;
+}
+
+static tSimSSI *
+simSSI(uint32_t ui32Base)
+{
+    uint32_t ui32I;
+
+    for(ui32I = 0; ui32I < SIM_NUM_SSI; ui32I++)
+    {
+        if(g_psSSI[ui32I].ui32Base == ui32Base)
+        {
+            if(!g_psSSI[ui32I].bClocked)
+            {
+                simFault("SSI used before its peripheral was enabled");
+            }
+            return(&g_psSSI[ui32I]);
+        }
+    }
+
+    simFault("not an SSI base");
+    return(&g_psSSI[0]);
+}
+
+static tSimChannel *
+simChannel(uint32_t ui32Channel)
+{
+    if(!g_bDMAClocked)
+    {
+        simFault("uDMA used before its peripheral was enabled");
+    }
+    return(&g_psChannel[ui32Channel & 0x1F]);
+}
+
+volatile uint32_t *
+WSSimReg(uint32_t ui32Addr)
+{
+    uint32_t ui32I;
+
+    for(ui32I = 0; ui32I < g_ui32NumRegs; ui32I++)
+    {
+        if(g_psRegs[ui32I].ui32Addr == ui32Addr)
+        {
+            return(&g_psRegs[ui32I].ui32Val);
+        }
+    }
+
+    if(g_ui32NumRegs == SIM_NUM_REGS)
+    {
+        fprintf(stderr, "wssim: register table full\n");
+        exit(1);
+    }
+    g_psRegs[g_ui32NumRegs].ui32Addr = ui32Addr;
+    g_psRegs[g_ui32NumRegs].ui32Val = 0;
+    return(&g_psRegs[g_ui32NumRegs++].ui32Val);
+}
+
+//*****************************************************************************
+//
+// System control, pins and interrupts
+//
+//*****************************************************************************
+uint32_t
+SysCtlClockGet(void)
+{
+    return(g_sConfig.ui32Clock);
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Periph)
+{
+    uint32_t ui32I;
+
+    if(ui32Periph == SYSCTL_PERIPH_UDMA)
+    {
+        g_bDMAClocked = true;
+    }
+    for(ui32I = 0; ui32I < SIM_NUM_SSI; ui32I++)
+    {
+        if(g_psSSI[ui32I].ui32Periph == ui32Periph)
+        {
+            g_psSSI[ui32I].bClocked = true;
+        }
+    }
+}
+
+void
+SysCtlPeripheralSleepEnable(uint32_t ui32Periph)
+{
+    (void)ui32Periph;
+}
+
+void
+GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    (void)ui32PinConfig;
+}
+
+void
+GPIOPinTypeSSI(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void
+IntEnable(uint32_t ui32Int)
+{
+    g_pbIntEnabled[ui32Int] = true;
+}
+
+void
+IntDisable(uint32_t ui32Int)
+{
+    g_pbIntEnabled[ui32Int] = false;
+}
+
+void
+IntPendSet(uint32_t ui32Int)
+{
+    if(!g_pbIntPending[ui32Int])
+    {
+        g_pbIntPending[ui32Int] = true;
+        g_pui64IntRaised[ui32Int] = g_ui64Now;
+    }
+}
+
+void
+IntPrioritySet(uint32_t ui32Int, uint8_t ui8Priority)
+{
+    g_pui8IntPriority[ui32Int] = ui8Priority;
+}
+
+//
+// Handlers only ever run between simulation steps, never inside driver
+// code, so masking has nothing to do.
+//
+bool
+IntMasterEnable(void)
+{
+    return(false);
+}
+
+bool
+IntMasterDisable(void)
+{
+    return(false);
+}
+
+//*****************************************************************************
+//
+// SSI
+//
+//*****************************************************************************
+void
+SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk,
+                   uint32_t ui32Protocol, uint32_t ui32Mode,
+                   uint32_t ui32BitRate, uint32_t ui32DataWidth)
+{
+    uint32_t ui32MaxBitRate;
+    uint32_t ui32PreDiv;
+    uint32_t ui32SCR;
+
+    (void)ui32Mode;
+    simSSI(ui32Base);
+
+    //
+    // The same divider search as the library
+    //
+    ui32MaxBitRate = ui32SSIClk / ui32BitRate;
+    ui32PreDiv = 0;
+    do
+    {
+        ui32PreDiv += 2;
+        ui32SCR = (ui32MaxBitRate / ui32PreDiv) - 1;
+    }
+    while(ui32SCR > 255);
+
+    HWREG(ui32Base + SSI_O_CPSR) = ui32PreDiv;
+    HWREG(ui32Base + SSI_O_CR0) = (ui32SCR << SSI_CR0_SCR_S) | ui32Protocol |
+                                  (ui32DataWidth - 1);
+    HWREG(ui32Base + SSI_O_CR1) = 0;
+}
+
+void
+SSIEnable(uint32_t ui32Base)
+{
+    simSSI(ui32Base)->bEnabled = true;
+}
+
+void
+SSIDMAEnable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    if(ui32DMAFlags & SSI_DMA_TX)
+    {
+        simSSI(ui32Base)->bDMA = true;
+    }
+}
+
+void
+SSIIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    simSSI(ui32Base)->ui32IntMask |= ui32IntFlags;
+}
+
+void
+SSIIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    simSSI(ui32Base)->ui32IntMask &= ~ui32IntFlags;
+}
+
+//
+// The TX interrupt flags a half empty FIFO, or in end of transmission mode
+// an empty FIFO with nothing left shifting out.
+//
+static uint32_t
+simSSIRaw(tSimSSI *psSSI)
+{
+    if(*psSSI->pui32CR1 & SSI_CR1_EOT)
+    {
+        return((!psSSI->ui32Count && !psSSI->bBusy) ? SSI_TXFF : 0);
+    }
+    return((psSSI->ui32Count <= (SIM_FIFO_DEPTH / 2)) ? SSI_TXFF : 0);
+}
+
+uint32_t
+SSIIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    tSimSSI *psSSI;
+
+    psSSI = simSSI(ui32Base);
+    return(simSSIRaw(psSSI) & (bMasked ? psSSI->ui32IntMask : 0xFFFFFFFF));
+}
+
+void
+SSIIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    //
+    // The TX interrupt follows the FIFO level and can't be cleared.
+    //
+    (void)ui32IntFlags;
+    simSSI(ui32Base);
+}
+
+//*****************************************************************************
+//
+// uDMA
+//
+//*****************************************************************************
+void
+uDMAEnable(void)
+{
+    if(!g_bDMAClocked)
+    {
+        simFault("uDMA enabled before its peripheral was enabled");
+    }
+    g_bDMAEnabled = true;
+}
+
+void
+uDMAControlBaseSet(void *pvControlTable)
+{
+    if(!g_bDMAClocked)
+    {
+        simFault("uDMA used before its peripheral was enabled");
+    }
+    if((uintptr_t)pvControlTable & 1023)
+    {
+        simFault("uDMA control table not 1024 byte aligned");
+    }
+}
+
+uint32_t
+uDMAErrorStatusGet(void)
+{
+    return(0);
+}
+
+void
+uDMAErrorStatusClear(void)
+{
+}
+
+void
+uDMAChannelAssign(uint32_t ui32Mapping)
+{
+    simChannel(ui32Mapping);
+}
+
+void
+uDMAChannelAttributeEnable(uint32_t ui32Channel, uint32_t ui32Attr)
+{
+    tSimChannel *psChan;
+
+    psChan = simChannel(ui32Channel);
+    psChan->ui32Attr |= ui32Attr;
+    if(ui32Attr & UDMA_ATTR_ALTSELECT)
+    {
+        psChan->bAlt = true;
+    }
+}
+
+void
+uDMAChannelAttributeDisable(uint32_t ui32Channel, uint32_t ui32Attr)
+{
+    tSimChannel *psChan;
+
+    psChan = simChannel(ui32Channel);
+    psChan->ui32Attr &= ~ui32Attr;
+    if(ui32Attr & UDMA_ATTR_ALTSELECT)
+    {
+        psChan->bAlt = false;
+    }
+}
+
+void
+uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control)
+{
+    tSimChannel *psChan;
+
+    psChan = simChannel(ui32ChannelStructIndex);
+    psChan->psStruct[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ? 1 : 0].
+        ui32Control = ui32Control;
+}
+
+void
+uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                       void *pvSrcAddr, void *pvDstAddr,
+                       uint32_t ui32TransferSize)
+{
+    tSimChannel *psChan;
+    tSimStruct *psStruct;
+
+    psChan = simChannel(ui32ChannelStructIndex);
+    psStruct = &psChan->psStruct[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ?
+                                 1 : 0];
+
+    if((ui32TransferSize == 0) || (ui32TransferSize > SIM_MAX_XFER))
+    {
+        simFault("uDMA transfer size out of range");
+    }
+    if(pvSrcAddr == NULL)
+    {
+        simFault("uDMA transfer from address 0");
+    }
+
+    psStruct->ui32Mode = ui32Mode;
+    psStruct->pui8Src = pvSrcAddr;
+    psStruct->ui32Dst = (uint32_t)(uintptr_t)pvDstAddr;
+    psStruct->ui32Left = ui32TransferSize;
+}
+
+void
+uDMAChannelEnable(uint32_t ui32Channel)
+{
+    simChannel(ui32Channel)->bEnabled = true;
+}
+
+bool
+uDMAChannelIsEnabled(uint32_t ui32Channel)
+{
+    return(simChannel(ui32Channel)->bEnabled);
+}
+
+uint32_t
+uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    tSimChannel *psChan;
+
+    psChan = simChannel(ui32ChannelStructIndex);
+    return(psChan->psStruct[(ui32ChannelStructIndex & UDMA_ALT_SELECT) ?
+                            1 : 0].ui32Mode);
+}
+
+//*****************************************************************************
+//
+// Simulation
+//
+//*****************************************************************************
+void
+WSSimReset(const tWSSimConfig *psConfig)
+{
+    static const uint32_t pui32Base[SIM_NUM_SSI] =
+    {
+        SSI0_BASE, SSI1_BASE, SSI2_BASE, SSI3_BASE
+    };
+    static const uint32_t pui32Periph[SIM_NUM_SSI] =
+    {
+        SYSCTL_PERIPH_SSI0, SYSCTL_PERIPH_SSI1, SYSCTL_PERIPH_SSI2,
+        SYSCTL_PERIPH_SSI3
+    };
+    static const uint32_t pui32Int[SIM_NUM_SSI] =
+    {
+        INT_SSI0, INT_SSI1, INT_SSI2, INT_SSI3
+    };
+    static const uint32_t pui32Channel[SIM_NUM_SSI] = { 11, 25, 13, 15 };
+    uint32_t ui32I;
+
+    for(ui32I = 0; ui32I < SIM_NUM_SSI; ui32I++)
+    {
+        free(g_psSSI[ui32I].sWire.pui8Data);
+        free(g_psSSI[ui32I].sWire.pui64Start);
+        memset(&g_psSSI[ui32I], 0, sizeof(g_psSSI[ui32I]));
+        g_psSSI[ui32I].ui32Base = pui32Base[ui32I];
+        g_psSSI[ui32I].ui32Periph = pui32Periph[ui32I];
+        g_psSSI[ui32I].ui32Int = pui32Int[ui32I];
+        g_psSSI[ui32I].ui32Channel = pui32Channel[ui32I];
+    }
+
+    memset(g_psChannel, 0, sizeof(g_psChannel));
+    memset(g_psRegs, 0, sizeof(g_psRegs));
+    g_ui32NumRegs = 0;
+    g_pui32EnaSet = WSSimReg(UDMA_ENASET);
+    for(ui32I = 0; ui32I < SIM_NUM_SSI; ui32I++)
+    {
+        g_psSSI[ui32I].pui32CR1 = WSSimReg(pui32Base[ui32I] + SSI_O_CR1);
+    }
+    memset(g_ppfnHandler, 0, sizeof(g_ppfnHandler));
+    memset(g_pbIntEnabled, 0, sizeof(g_pbIntEnabled));
+    memset(g_pbIntPending, 0, sizeof(g_pbIntPending));
+    memset(g_pui8IntPriority, 0, sizeof(g_pui8IntPriority));
+    g_ui32ActivePri = 0x100;
+
+    g_sConfig = *psConfig;
+    g_ui64Now = 0;
+    g_ui64DMAFree = 0;
+    g_ui64CPUFree = 0;
+    g_ui32Faults = 0;
+
+    //
+    // The drivers only bring up the uDMA controller once per program, so it
+    // stays enabled across resets like the rest of the drivers' own state.
+    //
+}
+
+void
+WSSimIntRegister(uint32_t ui32Int, void (*pfnHandler)(void))
+{
+    g_ppfnHandler[ui32Int] = pfnHandler;
+}
+
+void
+WSSimHogAdd(uint32_t ui32Channel, uint32_t ui32Arb, bool bHighPriority)
+{
+    tSimChannel *psChan;
+
+    psChan = &g_psChannel[ui32Channel];
+    psChan->bHog = true;
+    psChan->bEnabled = true;
+    psChan->ui32HogArb = 1 << ((ui32Arb >> 14) & 0xF);
+    psChan->ui32Attr = bHighPriority ? UDMA_ATTR_HIGH_PRIORITY : 0;
+}
+
+uint64_t
+WSSimNow(void)
+{
+    return(g_ui64Now);
+}
+
+tWSSimWire *
+WSSimWireGet(uint32_t ui32SSI)
+{
+    return(&g_psSSI[ui32SSI].sWire);
+}
+
+void
+WSSimWireClear(uint32_t ui32SSI)
+{
+    g_psSSI[ui32SSI].sWire.ui32Len = 0;
+    g_psSSI[ui32SSI].sWire.ui32Overflows = 0;
+}
+
+uint32_t
+WSSimFaultsGet(void)
+{
+    return(g_ui32Faults);
+}
+
+//*****************************************************************************
+//
+// Start shifting out the next frame in an SSI's FIFO.
+//
+//*****************************************************************************
+static void
+simSSIStep(tSimSSI *psSSI)
+{
+    tWSSimWire *psWire;
+    uint32_t ui32CR0;
+    uint32_t ui32Div;
+
+    if(psSSI->bBusy && (g_ui64Now >= psSSI->ui64ShiftEnd))
+    {
+        psSSI->bBusy = false;
+    }
+    if(psSSI->bBusy || !psSSI->bEnabled || !psSSI->ui32Count)
+    {
+        return;
+    }
+
+    ui32CR0 = HWREG(psSSI->ui32Base + SSI_O_CR0);
+    ui32Div = HWREG(psSSI->ui32Base + SSI_O_CPSR) *
+              (((ui32CR0 & SSI_CR0_SCR_M) >> SSI_CR0_SCR_S) + 1);
+
+    psWire = &psSSI->sWire;
+    if(psWire->ui32Len == psWire->ui32Cap)
+    {
+        psWire->ui32Cap = psWire->ui32Cap ? (psWire->ui32Cap * 2) : 65536;
+        psWire->pui8Data = realloc(psWire->pui8Data, psWire->ui32Cap);
+        psWire->pui64Start = realloc(psWire->pui64Start,
+                                     psWire->ui32Cap * sizeof(uint64_t));
+        if(!psWire->pui8Data || !psWire->pui64Start)
+        {
+            fprintf(stderr, "wssim: out of memory\n");
+            exit(1);
+        }
+    }
+    psWire->pui8Data[psWire->ui32Len] = psSSI->pui8Fifo[psSSI->ui32Head];
+    psWire->pui64Start[psWire->ui32Len] = g_ui64Now;
+    psWire->ui32Len++;
+    psWire->ui32FrameCycles = ((ui32CR0 & SSI_CR0_DSS_M) + 1) * ui32Div;
+
+    psSSI->ui32Head = (psSSI->ui32Head + 1) % SIM_FIFO_DEPTH;
+    psSSI->ui32Count--;
+    psSSI->bBusy = true;
+    psSSI->ui64ShiftEnd = g_ui64Now + psWire->ui32FrameCycles;
+}
+
+//*****************************************************************************
+//
+// Whether a channel is asking for a transfer, and how many items it gets if
+// it is granted.  Returns 0 with no request.
+//
+//*****************************************************************************
+static uint32_t
+simRequest(uint32_t ui32Channel, tSimSSI **ppsSSI)
+{
+    tSimChannel *psChan;
+    tSimStruct *psStruct;
+    tSimSSI *psSSI;
+    uint32_t ui32Free;
+    uint32_t ui32Arb;
+    uint32_t ui32I;
+
+    psChan = &g_psChannel[ui32Channel];
+    *ppsSSI = NULL;
+    if(!psChan->bEnabled || (psChan->ui32Attr & UDMA_ATTR_REQMASK))
+    {
+        return(0);
+    }
+    if(psChan->bHog)
+    {
+        return(psChan->ui32HogArb);
+    }
+
+    psSSI = NULL;
+    for(ui32I = 0; ui32I < SIM_NUM_SSI; ui32I++)
+    {
+        if(g_psSSI[ui32I].ui32Channel == ui32Channel)
+        {
+            psSSI = &g_psSSI[ui32I];
+        }
+    }
+    if(!psSSI || !psSSI->bDMA)
+    {
+        return(0);
+    }
+    *ppsSSI = psSSI;
+
+    psStruct = &psChan->psStruct[psChan->bAlt ? 1 : 0];
+    ui32Arb = 1 << ((psStruct->ui32Control >> 14) & 0xF);
+    ui32Free = SIM_FIFO_DEPTH - psSSI->ui32Count;
+
+    //
+    // A burst request moves a whole arbitration size whatever room is left;
+    // a single request moves one item.
+    //
+    if(ui32Free >= SIM_SSI_BURST)
+    {
+        return(ui32Arb);
+    }
+    if((ui32Free > 0) && !(psChan->ui32Attr & UDMA_ATTR_USEBURST))
+    {
+        return(1);
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Finish the current control structure of a channel.
+//
+//*****************************************************************************
+static void
+simStructDone(tSimChannel *psChan, tSimSSI *psSSI)
+{
+    tSimStruct *psStruct;
+
+    psStruct = &psChan->psStruct[psChan->bAlt ? 1 : 0];
+    if(psStruct->ui32Mode == UDMA_MODE_PINGPONG)
+    {
+        psStruct->ui32Mode = UDMA_MODE_STOP;
+        psChan->bAlt = !psChan->bAlt;
+        if(psChan->psStruct[psChan->bAlt ? 1 : 0].ui32Mode == UDMA_MODE_STOP)
+        {
+            psChan->bEnabled = false;
+        }
+    }
+    else
+    {
+        psStruct->ui32Mode = UDMA_MODE_STOP;
+        psChan->bEnabled = false;
+    }
+
+    //
+    // Completion is signalled on the peripheral's own interrupt
+    //
+    if(!g_pbIntPending[psSSI->ui32Int])
+    {
+        g_pbIntPending[psSSI->ui32Int] = true;
+        g_pui64IntRaised[psSSI->ui32Int] = g_ui64Now;
+    }
+}
+
+//*****************************************************************************
+//
+// Grant the bus to the highest priority request and move its items.
+//
+//*****************************************************************************
+static void
+simDMAStep(void)
+{
+    tSimChannel *psChan;
+    tSimStruct *psStruct;
+    tSimSSI *psSSI;
+    tSimSSI *psBestSSI;
+    uint32_t ui32Channel;
+    uint32_t ui32Best;
+    uint32_t ui32Items;
+    uint32_t ui32BestItems;
+    uint32_t ui32Tail;
+    int iPass;
+
+    if(!g_bDMAEnabled || (g_ui64Now < g_ui64DMAFree))
+    {
+        return;
+    }
+
+    //
+    // A write to the enable set register enables its channels together.
+    //
+    if(*g_pui32EnaSet)
+    {
+        for(ui32Channel = 0; ui32Channel < WSSIM_NUM_CHANNELS; ui32Channel++)
+        {
+            if(*g_pui32EnaSet & (1 << ui32Channel))
+            {
+                g_psChannel[ui32Channel].bEnabled = true;
+            }
+        }
+        *g_pui32EnaSet = 0;
+    }
+
+    ui32Best = WSSIM_NUM_CHANNELS;
+    ui32BestItems = 0;
+    psBestSSI = NULL;
+    for(iPass = 0; (iPass < 2) && (ui32Best == WSSIM_NUM_CHANNELS); iPass++)
+    {
+        for(ui32Channel = 0; ui32Channel < WSSIM_NUM_CHANNELS; ui32Channel++)
+        {
+            psChan = &g_psChannel[ui32Channel];
+            if(((psChan->ui32Attr & UDMA_ATTR_HIGH_PRIORITY) != 0) !=
+               (iPass == 0))
+            {
+                continue;
+            }
+            ui32Items = simRequest(ui32Channel, &psSSI);
+            if(ui32Items)
+            {
+                ui32Best = ui32Channel;
+                ui32BestItems = ui32Items;
+                psBestSSI = psSSI;
+                break;
+            }
+        }
+    }
+    if(ui32Best == WSSIM_NUM_CHANNELS)
+    {
+        return;
+    }
+
+    psChan = &g_psChannel[ui32Best];
+    g_ui64DMAFree = g_ui64Now + (ui32BestItems * g_sConfig.ui32DMACycles);
+    if(psChan->bHog)
+    {
+        return;
+    }
+
+    psStruct = &psChan->psStruct[psChan->bAlt ? 1 : 0];
+    if(psStruct->ui32Mode == UDMA_MODE_STOP)
+    {
+        simFault("uDMA request on a stopped control structure");
+        psChan->bEnabled = false;
+        return;
+    }
+    if(psStruct->ui32Dst != (psBestSSI->ui32Base + SSI_O_DR))
+    {
+        simFault("uDMA transfer not aimed at the SSI data register");
+    }
+
+    if(ui32BestItems > psStruct->ui32Left)
+    {
+        ui32BestItems = psStruct->ui32Left;
+        g_ui64DMAFree = g_ui64Now + (ui32BestItems * g_sConfig.ui32DMACycles);
+    }
+    while(ui32BestItems--)
+    {
+        if(psBestSSI->ui32Count == SIM_FIFO_DEPTH)
+        {
+            psBestSSI->sWire.ui32Overflows++;
+        }
+        else
+        {
+            ui32Tail = (psBestSSI->ui32Head + psBestSSI->ui32Count) %
+                       SIM_FIFO_DEPTH;
+            psBestSSI->pui8Fifo[ui32Tail] = *psStruct->pui8Src;
+            psBestSSI->ui32Count++;
+        }
+        if((psStruct->ui32Control & UDMA_SRC_INC_NONE) != UDMA_SRC_INC_NONE)
+        {
+            psStruct->pui8Src++;
+        }
+        psStruct->ui32Left--;
+    }
+
+    if(psStruct->ui32Left == 0)
+    {
+        simStructDone(psChan, psBestSSI);
+    }
+}
+
+//*****************************************************************************
+//
+// Raise level interrupts and run the next handler that is due.
+//
+//*****************************************************************************
+static void
+simIntStep(void)
+{
+    uint32_t ui32I;
+    uint32_t ui32Int;
+    uint32_t ui32Best;
+    uint32_t ui32Active;
+
+    for(ui32I = 0; ui32I < SIM_NUM_SSI; ui32I++)
+    {
+        ui32Int = g_psSSI[ui32I].ui32Int;
+        if((simSSIRaw(&g_psSSI[ui32I]) & g_psSSI[ui32I].ui32IntMask) &&
+           !g_pbIntPending[ui32Int])
+        {
+            g_pbIntPending[ui32Int] = true;
+            g_pui64IntRaised[ui32Int] = g_ui64Now;
+        }
+    }
+
+    if(g_ui64Now < g_ui64CPUFree)
+    {
+        return;
+    }
+
+    //
+    // The most urgent priority goes first, then the lowest number, and only
+    // if it is more urgent than the handler already running.  System
+    // exceptions (below 16) are always enabled.
+    //
+    ui32Best = WSSIM_NUM_INTS;
+    for(ui32Int = 0; ui32Int < WSSIM_NUM_INTS; ui32Int++)
+    {
+        if(g_pbIntPending[ui32Int] &&
+           (g_pbIntEnabled[ui32Int] || (ui32Int < 16)) &&
+           g_ppfnHandler[ui32Int] &&
+           (g_pui8IntPriority[ui32Int] < g_ui32ActivePri) &&
+           ((g_pui64IntRaised[ui32Int] + g_sConfig.ui32ISRLatency) <=
+            g_ui64Now) &&
+           ((ui32Best == WSSIM_NUM_INTS) ||
+            (g_pui8IntPriority[ui32Int] < g_pui8IntPriority[ui32Best])))
+        {
+            ui32Best = ui32Int;
+        }
+    }
+    if(ui32Best == WSSIM_NUM_INTS)
+    {
+        return;
+    }
+
+    ui32Active = g_ui32ActivePri;
+    g_ui32ActivePri = g_pui8IntPriority[ui32Best];
+    g_pbIntPending[ui32Best] = false;
+    HWREG(WSSIM_DWT_CYCCNT) = (uint32_t)g_ui64Now;
+    g_ppfnHandler[ui32Best]();
+    g_ui64CPUFree = g_ui64Now + g_sConfig.ui32ISRCycles;
+    g_ui32ActivePri = ui32Active;
+}
+
+void
+WSSimRun(uint64_t ui64Cycles)
+{
+    uint64_t ui64End;
+    uint32_t ui32I;
+
+    ui64End = g_ui64Now + ui64Cycles;
+    for(; g_ui64Now < ui64End; g_ui64Now++)
+    {
+        for(ui32I = 0; ui32I < SIM_NUM_SSI; ui32I++)
+        {
+            simSSIStep(&g_psSSI[ui32I]);
+        }
+        simDMAStep();
+        simIntStep();
+    }
+
+    HWREG(WSSIM_DWT_CYCCNT) = (uint32_t)g_ui64Now;
+}
@@ -0,0 +1,280 @@
+
+
+#ifndef __WSSIM_H__
+#define __WSSIM_H__
+
+//*****************************************************************************
+//
+// Host simulation of the parts of the TM4C123 the SSI drivers use: the SSI
+// transmitters, the uDMA controller and the interrupts between them.
+//
+// The driverlib and inc headers in this directory all include this one, so
+// the drivers build unchanged on the host against the functions below.  The
+// simulation steps one system clock at a time.  Each SSI shifts its FIFO out
+// at the bit rate its dividers give and records every frame it sends, with
+// the clock it started on.  The uDMA controller grants one channel at a time,
+// highest priority then lowest channel number, and holds the bus for the
+// arbitration size of a burst request or a single item otherwise.  Handlers
+// run after a fixed latency and keep the processor busy for a fixed number
+// of clocks.  A handler that calls WSSimRun() spends that long running, and
+// handlers of a more urgent priority preempt it meanwhile.
+//
+// Build with -Isim -include wssim.h so this header also reaches
+// WS2812_cycles.h, whose DWT counter then reads the simulated clock.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+//
+// Register access.  Registers are kept in a small table, and the simulation
+// reads the SSI dividers and the uDMA enable set register from it.
+//
+//*****************************************************************************
+extern volatile uint32_t *WSSimReg(uint32_t ui32Addr);
+
+#define HWREG(x)                (*WSSimReg(x))
+#define WS_CYCLES_REG(x)        (*WSSimReg(x))
+
+//
+// Memory map
+//
+#define SSI0_BASE               0x40008000
+#define SSI1_BASE               0x40009000
+#define SSI2_BASE               0x4000A000
+#define SSI3_BASE               0x4000B000
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define GPIO_PORTD_BASE         0x40007000
+#define GPIO_PORTF_BASE         0x40025000
+#define UDMA_ENASET             0x400FF028
+#define WSSIM_DWT_CYCCNT        0xE0001004
+
+//
+// SSI registers and bits
+//
+#define SSI_O_CR0               0x00000000
+#define SSI_O_CR1               0x00000004
+#define SSI_O_DR                0x00000008
+#define SSI_O_SR                0x0000000C
+#define SSI_O_CPSR              0x00000010
+#define SSI_CR0_SCR_M           0x0000FF00
+#define SSI_CR0_SCR_S           8
+#define SSI_CR0_DSS_M           0x0000000F
+#define SSI_CR1_EOT             0x00000010
+#define SSI_FRF_MOTO_MODE_0     0x00000000
+#define SSI_MODE_MASTER         0x00000000
+#define SSI_DMA_TX              0x00000002
+#define SSI_TXFF                0x00000008
+
+//
+// Interrupts
+//
+#define FAULT_PENDSV            14
+#define INT_SSI0                23
+#define INT_SSI1                50
+#define INT_UDMAERR             63
+#define INT_SSI2                73
+#define INT_SSI3                74
+#define WSSIM_NUM_INTS          140
+
+//
+// Peripherals
+//
+#define SYSCTL_PERIPH_GPIOA     0xF0000800
+#define SYSCTL_PERIPH_GPIOB     0xF0000801
+#define SYSCTL_PERIPH_GPIOD     0xF0000803
+#define SYSCTL_PERIPH_GPIOF     0xF0000805
+#define SYSCTL_PERIPH_UDMA      0xF0000C00
+#define SYSCTL_PERIPH_SSI0      0xF0001C00
+#define SYSCTL_PERIPH_SSI1      0xF0001C01
+#define SYSCTL_PERIPH_SSI2      0xF0001C02
+#define SYSCTL_PERIPH_SSI3      0xF0001C03
+
+//
+// Pins
+//
+#define GPIO_PIN_1              0x00000002
+#define GPIO_PIN_3              0x00000008
+#define GPIO_PIN_5              0x00000020
+#define GPIO_PIN_7              0x00000080
+#define GPIO_PA5_SSI0TX         0x00001402
+#define GPIO_PB7_SSI2TX         0x00011C02
+#define GPIO_PD3_SSI3TX         0x00030C01
+#define GPIO_PF1_SSI1TX         0x00050402
+
+//
+// uDMA channels, structures, control words, modes and attributes
+//
+#define UDMA_CHANNEL_SSI0TX     11
+#define UDMA_CHANNEL_SSI1TX     25
+#define UDMA_CH11_SSI0TX        0x0000000B
+#define UDMA_CH25_SSI1TX        0x00000019
+#define UDMA_CH13_SSI2TX        0x0002000D
+#define UDMA_CH15_SSI3TX        0x0002000F
+#define UDMA_PRI_SELECT         0x00000000
+#define UDMA_ALT_SELECT         0x00000020
+#define UDMA_SIZE_8             0x00000000
+#define UDMA_SRC_INC_8          0x00000000
+#define UDMA_SRC_INC_NONE       0x0C000000
+#define UDMA_DST_INC_NONE       0xC0000000
+#define UDMA_ARB_1              0x00000000
+#define UDMA_ARB_2              0x00004000
+#define UDMA_ARB_4              0x00008000
+#define UDMA_ARB_8              0x0000C000
+#define UDMA_ARB_16             0x00010000
+#define UDMA_ARB_32             0x00014000
+#define UDMA_ARB_64             0x00018000
+#define UDMA_ARB_128            0x0001C000
+#define UDMA_ARB_256            0x00020000
+#define UDMA_ARB_512            0x00024000
+#define UDMA_ARB_1024           0x00028000
+#define UDMA_MODE_STOP          0x00000000
+#define UDMA_MODE_BASIC         0x00000001
+#define UDMA_MODE_PINGPONG      0x00000003
+#define UDMA_ATTR_USEBURST      0x00000001
+#define UDMA_ATTR_ALTSELECT     0x00000002
+#define UDMA_ATTR_HIGH_PRIORITY 0x00000004
+#define UDMA_ATTR_REQMASK       0x00000008
+#define WSSIM_NUM_CHANNELS      32
+
+//*****************************************************************************
+//
+// The driverlib functions the drivers call.  The ROM versions are the same
+// functions.
+//
+//*****************************************************************************
+extern uint32_t SysCtlClockGet(void);
+extern void SysCtlPeripheralEnable(uint32_t ui32Periph);
+extern void SysCtlPeripheralSleepEnable(uint32_t ui32Periph);
+extern void GPIOPinConfigure(uint32_t ui32PinConfig);
+extern void GPIOPinTypeSSI(uint32_t ui32Port, uint8_t ui8Pins);
+extern void IntEnable(uint32_t ui32Int);
+extern void IntDisable(uint32_t ui32Int);
+extern void IntPendSet(uint32_t ui32Int);
+extern void IntPrioritySet(uint32_t ui32Int, uint8_t ui8Priority);
+extern bool IntMasterEnable(void);
+extern bool IntMasterDisable(void);
+extern void SSIConfigSetExpClk(uint32_t ui32Base, uint32_t ui32SSIClk,
+                               uint32_t ui32Protocol, uint32_t ui32Mode,
+                               uint32_t ui32BitRate, uint32_t ui32DataWidth);
+extern void SSIEnable(uint32_t ui32Base);
+extern void SSIDMAEnable(uint32_t ui32Base, uint32_t ui32DMAFlags);
+extern void SSIIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern void SSIIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern uint32_t SSIIntStatus(uint32_t ui32Base, bool bMasked);
+extern void SSIIntClear(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern void uDMAEnable(void);
+extern void uDMAControlBaseSet(void *pvControlTable);
+extern uint32_t uDMAErrorStatusGet(void);
+extern void uDMAErrorStatusClear(void);
+extern void uDMAChannelAssign(uint32_t ui32Mapping);
+extern void uDMAChannelAttributeEnable(uint32_t ui32Channel,
+                                       uint32_t ui32Attr);
+extern void uDMAChannelAttributeDisable(uint32_t ui32Channel,
+                                        uint32_t ui32Attr);
+extern void uDMAChannelControlSet(uint32_t ui32ChannelStructIndex,
+                                  uint32_t ui32Control);
+extern void uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex,
+                                   uint32_t ui32Mode, void *pvSrcAddr,
+                                   void *pvDstAddr, uint32_t ui32TransferSize);
+extern void uDMAChannelEnable(uint32_t ui32Channel);
+extern bool uDMAChannelIsEnabled(uint32_t ui32Channel);
+extern uint32_t uDMAChannelModeGet(uint32_t ui32ChannelStructIndex);
+
+#define ROM_SysCtlClockGet              SysCtlClockGet
+#define ROM_SysCtlPeripheralEnable      SysCtlPeripheralEnable
+#define ROM_SysCtlPeripheralSleepEnable SysCtlPeripheralSleepEnable
+#define ROM_IntEnable                   IntEnable
+#define ROM_IntDisable                  IntDisable
+#define ROM_IntPendSet                  IntPendSet
+#define ROM_IntPrioritySet              IntPrioritySet
+#define ROM_IntMasterEnable             IntMasterEnable
+#define ROM_IntMasterDisable            IntMasterDisable
+#define ROM_SSIConfigSetExpClk          SSIConfigSetExpClk
+#define ROM_SSIEnable                   SSIEnable
+#define ROM_SSIDMAEnable                SSIDMAEnable
+#define ROM_SSIIntEnable                SSIIntEnable
+#define ROM_SSIIntDisable               SSIIntDisable
+#define ROM_SSIIntStatus                SSIIntStatus
+#define ROM_SSIIntClear                 SSIIntClear
+#define ROM_uDMAEnable                  uDMAEnable
+#define ROM_uDMAControlBaseSet          uDMAControlBaseSet
+#define ROM_uDMAErrorStatusGet          uDMAErrorStatusGet
+#define ROM_uDMAChannelAssign           uDMAChannelAssign
+#define ROM_uDMAChannelAttributeEnable  uDMAChannelAttributeEnable
+#define ROM_uDMAChannelAttributeDisable uDMAChannelAttributeDisable
+#define ROM_uDMAChannelControlSet       uDMAChannelControlSet
+#define ROM_uDMAChannelTransferSet      uDMAChannelTransferSet
+#define ROM_uDMAChannelEnable           uDMAChannelEnable
+#define ROM_uDMAChannelIsEnabled        uDMAChannelIsEnabled
+#define ROM_uDMAChannelModeGet          uDMAChannelModeGet
+
+//*****************************************************************************
+//
+// Everything one SSI has sent: each frame and the clock it started on.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t *pui8Data;
+    uint64_t *pui64Start;
+    uint32_t ui32Len;
+    uint32_t ui32Cap;
+
+    //
+    // Clocks per frame of the last frame sent
+    //
+    uint32_t ui32FrameCycles;
+
+    //
+    // Frames written by the uDMA controller into a full FIFO, and so lost
+    //
+    uint32_t ui32Overflows;
+}
+tWSSimWire;
+
+//*****************************************************************************
+//
+// Simulation parameters
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // System clock in Hz
+    //
+    uint32_t ui32Clock;
+
+    //
+    // Bus clocks the uDMA controller takes per item moved
+    //
+    uint32_t ui32DMACycles;
+
+    //
+    // Clocks from an interrupt being raised to its handler starting, and
+    // clocks the handler keeps the processor busy
+    //
+    uint32_t ui32ISRLatency;
+    uint32_t ui32ISRCycles;
+}
+tWSSimConfig;
+
+//*****************************************************************************
+//
+// Simulation control
+//
+//*****************************************************************************
+extern void WSSimReset(const tWSSimConfig *psConfig);
+extern void WSSimIntRegister(uint32_t ui32Int, void (*pfnHandler)(void));
+extern void WSSimHogAdd(uint32_t ui32Channel, uint32_t ui32Arb,
+                        bool bHighPriority);
+extern void WSSimRun(uint64_t ui64Cycles);
+extern uint64_t WSSimNow(void);
+extern tWSSimWire *WSSimWireGet(uint32_t ui32SSI);
+extern void WSSimWireClear(uint32_t ui32SSI);
+extern uint32_t WSSimFaultsGet(void);
+
+#endif // __WSSIM_H__
@@ -0,0 +1,308 @@
+//*****************************************************************************
+//
+// test_anim - round trip raw frames through tools/wsanim and the playback
+// decoder, with the decode time per frame.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_drv.h"
+#include "WS2812_anim.h"
+#include "wstest.h"
+
+#define NUM_LED                 300
+#define NUM_FRAMES              120
+#define BENCH_LOOPS             200
+
+#define RAW_FILE                "test_anim.raw"
+#define ANIM_FILE               "test_anim.wsa"
+
+static uint8_t g_pui8Raw[NUM_FRAMES][NUM_LED][3];
+static uint8_t g_pui8Colors[NUM_LED][3];
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPIRef[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t *g_pui8Anim;
+static uint32_t g_ui32AnimSize;
+
+//*****************************************************************************
+//
+// Frames with the usual mix of content: a comet over a background that
+// changes colour now and then, a few sparkles, and an occasional frame of
+// noise that no delta can beat.
+//
+//*****************************************************************************
+static void
+makeFrames(void)
+{
+    uint32_t ui32F;
+    uint32_t ui32I;
+    uint32_t ui32Head;
+    uint8_t pui8Back[3];
+
+    for(ui32F = 0; ui32F < NUM_FRAMES; ui32F++)
+    {
+        if((ui32F % 30) == 0)
+        {
+            pui8Back[0] = WSTestRand();
+            pui8Back[1] = WSTestRand();
+            pui8Back[2] = WSTestRand();
+        }
+
+        for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+        {
+            memcpy(g_pui8Raw[ui32F][ui32I], pui8Back, 3);
+        }
+
+        ui32Head = (ui32F * 3) % NUM_LED;
+        for(ui32I = 0; (ui32I < 12) && (ui32I <= ui32Head); ui32I++)
+        {
+            g_pui8Raw[ui32F][ui32Head - ui32I][0] = 255 - (ui32I * 20);
+            g_pui8Raw[ui32F][ui32Head - ui32I][1] = 255 - (ui32I * 20);
+            g_pui8Raw[ui32F][ui32Head - ui32I][2] = 255;
+        }
+
+        for(ui32I = 0; ui32I < 4; ui32I++)
+        {
+            memset(g_pui8Raw[ui32F][WSTestRand() % NUM_LED], 0xFF, 3);
+        }
+
+        if((ui32F % 45) == 44)
+        {
+            for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+            {
+                g_pui8Raw[ui32F][ui32I][0] = WSTestRand();
+                g_pui8Raw[ui32F][ui32I][1] = WSTestRand();
+                g_pui8Raw[ui32F][ui32I][2] = WSTestRand();
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Write the raw frames, run the converter and read its output back.
+//
+//*****************************************************************************
+static bool
+convert(const char *pcOptions)
+{
+    char pcCmd[256];
+    FILE *psFile;
+    long lSize;
+
+    psFile = fopen(RAW_FILE, "wb");
+    if(!psFile)
+    {
+        return(false);
+    }
+    fwrite(g_pui8Raw, 1, sizeof(g_pui8Raw), psFile);
+    fclose(psFile);
+
+    snprintf(pcCmd, sizeof(pcCmd), "./wsanim %s %d 20 %s %s", pcOptions,
+             NUM_LED, RAW_FILE, ANIM_FILE);
+    if(system(pcCmd))
+    {
+        return(false);
+    }
+
+    psFile = fopen(ANIM_FILE, "rb");
+    if(!psFile)
+    {
+        return(false);
+    }
+    fseek(psFile, 0, SEEK_END);
+    lSize = ftell(psFile);
+    fseek(psFile, 0, SEEK_SET);
+    free(g_pui8Anim);
+    g_pui8Anim = malloc(lSize);
+    g_ui32AnimSize = fread(g_pui8Anim, 1, lSize, psFile);
+    fclose(psFile);
+
+    remove(RAW_FILE);
+    remove(ANIM_FILE);
+
+    return(g_ui32AnimSize == (uint32_t)lSize);
+}
+
+static void
+encodeAll(uint8_t *pui8SPI)
+{
+    uint32_t ui32I;
+
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        WSGRBtoSPI(pui8SPI + (ui32I * WS2812_SPI_LED_SIZE),
+                   g_pui8Colors[ui32I][0], g_pui8Colors[ui32I][1],
+                   g_pui8Colors[ui32I][2]);
+    }
+}
+
+//*****************************************************************************
+//
+// Play the animation twice over, checking every frame, that the spans cover
+// every changed LED, and that encoding only the spans keeps the SPI array in
+// step with a full encode.
+//
+//*****************************************************************************
+static void
+checkPlayback(void)
+{
+    uint8_t pui8Prev[NUM_LED][3];
+    tWSAnim sAnim;
+    uint32_t ui32F;
+    uint32_t ui32I;
+    uint32_t ui32S;
+    uint32_t ui32Spans;
+    bool bCovered;
+
+    WS_CHECK(WSAnimInit(&sAnim, g_pui8Anim, g_ui32AnimSize));
+    WS_CHECK(sAnim.ui16NumLED == NUM_LED);
+    WS_CHECK(sAnim.ui16NumFrames == NUM_FRAMES);
+    WS_CHECK(sAnim.ui16PeriodMs == 20);
+
+    memset(g_pui8Colors, 0, sizeof(g_pui8Colors));
+    encodeAll(g_pui8SPI);
+
+    for(ui32F = 0; ui32F < (2 * NUM_FRAMES); ui32F++)
+    {
+        memcpy(pui8Prev, g_pui8Colors, sizeof(pui8Prev));
+
+        ui32Spans = WSAnimNextFrame(&sAnim, g_pui8Colors);
+        WS_CHECK(ui32Spans != WS_ANIM_ERROR);
+        if(ui32Spans == WS_ANIM_ERROR)
+        {
+            return;
+        }
+        WS_CHECK(!memcmp(g_pui8Colors, g_pui8Raw[ui32F % NUM_FRAMES],
+                         sizeof(g_pui8Colors)));
+
+        for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+        {
+            if(!memcmp(pui8Prev[ui32I], g_pui8Colors[ui32I], 3))
+            {
+                continue;
+            }
+            bCovered = false;
+            for(ui32S = 0; ui32S < ui32Spans; ui32S++)
+            {
+                if((ui32I >= sAnim.psSpans[ui32S].ui16First) &&
+                   (ui32I < (uint32_t)(sAnim.psSpans[ui32S].ui16First +
+                                       sAnim.psSpans[ui32S].ui16Count)))
+                {
+                    bCovered = true;
+                }
+            }
+            WS_CHECK(bCovered);
+        }
+
+        WSAnimEncodeChanged(&sAnim, (const uint8_t (*)[3])g_pui8Colors,
+                            g_pui8SPI);
+        encodeAll(g_pui8SPIRef);
+        WS_CHECK(!memcmp(g_pui8SPI, g_pui8SPIRef, sizeof(g_pui8SPI)));
+    }
+}
+
+//*****************************************************************************
+//
+// Cut the data short at every length and make sure decoding stops with an
+// error instead of reading past the end.
+//
+//*****************************************************************************
+static void
+checkTruncated(void)
+{
+    tWSAnim sAnim;
+    uint8_t *pui8Copy;
+    uint32_t ui32Len;
+    uint32_t ui32F;
+    uint32_t ui32Ret;
+
+    WS_CHECK(!WSAnimInit(&sAnim, (const uint8_t *)"WSA2", 4));
+
+    for(ui32Len = WS_ANIM_HDR_SIZE; ui32Len < g_ui32AnimSize; ui32Len += 7)
+    {
+        //
+        // A copy of exactly the truncated length, so a read past the end
+        // would show up under a memory checker.
+        //
+        pui8Copy = malloc(ui32Len);
+        memcpy(pui8Copy, g_pui8Anim, ui32Len);
+        WS_CHECK(WSAnimInit(&sAnim, pui8Copy, ui32Len));
+
+        ui32Ret = 0;
+        for(ui32F = 0; ui32F < NUM_FRAMES; ui32F++)
+        {
+            ui32Ret = WSAnimNextFrame(&sAnim, g_pui8Colors);
+            if(ui32Ret == WS_ANIM_ERROR)
+            {
+                break;
+            }
+        }
+        WS_CHECK(ui32Ret == WS_ANIM_ERROR);
+        free(pui8Copy);
+    }
+}
+
+//*****************************************************************************
+//
+// Time the decode of every frame of the animation, without the encode.
+//
+//*****************************************************************************
+static void
+bench(const char *pcName)
+{
+    tWSAnim sAnim;
+    uint64_t ui64Cycles;
+    uint64_t ui64Ns;
+    uint32_t ui32F;
+
+    WSAnimInit(&sAnim, g_pui8Anim, g_ui32AnimSize);
+
+    ui64Cycles = WSTestCycles();
+    ui64Ns = WSTestNs();
+    for(ui32F = 0; ui32F < (BENCH_LOOPS * NUM_FRAMES); ui32F++)
+    {
+        WSAnimNextFrame(&sAnim, g_pui8Colors);
+    }
+    ui64Ns = WSTestNs() - ui64Ns;
+    ui64Cycles = WSTestCycles() - ui64Cycles;
+
+    printf("%-14s %6u bytes (raw %u)  %7.1f ns  %7.0f cycles per frame\n",
+           pcName, g_ui32AnimSize, (uint32_t)sizeof(g_pui8Raw),
+           (double)ui64Ns / (BENCH_LOOPS * NUM_FRAMES),
+           (double)ui64Cycles / (BENCH_LOOPS * NUM_FRAMES));
+}
+
+int
+main(int argc, char *argv[])
+{
+    makeFrames();
+
+    WS_CHECK(convert(""));
+    if(g_ui32AnimSize)
+    {
+        checkPlayback();
+        checkTruncated();
+        if(WSTestBench(argc, argv))
+        {
+            bench("deltas");
+        }
+    }
+
+    WS_CHECK(convert("-k 10"));
+    if(g_ui32AnimSize)
+    {
+        checkPlayback();
+        if(WSTestBench(argc, argv))
+        {
+            bench("key every 10");
+        }
+    }
+
+    free(g_pui8Anim);
+
+    return(WSTestDone("test_anim"));
+}
@@ -0,0 +1,228 @@
+//*****************************************************************************
+//
+// test_blend - packed byte helpers and framebuffer blending, with a
+// benchmark of 1000 LED blends.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_drv.h"
+#include "WS2812_blend.h"
+#include "WS2812_simd.h"
+#include "wstest.h"
+
+//
+// Odd so the byte at a time tail of each loop is covered
+//
+#define NUM_LED                 1001
+#define BENCH_LED               1000
+#define BENCH_REPS              2000
+
+static uint8_t g_pui8A[NUM_LED][3];
+static uint8_t g_pui8B[NUM_LED][3];
+static uint8_t g_pui8Dst[NUM_LED][3];
+static uint8_t g_pui8Alpha[NUM_LED];
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPIRef[NUM_LED * WS2812_SPI_LED_SIZE];
+
+static uint32_t
+refLerp(uint32_t ui32A, uint32_t ui32B, uint32_t ui32W)
+{
+    return(((ui32A * (255 - ui32W)) + (ui32B * ui32W) + 127) / 255);
+}
+
+//*****************************************************************************
+//
+// Check the packed helpers on every pair of byte values, in every lane.
+//
+//*****************************************************************************
+static void
+checkPacked(void)
+{
+    uint32_t ui32A;
+    uint32_t ui32B;
+    uint32_t ui32X;
+    uint32_t ui32Y;
+    uint32_t ui32W;
+    uint32_t ui32Add;
+    uint32_t ui32Sub;
+    uint32_t ui32Lerp;
+    uint32_t ui32Scale;
+    int k;
+
+    for(ui32X = 0; ui32X < 256; ui32X++)
+    {
+        for(ui32Y = 0; ui32Y < 256; ui32Y++)
+        {
+            //
+            // Put the pair in one lane and other values in the rest so
+            // carries between lanes would show up.
+            //
+            k = (ui32X + ui32Y) & 3;
+            ui32A = (WSTestRand() & ~(0xFFu << (k * 8))) | (ui32X << (k * 8));
+            ui32B = (WSTestRand() & ~(0xFFu << (k * 8))) | (ui32Y << (k * 8));
+            ui32W = WSTestRand() & 0xFF;
+
+            ui32Add = (WSQAdd8x4(ui32A, ui32B) >> (k * 8)) & 0xFF;
+            ui32Sub = (WSQSub8x4(ui32A, ui32B) >> (k * 8)) & 0xFF;
+            ui32Lerp = (WSLerp8x4(ui32A, ui32B, ui32W) >> (k * 8)) & 0xFF;
+            ui32Scale = (WSScale8x4(ui32A, ui32Y + 1) >> (k * 8)) & 0xFF;
+
+            WS_CHECK(ui32Add == ((ui32X + ui32Y > 255) ? 255 :
+                                 (ui32X + ui32Y)));
+            WS_CHECK(ui32Sub == ((ui32X > ui32Y) ? (ui32X - ui32Y) : 0));
+            WS_CHECK(ui32Lerp == refLerp(ui32X, ui32Y, ui32W));
+            WS_CHECK(ui32Scale == ((ui32X * (ui32Y + 1)) >> 8));
+        }
+    }
+}
+
+static void
+checkBlend(void)
+{
+    uint32_t ui32W;
+    int i;
+    int c;
+
+    for(ui32W = 0; ui32W < 256; ui32W += 15)
+    {
+        WSBlendLerp(g_pui8Dst, g_pui8A, g_pui8B, NUM_LED, ui32W);
+        for(i = 0; i < NUM_LED; i++)
+        {
+            for(c = 0; c < 3; c++)
+            {
+                WS_CHECK(g_pui8Dst[i][c] ==
+                         refLerp(g_pui8A[i][c], g_pui8B[i][c], ui32W));
+            }
+            WSGRBtoSPI(g_pui8SPIRef + (i * WS2812_SPI_LED_SIZE),
+                       g_pui8Dst[i][0], g_pui8Dst[i][1], g_pui8Dst[i][2]);
+        }
+
+        WSBlendLerpEncode(g_pui8SPI, g_pui8A, g_pui8B, NUM_LED, ui32W);
+        WS_CHECK(!memcmp(g_pui8SPI, g_pui8SPIRef, sizeof(g_pui8SPI)));
+    }
+
+    WSBlendAdd(g_pui8Dst, g_pui8A, g_pui8B, NUM_LED);
+    for(i = 0; i < NUM_LED; i++)
+    {
+        for(c = 0; c < 3; c++)
+        {
+            WS_CHECK(g_pui8Dst[i][c] ==
+                     ((g_pui8A[i][c] + g_pui8B[i][c] > 255) ? 255 :
+                      (g_pui8A[i][c] + g_pui8B[i][c])));
+        }
+    }
+
+    WSBlendMultiply(g_pui8Dst, g_pui8A, g_pui8B, NUM_LED);
+    for(i = 0; i < NUM_LED; i++)
+    {
+        for(c = 0; c < 3; c++)
+        {
+            WS_CHECK(g_pui8Dst[i][c] ==
+                     ((g_pui8A[i][c] * g_pui8B[i][c]) + 127) / 255);
+        }
+    }
+
+    WSBlendAlpha(g_pui8Dst, g_pui8A, g_pui8B, g_pui8Alpha, NUM_LED);
+    for(i = 0; i < NUM_LED; i++)
+    {
+        for(c = 0; c < 3; c++)
+        {
+            WS_CHECK(g_pui8Dst[i][c] ==
+                     refLerp(g_pui8A[i][c], g_pui8B[i][c], g_pui8Alpha[i]));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Time BENCH_REPS blends of BENCH_LED LEDs.  The weight changes each time so
+// nothing can be hoisted out of the loop.
+//
+//*****************************************************************************
+static void
+bench(const char *pcName, int iOp)
+{
+    uint64_t ui64Ns;
+    uint64_t ui64Cycles;
+    int iRep;
+    int i;
+
+    ui64Ns = WSTestNs();
+    ui64Cycles = WSTestCycles();
+
+    for(iRep = 0; iRep < BENCH_REPS; iRep++)
+    {
+        switch(iOp)
+        {
+            case 0:
+                WSBlendLerp(g_pui8Dst, g_pui8A, g_pui8B, BENCH_LED, iRep);
+                break;
+            case 1:
+                WSBlendAdd(g_pui8Dst, g_pui8A, g_pui8B, BENCH_LED);
+                break;
+            case 2:
+                WSBlendMultiply(g_pui8Dst, g_pui8A, g_pui8B, BENCH_LED);
+                break;
+            case 3:
+                WSBlendAlpha(g_pui8Dst, g_pui8A, g_pui8B, g_pui8Alpha,
+                             BENCH_LED);
+                break;
+            case 4:
+                WSBlendLerpEncode(g_pui8SPI, g_pui8A, g_pui8B, BENCH_LED,
+                                  iRep);
+                break;
+            default:
+                WSBlendLerp(g_pui8Dst, g_pui8A, g_pui8B, BENCH_LED, iRep);
+                for(i = 0; i < BENCH_LED; i++)
+                {
+                    WSGRBtoSPI(g_pui8SPI + (i * WS2812_SPI_LED_SIZE),
+                               g_pui8Dst[i][0], g_pui8Dst[i][1],
+                               g_pui8Dst[i][2]);
+                }
+                break;
+        }
+    }
+
+    ui64Cycles = WSTestCycles() - ui64Cycles;
+    ui64Ns = WSTestNs() - ui64Ns;
+
+    printf("%-24s %8.2f us per %d LEDs, %6.2f cycles per LED\n", pcName,
+           (double)ui64Ns / (1000.0 * BENCH_REPS), BENCH_LED,
+           (double)ui64Cycles / ((double)BENCH_REPS * BENCH_LED));
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i;
+    int c;
+
+    for(i = 0; i < NUM_LED; i++)
+    {
+        for(c = 0; c < 3; c++)
+        {
+            g_pui8A[i][c] = WSTestRand();
+            g_pui8B[i][c] = WSTestRand();
+        }
+        g_pui8Alpha[i] = WSTestRand();
+    }
+
+    checkPacked();
+    checkBlend();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench("lerp", 0);
+        bench("add", 1);
+        bench("multiply", 2);
+        bench("alpha", 3);
+        bench("lerp + encode, fused", 4);
+        bench("lerp, then encode", 5);
+    }
+
+    return(WSTestDone("test_blend"));
+}
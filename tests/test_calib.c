@@ -0,0 +1,355 @@
+//*****************************************************************************
+//
+// test_calib - per-LED calibration against applying the gains by hand, in
+// order, after seeks and past the end of the table, with a benchmark of the
+// cycles the gains add per LED as read through WSCycles().
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "wstest.h"
+
+//
+// WSCycles() reads the DWT registers through WS_CYCLES_REG().  On the host
+// the cycle count register reads the time stamp counter instead.
+//
+static volatile uint32_t *hostReg(uint32_t ui32Addr);
+#define WS_CYCLES_REG(ui32Addr) (*hostReg(ui32Addr))
+
+#include "WS2812_drv.h"
+#include "WS2812_cycles.h"
+#include "WS2812_calib.h"
+
+#define NUM_LED                 500
+#define NUM_RUNS                5
+
+//
+// The benchmark repeats each encode and keeps the fastest
+//
+#define BENCH_REPS              200
+
+static const tWSCalibRun g_psRuns[NUM_RUNS] =
+{
+    { 120, { 255, 230, 240 } },
+    { 0, { 0, 0, 0 } },
+    { 80, { 200, 255, 180 } },
+    { 150, { 128, 64, 255 } },
+    { 100, { 0, 255, 17 } },
+};
+#define TABLE_LED               (120 + 80 + 150 + 100)
+
+static uint8_t g_pui8Colors[NUM_LED][3];
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPIRef[NUM_LED * WS2812_SPI_LED_SIZE];
+
+//*****************************************************************************
+//
+// The DWT registers, with the cycle count taken from the time stamp counter
+// whenever it is read.
+//
+//*****************************************************************************
+static volatile uint32_t *
+hostReg(uint32_t ui32Addr)
+{
+    static volatile uint32_t pui32Reg[3];
+
+    switch(ui32Addr)
+    {
+        case WS_CYCLES_DEMCR:
+            return(&pui32Reg[0]);
+
+        case WS_CYCLES_DWT_CTRL:
+            return(&pui32Reg[1]);
+
+        default:
+            pui32Reg[2] = (uint32_t)WSTestCycles();
+            return(&pui32Reg[2]);
+    }
+}
+
+//*****************************************************************************
+//
+// The gains of an LED, walking the table the slow way.
+//
+//*****************************************************************************
+static const uint8_t *
+refGain(uint16_t ui16LED)
+{
+    static const uint8_t pui8Unity[3] = { 255, 255, 255 };
+    uint32_t ui32R;
+
+    for(ui32R = 0; ui32R < NUM_RUNS; ui32R++)
+    {
+        if(ui16LED < g_psRuns[ui32R].ui16Count)
+        {
+            return(g_psRuns[ui32R].pui8Gain);
+        }
+        ui16LED -= g_psRuns[ui32R].ui16Count;
+    }
+    return(pui8Unity);
+}
+
+//*****************************************************************************
+//
+// Encode LEDs ui16First onwards into the reference array with the gains
+// applied by hand.
+//
+//*****************************************************************************
+static void
+refEncode(uint16_t ui16First, uint16_t ui16Count)
+{
+    const uint8_t *pui8Gain;
+    uint32_t ui32I;
+    uint32_t ui32C;
+    uint8_t pui8Color[3];
+
+    for(ui32I = ui16First; ui32I < ((uint32_t)ui16First + ui16Count);
+        ui32I++)
+    {
+        pui8Gain = refGain(ui32I);
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            pui8Color[ui32C] = (g_pui8Colors[ui32I][ui32C] *
+                                (pui8Gain[ui32C] + 1)) / 256;
+        }
+        WSGRBtoSPI(g_pui8SPIRef + (ui32I * WS2812_SPI_LED_SIZE),
+                   pui8Color[0], pui8Color[1], pui8Color[2]);
+    }
+}
+
+//*****************************************************************************
+//
+// The whole strip in one go, then in pieces that run in order, jump back
+// and skip ahead, matches the gains applied by hand; LEDs past the table are
+// left as they are.  Setting LEDs one at a time does the same.
+//
+//*****************************************************************************
+static void
+checkEncode(void)
+{
+    static const uint16_t pui16Piece[][2] =
+    {
+        { 0, 7 }, { 7, 113 }, { 120, 1 }, { 300, 60 }, { 5, 300 },
+        { 449, 2 }, { 451, 49 }, { 200, 0 }, { 199, 2 }
+    };
+    tWSCalib sCalib;
+    uint32_t ui32I;
+
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        g_pui8Colors[ui32I][0] = WSTestRand();
+        g_pui8Colors[ui32I][1] = WSTestRand();
+        g_pui8Colors[ui32I][2] = WSTestRand();
+    }
+    refEncode(0, NUM_LED);
+
+    WSCalibInit(&sCalib, g_psRuns, NUM_RUNS);
+    WSCalibEncode(&sCalib, (const uint8_t (*)[3])g_pui8Colors, g_pui8SPI, 0,
+                  NUM_LED);
+    WS_CHECK(!memcmp(g_pui8SPI, g_pui8SPIRef, sizeof(g_pui8SPI)));
+    WS_CHECK(sCalib.ui16LED == NUM_LED);
+
+    for(ui32I = 0; ui32I < (sizeof(pui16Piece) / sizeof(pui16Piece[0]));
+        ui32I++)
+    {
+        memset(g_pui8SPI, 0, sizeof(g_pui8SPI));
+        WSCalibEncode(&sCalib, (const uint8_t (*)[3])g_pui8Colors, g_pui8SPI,
+                      pui16Piece[ui32I][0], pui16Piece[ui32I][1]);
+        WS_CHECK(!memcmp(g_pui8SPI + (pui16Piece[ui32I][0] *
+                                      WS2812_SPI_LED_SIZE),
+                         g_pui8SPIRef + (pui16Piece[ui32I][0] *
+                                         WS2812_SPI_LED_SIZE),
+                         pui16Piece[ui32I][1] * WS2812_SPI_LED_SIZE));
+        WS_CHECK(sCalib.ui16LED ==
+                 (pui16Piece[ui32I][0] + pui16Piece[ui32I][1]));
+    }
+
+    memset(g_pui8SPI, 0, sizeof(g_pui8SPI));
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        WSCalibSetLEDColors(&sCalib, g_pui8SPI, ui32I, g_pui8Colors[ui32I][0],
+                            g_pui8Colors[ui32I][1], g_pui8Colors[ui32I][2]);
+    }
+    WS_CHECK(!memcmp(g_pui8SPI, g_pui8SPIRef, sizeof(g_pui8SPI)));
+
+    //
+    // Past the end of the table the colors go out unchanged
+    //
+    WSGRBtoSPI(g_pui8SPIRef, g_pui8Colors[TABLE_LED][0],
+               g_pui8Colors[TABLE_LED][1], g_pui8Colors[TABLE_LED][2]);
+    WS_CHECK(!memcmp(g_pui8SPI + (TABLE_LED * WS2812_SPI_LED_SIZE),
+                     g_pui8SPIRef, WS2812_SPI_LED_SIZE));
+}
+
+//*****************************************************************************
+//
+// The pipeline stage scales 16-bit pixels by the same gains, following the
+// LED index it is given.
+//
+//*****************************************************************************
+static void
+checkStage(void)
+{
+    static const uint16_t pui16In[3] = { 0xFFFF, 0x8000, 0x1234 };
+    const uint8_t *pui8Gain;
+    tWSCalib sCalib;
+    uint16_t pui16Pix[3];
+    uint32_t ui32I;
+    uint32_t ui32C;
+    uint16_t ui16LED;
+
+    WSCalibInit(&sCalib, g_psRuns, NUM_RUNS);
+    for(ui32I = 0; ui32I < 2000; ui32I++)
+    {
+        ui16LED = (ui32I < NUM_LED) ? ui32I : (WSTestRand() % NUM_LED);
+        memcpy(pui16Pix, pui16In, sizeof(pui16Pix));
+        WSStageCalib(&sCalib, pui16Pix, ui16LED);
+
+        pui8Gain = refGain(ui16LED);
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            WS_CHECK(pui16Pix[ui32C] ==
+                     ((pui16In[ui32C] * (pui8Gain[ui32C] + 1)) >> 8));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Compressing per-LED gains gives runs that cover every LED, with every LED
+// within the tolerance of its run, and refuses a table that's too small.
+//
+//*****************************************************************************
+static void
+checkCompress(void)
+{
+    static uint8_t pui8Gains[NUM_LED][3];
+    tWSCalibRun psRuns[NUM_LED];
+    tWSCalib sCalib;
+    const uint8_t *pui8Gain;
+    uint32_t ui32Total;
+    uint32_t ui32I;
+    uint32_t ui32C;
+    uint16_t ui16NumRuns;
+    int32_t i32Diff;
+
+    //
+    // Five batches, each with a little spread
+    //
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        pui8Gain = g_psRuns[(ui32I / 100) % NUM_RUNS].pui8Gain;
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            i32Diff = pui8Gain[ui32C] - 2 + (WSTestRand() % 5);
+            pui8Gains[ui32I][ui32C] = (i32Diff < 0) ? 0 :
+                                      (i32Diff > 255) ? 255 : i32Diff;
+        }
+    }
+
+    ui16NumRuns = WSCalibCompress((const uint8_t (*)[3])pui8Gains, NUM_LED, 4,
+                                  psRuns, NUM_LED);
+    WS_CHECK(ui16NumRuns == NUM_RUNS);
+
+    ui32Total = 0;
+    for(ui32I = 0; ui32I < ui16NumRuns; ui32I++)
+    {
+        ui32Total += psRuns[ui32I].ui16Count;
+    }
+    WS_CHECK(ui32Total == NUM_LED);
+
+    WSCalibInit(&sCalib, psRuns, ui16NumRuns);
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        pui8Gain = WSCalibNext(&sCalib);
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            i32Diff = (int32_t)pui8Gain[ui32C] - pui8Gains[ui32I][ui32C];
+            WS_CHECK((i32Diff <= 4) && (i32Diff >= -4));
+        }
+    }
+
+    WS_CHECK(WSCalibCompress((const uint8_t (*)[3])pui8Gains, NUM_LED, 4,
+                             psRuns, 4) == 0);
+    WS_CHECK(WSCalibCompress((const uint8_t (*)[3])pui8Gains, NUM_LED, 0,
+                             psRuns, NUM_LED) > 100);
+}
+
+//*****************************************************************************
+//
+// Cycles per LED for the strip encoded plain with WSGRBtoSPI() and with the
+// gains applied by WSCalibEncode(), the fastest of a few hundred runs each
+// read with WSCycles().  The difference is what calibration adds per LED.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static const char *ppcName[2] = { "WSGRBtoSPI", "WSCalibEncode" };
+    tWSCalib sCalib;
+    uint32_t pui32Best[2];
+    uint32_t ui32Cycles;
+    uint32_t ui32Rep;
+    uint32_t ui32Way;
+    uint32_t ui32I;
+
+    WSCyclesInit();
+    if(!WSCycles())
+    {
+        printf("no cycle counter on this host\n");
+        return;
+    }
+
+    WSCalibInit(&sCalib, g_psRuns, NUM_RUNS);
+    pui32Best[0] = pui32Best[1] = 0xFFFFFFFF;
+    for(ui32Rep = 0; ui32Rep < (2 * BENCH_REPS); ui32Rep++)
+    {
+        //
+        // Take turns, so both see the same state of the host
+        //
+        ui32Way = ui32Rep & 1;
+        ui32Cycles = WSCycles();
+        if(ui32Way)
+        {
+            WSCalibEncode(&sCalib, (const uint8_t (*)[3])g_pui8Colors,
+                          g_pui8SPI, 0, NUM_LED);
+        }
+        else
+        {
+            for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+            {
+                WSGRBtoSPI(g_pui8SPI + (ui32I * WS2812_SPI_LED_SIZE),
+                           g_pui8Colors[ui32I][0], g_pui8Colors[ui32I][1],
+                           g_pui8Colors[ui32I][2]);
+            }
+        }
+        ui32Cycles = WSCycles() - ui32Cycles;
+        pui32Best[ui32Way] = (ui32Cycles < pui32Best[ui32Way]) ?
+                             ui32Cycles : pui32Best[ui32Way];
+    }
+
+    for(ui32Way = 0; ui32Way < 2; ui32Way++)
+    {
+        printf("%-14s %7.1f cycles per LED\n", ppcName[ui32Way],
+               (double)pui32Best[ui32Way] / NUM_LED);
+    }
+    printf("calibration adds %5.1f cycles per LED\n",
+           ((double)pui32Best[1] - pui32Best[0]) / NUM_LED);
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkEncode();
+    checkStage();
+    checkCompress();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_calib"));
+}
@@ -0,0 +1,265 @@
+//*****************************************************************************
+//
+// test_color - the color math against the single value helpers applied to
+// each channel, on random spans of every length up to a few words, with a
+// benchmark of bytes per cycle for each span function.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+#include "WS2812_color.h"
+#include "wstest.h"
+
+#define MAX_LED                 40
+#define NUM_SPANS               20000
+
+//
+// The benchmark: a 500 LED framebuffer, each function run a few hundred
+// times keeping the fastest
+//
+#define BENCH_LED               500
+#define BENCH_REPS              500
+
+static uint8_t g_pui8Colors[MAX_LED + 1][3];
+static uint8_t g_pui8Ref[MAX_LED + 1][3];
+
+//*****************************************************************************
+//
+// The single value helpers against their definitions, for every input, and
+// the sine table against the formula it was built from.
+//
+//*****************************************************************************
+static void
+checkHelpers(void)
+{
+    uint32_t ui32A;
+    uint32_t ui32B;
+
+    for(ui32A = 0; ui32A < 256; ui32A++)
+    {
+        for(ui32B = 0; ui32B < 256; ui32B++)
+        {
+            WS_CHECK(WSScale8(ui32A, ui32B) == ((ui32A * (ui32B + 1)) / 256));
+            WS_CHECK(WSQAdd8(ui32A, ui32B) ==
+                     (((ui32A + ui32B) > 255) ? 255 : (ui32A + ui32B)));
+            WS_CHECK(WSQSub8(ui32A, ui32B) ==
+                     ((ui32A > ui32B) ? (ui32A - ui32B) : 0));
+        }
+        WS_CHECK(WSScale8(ui32A, 255) == ui32A);
+
+        WS_CHECK(WSSin8(ui32A) ==
+                 (uint8_t)floor(127.5 + 127.5 * sin(2 * M_PI * ui32A / 256) +
+                                0.5));
+        WS_CHECK(WSCos8(ui32A) == WSSin8((ui32A + 64) & 0xFF));
+    }
+}
+
+//*****************************************************************************
+//
+// Fill the first ui16NumLED LEDs with random colors, the odd one saturated,
+// and the LED after them with a guard that must survive.
+//
+//*****************************************************************************
+static void
+fillSpan(uint16_t ui16NumLED)
+{
+    uint32_t ui32I;
+    uint32_t ui32C;
+
+    for(ui32I = 0; ui32I <= ui16NumLED; ui32I++)
+    {
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            g_pui8Colors[ui32I][ui32C] = WSTestRand();
+            if(!(WSTestRand() % 8))
+            {
+                g_pui8Colors[ui32I][ui32C] = (WSTestRand() & 1) ? 255 : 0;
+            }
+        }
+    }
+    g_pui8Colors[ui16NumLED][0] = 0xA5;
+    g_pui8Colors[ui16NumLED][1] = 0x5A;
+    g_pui8Colors[ui16NumLED][2] = 0xC3;
+    memcpy(g_pui8Ref, g_pui8Colors, sizeof(g_pui8Ref));
+}
+
+//*****************************************************************************
+//
+// What a span function should leave in channel ui32C of LED ui32I, worked
+// out from the original colors with the single value helpers.
+//
+//*****************************************************************************
+static uint8_t
+refByte(uint8_t ui8Func, uint16_t ui16NumLED, uint32_t ui32I, uint32_t ui32C,
+        uint8_t ui8Amount, uint8_t ui8Add)
+{
+    uint8_t ui8Left;
+    uint8_t ui8Right;
+
+    switch(ui8Func)
+    {
+        case 0:
+            return(WSScale8(g_pui8Ref[ui32I][ui32C], ui8Amount));
+
+        case 1:
+            return(WSScale8(g_pui8Ref[ui32I][ui32C], 255 - ui8Amount));
+
+        case 2:
+            return(WSQAdd8(g_pui8Ref[ui32I][ui32C], ui8Add));
+
+        default:
+            ui8Left = ui32I ? g_pui8Ref[ui32I - 1][ui32C] : 0;
+            ui8Right = ((ui32I + 1) < ui16NumLED) ?
+                       g_pui8Ref[ui32I + 1][ui32C] : 0;
+            return(WSScale8(g_pui8Ref[ui32I][ui32C], 255 - ui8Amount) +
+                   WSScale8(ui8Left, ui8Amount >> 1) +
+                   WSScale8(ui8Right, ui8Amount >> 1));
+    }
+}
+
+//*****************************************************************************
+//
+// Each span function on random spans of 0 to 39 LEDs gives what the single
+// value helpers give channel by channel, and leaves the next LED alone.
+//
+//*****************************************************************************
+static void
+checkSpans(void)
+{
+    uint8_t pui8Add[3];
+    uint32_t ui32N;
+    uint32_t ui32I;
+    uint32_t ui32C;
+    uint16_t ui16NumLED;
+    uint8_t ui8Amount;
+    uint8_t ui8Func;
+
+    for(ui32N = 0; ui32N < NUM_SPANS; ui32N++)
+    {
+        ui16NumLED = ui32N % MAX_LED;
+        ui8Func = (ui32N / MAX_LED) % 4;
+        ui8Amount = WSTestRand();
+        if(!(WSTestRand() % 16))
+        {
+            ui8Amount = (WSTestRand() & 1) ? 255 : 0;
+        }
+        pui8Add[0] = WSTestRand();
+        pui8Add[1] = WSTestRand();
+        pui8Add[2] = WSTestRand();
+        fillSpan(ui16NumLED);
+
+        switch(ui8Func)
+        {
+            case 0:
+                WSColorNScale8(g_pui8Colors, ui16NumLED, ui8Amount);
+                break;
+
+            case 1:
+                WSColorFade(g_pui8Colors, ui16NumLED, ui8Amount);
+                break;
+
+            case 2:
+                WSColorQAdd(g_pui8Colors, ui16NumLED, pui8Add[0], pui8Add[1],
+                            pui8Add[2]);
+                break;
+
+            default:
+                WSColorBlur1D(g_pui8Colors, ui16NumLED, ui8Amount);
+                break;
+        }
+
+        for(ui32I = 0; ui32I < ui16NumLED; ui32I++)
+        {
+            for(ui32C = 0; ui32C < 3; ui32C++)
+            {
+                WS_CHECK(g_pui8Colors[ui32I][ui32C] ==
+                         refByte(ui8Func, ui16NumLED, ui32I, ui32C, ui8Amount,
+                                 pui8Add[ui32C]));
+            }
+        }
+        WS_CHECK(!memcmp(g_pui8Colors[ui16NumLED], g_pui8Ref[ui16NumLED], 3));
+    }
+}
+
+//*****************************************************************************
+//
+// Bytes per cycle for each span function over a 500 LED framebuffer, from
+// the fastest of a few hundred runs.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static uint8_t pui8Frame[BENCH_LED][3];
+    static const char *ppcName[4] =
+    {
+        "WSColorNScale8", "WSColorFade", "WSColorQAdd", "WSColorBlur1D"
+    };
+    uint64_t ui64Best;
+    uint64_t ui64Cycles;
+    uint32_t ui32Func;
+    uint32_t ui32Rep;
+    uint32_t ui32I;
+
+    if(!WSTestCycles())
+    {
+        printf("no cycle counter on this host\n");
+        return;
+    }
+
+    for(ui32I = 0; ui32I < BENCH_LED; ui32I++)
+    {
+        pui8Frame[ui32I][0] = WSTestRand();
+        pui8Frame[ui32I][1] = WSTestRand();
+        pui8Frame[ui32I][2] = WSTestRand();
+    }
+
+    printf("%u LEDs, %u bytes\n", BENCH_LED, BENCH_LED * 3);
+    for(ui32Func = 0; ui32Func < 4; ui32Func++)
+    {
+        ui64Best = ~(uint64_t)0;
+        for(ui32Rep = 0; ui32Rep < BENCH_REPS; ui32Rep++)
+        {
+            ui64Cycles = WSTestCycles();
+            switch(ui32Func)
+            {
+                case 0:
+                    WSColorNScale8(pui8Frame, BENCH_LED, 250);
+                    break;
+
+                case 1:
+                    WSColorFade(pui8Frame, BENCH_LED, 5);
+                    break;
+
+                case 2:
+                    WSColorQAdd(pui8Frame, BENCH_LED, 3, 2, 1);
+                    break;
+
+                default:
+                    WSColorBlur1D(pui8Frame, BENCH_LED, 64);
+                    break;
+            }
+            ui64Cycles = WSTestCycles() - ui64Cycles;
+            ui64Best = (ui64Cycles < ui64Best) ? ui64Cycles : ui64Best;
+        }
+        printf("%-14s %6.2f bytes/cycle, %7.0f cycles\n", ppcName[ui32Func],
+               (BENCH_LED * 3.0) / ui64Best, (double)ui64Best);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkHelpers();
+    checkSpans();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_color"));
+}
@@ -0,0 +1,489 @@
+//*****************************************************************************
+//
+// test_fft - the fixed-point FFT, bands and beat detector on sample files,
+// against a floating point transform, with the time per block.
+//
+// Sample files are what the ADC capture hands over: raw 12-bit samples,
+// 0 to 4095 around a mid-scale bias, one little-endian uint16_t each, at
+// SAMPLE_RATE.  Tone and drum recordings are made and played back from
+// files first; recordings given on the command line, after "bench" if it is
+// there, are then played back and summarized.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <math.h>
+#include "WS2812_fft.h"
+#include "wstest.h"
+
+#define SAMPLE_RATE             16000
+#define BLOCK_LOG2N             8
+#define BLOCK                   (1 << BLOCK_LOG2N)
+#define NUM_BANDS               8
+
+#define TONES_FILE              "test_fft_tones.raw"
+#define DRUMS_FILE              "test_fft_drums.raw"
+
+//
+// Tones sit in the middle of these bins, each held for TONE_BLOCKS blocks
+//
+static const uint16_t g_pui16ToneBins[] = { 2, 5, 9, 17, 30, 55, 90, 120 };
+#define NUM_TONES               (sizeof(g_pui16ToneBins) / sizeof(uint16_t))
+#define TONE_BLOCKS             4
+
+//
+// Kick drums at 120 beats per minute
+//
+#define DRUM_BEATS              16
+#define DRUM_PERIOD             (SAMPLE_RATE / 2)
+
+static int16_t g_pi16Re[1 << WS_FFT_LOG2N_MAX];
+static int16_t g_pi16Im[1 << WS_FFT_LOG2N_MAX];
+
+//*****************************************************************************
+//
+// Write samples to a file as the capture would have recorded them.
+//
+//*****************************************************************************
+static bool
+writeSamples(const char *pcFile, const double *pdSignal, uint32_t ui32Count)
+{
+    FILE *psFile;
+    uint32_t ui32I;
+    int32_t i32Val;
+    uint8_t pui8LE[2];
+
+    psFile = fopen(pcFile, "wb");
+    if(!psFile)
+    {
+        return(false);
+    }
+    for(ui32I = 0; ui32I < ui32Count; ui32I++)
+    {
+        i32Val = (int32_t)lrint(2048.0 + pdSignal[ui32I]);
+        i32Val = (i32Val < 0) ? 0 : ((i32Val > 4095) ? 4095 : i32Val);
+        pui8LE[0] = i32Val & 0xFF;
+        pui8LE[1] = i32Val >> 8;
+        fwrite(pui8LE, 1, 2, psFile);
+    }
+    fclose(psFile);
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Read a sample file into a new array.  Returns the number of samples, or 0
+// if the file can't be read.
+//
+//*****************************************************************************
+static uint32_t
+readSamples(const char *pcFile, uint16_t **ppui16Samples)
+{
+    FILE *psFile;
+    uint8_t pui8LE[2];
+    uint32_t ui32Count;
+    uint32_t ui32Cap;
+
+    *ppui16Samples = NULL;
+    psFile = fopen(pcFile, "rb");
+    if(!psFile)
+    {
+        return(0);
+    }
+
+    ui32Count = 0;
+    ui32Cap = 0;
+    while(fread(pui8LE, 1, 2, psFile) == 2)
+    {
+        if(ui32Count == ui32Cap)
+        {
+            ui32Cap = ui32Cap ? (ui32Cap * 2) : 65536;
+            *ppui16Samples = realloc(*ppui16Samples,
+                                     ui32Cap * sizeof(uint16_t));
+        }
+        (*ppui16Samples)[ui32Count++] = (pui8LE[0] | (pui8LE[1] << 8)) &
+                                        0xFFF;
+    }
+    fclose(psFile);
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+// Run one block through the load, transform and bands, as the audio render
+// job does.
+//
+//*****************************************************************************
+static void
+analyze(const uint16_t *pui16Block, uint32_t *pui32Power)
+{
+    tWSFFT sFFT;
+
+    WSFFTInit(&sFFT, g_pi16Re, g_pi16Im, BLOCK_LOG2N);
+    WSFFTLoadADC(&sFFT, pui16Block);
+    WSFFTRun(&sFFT);
+    WSFFTBands(&sFFT, pui32Power, NUM_BANDS);
+}
+
+static uint32_t
+loudestBand(const uint32_t *pui32Power)
+{
+    uint32_t ui32Best;
+    uint32_t ui32B;
+
+    ui32Best = 0;
+    for(ui32B = 1; ui32B < NUM_BANDS; ui32B++)
+    {
+        if(pui32Power[ui32B] > pui32Power[ui32Best])
+        {
+            ui32Best = ui32B;
+        }
+    }
+    return(ui32Best);
+}
+
+//*****************************************************************************
+//
+// The transform of random and tone input matches a double precision DFT of
+// the same windowed samples, to within the rounding of one LSB per stage.
+//
+//*****************************************************************************
+static void
+checkTransform(void)
+{
+    static uint16_t pui16Samples[1 << WS_FFT_LOG2N_MAX];
+    static double pdIn[1 << WS_FFT_LOG2N_MAX];
+    tWSFFT sFFT;
+    double dRe;
+    double dIm;
+    double dErr;
+    double dMaxErr;
+    uint32_t ui32N;
+    uint32_t ui32I;
+    uint32_t ui32K;
+    uint8_t ui8Log2N;
+    int iPass;
+
+    WS_CHECK(!WSFFTInit(&sFFT, g_pi16Re, g_pi16Im, WS_FFT_LOG2N_MIN - 1));
+    WS_CHECK(!WSFFTInit(&sFFT, g_pi16Re, g_pi16Im, WS_FFT_LOG2N_MAX + 1));
+
+    for(ui8Log2N = WS_FFT_LOG2N_MIN; ui8Log2N <= WS_FFT_LOG2N_MAX;
+        ui8Log2N++)
+    {
+        ui32N = 1 << ui8Log2N;
+        for(iPass = 0; iPass < 2; iPass++)
+        {
+            for(ui32I = 0; ui32I < ui32N; ui32I++)
+            {
+                pui16Samples[ui32I] =
+                    iPass ? (uint16_t)(2048 + 2000 * sin(2 * M_PI * 3.3 *
+                                                         ui32I / ui32N)) :
+                            (WSTestRand() & 0xFFF);
+            }
+
+            WS_CHECK(WSFFTInit(&sFFT, g_pi16Re, g_pi16Im, ui8Log2N));
+            WSFFTLoadADC(&sFFT, pui16Samples);
+            for(ui32I = 0; ui32I < ui32N; ui32I++)
+            {
+                pdIn[ui32I] = sFFT.pi16Re[ui32I];
+            }
+            WSFFTRun(&sFFT);
+
+            dMaxErr = 0;
+            for(ui32K = 0; ui32K < ui32N; ui32K++)
+            {
+                dRe = 0;
+                dIm = 0;
+                for(ui32I = 0; ui32I < ui32N; ui32I++)
+                {
+                    dRe += pdIn[ui32I] * cos(2 * M_PI * ui32I * ui32K /
+                                             ui32N);
+                    dIm -= pdIn[ui32I] * sin(2 * M_PI * ui32I * ui32K /
+                                             ui32N);
+                }
+                dErr = hypot(sFFT.pi16Re[ui32K] - (dRe / ui32N),
+                             sFFT.pi16Im[ui32K] - (dIm / ui32N));
+                dMaxErr = (dErr > dMaxErr) ? dErr : dMaxErr;
+            }
+            WS_CHECK(dMaxErr <= (ui8Log2N + 1));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Levels are 8 per doubling of power and never go down as power goes up.
+//
+//*****************************************************************************
+static void
+checkLevel(void)
+{
+    uint32_t ui32Power;
+    uint8_t ui8Last;
+    uint32_t ui32I;
+
+    WS_CHECK(WSFFTLevel(0) == 0);
+    WS_CHECK(WSFFTLevel(1) == 0);
+    for(ui32I = 1; ui32I < 32; ui32I++)
+    {
+        WS_CHECK(WSFFTLevel(1u << ui32I) == (ui32I * 8));
+    }
+
+    ui8Last = 0;
+    for(ui32Power = 1; ui32Power < 0xF0000000;
+        ui32Power += (ui32Power / 64) + 1)
+    {
+        WS_CHECK(WSFFTLevel(ui32Power) >= ui8Last);
+        ui8Last = WSFFTLevel(ui32Power);
+    }
+}
+
+//*****************************************************************************
+//
+// Tones played back from a file land in the band that holds their bin, and
+// the bands step up with the tones.
+//
+//*****************************************************************************
+static void
+checkTones(void)
+{
+    static double pdSignal[NUM_TONES * TONE_BLOCKS * BLOCK];
+    uint32_t pui32Power[NUM_BANDS];
+    uint16_t *pui16Samples;
+    uint32_t ui32Count;
+    uint32_t ui32Band;
+    uint32_t ui32Last;
+    uint32_t ui32T;
+    uint32_t ui32I;
+
+    for(ui32T = 0; ui32T < NUM_TONES; ui32T++)
+    {
+        for(ui32I = 0; ui32I < (TONE_BLOCKS * BLOCK); ui32I++)
+        {
+            pdSignal[(ui32T * TONE_BLOCKS * BLOCK) + ui32I] =
+                1500 * sin(2 * M_PI * g_pui16ToneBins[ui32T] * ui32I / BLOCK);
+        }
+    }
+    WS_CHECK(writeSamples(TONES_FILE, pdSignal,
+                          NUM_TONES * TONE_BLOCKS * BLOCK));
+    ui32Count = readSamples(TONES_FILE, &pui16Samples);
+    remove(TONES_FILE);
+    WS_CHECK(ui32Count == (NUM_TONES * TONE_BLOCKS * BLOCK));
+    if(ui32Count != (NUM_TONES * TONE_BLOCKS * BLOCK))
+    {
+        free(pui16Samples);
+        return;
+    }
+
+    ui32Last = 0;
+    for(ui32T = 0; ui32T < NUM_TONES; ui32T++)
+    {
+        for(ui32I = 0; ui32I < TONE_BLOCKS; ui32I++)
+        {
+            analyze(pui16Samples + (((ui32T * TONE_BLOCKS) + ui32I) * BLOCK),
+                    pui32Power);
+            ui32Band = loudestBand(pui32Power);
+            WS_CHECK(ui32Band >= ui32Last);
+            WS_CHECK(WSFFTLevel(pui32Power[ui32Band]) >
+                     WSFFTLevel(pui32Power[(ui32Band + 4) % NUM_BANDS]) + 40);
+            ui32Last = ui32Band;
+        }
+    }
+    WS_CHECK(ui32Last == (NUM_BANDS - 1));
+
+    free(pui16Samples);
+}
+
+//*****************************************************************************
+//
+// Play back blocks from the bass bands through the beat detector, and
+// return how many beats it found.  pui32Blocks gets the block of each beat.
+//
+//*****************************************************************************
+static uint32_t
+findBeats(const uint16_t *pui16Samples, uint32_t ui32Count,
+          uint32_t *pui32Blocks, uint32_t ui32Max)
+{
+    uint32_t pui32Power[NUM_BANDS];
+    tWSBeat sBeat;
+    uint32_t ui32Beats;
+    uint32_t ui32B;
+
+    WSBeatInit(&sBeat, 24, 8);
+    ui32Beats = 0;
+    for(ui32B = 0; ((ui32B + 1) * BLOCK) <= ui32Count; ui32B++)
+    {
+        analyze(pui16Samples + (ui32B * BLOCK), pui32Power);
+        if(WSBeatUpdate(&sBeat, pui32Power[0] + pui32Power[1]) &&
+           (ui32Beats < ui32Max))
+        {
+            pui32Blocks[ui32Beats++] = ui32B;
+        }
+    }
+    return(ui32Beats);
+}
+
+//*****************************************************************************
+//
+// Kick drums over hi-hat noise played back from a file give one beat per
+// kick, in the block the kick starts in or the next.  The detector ignores
+// its first hold period while the average settles, so the first kick, right
+// at the start, isn't counted.
+//
+//*****************************************************************************
+static void
+checkDrums(void)
+{
+    static double pdSignal[DRUM_BEATS * DRUM_PERIOD];
+    uint32_t pui32Blocks[DRUM_BEATS * 2];
+    uint16_t *pui16Samples;
+    uint32_t ui32Count;
+    uint32_t ui32Beats;
+    uint32_t ui32Kick;
+    uint32_t ui32I;
+    double dT;
+
+    for(ui32I = 0; ui32I < (DRUM_BEATS * DRUM_PERIOD); ui32I++)
+    {
+        dT = (double)(ui32I % DRUM_PERIOD) / SAMPLE_RATE;
+        pdSignal[ui32I] = 1800 * exp(-dT * 25) * sin(2 * M_PI * 60 * dT) +
+                          ((int32_t)(WSTestRand() % 161) - 80);
+    }
+    WS_CHECK(writeSamples(DRUMS_FILE, pdSignal, DRUM_BEATS * DRUM_PERIOD));
+    ui32Count = readSamples(DRUMS_FILE, &pui16Samples);
+    remove(DRUMS_FILE);
+    WS_CHECK(ui32Count == (DRUM_BEATS * DRUM_PERIOD));
+
+    ui32Beats = findBeats(pui16Samples, ui32Count, pui32Blocks,
+                          DRUM_BEATS * 2);
+    WS_CHECK(ui32Beats == (DRUM_BEATS - 1));
+    for(ui32I = 0; ui32I < ui32Beats; ui32I++)
+    {
+        ui32Kick = ((ui32I + 1) * DRUM_PERIOD) / BLOCK;
+        WS_CHECK((pui32Blocks[ui32I] >= ui32Kick) &&
+                 (pui32Blocks[ui32I] <= (ui32Kick + 1)));
+    }
+
+    free(pui16Samples);
+}
+
+//*****************************************************************************
+//
+// Play back a recording from the command line: its mean band levels and
+// the beats found.
+//
+//*****************************************************************************
+static void
+playFile(const char *pcFile)
+{
+    uint32_t pui32Power[NUM_BANDS];
+    uint64_t pui64Level[NUM_BANDS];
+    uint32_t pui32Blocks[256];
+    uint16_t *pui16Samples;
+    uint32_t ui32Count;
+    uint32_t ui32Beats;
+    uint32_t ui32B;
+    uint32_t ui32I;
+
+    ui32Count = readSamples(pcFile, &pui16Samples);
+    WS_CHECK(ui32Count >= BLOCK);
+    if(ui32Count < BLOCK)
+    {
+        free(pui16Samples);
+        return;
+    }
+
+    memset(pui64Level, 0, sizeof(pui64Level));
+    for(ui32B = 0; ((ui32B + 1) * BLOCK) <= ui32Count; ui32B++)
+    {
+        analyze(pui16Samples + (ui32B * BLOCK), pui32Power);
+        for(ui32I = 0; ui32I < NUM_BANDS; ui32I++)
+        {
+            pui64Level[ui32I] += WSFFTLevel(pui32Power[ui32I]);
+        }
+    }
+    ui32Beats = findBeats(pui16Samples, ui32Count, pui32Blocks, 256);
+
+    printf("%s: %u blocks, %.1f s, %u beats, mean band levels", pcFile,
+           ui32B, (double)ui32Count / SAMPLE_RATE, ui32Beats);
+    for(ui32I = 0; ui32I < NUM_BANDS; ui32I++)
+    {
+        printf(" %3u", (uint32_t)(pui64Level[ui32I] / ui32B));
+    }
+    printf("\n");
+
+    free(pui16Samples);
+}
+
+//*****************************************************************************
+//
+// Time the work done per captured block at each size, against the time the
+// block takes to capture.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static uint16_t pui16Samples[1 << WS_FFT_LOG2N_MAX];
+    uint32_t pui32Power[NUM_BANDS];
+    tWSFFT sFFT;
+    uint64_t ui64Cycles;
+    uint64_t ui64Ns;
+    uint32_t ui32Loops;
+    uint32_t ui32I;
+    uint8_t ui8Log2N;
+
+    for(ui32I = 0; ui32I < (1 << WS_FFT_LOG2N_MAX); ui32I++)
+    {
+        pui16Samples[ui32I] = WSTestRand() & 0xFFF;
+    }
+
+    for(ui8Log2N = 6; ui8Log2N <= WS_FFT_LOG2N_MAX; ui8Log2N += 2)
+    {
+        ui32Loops = 2000000 >> ui8Log2N;
+        WSFFTInit(&sFFT, g_pi16Re, g_pi16Im, ui8Log2N);
+
+        ui64Cycles = WSTestCycles();
+        ui64Ns = WSTestNs();
+        for(ui32I = 0; ui32I < ui32Loops; ui32I++)
+        {
+            WSFFTLoadADC(&sFFT, pui16Samples);
+            WSFFTRun(&sFFT);
+            WSFFTBands(&sFFT, pui32Power, NUM_BANDS);
+        }
+        ui64Ns = WSTestNs() - ui64Ns;
+        ui64Cycles = WSTestCycles() - ui64Cycles;
+
+        printf("%4u points  %8.2f us  %8.0f cycles per block  "
+               "(captured in %.0f us at %u Hz)\n", 1 << ui8Log2N,
+               (double)ui64Ns / (ui32Loops * 1000.0),
+               (double)ui64Cycles / ui32Loops,
+               (1e6 * (1 << ui8Log2N)) / SAMPLE_RATE, SAMPLE_RATE);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    int iArg;
+
+    checkTransform();
+    checkLevel();
+    checkTones();
+    checkDrums();
+
+    for(iArg = WSTestBench(argc, argv) ? 2 : 1; iArg < argc; iArg++)
+    {
+        playFile(argv[iArg]);
+    }
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_fft"));
+}
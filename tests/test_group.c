@@ -0,0 +1,288 @@
+//*****************************************************************************
+//
+// test_group - strip groups on the simulated SSI and uDMA hardware: what
+// each output sends, and how far apart the outputs finish.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "SPI_uDMA_group.h"
+#include "WS2812_drv.h"
+#include "WS2812_timing.h"
+#include "wstest.h"
+
+#define SIM_CLOCK               50000000
+#define SIM_DMA_CYCLES          4
+#define SIM_ISR_LATENCY         12
+#define SIM_FIFO_DEPTH          8
+#define SIM_FRAME_LIMIT         2000000
+
+//
+// Three outputs of different lengths.  The longest needs several ping-pong
+// halves for its data and the shortest for its lead.
+//
+static const uint32_t g_pui32Output[3] =
+{
+    SPI_GROUP_SSI0, SPI_GROUP_SSI2, SPI_GROUP_SSI3
+};
+static const uint16_t g_pui16NumLED[3] = { 100, 60, 1 };
+
+static uint8_t g_pui8SPI0[100 * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPI2[60 * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPI3[1 * WS2812_SPI_LED_SIZE];
+static uint8_t *const g_ppui8SPI[3] = { g_pui8SPI0, g_pui8SPI2, g_pui8SPI3 };
+
+static uint8_t g_ui8Done;
+
+static void
+fillRandom(void)
+{
+    uint32_t ui32O;
+    uint32_t ui32I;
+
+    for(ui32O = 0; ui32O < 3; ui32O++)
+    {
+        for(ui32I = 0; ui32I < g_pui16NumLED[ui32O]; ui32I++)
+        {
+            WSGRBtoSPI(g_ppui8SPI[ui32O] + (ui32I * WS2812_SPI_LED_SIZE),
+                       WSTestRand(), WSTestRand(), WSTestRand());
+        }
+    }
+}
+
+static void
+setUp(uint32_t ui32ISRCycles)
+{
+    tWSSimConfig sConfig;
+    uint32_t ui32O;
+
+    sConfig.ui32Clock = SIM_CLOCK;
+    sConfig.ui32DMACycles = SIM_DMA_CYCLES;
+    sConfig.ui32ISRLatency = SIM_ISR_LATENCY;
+    sConfig.ui32ISRCycles = ui32ISRCycles;
+    WSSimReset(&sConfig);
+    WSSimIntRegister(INT_SSI0, SPIGroupSSI0IntHandler);
+    WSSimIntRegister(INT_SSI1, SPIGroupSSI1IntHandler);
+    WSSimIntRegister(INT_SSI2, SPIGroupSSI2IntHandler);
+    WSSimIntRegister(INT_SSI3, SPIGroupSSI3IntHandler);
+
+    SPIGroupInit(&g_ui8Done);
+    for(ui32O = 0; ui32O < 3; ui32O++)
+    {
+        WS_CHECK(SPIGroupOutputAdd(g_pui32Output[ui32O], g_ppui8SPI[ui32O],
+                                   g_pui16NumLED[ui32O] *
+                                   WS2812_SPI_LED_SIZE));
+    }
+    WS_CHECK(!SPIGroupOutputAdd(SPI_GROUP_MAX_OUTPUTS, g_pui8SPI3,
+                                sizeof(g_pui8SPI3)));
+}
+
+static bool
+runToDone(void)
+{
+    uint64_t ui64Start;
+
+    ui64Start = WSSimNow();
+    while(!g_ui8Done)
+    {
+        if((WSSimNow() - ui64Start) > SIM_FRAME_LIMIT)
+        {
+            return(false);
+        }
+        WSSimRun(1000);
+    }
+
+    //
+    // Let the FIFOs empty onto the wire
+    //
+    WSSimRun(2000);
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Check one output sent ui32Frames frames of its lead zeros and SPI array,
+// back to back with no gaps, and return the clock its last data frame
+// finished on.
+//
+//*****************************************************************************
+static uint64_t
+checkWire(uint32_t ui32O, uint32_t ui32Frames)
+{
+    const tWSSimWire *psWire;
+    uint32_t ui32Size;
+    uint32_t ui32Lead;
+    uint32_t ui32Pos;
+    uint32_t ui32F;
+    uint32_t ui32I;
+    uint32_t ui32Gaps;
+
+    psWire = WSSimWireGet(g_pui32Output[ui32O]);
+    ui32Size = g_pui16NumLED[ui32O] * WS2812_SPI_LED_SIZE;
+    ui32Lead = WSTimingActive()->ui16LatchFrames + sizeof(g_pui8SPI0) -
+               ui32Size;
+
+    WS_CHECK(psWire->ui32Overflows == 0);
+    WS_CHECK(psWire->ui32Len == (ui32Frames * (ui32Lead + ui32Size)));
+    if(psWire->ui32Len != (ui32Frames * (ui32Lead + ui32Size)))
+    {
+        return(0);
+    }
+
+    ui32Pos = 0;
+    for(ui32F = 0; ui32F < ui32Frames; ui32F++)
+    {
+        for(ui32I = 0; ui32I < ui32Lead; ui32I++)
+        {
+            WS_CHECK(psWire->pui8Data[ui32Pos++] == 0);
+        }
+        WS_CHECK(!memcmp(psWire->pui8Data + ui32Pos, g_ppui8SPI[ui32O],
+                         ui32Size));
+        ui32Pos += ui32Size;
+    }
+
+    ui32Gaps = 0;
+    for(ui32I = 1; ui32I < psWire->ui32Len; ui32I++)
+    {
+        if((psWire->pui64Start[ui32I] - psWire->pui64Start[ui32I - 1]) !=
+           psWire->ui32FrameCycles)
+        {
+            ui32Gaps++;
+        }
+    }
+    WS_CHECK(ui32Gaps == 0);
+
+    return(psWire->pui64Start[psWire->ui32Len - 1] + psWire->ui32FrameCycles);
+}
+
+//*****************************************************************************
+//
+// Send one frame and return the spread of the outputs' data ends on the
+// wire, with the driver's own skew figure.
+//
+//*****************************************************************************
+static uint32_t
+oneFrame(uint32_t ui32ISRCycles, tSPIGroupStats *psStats)
+{
+    uint64_t ui64End;
+    uint64_t ui64Min;
+    uint64_t ui64Max;
+    uint32_t ui32O;
+
+    setUp(ui32ISRCycles);
+    fillRandom();
+
+    SPIGroupCommit();
+    WS_CHECK(g_ui8Done == 0);
+    WS_CHECK(runToDone());
+
+    ui64Min = UINT64_MAX;
+    ui64Max = 0;
+    for(ui32O = 0; ui32O < 3; ui32O++)
+    {
+        ui64End = checkWire(ui32O, 1);
+        ui64Min = (ui64End < ui64Min) ? ui64End : ui64Min;
+        ui64Max = (ui64End > ui64Max) ? ui64End : ui64Max;
+    }
+
+    SPIGroupStatsGet(psStats);
+    WS_CHECK(psStats->ui32Frames == 1);
+    WS_CHECK(WSSimFaultsGet() == 0);
+
+    return(ui64Max - ui64Min);
+}
+
+//*****************************************************************************
+//
+// All outputs finish their data within the time the uDMA controller takes to
+// fill every SSI FIFO in turn at the start, which is where the skew comes
+// from: the lowest channel keeps the bus until its FIFO is full.  The skew
+// the driver reports covers that plus the handlers running one after
+// another.
+//
+//*****************************************************************************
+static void
+checkSkew(void)
+{
+    tSPIGroupStats sStats;
+    uint32_t ui32Fill;
+    uint32_t ui32Skew;
+
+    ui32Skew = oneFrame(100, &sStats);
+    ui32Fill = 3 * SIM_FIFO_DEPTH * SIM_DMA_CYCLES;
+
+    WS_CHECK(ui32Skew <= ui32Fill);
+    WS_CHECK(sStats.ui32SkewLast <= (ui32Fill + (3 * (SIM_ISR_LATENCY +
+                                                      100))));
+    WS_CHECK(sStats.ui32SkewMax == sStats.ui32SkewLast);
+}
+
+//*****************************************************************************
+//
+// A commit while a frame is being sent is held and follows straight on,
+// and the done flag only rises after it.
+//
+//*****************************************************************************
+static void
+checkPending(void)
+{
+    tSPIGroupStats sStats;
+    uint32_t ui32O;
+
+    setUp(100);
+    fillRandom();
+
+    SPIGroupCommit();
+    WSSimRun(20000);
+    WS_CHECK(g_ui8Done == 0);
+    SPIGroupCommit();
+    WS_CHECK(runToDone());
+
+    for(ui32O = 0; ui32O < 3; ui32O++)
+    {
+        checkWire(ui32O, 2);
+    }
+    SPIGroupStatsGet(&sStats);
+    WS_CHECK(sStats.ui32Frames == 2);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// Skew on the wire and as reported, as the handlers get slower.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static const uint32_t pui32ISR[4] = { 50, 200, 1000, 5000 };
+    tSPIGroupStats sStats;
+    uint32_t ui32Skew;
+    uint32_t ui32I;
+
+    printf("%d MHz, bit %u ns, outputs of 100, 60 and 1 LEDs\n",
+           SIM_CLOCK / 1000000, WSTimingActive()->ui32BitNs);
+    for(ui32I = 0; ui32I < 4; ui32I++)
+    {
+        ui32Skew = oneFrame(pui32ISR[ui32I], &sStats);
+        printf("handler %4u clocks: wire skew %3u clocks, reported %5u "
+               "clocks\n", pui32ISR[ui32I], ui32Skew, sStats.ui32SkewLast);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkSkew();
+    checkPending();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_group"));
+}
@@ -0,0 +1,259 @@
+//*****************************************************************************
+//
+// test_hostenc - the host encoder against WStoSPI(), on its own and through
+// pools of different sizes, with a benchmark of how frame rate scales with
+// the number of threads.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "WS2812_drv.h"
+#include "WS2812_hostenc.h"
+#include "wstest.h"
+
+//
+// Strip lengths either side of a chunk boundary, and an empty strip
+//
+#define NUM_STRIPS              8
+static const uint16_t g_pui16NumLED[NUM_STRIPS] =
+{
+    1, WS_ENC_CHUNK_LEDS - 1, WS_ENC_CHUNK_LEDS, WS_ENC_CHUNK_LEDS + 1, 0,
+    500, 3 * WS_ENC_CHUNK_LEDS, 77
+};
+#define MAX_STRIP_LED           500
+
+//
+// The benchmark: 64 strips of 500 LEDs
+//
+#define BENCH_STRIPS            64
+#define BENCH_LED               500
+#define BENCH_MAX_THREADS       16
+
+static uint8_t g_pui8Colors[BENCH_STRIPS][BENCH_LED][3];
+static uint8_t g_pui8SPI[BENCH_STRIPS][BENCH_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPIRef[MAX_STRIP_LED * WS2812_SPI_LED_SIZE];
+
+static void
+fillRandom(void)
+{
+    uint32_t ui32S;
+    uint32_t ui32I;
+
+    for(ui32S = 0; ui32S < BENCH_STRIPS; ui32S++)
+    {
+        for(ui32I = 0; ui32I < BENCH_LED; ui32I++)
+        {
+            g_pui8Colors[ui32S][ui32I][0] = WSTestRand();
+            g_pui8Colors[ui32S][ui32I][1] = WSTestRand();
+            g_pui8Colors[ui32S][ui32I][2] = WSTestRand();
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Every byte value, at every length up to a few SIMD blocks so each kernel's
+// tail is covered, in the default encoding and in the 50MHz plan's.
+//
+//*****************************************************************************
+static void
+checkBytes(void)
+{
+    uint8_t pui8Src[256 + 64];
+    uint8_t pui8Out[(256 + 64 + 1) * WS2812_SPI_BIT_WIDTH];
+    uint8_t pui8Ref[(256 + 64) * WS2812_SPI_BIT_WIDTH];
+    uint32_t ui32Len;
+    uint32_t ui32I;
+    uint32_t ui32E;
+
+    for(ui32I = 0; ui32I < sizeof(pui8Src); ui32I++)
+    {
+        pui8Src[ui32I] = ui32I;
+    }
+
+    for(ui32E = 0; ui32E < 2; ui32E++)
+    {
+        if(ui32E)
+        {
+            WSEncodingSet(0x7C, 0x60);
+        }
+        for(ui32I = 0; ui32I < sizeof(pui8Src); ui32I++)
+        {
+            WStoSPI(pui8Ref + (ui32I * WS2812_SPI_BIT_WIDTH), pui8Src[ui32I]);
+        }
+
+        for(ui32Len = 0; ui32Len <= sizeof(pui8Src); ui32Len++)
+        {
+            memset(pui8Out, 0xA5, sizeof(pui8Out));
+            WSEncodeBytes(pui8Out, pui8Src, ui32Len);
+            WS_CHECK(!memcmp(pui8Out, pui8Ref,
+                             ui32Len * WS2812_SPI_BIT_WIDTH));
+            WS_CHECK(pui8Out[ui32Len * WS2812_SPI_BIT_WIDTH] == 0xA5);
+        }
+    }
+    WSEncodingSet(WS2812_SPI_HIGH, WS2812_SPI_LOW);
+}
+
+//*****************************************************************************
+//
+// Pools of one thread up to more threads than chunks encode every strip as
+// WSGRBtoSPI() would, and stop at the end of each strip.  A frame with more
+// chunks than the pool takes is refused without writing anything.
+//
+//*****************************************************************************
+static void
+checkPool(void)
+{
+    tWSEncStrip psStrips[NUM_STRIPS];
+    tWSEncPool *psPool;
+    uint32_t ui32Tasks;
+    uint32_t ui32Threads;
+    uint32_t ui32Size;
+    uint32_t ui32S;
+    uint32_t ui32I;
+
+    fillRandom();
+
+    ui32Tasks = 0;
+    for(ui32S = 0; ui32S < NUM_STRIPS; ui32S++)
+    {
+        psStrips[ui32S].pui8Colors =
+            (const uint8_t (*)[3])g_pui8Colors[ui32S];
+        psStrips[ui32S].pui8SPI = g_pui8SPI[ui32S];
+        psStrips[ui32S].ui16NumLED = g_pui16NumLED[ui32S];
+        ui32Tasks += (g_pui16NumLED[ui32S] + WS_ENC_CHUNK_LEDS - 1) /
+                     WS_ENC_CHUNK_LEDS;
+    }
+
+    for(ui32Threads = 1; ui32Threads <= 20; ui32Threads += 3)
+    {
+        psPool = WSEncPoolCreate(ui32Threads, ui32Tasks);
+        WS_CHECK(psPool != NULL);
+        if(psPool == NULL)
+        {
+            continue;
+        }
+
+        memset(g_pui8SPI, 0, sizeof(g_pui8SPI));
+        WS_CHECK(WSEncPoolEncode(psPool, psStrips, NUM_STRIPS));
+        for(ui32S = 0; ui32S < NUM_STRIPS; ui32S++)
+        {
+            ui32Size = g_pui16NumLED[ui32S] * WS2812_SPI_LED_SIZE;
+            for(ui32I = 0; ui32I < g_pui16NumLED[ui32S]; ui32I++)
+            {
+                WSGRBtoSPI(g_pui8SPIRef + (ui32I * WS2812_SPI_LED_SIZE),
+                           g_pui8Colors[ui32S][ui32I][0],
+                           g_pui8Colors[ui32S][ui32I][1],
+                           g_pui8Colors[ui32S][ui32I][2]);
+            }
+            WS_CHECK(!memcmp(g_pui8SPI[ui32S], g_pui8SPIRef, ui32Size));
+            WS_CHECK((g_pui16NumLED[ui32S] == BENCH_LED) ||
+                     (g_pui8SPI[ui32S][ui32Size] == 0));
+        }
+
+        //
+        // The same pool again, for a frame one chunk too big
+        //
+        memset(g_pui8SPI, 0, sizeof(g_pui8SPI));
+        psStrips[NUM_STRIPS - 1].ui16NumLED = WS_ENC_CHUNK_LEDS + 1;
+        WS_CHECK(!WSEncPoolEncode(psPool, psStrips, NUM_STRIPS));
+        WS_CHECK(g_pui8SPI[0][0] == 0);
+        psStrips[NUM_STRIPS - 1].ui16NumLED = g_pui16NumLED[NUM_STRIPS - 1];
+
+        WSEncPoolDestroy(psPool);
+    }
+}
+
+//*****************************************************************************
+//
+// Frames per second for 64 strips of 500 LEDs: WSGRBtoSPI() on one thread,
+// then the pool from one thread up to every core.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    tWSEncStrip psStrips[BENCH_STRIPS];
+    tWSEncPool *psPool;
+    uint64_t ui64Ns;
+    uint32_t ui32Threads;
+    uint32_t ui32Cores;
+    uint32_t ui32Reps;
+    uint32_t ui32S;
+    uint32_t ui32I;
+    double dOne;
+    double dRate;
+
+    ui32Cores = sysconf(_SC_NPROCESSORS_ONLN);
+    ui32Cores = (ui32Cores > BENCH_MAX_THREADS) ? BENCH_MAX_THREADS :
+                ui32Cores;
+    for(ui32S = 0; ui32S < BENCH_STRIPS; ui32S++)
+    {
+        psStrips[ui32S].pui8Colors =
+            (const uint8_t (*)[3])g_pui8Colors[ui32S];
+        psStrips[ui32S].pui8SPI = g_pui8SPI[ui32S];
+        psStrips[ui32S].ui16NumLED = BENCH_LED;
+    }
+
+    ui64Ns = WSTestNs();
+    for(ui32Reps = 0; ui32Reps < 50; ui32Reps++)
+    {
+        for(ui32S = 0; ui32S < BENCH_STRIPS; ui32S++)
+        {
+            for(ui32I = 0; ui32I < BENCH_LED; ui32I++)
+            {
+                WSGRBtoSPI(g_pui8SPI[ui32S] + (ui32I * WS2812_SPI_LED_SIZE),
+                           g_pui8Colors[ui32S][ui32I][0],
+                           g_pui8Colors[ui32S][ui32I][1],
+                           g_pui8Colors[ui32S][ui32I][2]);
+            }
+        }
+    }
+    ui64Ns = WSTestNs() - ui64Ns;
+    printf("%u strips of %u LEDs, %s kernel\n", BENCH_STRIPS, BENCH_LED,
+           WSEncKernelName());
+    printf("WSGRBtoSPI     %8.0f frames/s\n", (ui32Reps * 1e9) / ui64Ns);
+
+    dOne = 0;
+    for(ui32Threads = 1; ui32Threads <= ui32Cores; ui32Threads++)
+    {
+        psPool = WSEncPoolCreate(ui32Threads, BENCH_STRIPS *
+                                 ((BENCH_LED + WS_ENC_CHUNK_LEDS - 1) /
+                                  WS_ENC_CHUNK_LEDS));
+        if(psPool == NULL)
+        {
+            break;
+        }
+
+        ui64Ns = WSTestNs();
+        for(ui32Reps = 0; ui32Reps < 1000; ui32Reps++)
+        {
+            WSEncPoolEncode(psPool, psStrips, BENCH_STRIPS);
+        }
+        ui64Ns = WSTestNs() - ui64Ns;
+        WSEncPoolDestroy(psPool);
+
+        dRate = (ui32Reps * 1e9) / ui64Ns;
+        dOne = dOne ? dOne : dRate;
+        printf("%2u thread%s     %8.0f frames/s, %5.2fx\n", ui32Threads,
+               (ui32Threads == 1) ? " " : "s", dRate, dRate / dOne);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkBytes();
+    checkPool();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_hostenc"));
+}
@@ -0,0 +1,179 @@
+//*****************************************************************************
+//
+// test_interp - frame interpolation against a model of the two keyframes
+// being faded between: every output frame, encoded a chunk at a time, is
+// the WSBlendLerp() of the keyframes at that step, across pushes at the
+// start, middle and end of a fade.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_blend.h"
+#include "WS2812_interp.h"
+#include "wstest.h"
+
+#define NUM_LED                 50
+#define NUM_STEPS               6
+
+static tWSInterp g_sInterp;
+static uint8_t g_pui8Frames[3][NUM_LED][3];
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8Ref[NUM_LED * WS2812_SPI_LED_SIZE];
+
+//
+// The model: the keyframes faded from and to, and the step of the fade
+//
+static uint8_t g_pui8From[NUM_LED][3];
+static uint8_t g_pui8To[NUM_LED][3];
+static uint32_t g_ui32Step;
+
+//*****************************************************************************
+//
+// The weight of the output frame at the model's step.
+//
+//*****************************************************************************
+static uint8_t
+refWeight(void)
+{
+    return((g_ui32Step * 255) / NUM_STEPS);
+}
+
+//*****************************************************************************
+//
+// Encode the current output frame ui16Chunk LEDs at a time, checking only
+// the last chunk reports the frame done, and compare it with encoding the
+// model's lerp one LED at a time.
+//
+//*****************************************************************************
+static void
+checkOutput(uint16_t ui16Chunk)
+{
+    uint8_t pui8Lerp[NUM_LED][3];
+    uint32_t ui32Calls;
+    uint32_t ui32I;
+
+    memset(g_pui8SPI, 0, sizeof(g_pui8SPI));
+    for(ui32Calls = 1; !WSInterpRender(&g_sInterp, g_pui8SPI, ui16Chunk);
+        ui32Calls++)
+    {
+        if(ui32Calls > NUM_LED)
+        {
+            break;
+        }
+    }
+    WS_CHECK(ui32Calls == ((NUM_LED + ui16Chunk - 1) / (uint32_t)ui16Chunk));
+    WS_CHECK(WSInterpRender(&g_sInterp, g_pui8SPI, ui16Chunk));
+
+    WSBlendLerp(pui8Lerp, (const uint8_t (*)[3])g_pui8From,
+                (const uint8_t (*)[3])g_pui8To, NUM_LED, refWeight());
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        WSGRBtoSPI(g_pui8Ref + (ui32I * WS2812_SPI_LED_SIZE),
+                   pui8Lerp[ui32I][0], pui8Lerp[ui32I][1],
+                   pui8Lerp[ui32I][2]);
+    }
+    WS_CHECK(!memcmp(g_pui8SPI, g_pui8Ref, sizeof(g_pui8SPI)));
+}
+
+//*****************************************************************************
+//
+// Render a random keyframe into the target and push it, updating the model:
+// the output at the current weight becomes the keyframe faded from.
+//
+//*****************************************************************************
+static void
+pushKeyframe(void)
+{
+    uint8_t (*pui8Target)[3];
+    uint32_t ui32I;
+
+    pui8Target = WSInterpTarget(&g_sInterp);
+    WS_CHECK((pui8Target != g_sInterp.pui8From) &&
+             (pui8Target != g_sInterp.pui8To));
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        pui8Target[ui32I][0] = WSTestRand();
+        pui8Target[ui32I][1] = WSTestRand();
+        pui8Target[ui32I][2] = WSTestRand();
+    }
+
+    WSBlendLerp(g_pui8From, (const uint8_t (*)[3])g_pui8From,
+                (const uint8_t (*)[3])g_pui8To, NUM_LED, refWeight());
+    memcpy(g_pui8To, pui8Target, sizeof(g_pui8To));
+    g_ui32Step = 0;
+
+    WSInterpPush(&g_sInterp);
+}
+
+//*****************************************************************************
+//
+// A run of keyframes, each pushed after a number of output frames: right
+// away at weight 0, part way through the fade, at the end of the fade at
+// 255, and after the output has held on the newest keyframe for a while.
+// Every output frame is encoded in chunks smaller than the strip, of
+// several sizes, and once in a single call.
+//
+//*****************************************************************************
+static void
+checkFades(void)
+{
+    static const uint32_t pui32Advances[] =
+    {
+        NUM_STEPS, 0, 2, NUM_STEPS, NUM_STEPS + 4, 0, 0, 5, 1, NUM_STEPS, 3
+    };
+    static const uint16_t pui16Chunk[] = { 7, 1, NUM_LED - 1, 16, NUM_LED };
+    uint32_t ui32Key;
+    uint32_t ui32I;
+    uint32_t ui32Frame;
+    uint8_t ui8Weights;
+
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        g_pui8Frames[0][ui32I][0] = WSTestRand();
+        g_pui8Frames[0][ui32I][1] = WSTestRand();
+        g_pui8Frames[0][ui32I][2] = WSTestRand();
+    }
+    memcpy(g_pui8Frames[1], g_pui8Frames[0], sizeof(g_pui8Frames[0]));
+    memcpy(g_pui8From, g_pui8Frames[0], sizeof(g_pui8From));
+    memcpy(g_pui8To, g_pui8Frames[0], sizeof(g_pui8To));
+    g_ui32Step = 0;
+
+    WSInterpInit(&g_sInterp, (uint8_t *)g_pui8Frames, NUM_LED, NUM_STEPS);
+    checkOutput(NUM_LED);
+
+    //
+    // Keep track of having pushed at weight 0, part way and at 255
+    //
+    ui8Weights = 0;
+    ui32Frame = 0;
+    for(ui32Key = 0;
+        ui32Key < (sizeof(pui32Advances) / sizeof(pui32Advances[0]));
+        ui32Key++)
+    {
+        ui8Weights |= (refWeight() == 0) ? 1 : (refWeight() == 255) ? 4 : 2;
+        pushKeyframe();
+        checkOutput(pui16Chunk[ui32Frame++ % 5]);
+
+        for(ui32I = 0; ui32I < pui32Advances[ui32Key]; ui32I++)
+        {
+            WSInterpAdvance(&g_sInterp);
+            if(g_ui32Step < NUM_STEPS)
+            {
+                g_ui32Step++;
+            }
+            checkOutput(pui16Chunk[ui32Frame++ % 5]);
+        }
+    }
+    WS_CHECK(ui8Weights == 7);
+}
+
+int
+main(void)
+{
+    checkFades();
+
+    return(WSTestDone("test_interp"));
+}
@@ -0,0 +1,282 @@
+//*****************************************************************************
+//
+// test_matrix - the index maps of each panel layout against a reference
+// built by walking the LED chain, and row fills, rectangle fills and blits
+// against encoding the same pixels one at a time.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_matrix.h"
+#include "wstest.h"
+
+#define MAX_PIXELS              (24 * 12)
+#define NUM_SPANS               2000
+
+//*****************************************************************************
+//
+// A surface and its tiles
+//
+//*****************************************************************************
+typedef struct
+{
+    uint16_t ui16Width;
+    uint16_t ui16Height;
+    uint16_t ui16TileWidth;
+    uint16_t ui16TileHeight;
+}
+tTestPanel;
+
+static const tTestPanel g_psPanels[] =
+{
+    { 24, 12, 24, 12 },
+    { 24, 12, 8, 4 },
+    { 24, 12, 3, 12 },
+    { 12, 12, 1, 6 },
+    { 1, 12, 1, 12 },
+};
+
+#define NUM_PANELS              (sizeof(g_psPanels) / sizeof(g_psPanels[0]))
+
+static uint16_t g_pui16Map[MAX_PIXELS];
+static uint16_t g_pui16Ref[MAX_PIXELS];
+static uint8_t g_pui8SPI[MAX_PIXELS * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPIRef[MAX_PIXELS * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8Src[MAX_PIXELS][3];
+
+//*****************************************************************************
+//
+// Build the index map the slow way, by following the chain from its first
+// LED: tile by tile along each row of tiles, and line by line inside each
+// tile, turning around where the wiring is serpentine.
+//
+//*****************************************************************************
+static void
+refMap(const tTestPanel *psPanel, uint32_t ui32Flags)
+{
+    uint32_t ui32LED;
+    uint32_t ui32TileRow;
+    uint32_t ui32TileCol;
+    uint32_t ui32Tile;
+    uint32_t ui32Major;
+    uint32_t ui32Minor;
+    uint32_t ui32Step;
+    uint32_t ui32Majors;
+    uint32_t ui32Minors;
+    uint32_t ui32TileRows;
+    uint32_t ui32TileCols;
+    uint32_t ui32X;
+    uint32_t ui32Y;
+
+    ui32Majors = (ui32Flags & WS_MATRIX_COLUMNS) ? psPanel->ui16TileWidth :
+                                                   psPanel->ui16TileHeight;
+    ui32Minors = (ui32Flags & WS_MATRIX_COLUMNS) ? psPanel->ui16TileHeight :
+                                                   psPanel->ui16TileWidth;
+    ui32TileRows = psPanel->ui16Height / psPanel->ui16TileHeight;
+    ui32TileCols = psPanel->ui16Width / psPanel->ui16TileWidth;
+    ui32LED = 0;
+    for(ui32TileRow = 0; ui32TileRow < ui32TileRows; ui32TileRow++)
+    {
+        for(ui32Tile = 0; ui32Tile < ui32TileCols; ui32Tile++)
+        {
+            ui32TileCol = ui32Tile;
+            if((ui32Flags & WS_MATRIX_TILE_SERPENTINE) && (ui32TileRow & 1))
+            {
+                ui32TileCol = ui32TileCols - 1 - ui32Tile;
+            }
+
+            for(ui32Major = 0; ui32Major < ui32Majors; ui32Major++)
+            {
+                for(ui32Step = 0; ui32Step < ui32Minors; ui32Step++)
+                {
+                    ui32Minor = ui32Step;
+                    if((ui32Flags & WS_MATRIX_SERPENTINE) && (ui32Major & 1))
+                    {
+                        ui32Minor = ui32Minors - 1 - ui32Step;
+                    }
+                    if(ui32Flags & WS_MATRIX_COLUMNS)
+                    {
+                        ui32X = ui32Major;
+                        ui32Y = ui32Minor;
+                    }
+                    else
+                    {
+                        ui32X = ui32Minor;
+                        ui32Y = ui32Major;
+                    }
+                    ui32X += ui32TileCol * psPanel->ui16TileWidth;
+                    ui32Y += ui32TileRow * psPanel->ui16TileHeight;
+                    g_pui16Ref[(ui32Y * psPanel->ui16Width) + ui32X] =
+                        ui32LED++;
+                }
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// A 4 by 2 serpentine panel, written out by hand, and the layouts of each
+// test panel against the chain walk.  Tiles that don't divide the surface
+// are refused.
+//
+//*****************************************************************************
+static void
+checkMaps(void)
+{
+    static const uint16_t pui16Serp[8] = { 0, 1, 2, 3, 7, 6, 5, 4 };
+    static const uint16_t pui16Cols[8] = { 0, 2, 4, 6, 1, 3, 5, 7 };
+    tWSMatrix sMatrix;
+    uint32_t ui32Panel;
+    uint32_t ui32Flags;
+    uint32_t ui32Pixels;
+
+    WS_CHECK(WSMatrixInit(&sMatrix, g_pui16Map, 4, 2, 4, 2,
+                          WS_MATRIX_SERPENTINE));
+    WS_CHECK(!memcmp(g_pui16Map, pui16Serp, sizeof(pui16Serp)));
+    WS_CHECK(WSMatrixInit(&sMatrix, g_pui16Map, 4, 2, 4, 2,
+                          WS_MATRIX_COLUMNS));
+    WS_CHECK(!memcmp(g_pui16Map, pui16Cols, sizeof(pui16Cols)));
+
+    WS_CHECK(!WSMatrixInit(&sMatrix, g_pui16Map, 24, 12, 5, 4, 0));
+    WS_CHECK(!WSMatrixInit(&sMatrix, g_pui16Map, 24, 12, 8, 5, 0));
+    WS_CHECK(!WSMatrixInit(&sMatrix, g_pui16Map, 24, 12, 0, 4, 0));
+
+    for(ui32Panel = 0; ui32Panel < NUM_PANELS; ui32Panel++)
+    {
+        ui32Pixels = g_psPanels[ui32Panel].ui16Width *
+                     g_psPanels[ui32Panel].ui16Height;
+        for(ui32Flags = 0; ui32Flags < 8; ui32Flags++)
+        {
+            refMap(&g_psPanels[ui32Panel], ui32Flags);
+            WS_CHECK(WSMatrixInit(&sMatrix, g_pui16Map,
+                                  g_psPanels[ui32Panel].ui16Width,
+                                  g_psPanels[ui32Panel].ui16Height,
+                                  g_psPanels[ui32Panel].ui16TileWidth,
+                                  g_psPanels[ui32Panel].ui16TileHeight,
+                                  ui32Flags));
+            WS_CHECK(!memcmp(g_pui16Map, g_pui16Ref,
+                             ui32Pixels * sizeof(uint16_t)));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Encode the pixels of a rectangle one at a time into the reference SPI
+// array, from the source pixels or in one color, clipping to the surface.
+//
+//*****************************************************************************
+static void
+refRect(const tWSMatrix *psMatrix, uint16_t ui16X, uint16_t ui16Y,
+        uint16_t ui16W, uint16_t ui16H, bool bBlit, const uint8_t *pui8Color)
+{
+    const uint8_t *pui8Pix;
+    uint32_t ui32X;
+    uint32_t ui32Y;
+
+    for(ui32Y = 0; ui32Y < ui16H; ui32Y++)
+    {
+        for(ui32X = 0; ui32X < ui16W; ui32X++)
+        {
+            if(((ui16X + ui32X) >= psMatrix->ui16Width) ||
+               ((ui16Y + ui32Y) >= psMatrix->ui16Height))
+            {
+                continue;
+            }
+            pui8Pix = bBlit ? g_pui8Src[(ui32Y * ui16W) + ui32X] : pui8Color;
+            WSGRBtoSPI(g_pui8SPIRef +
+                       ((uint32_t)WSMatrixIndex(psMatrix, ui16X + ui32X,
+                                                ui16Y + ui32Y) *
+                        WS2812_SPI_LED_SIZE),
+                       pui8Pix[0], pui8Pix[1], pui8Pix[2]);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Random row fills, rectangle fills and blits, some hanging off the right
+// and bottom edges, on each panel in each layout, give the same SPI array
+// as encoding their pixels one at a time.
+//
+//*****************************************************************************
+static void
+checkSpans(void)
+{
+    tWSMatrix sMatrix;
+    const tTestPanel *psPanel;
+    uint8_t pui8Color[3];
+    uint32_t ui32Span;
+    uint32_t ui32I;
+    uint16_t ui16X;
+    uint16_t ui16Y;
+    uint16_t ui16W;
+    uint16_t ui16H;
+    uint8_t ui8Func;
+
+    for(ui32I = 0; ui32I < sizeof(g_pui8SPI); ui32I++)
+    {
+        g_pui8SPI[ui32I] = WSTestRand();
+    }
+    memcpy(g_pui8SPIRef, g_pui8SPI, sizeof(g_pui8SPI));
+
+    for(ui32Span = 0; ui32Span < NUM_SPANS; ui32Span++)
+    {
+        psPanel = &g_psPanels[ui32Span % NUM_PANELS];
+        WS_CHECK(WSMatrixInit(&sMatrix, g_pui16Map, psPanel->ui16Width,
+                              psPanel->ui16Height, psPanel->ui16TileWidth,
+                              psPanel->ui16TileHeight,
+                              (ui32Span / NUM_PANELS) % 8));
+
+        ui8Func = (ui32Span / (NUM_PANELS * 8)) % 3;
+        ui16X = WSTestRand() % (psPanel->ui16Width + 2);
+        ui16Y = WSTestRand() % (psPanel->ui16Height + 2);
+        ui16W = WSTestRand() % (psPanel->ui16Width + 4);
+        ui16H = (ui8Func == 0) ? 1 : (WSTestRand() % 8);
+        pui8Color[0] = WSTestRand();
+        pui8Color[1] = WSTestRand();
+        pui8Color[2] = WSTestRand();
+        for(ui32I = 0; ui32I < ((uint32_t)ui16W * ui16H); ui32I++)
+        {
+            g_pui8Src[ui32I][0] = WSTestRand();
+            g_pui8Src[ui32I][1] = WSTestRand();
+            g_pui8Src[ui32I][2] = WSTestRand();
+        }
+
+        switch(ui8Func)
+        {
+            case 0:
+                WSMatrixFillRow(&sMatrix, g_pui8SPI, ui16X, ui16Y, ui16W,
+                                pui8Color[0], pui8Color[1], pui8Color[2]);
+                break;
+
+            case 1:
+                WSMatrixFillRect(&sMatrix, g_pui8SPI, ui16X, ui16Y, ui16W,
+                                 ui16H, pui8Color[0], pui8Color[1],
+                                 pui8Color[2]);
+                break;
+
+            default:
+                WSMatrixBlit(&sMatrix, g_pui8SPI, ui16X, ui16Y,
+                             (const uint8_t (*)[3])g_pui8Src, ui16W, ui16H);
+                break;
+        }
+        refRect(&sMatrix, ui16X, ui16Y, ui16W, ui16H, ui8Func == 2,
+                pui8Color);
+
+        WS_CHECK(!memcmp(g_pui8SPI, g_pui8SPIRef, sizeof(g_pui8SPI)));
+    }
+}
+
+int
+main(void)
+{
+    checkMaps();
+    checkSpans();
+
+    return(WSTestDone("test_matrix"));
+}
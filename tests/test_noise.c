@@ -0,0 +1,272 @@
+//*****************************************************************************
+//
+// test_noise - rows of noise against single point evaluation, continuity
+// across cells, range and the palette, with a benchmark of samples per
+// second for rows that stay in a cell and rows that cross one every sample.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_noise.h"
+#include "wstest.h"
+
+#define ROW_LEN                 300
+#define NUM_ROWS                1000
+
+//
+// The benchmark: rows of 300 samples stepping 3/64 of a cell, and stepping
+// just over a cell so every sample sets up a new one
+//
+#define BENCH_STEP_IN           ((3 * WS_NOISE_ONE) / 64)
+#define BENCH_STEP_NEW          (WS_NOISE_ONE + 0x1234)
+#define BENCH_ROWS              2000
+#define BENCH_REPS              10
+
+//*****************************************************************************
+//
+// Evaluate noise at a single point in ui8Dims dimensions.
+//
+//*****************************************************************************
+static uint8_t
+pointAt(uint8_t ui8Dims, uint32_t ui32X, uint32_t ui32Y, uint32_t ui32Z)
+{
+    switch(ui8Dims)
+    {
+        case 1:
+            return(WSNoise1D(ui32X));
+
+        case 2:
+            return(WSNoise2D(ui32X, ui32Y));
+
+        default:
+            return(WSNoise3D(ui32X, ui32Y, ui32Z));
+    }
+}
+
+//*****************************************************************************
+//
+// Random rows of 300 samples, in 1 to 3 dimensions and with steps from a
+// fraction of a cell to several cells, give the same samples as evaluating
+// each point on its own: 300000 samples in all.  The stride is honoured and
+// the bytes between samples are left alone.
+//
+//*****************************************************************************
+static void
+checkRows(void)
+{
+    static const uint32_t pui32Step[4] =
+    {
+        (3 * WS_NOISE_ONE) / 64, 0x100, WS_NOISE_ONE, 0x3A5C3
+    };
+    tWSNoiseRow sRow;
+    uint8_t pui8Dst[ROW_LEN * 3];
+    uint32_t ui32Row;
+    uint32_t ui32Step;
+    uint32_t ui32X;
+    uint32_t ui32Y;
+    uint32_t ui32Z;
+    uint32_t ui32I;
+    uint32_t ui32Diff;
+    uint8_t ui8Dims;
+
+    ui32Diff = 0;
+    for(ui32Row = 0; ui32Row < NUM_ROWS; ui32Row++)
+    {
+        ui8Dims = (ui32Row % 3) + 1;
+        ui32Step = pui32Step[(ui32Row / 3) % 4];
+        ui32X = WSTestRand();
+        ui32Y = WSTestRand();
+        ui32Z = WSTestRand();
+
+        memset(pui8Dst, 0xA5, sizeof(pui8Dst));
+        WSNoiseRowInit(&sRow, ui8Dims, ui32X, ui32Y, ui32Z, ui32Step);
+        WSNoiseRowFill(&sRow, pui8Dst, ROW_LEN, 3);
+
+        for(ui32I = 0; ui32I < ROW_LEN; ui32I++)
+        {
+            ui32Diff += (pui8Dst[ui32I * 3] !=
+                         pointAt(ui8Dims, ui32X + (ui32I * ui32Step), ui32Y,
+                                 ui32Z));
+            ui32Diff += (pui8Dst[(ui32I * 3) + 1] != 0xA5) +
+                        (pui8Dst[(ui32I * 3) + 2] != 0xA5);
+        }
+    }
+    WS_CHECK(ui32Diff == 0);
+}
+
+//*****************************************************************************
+//
+// Noise is 128 on lattice points and repeats every 256 cells.  Samples
+// 1/256 of a cell apart never differ by more than a couple of steps, across
+// cell edges too, and long rows reach close to both ends of the range.
+//
+//*****************************************************************************
+static void
+checkShape(void)
+{
+    tWSNoiseRow sRow;
+    uint8_t pui8Dst[4096];
+    uint32_t ui32Row;
+    uint32_t ui32X;
+    uint32_t ui32Y;
+    uint32_t ui32Z;
+    uint32_t ui32I;
+    uint8_t ui8Dims;
+    uint8_t ui8Min;
+    uint8_t ui8Max;
+    uint8_t ui8Jump;
+
+    for(ui32I = 0; ui32I < 1000; ui32I++)
+    {
+        ui32X = WSTestRand() & 0xFFFF0000;
+        ui32Y = WSTestRand() & 0xFFFF0000;
+        ui32Z = WSTestRand() & 0xFFFF0000;
+        WS_CHECK(WSNoise1D(ui32X) == 128);
+        WS_CHECK(WSNoise2D(ui32X, ui32Y) == 128);
+        WS_CHECK(WSNoise3D(ui32X, ui32Y, ui32Z) == 128);
+
+        ui32X = WSTestRand();
+        ui32Y = WSTestRand();
+        ui32Z = WSTestRand();
+        WS_CHECK(WSNoise3D(ui32X, ui32Y, ui32Z) ==
+                 WSNoise3D(ui32X + (256 * WS_NOISE_ONE), ui32Y, ui32Z));
+    }
+
+    for(ui8Dims = 1; ui8Dims <= 3; ui8Dims++)
+    {
+        ui8Min = 255;
+        ui8Max = 0;
+        ui8Jump = 0;
+        for(ui32Row = 0; ui32Row < 200; ui32Row++)
+        {
+            WSNoiseRowInit(&sRow, ui8Dims, WSTestRand(), WSTestRand(),
+                           WSTestRand(), 0x100);
+            WSNoiseRowFill(&sRow, pui8Dst, sizeof(pui8Dst), 1);
+            for(ui32I = 0; ui32I < sizeof(pui8Dst); ui32I++)
+            {
+                ui8Min = (pui8Dst[ui32I] < ui8Min) ? pui8Dst[ui32I] : ui8Min;
+                ui8Max = (pui8Dst[ui32I] > ui8Max) ? pui8Dst[ui32I] : ui8Max;
+                if(ui32I && (abs(pui8Dst[ui32I] - pui8Dst[ui32I - 1]) >
+                             ui8Jump))
+                {
+                    ui8Jump = abs(pui8Dst[ui32I] - pui8Dst[ui32I - 1]);
+                }
+            }
+        }
+        WS_CHECK(ui8Jump <= 3);
+        WS_CHECK((ui8Min < 32) && (ui8Max > 224));
+    }
+}
+
+//*****************************************************************************
+//
+// Through a palette, each LED is the blend of the two entries either side
+// of the plain sample, and the top entry isn't blended past.
+//
+//*****************************************************************************
+static void
+checkPalette(void)
+{
+    static uint8_t pui8Palette[16][3];
+    tWSNoiseRow sRow;
+    uint8_t pui8Colors[ROW_LEN][3];
+    uint8_t pui8Plain[ROW_LEN];
+    uint32_t ui32I;
+    uint32_t ui32C;
+    int32_t i32Lo;
+    int32_t i32Hi;
+    uint8_t ui8N;
+
+    for(ui32I = 0; ui32I < (16 * 3); ui32I++)
+    {
+        pui8Palette[ui32I / 3][ui32I % 3] = WSTestRand();
+    }
+
+    WSNoiseRowInit(&sRow, 3, 0x12345, 0x6789A, 0xBCDEF, 0x2000);
+    WSNoiseRowFill(&sRow, pui8Plain, ROW_LEN, 1);
+    WSNoiseRowInit(&sRow, 3, 0x12345, 0x6789A, 0xBCDEF, 0x2000);
+    WSNoiseRowPalette(&sRow, pui8Colors, ROW_LEN,
+                      (const uint8_t (*)[3])pui8Palette);
+
+    for(ui32I = 0; ui32I < ROW_LEN; ui32I++)
+    {
+        ui8N = pui8Plain[ui32I];
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            i32Lo = pui8Palette[ui8N >> 4][ui32C];
+            i32Hi = pui8Palette[(ui8N >= 0xF0) ? 15 : ((ui8N >> 4) + 1)]
+                               [ui32C];
+            WS_CHECK(pui8Colors[ui32I][ui32C] ==
+                     (i32Lo + (((i32Hi - i32Lo) * (ui8N & 15)) >> 4)));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Million samples per second in 1D, 2D and 3D for rows of 300 samples,
+// stepping 3/64 of a cell so the cell is set up every 21 or so samples, and
+// stepping over a cell so it is set up for every sample.  Each is the best
+// of a few runs of 2000 rows.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static const uint32_t pui32Step[2] = { BENCH_STEP_IN, BENCH_STEP_NEW };
+    static const char *ppcStep[2] = { "step 3/64 cell", "new cell each" };
+    static uint8_t pui8Dst[ROW_LEN];
+    tWSNoiseRow sRow;
+    uint64_t ui64Best;
+    uint64_t ui64Ns;
+    uint32_t ui32Step;
+    uint32_t ui32Rep;
+    uint32_t ui32Row;
+    uint32_t ui32Sum;
+    uint8_t ui8Dims;
+
+    ui32Sum = 0;
+    for(ui32Step = 0; ui32Step < 2; ui32Step++)
+    {
+        printf("%-15s", ppcStep[ui32Step]);
+        for(ui8Dims = 1; ui8Dims <= 3; ui8Dims++)
+        {
+            ui64Best = ~(uint64_t)0;
+            for(ui32Rep = 0; ui32Rep < BENCH_REPS; ui32Rep++)
+            {
+                ui64Ns = WSTestNs();
+                for(ui32Row = 0; ui32Row < BENCH_ROWS; ui32Row++)
+                {
+                    WSNoiseRowInit(&sRow, ui8Dims, ui32Row * 0x3B7, 0x48000,
+                                   ui32Row * 0x1000, pui32Step[ui32Step]);
+                    WSNoiseRowFill(&sRow, pui8Dst, ROW_LEN, 1);
+                    ui32Sum += pui8Dst[ROW_LEN - 1];
+                }
+                ui64Ns = WSTestNs() - ui64Ns;
+                ui64Best = (ui64Ns < ui64Best) ? ui64Ns : ui64Best;
+            }
+            printf("  %uD %6.1f M samples/s", ui8Dims,
+                   (BENCH_ROWS * ROW_LEN * 1e3) / ui64Best);
+        }
+        printf("\n");
+    }
+    WS_CHECK(ui32Sum != 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkRows();
+    checkShape();
+    checkPalette();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_noise"));
+}
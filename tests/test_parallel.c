@@ -0,0 +1,159 @@
+//*****************************************************************************
+//
+// test_parallel - bit-plane transpose and encoder for the 8-strip GPIO
+// output.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_parallel.h"
+#include "wstest.h"
+
+#define NUM_LED                 300
+
+//*****************************************************************************
+//
+// Reference transpose: bit 7 - b of strip s goes to pin s of output byte b.
+//
+//*****************************************************************************
+static void
+refTranspose(const uint8_t *pui8In, uint8_t *pui8Out)
+{
+    int b;
+    int s;
+
+    for(b = 0; b < 8; b++)
+    {
+        pui8Out[b] = 0;
+        for(s = 0; s < 8; s++)
+        {
+            if(pui8In[s] & (0x80 >> b))
+            {
+                pui8Out[b] |= 1 << s;
+            }
+        }
+    }
+}
+
+static void
+checkTranspose(const uint8_t *pui8In)
+{
+    uint8_t pui8Out[8 * 3];
+    uint8_t pui8Ref[8];
+    int b;
+
+    memset(pui8Out, 0x5A, sizeof(pui8Out));
+    WSTranspose8(pui8In, pui8Out, 3);
+    refTranspose(pui8In, pui8Ref);
+
+    for(b = 0; b < 8; b++)
+    {
+        WS_CHECK(pui8Out[b * 3] == pui8Ref[b]);
+
+        //
+        // The slots in between must be left alone
+        //
+        WS_CHECK(pui8Out[(b * 3) + 1] == 0x5A);
+        WS_CHECK(pui8Out[(b * 3) + 2] == 0x5A);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    static uint8_t pui8Colors[8][NUM_LED][3];
+    static uint8_t pui8Port[NUM_LED * WS2812_PAR_LED_SIZE];
+    const uint8_t (*ppui8Colors[8])[3];
+    uint8_t pui8In[8];
+    uint8_t pui8Ref[8];
+    uint32_t ui32Slot;
+    uint64_t ui64Start;
+    uint64_t ui64Ns;
+    int iRep;
+    int iLED;
+    int iClr;
+    int s;
+    int i;
+
+    //
+    // Every single set bit, then random bytes
+    //
+    for(s = 0; s < 8; s++)
+    {
+        for(i = 0; i < 8; i++)
+        {
+            memset(pui8In, 0, sizeof(pui8In));
+            pui8In[s] = 0x80 >> i;
+            checkTranspose(pui8In);
+        }
+    }
+    for(iRep = 0; iRep < 100000; iRep++)
+    {
+        for(s = 0; s < 8; s++)
+        {
+            pui8In[s] = WSTestRand();
+        }
+        checkTranspose(pui8In);
+    }
+
+    //
+    // Encode part of the strips, with strip 3 unused, and check every slot
+    //
+    for(s = 0; s < 8; s++)
+    {
+        for(iLED = 0; iLED < NUM_LED; iLED++)
+        {
+            for(iClr = 0; iClr < 3; iClr++)
+            {
+                pui8Colors[s][iLED][iClr] = WSTestRand();
+            }
+        }
+        ppui8Colors[s] = pui8Colors[s];
+    }
+    ppui8Colors[3] = NULL;
+
+    WSParallelArrayInit(pui8Port, NUM_LED, 0xFF);
+    WSParallelEncode(pui8Port, ppui8Colors, 10, NUM_LED - 20);
+
+    for(iLED = 0; iLED < NUM_LED; iLED++)
+    {
+        for(iClr = 0; iClr < 3; iClr++)
+        {
+            for(s = 0; s < 8; s++)
+            {
+                pui8In[s] = ((s == 3) || (iLED < 10) ||
+                             (iLED >= (NUM_LED - 10))) ?
+                            0 : pui8Colors[s][iLED][iClr];
+            }
+            refTranspose(pui8In, pui8Ref);
+
+            for(i = 0; i < 8; i++)
+            {
+                ui32Slot = ((iLED * 24) + (iClr * 8) + i) *
+                           WS2812_PAR_SLOT_PER_BIT;
+                WS_CHECK(pui8Port[ui32Slot] == 0xFF);
+                WS_CHECK(pui8Port[ui32Slot + 1] == pui8Ref[i]);
+                WS_CHECK(pui8Port[ui32Slot + 2] == 0);
+            }
+        }
+    }
+
+    if(WSTestBench(argc, argv))
+    {
+        ppui8Colors[3] = pui8Colors[3];
+        ui64Start = WSTestNs();
+        for(iRep = 0; iRep < 2000; iRep++)
+        {
+            WSParallelEncode(pui8Port, ppui8Colors, 0, NUM_LED);
+        }
+        ui64Ns = WSTestNs() - ui64Start;
+
+        printf("parallel encode: %.1f ns per LED of 8 strips\n",
+               (double)ui64Ns / (2000.0 * NUM_LED));
+    }
+
+    return(WSTestDone("test_parallel"));
+}
@@ -0,0 +1,266 @@
+//*****************************************************************************
+//
+// test_particle - particle pool, incremental erase and dirty span encoding
+// against a full redraw, with the particles updated per millisecond.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_drv.h"
+#include "WS2812_particle.h"
+#include "wstest.h"
+
+#define NUM_LED                 1000
+#define NUM_PARTICLES           256
+#define NUM_FRAMES              500
+
+static tWSParticle g_psParticles[NUM_PARTICLES];
+static tWSParticlePool g_sPool;
+static uint8_t g_pui8Colors[NUM_LED][3];
+static uint8_t g_pui8Ref[NUM_LED][3];
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPIRef[NUM_LED * WS2812_SPI_LED_SIZE];
+
+//*****************************************************************************
+//
+// Draw every live particle into a cleared framebuffer, written out longhand
+// from the description of the splat.
+//
+//*****************************************************************************
+static void
+refRender(void)
+{
+    const tWSParticle *psPart;
+    uint32_t ui32Life;
+    uint32_t ui32Frac;
+    uint32_t ui32LED;
+    uint32_t ui32Val;
+    uint16_t ui16Idx;
+    int iC;
+
+    memset(g_pui8Ref, 0, sizeof(g_pui8Ref));
+
+    for(ui16Idx = g_sPool.ui16Live; ui16Idx != WS_PARTICLE_NONE;
+        ui16Idx = psPart->ui16Next)
+    {
+        psPart = &g_psParticles[ui16Idx];
+        ui32LED = psPart->i32Pos >> 16;
+        ui32Frac = (psPart->i32Pos >> 8) & 0xFF;
+        ui32Life = psPart->ui8Life + (psPart->ui8Life >> 7);
+
+        for(iC = 0; iC < 3; iC++)
+        {
+            ui32Val = g_pui8Ref[ui32LED][iC] +
+                      ((psPart->pui8Color[iC] *
+                        ((ui32Life * (256 - ui32Frac)) >> 8)) >> 8);
+            g_pui8Ref[ui32LED][iC] = (ui32Val > 255) ? 255 : ui32Val;
+
+            if(ui32Frac && ((ui32LED + 1) < NUM_LED))
+            {
+                ui32Val = g_pui8Ref[ui32LED + 1][iC] +
+                          ((psPart->pui8Color[iC] *
+                            ((ui32Life * ui32Frac) >> 8)) >> 8);
+                g_pui8Ref[ui32LED + 1][iC] = (ui32Val > 255) ? 255 : ui32Val;
+            }
+        }
+    }
+}
+
+static void
+spawnRandom(uint32_t ui32Count)
+{
+    uint8_t pui8Color[3];
+
+    while(ui32Count--)
+    {
+        pui8Color[0] = WSTestRand();
+        pui8Color[1] = WSTestRand();
+        pui8Color[2] = WSTestRand();
+        if((WSTestRand() & 7) == 0)
+        {
+            WSParticleBurst(&g_sPool, WSTestRand() % (NUM_LED << 16), 8,
+                            0x8000, pui8Color, 255, 4);
+        }
+        else
+        {
+            WSParticleSpawn(&g_sPool, WSTestRand() % (NUM_LED << 16),
+                            (int32_t)(WSTestRand() % 0x30000) - 0x18000,
+                            pui8Color, 128 + (WSTestRand() & 127),
+                            1 + (WSTestRand() & 7));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Run frames of random spawns and bursts with gravity and drag, checking
+// that erasing only what each particle drew matches a full redraw and that
+// encoding only the dirty span keeps the SPI array up to date.
+//
+//*****************************************************************************
+static void
+checkFrames(void)
+{
+    uint32_t ui32F;
+    uint32_t ui32I;
+    uint16_t ui16Idx;
+    uint16_t ui16Free;
+
+    WSParticleInit(&g_sPool, g_psParticles, NUM_PARTICLES, NUM_LED);
+    WSParticleForcesSet(&g_sPool, -0x400, 8);
+    memset(g_pui8Colors, 0, sizeof(g_pui8Colors));
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        WSGRBtoSPI(g_pui8SPI + (ui32I * WS2812_SPI_LED_SIZE), 0, 0, 0);
+    }
+
+    for(ui32F = 0; ui32F < NUM_FRAMES; ui32F++)
+    {
+        WSParticleUpdate(&g_sPool, g_pui8Colors);
+        spawnRandom(WSTestRand() % 12);
+        WSParticleRender(&g_sPool, g_pui8Colors);
+        WSParticleEncodeDirty(&g_sPool, (const uint8_t (*)[3])g_pui8Colors,
+                              g_pui8SPI);
+
+        refRender();
+        WS_CHECK(!memcmp(g_pui8Colors, g_pui8Ref, sizeof(g_pui8Colors)));
+
+        for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+        {
+            WSGRBtoSPI(g_pui8SPIRef + (ui32I * WS2812_SPI_LED_SIZE),
+                       g_pui8Ref[ui32I][0], g_pui8Ref[ui32I][1],
+                       g_pui8Ref[ui32I][2]);
+        }
+        WS_CHECK(!memcmp(g_pui8SPI, g_pui8SPIRef, sizeof(g_pui8SPI)));
+    }
+
+    //
+    // Every particle is on exactly one of the two lists
+    //
+    ui16Free = 0;
+    for(ui16Idx = g_sPool.ui16Free; ui16Idx != WS_PARTICLE_NONE;
+        ui16Idx = g_psParticles[ui16Idx].ui16Next)
+    {
+        ui16Free++;
+    }
+    WS_CHECK((ui16Free + WSParticleLiveCount(&g_sPool)) == NUM_PARTICLES);
+}
+
+//*****************************************************************************
+//
+// Positions off the strip are refused without using up the pool.
+//
+//*****************************************************************************
+static void
+checkBounds(void)
+{
+    static const uint8_t pui8White[3] = { 255, 255, 255 };
+    tWSParticle psParticles[4];
+    tWSParticlePool sPool;
+
+    WSParticleInit(&sPool, psParticles, 4, 10);
+
+    WS_CHECK(!WSParticleSpawn(&sPool, -1, 0, pui8White, 255, 1));
+    WS_CHECK(!WSParticleSpawn(&sPool, 10 << 16, 0, pui8White, 255, 1));
+    WS_CHECK(!WSParticleSpawn(&sPool, INT32_MAX, 0, pui8White, 255, 1));
+    WS_CHECK(WSParticleBurst(&sPool, -WS_PARTICLE_ONE, 4, 0x8000, pui8White,
+                             255, 1) == 0);
+    WS_CHECK(WSParticleBurst(&sPool, 10 << 16, 4, 0x8000, pui8White,
+                             255, 1) == 0);
+    WS_CHECK(WSParticleLiveCount(&sPool) == 0);
+
+    WS_CHECK(WSParticleSpawn(&sPool, (10 << 16) - 1, 0, pui8White, 255, 1));
+    WS_CHECK(WSParticleBurst(&sPool, 0, 4, 0x8000, pui8White, 255, 1) == 3);
+    WS_CHECK(WSParticleLiveCount(&sPool) == 4);
+}
+
+//*****************************************************************************
+//
+// Drag slows particles the same whichever way they are going.
+//
+//*****************************************************************************
+static void
+checkDrag(void)
+{
+    static const uint8_t pui8White[3] = { 255, 255, 255 };
+    tWSParticle psParticles[2];
+    tWSParticlePool sPool;
+    static uint8_t pui8Colors[100][3];
+    tWSParticle *psLeft;
+    tWSParticle *psRight;
+    int32_t i32Speed;
+    uint32_t ui32I;
+
+    for(i32Speed = 1; i32Speed < 0x20000; i32Speed = (i32Speed * 3) + 1)
+    {
+        WSParticleInit(&sPool, psParticles, 2, 100);
+        WSParticleForcesSet(&sPool, 0, 37);
+        memset(pui8Colors, 0, sizeof(pui8Colors));
+
+        psLeft = WSParticleSpawn(&sPool, 50 << 16, -i32Speed, pui8White, 255,
+                                 1);
+        psRight = WSParticleSpawn(&sPool, 50 << 16, i32Speed, pui8White, 255,
+                                  1);
+
+        for(ui32I = 0; ui32I < 20; ui32I++)
+        {
+            WSParticleUpdate(&sPool, pui8Colors);
+            WS_CHECK(psLeft->i32Vel == -psRight->i32Vel);
+            WS_CHECK((psRight->i32Pos - (50 << 16)) ==
+                     ((50 << 16) - psLeft->i32Pos));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Time whole frames of update, render and dirty encode with the pool kept
+// full.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    uint64_t ui64Ns;
+    uint64_t ui64Updated;
+    uint32_t ui32F;
+
+    WSParticleInit(&g_sPool, g_psParticles, NUM_PARTICLES, NUM_LED);
+    WSParticleForcesSet(&g_sPool, 0, 2);
+    memset(g_pui8Colors, 0, sizeof(g_pui8Colors));
+
+    ui64Updated = 0;
+    ui64Ns = WSTestNs();
+    for(ui32F = 0; ui32F < 20000; ui32F++)
+    {
+        ui64Updated += WSParticleLiveCount(&g_sPool);
+        WSParticleUpdate(&g_sPool, g_pui8Colors);
+        spawnRandom(NUM_PARTICLES - WSParticleLiveCount(&g_sPool));
+        WSParticleRender(&g_sPool, g_pui8Colors);
+        WSParticleEncodeDirty(&g_sPool, (const uint8_t (*)[3])g_pui8Colors,
+                              g_pui8SPI);
+    }
+    ui64Ns = WSTestNs() - ui64Ns;
+
+    printf("%u particles on %u LEDs  %8.0f particles per ms  "
+           "%6.2f us per frame\n", NUM_PARTICLES, NUM_LED,
+           (double)ui64Updated * 1e6 / ui64Ns, (double)ui64Ns / 20000000.0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkBounds();
+    checkDrag();
+    checkFrames();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_particle"));
+}
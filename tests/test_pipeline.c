@@ -0,0 +1,338 @@
+//*****************************************************************************
+//
+// test_pipeline - fused and run time render pipelines, with a benchmark of
+// the fused pipeline against a chain of separate passes.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_drv.h"
+#include "WS2812_blend.h"
+#include "WS2812_pipeline.h"
+#include "WS2812_power.h"
+#include "wstest.h"
+
+#define NUM_LED                 1000
+#define BENCH_REPS              1000
+#define WIDE_LED                65536
+#define WIDE_COUNT              6
+
+static uint8_t g_pui8Src[NUM_LED][3];
+static uint8_t g_pui8Over[NUM_LED][3];
+static uint8_t g_pui8Tmp[NUM_LED][3];
+static uint8_t g_pui8SPIFused[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPITable[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8SPIRef[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8WideSrc[WIDE_LED][3];
+static uint8_t g_pui8WideSPI[WIDE_LED * WS2812_SPI_LED_SIZE];
+
+static uint16_t g_ui16Scale = 200;
+static uint8_t g_ui8Frame;
+static tWSStageBlend g_sBlend = { (const uint8_t (*)[3])g_pui8Over, 96 };
+
+WS_PIPELINE_DEFINE(renderFused,
+                   WS_STAGE(WSStageGamma, g_pui16WSGamma22);
+                   WS_STAGE(WSStageBlend, &g_sBlend);
+                   WS_STAGE(WSStageScale, &g_ui16Scale);
+                   WS_STAGE(WSStageDither, &g_ui8Frame))
+
+WS_PIPELINE_DEFINE(renderGamma,
+                   WS_STAGE(WSStageGamma, g_pui16WSGamma22))
+
+static const tWSStage g_psGamma[] =
+{
+    { WSStageGamma, g_pui16WSGamma22 }
+};
+
+static const tWSStage g_psStages[] =
+{
+    { WSStageGamma, g_pui16WSGamma22 },
+    { WSStageBlend, &g_sBlend },
+    { WSStageScale, &g_ui16Scale },
+    { WSStageDither, &g_ui8Frame }
+};
+
+//*****************************************************************************
+//
+// Reference for one channel, written out longhand from the stage
+// descriptions.
+//
+//*****************************************************************************
+static uint8_t
+refChannel(uint32_t ui32LED, uint32_t ui32Clr)
+{
+    static const uint32_t pui32Threshold[4] = { 0x20, 0xA0, 0xE0, 0x60 };
+    uint32_t ui32Val;
+
+    ui32Val = g_pui16WSGamma22[g_pui8Src[ui32LED][ui32Clr]];
+    ui32Val = ((ui32Val * (255 - g_sBlend.ui8Weight)) +
+               ((uint32_t)g_pui8Over[ui32LED][ui32Clr] << 8) *
+               g_sBlend.ui8Weight) / 255;
+    ui32Val = (ui32Val * g_ui16Scale) >> 8;
+    ui32Val += pui32Threshold[(ui32LED + g_ui8Frame) & 3];
+    if(ui32Val > 0xFFFF)
+    {
+        ui32Val = 0xFFFF;
+    }
+
+    return(ui32Val >> 8);
+}
+
+//*****************************************************************************
+//
+// The same effects as separate passes over 8-bit framebuffers, the way they
+// were chained before the pipeline.
+//
+//*****************************************************************************
+static void
+renderMultiPass(void)
+{
+    uint32_t ui32I;
+    uint32_t ui32C;
+
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            g_pui8Tmp[ui32I][ui32C] =
+                g_pui16WSGamma22[g_pui8Src[ui32I][ui32C]] >> 8;
+        }
+    }
+
+    WSBlendLerp(g_pui8Tmp, (const uint8_t (*)[3])g_pui8Tmp,
+                (const uint8_t (*)[3])g_pui8Over, NUM_LED,
+                g_sBlend.ui8Weight);
+
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            g_pui8Tmp[ui32I][ui32C] =
+                (g_pui8Tmp[ui32I][ui32C] * g_ui16Scale) >> 8;
+        }
+    }
+
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        WSGRBtoSPI(g_pui8SPIRef + (ui32I * WS2812_SPI_LED_SIZE),
+                   g_pui8Tmp[ui32I][0], g_pui8Tmp[ui32I][1],
+                   g_pui8Tmp[ui32I][2]);
+    }
+}
+
+//*****************************************************************************
+//
+// One step scaled to a quarter should light one frame in four.
+//
+//*****************************************************************************
+static void
+checkDither(void)
+{
+    static const uint8_t pui8Src[1][3] = { { 1, 1, 1 } };
+    static const uint16_t ui16Quarter = 64;
+    const tWSStage psStages[2] =
+    {
+        { WSStageScale, &ui16Quarter },
+        { WSStageDither, &g_ui8Frame }
+    };
+    uint8_t pui8One[WS2812_SPI_LED_SIZE];
+    uint8_t pui8Out[WS2812_SPI_LED_SIZE];
+    uint32_t ui32Ones;
+
+    WSGRBtoSPI(pui8One, 1, 1, 1);
+    ui32Ones = 0;
+    for(g_ui8Frame = 0; g_ui8Frame < 4; g_ui8Frame++)
+    {
+        WSPipelineRun(psStages, 2, pui8Src, pui8Out, 0, 1);
+        if(!memcmp(pui8Out, pui8One, sizeof(pui8Out)))
+        {
+            ui32Ones++;
+        }
+    }
+    WS_CHECK(ui32Ones == 1);
+}
+
+static void
+checkPipeline(void)
+{
+    uint32_t ui32I;
+
+    for(g_ui8Frame = 0; g_ui8Frame < 4; g_ui8Frame++)
+    {
+        memset(g_pui8SPIFused, 0, sizeof(g_pui8SPIFused));
+        memset(g_pui8SPITable, 0, sizeof(g_pui8SPITable));
+
+        //
+        // A range that doesn't start at 0, so the LED index the stages see
+        // must be the framebuffer index
+        //
+        renderFused((const uint8_t (*)[3])g_pui8Src, g_pui8SPIFused, 7,
+                    NUM_LED - 7);
+        WSPipelineRun(g_psStages, 4, (const uint8_t (*)[3])g_pui8Src,
+                      g_pui8SPITable, 7, NUM_LED - 7);
+        WS_CHECK(!memcmp(g_pui8SPIFused, g_pui8SPITable,
+                         sizeof(g_pui8SPIFused)));
+
+        for(ui32I = 7; ui32I < NUM_LED; ui32I++)
+        {
+            WSGRBtoSPI(g_pui8SPIRef + (ui32I * WS2812_SPI_LED_SIZE),
+                       refChannel(ui32I, 0), refChannel(ui32I, 1),
+                       refChannel(ui32I, 2));
+        }
+        WS_CHECK(!memcmp(g_pui8SPIFused + (7 * WS2812_SPI_LED_SIZE),
+                         g_pui8SPIRef + (7 * WS2812_SPI_LED_SIZE),
+                         (NUM_LED - 7) * WS2812_SPI_LED_SIZE));
+        for(ui32I = 0; ui32I < (7 * WS2812_SPI_LED_SIZE); ui32I++)
+        {
+            WS_CHECK(g_pui8SPIFused[ui32I] == 0);
+        }
+    }
+
+    checkDither();
+}
+
+//*****************************************************************************
+//
+// A range ending at the last LED a 16 bit index can name, which both
+// pipelines must stop after rather than wrapping back to LED 0.
+//
+//*****************************************************************************
+static void
+checkWide(void)
+{
+    uint32_t ui32First;
+    uint32_t ui32I;
+    int iWay;
+
+    ui32First = WIDE_LED - WIDE_COUNT;
+    for(ui32I = ui32First; ui32I < WIDE_LED; ui32I++)
+    {
+        g_pui8WideSrc[ui32I][0] = WSTestRand();
+        g_pui8WideSrc[ui32I][1] = WSTestRand();
+        g_pui8WideSrc[ui32I][2] = WSTestRand();
+        WSGRBtoSPI(g_pui8SPIRef + ((ui32I - ui32First) * WS2812_SPI_LED_SIZE),
+                   g_pui16WSGamma22[g_pui8WideSrc[ui32I][0]] >> 8,
+                   g_pui16WSGamma22[g_pui8WideSrc[ui32I][1]] >> 8,
+                   g_pui16WSGamma22[g_pui8WideSrc[ui32I][2]] >> 8);
+    }
+
+    for(iWay = 0; iWay < 2; iWay++)
+    {
+        memset(g_pui8WideSPI, 0, sizeof(g_pui8WideSPI));
+        if(iWay == 0)
+        {
+            renderGamma((const uint8_t (*)[3])g_pui8WideSrc, g_pui8WideSPI,
+                        ui32First, WIDE_COUNT);
+        }
+        else
+        {
+            WSPipelineRun(g_psGamma, 1, (const uint8_t (*)[3])g_pui8WideSrc,
+                          g_pui8WideSPI, ui32First, WIDE_COUNT);
+        }
+        WS_CHECK(!memcmp(g_pui8WideSPI + (ui32First * WS2812_SPI_LED_SIZE),
+                         g_pui8SPIRef, WIDE_COUNT * WS2812_SPI_LED_SIZE));
+        for(ui32I = 0; ui32I < WS2812_SPI_LED_SIZE; ui32I++)
+        {
+            WS_CHECK(g_pui8WideSPI[ui32I] == 0);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Check the power limiter counts one limited frame per encode, however many
+// times the scale is refreshed.
+//
+//*****************************************************************************
+static void
+checkPower(void)
+{
+    static uint8_t pui8Colors[100][3];
+    tWSPowerStats sStats;
+    tWSPower sPower;
+    uint32_t ui32I;
+
+    memset(pui8Colors, 0xFF, sizeof(pui8Colors));
+    WSPowerInit(&sPower, (const uint8_t (*)[3])pui8Colors, 100, 1000);
+
+    for(ui32I = 0; ui32I < 3; ui32I++)
+    {
+        WSPowerScaleUpdate(&sPower);
+        WSPowerScaleUpdate(&sPower);
+        g_ui16Scale = sPower.ui16Scale;
+        renderFused((const uint8_t (*)[3])pui8Colors, g_pui8SPIFused, 0, 100);
+        WSPowerFrameEncoded(&sPower);
+    }
+    WSPowerEncode(&sPower, (const uint8_t (*)[3])pui8Colors, g_pui8SPIFused);
+
+    WSPowerStatsGet(&sPower, &sStats);
+    WS_CHECK(sStats.ui16Scale < WS_POWER_SCALE_FULL);
+    WS_CHECK(sStats.ui32LimitedFrames == 4);
+    WS_CHECK(sStats.ui32OutputmA <= 1000);
+}
+
+static void
+bench(const char *pcName, int iWay)
+{
+    uint64_t ui64Ns;
+    int iRep;
+
+    ui64Ns = WSTestNs();
+    for(iRep = 0; iRep < BENCH_REPS; iRep++)
+    {
+        g_ui8Frame = iRep;
+        if(iWay == 0)
+        {
+            renderFused((const uint8_t (*)[3])g_pui8Src, g_pui8SPIFused, 0,
+                        NUM_LED);
+        }
+        else if(iWay == 1)
+        {
+            WSPipelineRun(g_psStages, 4, (const uint8_t (*)[3])g_pui8Src,
+                          g_pui8SPITable, 0, NUM_LED);
+        }
+        else
+        {
+            renderMultiPass();
+        }
+    }
+    ui64Ns = WSTestNs() - ui64Ns;
+
+    printf("%-28s %8.2f us per %d LEDs\n", pcName,
+           (double)ui64Ns / (1000.0 * BENCH_REPS), NUM_LED);
+}
+
+int
+main(int argc, char *argv[])
+{
+    uint32_t ui32I;
+    uint32_t ui32C;
+
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        for(ui32C = 0; ui32C < 3; ui32C++)
+        {
+            g_pui8Src[ui32I][ui32C] = WSTestRand();
+            g_pui8Over[ui32I][ui32C] = WSTestRand();
+        }
+    }
+
+    checkPipeline();
+    checkWide();
+
+    if(WSTestBench(argc, argv))
+    {
+        g_sBlend.ui8Weight = 96;
+        g_ui16Scale = 200;
+        bench("fused (WS_PIPELINE_DEFINE)", 0);
+        bench("run time stage table", 1);
+        bench("separate passes", 2);
+    }
+
+    checkPower();
+
+    return(WSTestDone("test_pipeline"));
+}
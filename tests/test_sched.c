@@ -0,0 +1,188 @@
+//*****************************************************************************
+//
+// test_sched - the PendSV render scheduler driven by the SSI1 driver on the
+// simulated hardware: jobs run once per frame, a job over its budget is
+// counted and skipped on the next frame, and frames that finish while the
+// jobs are still running are counted as missed.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "SPI_uDMA_drv.h"
+#include "WS2812_drv.h"
+#include "WS2812_sched.h"
+#include "wstest.h"
+
+#define NUM_LED                 20
+#define SIM_CLOCK               50000000
+#define SIM_ISR_LATENCY         12
+#define SIM_ISR_CYCLES          200
+#define CYCLES_PER_US           (SIM_CLOCK / 1000000)
+
+//
+// The driver's handlers, otherwise only named in the vector table
+//
+extern void SSI1IntHandler(void);
+extern void uDMAErrorHandler(void);
+
+//*****************************************************************************
+//
+// A job that spends ui32Us of simulated time, or ui32LongUs on the runs
+// whose bit is set in ui32LongRuns.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Us;
+    uint32_t ui32LongUs;
+    uint32_t ui32LongRuns;
+    uint32_t ui32Runs;
+}
+tTestJob;
+
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_ui8Done;
+static tWSSchedJob g_psJobs[2];
+static tTestJob g_psTest[2];
+
+static void
+testJob(void *pvData)
+{
+    tTestJob *psTest;
+
+    psTest = (tTestJob *)pvData;
+    if((psTest->ui32Runs < 32) &&
+       (psTest->ui32LongRuns & (1 << psTest->ui32Runs)))
+    {
+        WSSimRun(psTest->ui32LongUs * CYCLES_PER_US);
+    }
+    else
+    {
+        WSSimRun(psTest->ui32Us * CYCLES_PER_US);
+    }
+    psTest->ui32Runs++;
+}
+
+//*****************************************************************************
+//
+// Run until ui32Count more frames have finished.
+//
+//*****************************************************************************
+static void
+runFrames(uint32_t ui32Count)
+{
+    tWSSchedStats sStats;
+    uint32_t ui32Target;
+
+    WSSchedStatsGet(&sStats);
+    ui32Target = sStats.ui32Frames + ui32Count;
+    while(sStats.ui32Frames < ui32Target)
+    {
+        WSSimRun(1000);
+        WSSchedStatsGet(&sStats);
+    }
+
+    //
+    // Let the jobs for the last frame finish
+    //
+    WSSimRun(200 * CYCLES_PER_US);
+}
+
+//*****************************************************************************
+//
+// Two jobs, one well inside its budget and one that runs over it on its
+// fourth and ninth runs.  Both run on every frame except the one after each
+// overrun, which the second skips, and each runs promptly after its frame.
+//
+//*****************************************************************************
+static void
+checkBudget(void)
+{
+    tWSSchedStats sStats;
+    tWSSimConfig sConfig;
+
+    sConfig.ui32Clock = SIM_CLOCK;
+    sConfig.ui32DMACycles = 4;
+    sConfig.ui32ISRLatency = SIM_ISR_LATENCY;
+    sConfig.ui32ISRCycles = SIM_ISR_CYCLES;
+    WSSimReset(&sConfig);
+    WSSimIntRegister(INT_SSI1, SSI1IntHandler);
+    WSSimIntRegister(INT_UDMAERR, uDMAErrorHandler);
+    WSSimIntRegister(FAULT_PENDSV, PendSVIntHandler);
+
+    WSSchedInit();
+    g_psTest[0].ui32Us = 20;
+    g_psTest[0].ui32LongRuns = 0;
+    g_psTest[1].ui32Us = 10;
+    g_psTest[1].ui32LongUs = 80;
+    g_psTest[1].ui32LongRuns = (1 << 3) | (1 << 8);
+    WS_CHECK(WSSchedJobAdd(&g_psJobs[0], testJob, &g_psTest[0], 100));
+    WS_CHECK(WSSchedJobAdd(&g_psJobs[1], testJob, &g_psTest[1], 50));
+
+    InitSPITransfer(g_pui8SPI, sizeof(g_pui8SPI), &g_ui8Done);
+    runFrames(20);
+    WSSchedStatsGet(&sStats);
+
+    WS_CHECK(g_psJobs[0].ui32Runs == sStats.ui32Frames);
+    WS_CHECK(g_psJobs[0].ui32Overruns == 0);
+    WS_CHECK(g_psJobs[0].ui32Skips == 0);
+    WS_CHECK(g_psJobs[0].ui32CyclesMax == (20 * CYCLES_PER_US));
+
+    WS_CHECK(g_psJobs[1].ui32Overruns == 2);
+    WS_CHECK(g_psJobs[1].ui32Skips == 2);
+    WS_CHECK((g_psJobs[1].ui32Runs + g_psJobs[1].ui32Skips) ==
+             g_psJobs[0].ui32Runs);
+    WS_CHECK(g_psJobs[1].ui32CyclesMax == (80 * CYCLES_PER_US));
+    WS_CHECK(g_psJobs[1].ui32CyclesLast == (10 * CYCLES_PER_US));
+    WS_CHECK(!g_psJobs[1].bSkipNext);
+
+    WS_CHECK(sStats.ui32Missed == 0);
+    WS_CHECK(sStats.ui32LatencyMax <= (SIM_ISR_CYCLES + SIM_ISR_LATENCY));
+    WS_CHECK(SPIUnderrunsGet() == 0);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// A job that takes several frames once.  The SSI1 interrupt preempts it
+// and the frames that finish meanwhile are counted as missed, so runs,
+// skips and missed frames add up to the frames sent.  The newest of them is
+// picked up late, which shows in the latency.
+//
+//*****************************************************************************
+static void
+checkMissed(void)
+{
+    tWSSchedStats sStats;
+    uint32_t ui32Runs;
+
+    WSSchedStatsGet(&sStats);
+    WS_CHECK(sStats.ui32Missed == 0);
+    ui32Runs = g_psTest[0].ui32Runs;
+
+    g_psTest[0].ui32LongUs = 2500;
+    g_psTest[0].ui32LongRuns = 1 << (ui32Runs + 2);
+    runFrames(20);
+    WSSchedStatsGet(&sStats);
+
+    WS_CHECK(sStats.ui32Missed >= 2);
+    WS_CHECK((g_psJobs[0].ui32Runs + g_psJobs[0].ui32Skips +
+              sStats.ui32Missed) == sStats.ui32Frames);
+    WS_CHECK(g_psJobs[0].ui32Overruns == 1);
+    WS_CHECK(g_psJobs[0].ui32Skips == 1);
+    WS_CHECK(sStats.ui32LatencyMax > (SIM_ISR_CYCLES + SIM_ISR_LATENCY));
+    WS_CHECK(sStats.ui32LatencyLast <= (SIM_ISR_CYCLES + SIM_ISR_LATENCY));
+    WS_CHECK(SPIUnderrunsGet() == 0);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+int
+main(void)
+{
+    checkBudget();
+    checkMissed();
+
+    return(WSTestDone("test_sched"));
+}
@@ -0,0 +1,391 @@
+//*****************************************************************************
+//
+// test_shm - the shared memory framebuffer between processes: lane claims,
+// frames that arrive whole and in order while producers publish as fast as
+// they can, and a benchmark of publish to encode latency.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "WS2812_drv.h"
+#include "WS2812_shm.h"
+#include "wstest.h"
+
+#define NUM_LED                 300
+#define NUM_LANES               4
+#define LANE_LED                (NUM_LED / NUM_LANES)
+#define NUM_PUBLISH             20000
+
+static char g_pcName[32];
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+
+//*****************************************************************************
+//
+// Read a color byte back out of the SPI array.
+//
+//*****************************************************************************
+static uint8_t
+decodeByte(const uint8_t *pui8SPI)
+{
+    uint8_t ui8Byte;
+    int i;
+
+    ui8Byte = 0;
+    for(i = 0; i < WS2812_SPI_BIT_WIDTH; i++)
+    {
+        ui8Byte = (ui8Byte << 1) | (pui8SPI[i] == g_ui8WSSPIHigh);
+    }
+    return(ui8Byte);
+}
+
+//*****************************************************************************
+//
+// A producer process: claim a lane and publish ui32Count frames as fast as
+// possible, every color byte of frame n holding n, or with a pause of
+// ui32GapUs between frames.  Exits 0 if all went well.
+//
+//*****************************************************************************
+static void
+producer(uint16_t ui16Lane, uint32_t ui32Count, uint32_t ui32GapUs)
+{
+    tWSShm sShm;
+    uint8_t (*pui8Frame)[3];
+    uint32_t ui32N;
+
+    if(!WSShmAttach(&sShm, g_pcName) ||
+       !WSShmLaneClaim(&sShm, ui16Lane, ui16Lane * LANE_LED, LANE_LED))
+    {
+        _exit(1);
+    }
+
+    for(ui32N = 1; ui32N <= ui32Count; ui32N++)
+    {
+        pui8Frame = WSShmFrameGet(&sShm);
+        memset(pui8Frame[ui16Lane * LANE_LED], ui32N, LANE_LED * 3);
+        WSShmPublish(&sShm);
+        if(ui32GapUs)
+        {
+            usleep(ui32GapUs);
+        }
+    }
+
+    WSShmClose(&sShm);
+    _exit(0);
+}
+
+//*****************************************************************************
+//
+// Start a producer for each of ui16Lanes lanes.
+//
+//*****************************************************************************
+static void
+startProducers(pid_t *piPid, uint16_t ui16Lanes, uint32_t ui32Count,
+               uint32_t ui32GapUs)
+{
+    uint16_t ui16L;
+
+    for(ui16L = 0; ui16L < ui16Lanes; ui16L++)
+    {
+        piPid[ui16L] = fork();
+        if(piPid[ui16L] == 0)
+        {
+            producer(ui16L, ui32Count, ui32GapUs);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Whether every producer has exited, and all of them with success.
+//
+//*****************************************************************************
+static bool
+producersDone(pid_t *piPid, uint16_t ui16Lanes, bool *pbOK)
+{
+    uint16_t ui16L;
+    int iStatus;
+
+    for(ui16L = 0; ui16L < ui16Lanes; ui16L++)
+    {
+        if(piPid[ui16L] <= 0)
+        {
+            continue;
+        }
+        if(waitpid(piPid[ui16L], &iStatus, WNOHANG) != piPid[ui16L])
+        {
+            return(false);
+        }
+        *pbOK = *pbOK && WIFEXITED(iStatus) && !WEXITSTATUS(iStatus);
+        piPid[ui16L] = 0;
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Lanes out of range, runs that don't fit, runs that overlap a live lane's
+// and lanes held by a live process can't be claimed.  A lane whose owner
+// exited without releasing it can, and its run no longer gets in the way.
+//
+//*****************************************************************************
+static void
+checkClaims(void)
+{
+    tWSShm sShm;
+    tWSShm sProd;
+    tWSShm sOther;
+    pid_t iPid;
+    int iStatus;
+
+    WS_CHECK(!WSShmCreate(&sShm, g_pcName, NUM_LED, WS_SHM_MAX_LANES + 1));
+    WS_CHECK(WSShmCreate(&sShm, g_pcName, NUM_LED, NUM_LANES));
+    WS_CHECK(WSShmAttach(&sProd, g_pcName));
+    WS_CHECK(sProd.ui16NumLED == NUM_LED);
+    WS_CHECK(sProd.ui16NumLanes == NUM_LANES);
+
+    WS_CHECK(!WSShmLaneClaim(&sProd, NUM_LANES, 0, 1));
+    WS_CHECK(!WSShmLaneClaim(&sProd, 0, NUM_LED - 1, 2));
+
+    //
+    // A child claims lane 1 and exits while holding it
+    //
+    iPid = fork();
+    if(iPid == 0)
+    {
+        _exit(WSShmLaneClaim(&sProd, 1, 0, 1) ? 0 : 1);
+    }
+    waitpid(iPid, &iStatus, 0);
+    WS_CHECK(WIFEXITED(iStatus) && !WEXITSTATUS(iStatus));
+
+    WS_CHECK(WSShmLaneClaim(&sProd, 1, 0, NUM_LED));
+    WSShmLaneRelease(&sProd);
+    WS_CHECK(WSShmLaneClaim(&sProd, 0, 0, NUM_LED));
+    WS_CHECK(!WSShmLaneClaim(&sProd, 0, 0, NUM_LED));
+
+    //
+    // Another producer in this process can't overlap the first one's run,
+    // not even by one LED at either end, until it is released
+    //
+    WS_CHECK(WSShmAttach(&sOther, g_pcName));
+    WS_CHECK(!WSShmLaneClaim(&sOther, 2, NUM_LED - 1, 1));
+    WS_CHECK(!WSShmLaneClaim(&sOther, 2, 0, 1));
+    WSShmLaneRelease(&sProd);
+    WS_CHECK(WSShmLaneClaim(&sProd, 0, 0, LANE_LED));
+    WS_CHECK(!WSShmLaneClaim(&sOther, 2, LANE_LED - 1, LANE_LED));
+    WS_CHECK(!WSShmLaneClaim(&sOther, 2, 0, NUM_LED));
+    WS_CHECK(WSShmLaneClaim(&sOther, 2, LANE_LED, LANE_LED));
+    WSShmLaneRelease(&sOther);
+    WS_CHECK(!WSShmLaneClaim(&sOther, 3, 1, NUM_LED - 1));
+    WS_CHECK(WSShmLaneClaim(&sOther, 3, LANE_LED, NUM_LED - LANE_LED));
+    WSShmClose(&sOther);
+    WSShmLaneRelease(&sProd);
+
+    //
+    // A child holding a run that exits doesn't block it
+    //
+    iPid = fork();
+    if(iPid == 0)
+    {
+        _exit(WSShmLaneClaim(&sProd, 3, 0, NUM_LED) ? 0 : 1);
+    }
+    waitpid(iPid, &iStatus, 0);
+    WS_CHECK(WIFEXITED(iStatus) && !WEXITSTATUS(iStatus));
+    WS_CHECK(WSShmLaneClaim(&sProd, 0, 0, NUM_LED));
+
+    //
+    // Nothing published yet, so there is nothing to encode
+    //
+    WS_CHECK(WSShmConsume(&sShm, g_pui8SPI, NULL) == 0);
+
+    WSShmClose(&sProd);
+    WSShmClose(&sShm);
+    WS_CHECK(!WSShmAttach(&sProd, g_pcName));
+}
+
+//*****************************************************************************
+//
+// Producers in their own processes publish as fast as they can while the
+// consumer encodes.  Every lane's LEDs always come from one frame, frames
+// are never seen out of order, frames seen plus frames dropped add up, and
+// the last frame of every lane is the last one encoded.
+//
+//*****************************************************************************
+static void
+checkProducers(void)
+{
+    pid_t piPid[NUM_LANES];
+    tWSShm sShm;
+    uint64_t ui64Stamp;
+    uint32_t pui32Last[NUM_LANES];
+    uint32_t pui32Seen[NUM_LANES];
+    uint32_t ui32Torn;
+    uint32_t ui32Seen;
+    uint32_t ui32I;
+    uint16_t ui16L;
+    uint8_t *pui8Lane;
+    uint8_t ui8Value;
+    bool bDone;
+    bool bOK;
+
+    WS_CHECK(WSShmCreate(&sShm, g_pcName, NUM_LED, NUM_LANES));
+    memset(pui32Last, 0, sizeof(pui32Last));
+    memset(pui32Seen, 0, sizeof(pui32Seen));
+    ui32Torn = 0;
+
+    startProducers(piPid, NUM_LANES, NUM_PUBLISH, 0);
+    bOK = true;
+    do
+    {
+        //
+        // Look at the producers before consuming, so the last frames are
+        // always taken.
+        //
+        bDone = producersDone(piPid, NUM_LANES, &bOK);
+        if(!WSShmConsume(&sShm, g_pui8SPI, &ui64Stamp))
+        {
+            continue;
+        }
+        WS_CHECK(ui64Stamp <= WSShmNow());
+
+        for(ui16L = 0; ui16L < NUM_LANES; ui16L++)
+        {
+            pui8Lane = g_pui8SPI + (ui16L * LANE_LED * WS2812_SPI_LED_SIZE);
+            ui8Value = decodeByte(pui8Lane);
+            for(ui32I = 1; ui32I < (LANE_LED * 3); ui32I++)
+            {
+                if(decodeByte(pui8Lane + (ui32I * WS2812_SPI_BIT_WIDTH)) !=
+                   ui8Value)
+                {
+                    ui32Torn++;
+                    break;
+                }
+            }
+
+            //
+            // The colors hold the low byte of the frame number, and a frame
+            // is never older than the last one seen.
+            //
+            WS_CHECK(sShm.pui32Seq[ui16L] >= pui32Last[ui16L]);
+            WS_CHECK((uint8_t)sShm.pui32Seq[ui16L] == ui8Value);
+            if(sShm.pui32Seq[ui16L] != pui32Last[ui16L])
+            {
+                pui32Last[ui16L] = sShm.pui32Seq[ui16L];
+                pui32Seen[ui16L]++;
+            }
+        }
+    }
+    while(!bDone);
+
+    WS_CHECK(bOK);
+    WS_CHECK(ui32Torn == 0);
+    ui32Seen = 0;
+    for(ui16L = 0; ui16L < NUM_LANES; ui16L++)
+    {
+        WS_CHECK(pui32Last[ui16L] == NUM_PUBLISH);
+        ui32Seen += pui32Seen[ui16L];
+    }
+    WS_CHECK((ui32Seen + sShm.ui32Dropped) == (NUM_LANES * NUM_PUBLISH));
+
+    WSShmClose(&sShm);
+}
+
+static int
+cmpU64(const void *pvA, const void *pvB)
+{
+    uint64_t ui64A;
+    uint64_t ui64B;
+
+    ui64A = *(const uint64_t *)pvA;
+    ui64B = *(const uint64_t *)pvB;
+    return((ui64A > ui64B) - (ui64A < ui64B));
+}
+
+//*****************************************************************************
+//
+// Publish to encode latency with 1 and 4 producer processes, each publishing
+// every 500us while the consumer polls, and the drop rate with producers
+// publishing flat out.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static uint64_t pui64Lat[NUM_LANES * 2000];
+    static const uint16_t pui16Lanes[2] = { 1, NUM_LANES };
+    pid_t piPid[NUM_LANES];
+    tWSShm sShm;
+    uint64_t ui64Stamp;
+    uint64_t ui64Now;
+    uint32_t ui32N;
+    uint32_t ui32I;
+    bool bDone;
+    bool bOK;
+
+    for(ui32I = 0; ui32I < 2; ui32I++)
+    {
+        WSShmCreate(&sShm, g_pcName, NUM_LED, NUM_LANES);
+        startProducers(piPid, pui16Lanes[ui32I], 2000, 500);
+        ui32N = 0;
+        bOK = true;
+        do
+        {
+            bDone = producersDone(piPid, pui16Lanes[ui32I], &bOK);
+            if(WSShmConsume(&sShm, g_pui8SPI, &ui64Stamp))
+            {
+                ui64Now = WSShmNow();
+                if(ui32N < (sizeof(pui64Lat) / sizeof(uint64_t)))
+                {
+                    pui64Lat[ui32N++] = ui64Now - ui64Stamp;
+                }
+            }
+        }
+        while(!bDone);
+
+        qsort(pui64Lat, ui32N, sizeof(uint64_t), cmpU64);
+        printf("%u producer%s every 500us: %5u frames encoded, %4u dropped, "
+               "latency median %6.2f us, 99%% %7.2f us, max %8.2f us\n",
+               pui16Lanes[ui32I], (pui16Lanes[ui32I] == 1) ? " " : "s",
+               ui32N, sShm.ui32Dropped, pui64Lat[ui32N / 2] / 1e3,
+               pui64Lat[(ui32N * 99) / 100] / 1e3, pui64Lat[ui32N - 1] / 1e3);
+        WSShmClose(&sShm);
+    }
+
+    WSShmCreate(&sShm, g_pcName, NUM_LED, NUM_LANES);
+    ui64Now = WSShmNow();
+    startProducers(piPid, NUM_LANES, NUM_PUBLISH, 0);
+    ui32N = 0;
+    bOK = true;
+    do
+    {
+        bDone = producersDone(piPid, NUM_LANES, &bOK);
+        ui32N += WSShmConsume(&sShm, g_pui8SPI, NULL);
+    }
+    while(!bDone);
+    ui64Now = WSShmNow() - ui64Now;
+    printf("%u producers flat out: %8.0f publishes/s, %8.0f lane frames "
+           "encoded/s, %u dropped\n", NUM_LANES,
+           (NUM_LANES * NUM_PUBLISH * 1e9) / ui64Now, (ui32N * 1e9) / ui64Now,
+           sShm.ui32Dropped);
+    WSShmClose(&sShm);
+}
+
+int
+main(int argc, char *argv[])
+{
+    snprintf(g_pcName, sizeof(g_pcName), "/wstest_shm_%d", (int)getpid());
+
+    checkClaims();
+    checkProducers();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_shm"));
+}
@@ -0,0 +1,296 @@
+//*****************************************************************************
+//
+// test_show - round trip raw frames through tools/wsshow and the replay,
+// plain and pre-encoded, with a benchmark of frames per second per core.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include "WS2812_drv.h"
+#include "WS2812_show.h"
+#include "wstest.h"
+
+#define NUM_STRIPS              3
+#define NUM_FRAMES              20
+#define MAX_STRIP_LED           500
+
+//
+// The benchmark show: 16 strips of 500 LEDs, pre-encoded
+//
+#define BENCH_STRIPS            16
+#define BENCH_LED               500
+#define BENCH_FRAMES            200
+#define BENCH_PLAYS             2000
+
+#define RAW_FILE                "test_show.raw"
+#define SHOW_FILE               "test_show.wss"
+
+static const uint16_t g_pui16NumLED[NUM_STRIPS] = { 100, 37, MAX_STRIP_LED };
+#define FRAME_LED               (100 + 37 + MAX_STRIP_LED)
+
+static uint8_t g_pui8Raw[NUM_FRAMES][FRAME_LED][3];
+static uint8_t g_pui8SPIRef[MAX_STRIP_LED * WS2812_SPI_LED_SIZE];
+
+//*****************************************************************************
+//
+// Write the raw frames and run the converter with pcOptions.
+//
+//*****************************************************************************
+static bool
+convert(const char *pcOptions, const char *pcLeds, const void *pvRaw,
+        size_t szRaw, uint32_t ui32Count)
+{
+    char pcCmd[256];
+    FILE *psFile;
+    uint32_t ui32N;
+
+    psFile = fopen(RAW_FILE, "wb");
+    if(!psFile)
+    {
+        return(false);
+    }
+    for(ui32N = 0; ui32N < ui32Count; ui32N++)
+    {
+        fwrite(pvRaw, 1, szRaw, psFile);
+    }
+    fclose(psFile);
+
+    snprintf(pcCmd, sizeof(pcCmd), "./wsshow %s 20000 %s %s %s 2>/dev/null",
+             pcOptions, pcLeds, RAW_FILE, SHOW_FILE);
+    ui32N = system(pcCmd);
+    remove(RAW_FILE);
+
+    return(ui32N == 0);
+}
+
+//*****************************************************************************
+//
+// Convert the frames plain and pre-encoded with the 50MHz plan's SPI bytes,
+// and replay each twice over: every strip's slice of every frame is what
+// was put in, starts on a cache line, and frames start on a page.
+//
+//*****************************************************************************
+static void
+checkRoundTrip(void)
+{
+    const uint8_t *pui8Strip;
+    tWSShow sShow;
+    uint32_t ui32Frame;
+    uint32_t ui32Offs;
+    uint32_t ui32Pass;
+    uint32_t ui32N;
+    uint32_t ui32I;
+    uint16_t ui16NumLED;
+    uint16_t ui16S;
+
+    for(ui32Frame = 0; ui32Frame < NUM_FRAMES; ui32Frame++)
+    {
+        for(ui32I = 0; ui32I < FRAME_LED; ui32I++)
+        {
+            g_pui8Raw[ui32Frame][ui32I][0] = WSTestRand();
+            g_pui8Raw[ui32Frame][ui32I][1] = WSTestRand();
+            g_pui8Raw[ui32Frame][ui32I][2] = WSTestRand();
+        }
+    }
+
+    for(ui32Pass = 0; ui32Pass < 2; ui32Pass++)
+    {
+        WS_CHECK(convert(ui32Pass ? "-e -s 0x7C,0x60" : "", "100,37,500",
+                         g_pui8Raw, sizeof(g_pui8Raw), 1));
+        WS_CHECK(WSShowOpen(&sShow, SHOW_FILE));
+        remove(SHOW_FILE);
+
+        WS_CHECK(sShow.ui16NumStrips == NUM_STRIPS);
+        WS_CHECK(sShow.ui32NumFrames == NUM_FRAMES);
+        WS_CHECK(sShow.ui32PeriodUs == 20000);
+        WS_CHECK(WSShowFrameTime(&sShow, 3) == 60000);
+        WS_CHECK(!(sShow.ui32DataOffs % WS_SHOW_ALIGN) &&
+                 !(sShow.ui32Stride % WS_SHOW_ALIGN));
+        WS_CHECK(ui32Pass ? ((sShow.ui16Flags & WS_SHOW_ENCODED) &&
+                             (sShow.ui8SPIHigh == 0x7C) &&
+                             (sShow.ui8SPILow == 0x60)) :
+                 !(sShow.ui16Flags & WS_SHOW_ENCODED));
+        if(ui32Pass)
+        {
+            WSEncodingSet(0x7C, 0x60);
+        }
+
+        for(ui32N = 0; ui32N < (2 * NUM_FRAMES); ui32N++)
+        {
+            ui32Frame = WSShowFrameNext(&sShow);
+            WS_CHECK(ui32Frame == (ui32N % NUM_FRAMES));
+
+            ui32Offs = 0;
+            for(ui16S = 0; ui16S < NUM_STRIPS; ui16S++)
+            {
+                pui8Strip = WSShowStripGet(&sShow, ui16S, &ui16NumLED);
+                WS_CHECK(ui16NumLED == g_pui16NumLED[ui16S]);
+                WS_CHECK(!((uintptr_t)pui8Strip % 64));
+                if(!ui32Pass)
+                {
+                    WS_CHECK(!memcmp(pui8Strip, g_pui8Raw[ui32Frame][ui32Offs],
+                                     ui16NumLED * 3));
+                }
+                else
+                {
+                    for(ui32I = 0; ui32I < ui16NumLED; ui32I++)
+                    {
+                        WSGRBtoSPI(g_pui8SPIRef +
+                                   (ui32I * WS2812_SPI_LED_SIZE),
+                                   g_pui8Raw[ui32Frame][ui32Offs + ui32I][0],
+                                   g_pui8Raw[ui32Frame][ui32Offs + ui32I][1],
+                                   g_pui8Raw[ui32Frame][ui32Offs + ui32I][2]);
+                    }
+                    WS_CHECK(!memcmp(pui8Strip, g_pui8SPIRef,
+                                     ui16NumLED * WS2812_SPI_LED_SIZE));
+                }
+                ui32Offs += ui16NumLED;
+            }
+        }
+
+        WSShowClose(&sShow);
+    }
+    WSEncodingSet(WS2812_SPI_HIGH, WS2812_SPI_LOW);
+}
+
+//*****************************************************************************
+//
+// A file that isn't a show, and a show cut short, are refused.
+//
+//*****************************************************************************
+static void
+checkBad(void)
+{
+    tWSShow sShow;
+    FILE *psFile;
+
+    psFile = fopen(SHOW_FILE, "wb");
+    fwrite(g_pui8Raw, 1, 4096, psFile);
+    fclose(psFile);
+    errno = 0;
+    WS_CHECK(!WSShowOpen(&sShow, SHOW_FILE) && (errno == EINVAL));
+
+    WS_CHECK(convert("", "100,37,500", g_pui8Raw, sizeof(g_pui8Raw), 1));
+    WS_CHECK(truncate(SHOW_FILE, WS_SHOW_ALIGN + 100) == 0);
+    errno = 0;
+    WS_CHECK(!WSShowOpen(&sShow, SHOW_FILE) && (errno == EINVAL));
+    remove(SHOW_FILE);
+
+    WS_CHECK(!WSShowOpen(&sShow, SHOW_FILE) && (errno == ENOENT));
+}
+
+//*****************************************************************************
+//
+// Process CPU time in nanoseconds.
+//
+//*****************************************************************************
+static uint64_t
+cpuNs(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &sTime);
+    return(((uint64_t)sTime.tv_sec * 1000000000) + sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Replay a pre-encoded show of 16 strips of 500 LEDs over and over, handing
+// out the slices only and then also reading every byte as a backend
+// copying the frames would.  Frames per second per core are frames over
+// the CPU time the replay used.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static uint8_t pui8Frame[BENCH_STRIPS * BENCH_LED][3];
+    static const char *ppcMode[2] = { "slices only", "reading every byte" };
+    const uint64_t *pui64Word;
+    tWSShow sShow;
+    char pcLeds[BENCH_STRIPS * 4];
+    uint64_t ui64Sum;
+    uint64_t ui64Wall;
+    uint64_t ui64CPU;
+    uint32_t ui32Mode;
+    uint32_t ui32N;
+    uint32_t ui32I;
+    uint16_t ui16NumLED;
+    uint16_t ui16S;
+
+    for(ui32I = 0; ui32I < (BENCH_STRIPS * BENCH_LED); ui32I++)
+    {
+        pui8Frame[ui32I][0] = WSTestRand();
+        pui8Frame[ui32I][1] = WSTestRand();
+        pui8Frame[ui32I][2] = WSTestRand();
+    }
+    pcLeds[0] = '\0';
+    for(ui16S = 0; ui16S < BENCH_STRIPS; ui16S++)
+    {
+        snprintf(pcLeds + strlen(pcLeds), sizeof(pcLeds) - strlen(pcLeds),
+                 ui16S ? ",%d" : "%d", BENCH_LED);
+    }
+    if(!convert("-e", pcLeds, pui8Frame, sizeof(pui8Frame), BENCH_FRAMES) ||
+       !WSShowOpen(&sShow, SHOW_FILE))
+    {
+        printf("couldn't make the benchmark show\n");
+        return;
+    }
+
+    printf("%u strips of %u LEDs, %u frames of %u bytes\n", BENCH_STRIPS,
+           BENCH_LED, BENCH_FRAMES, sShow.ui32Stride);
+    ui64Sum = 0;
+    for(ui32Mode = 0; ui32Mode < 2; ui32Mode++)
+    {
+        ui64Wall = WSTestNs();
+        ui64CPU = cpuNs();
+        for(ui32N = 0; ui32N < BENCH_PLAYS; ui32N++)
+        {
+            WSShowFrameNext(&sShow);
+            for(ui16S = 0; ui16S < BENCH_STRIPS; ui16S++)
+            {
+                pui64Word = (const uint64_t *)WSShowStripGet(&sShow, ui16S,
+                                                             &ui16NumLED);
+                ui64Sum += (uintptr_t)pui64Word;
+                if(ui32Mode)
+                {
+                    for(ui32I = 0;
+                        ui32I < ((ui16NumLED * WS2812_SPI_LED_SIZE) / 8);
+                        ui32I++)
+                    {
+                        ui64Sum += pui64Word[ui32I];
+                    }
+                }
+            }
+        }
+        ui64CPU = cpuNs() - ui64CPU;
+        ui64Wall = WSTestNs() - ui64Wall;
+
+        printf("%-20s %9.0f frames/s per core, %9.0f frames/s\n",
+               ppcMode[ui32Mode], (BENCH_PLAYS * 1e9) / ui64CPU,
+               (BENCH_PLAYS * 1e9) / ui64Wall);
+    }
+
+    WSShowClose(&sShow);
+    remove(SHOW_FILE);
+    WS_CHECK(ui64Sum != 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkRoundTrip();
+    checkBad();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_show"));
+}
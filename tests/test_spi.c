@@ -0,0 +1,565 @@
+//*****************************************************************************
+//
+// test_spi - the SSI1 uDMA driver on the simulated hardware: setting the
+// uDMA attributes before the controller is up, frames on the wire,
+// underruns when another channel hogs the controller, frames sent
+// straight from flash, including frames built by tools/wsflash, and partial
+// refresh.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "SPI_uDMA_drv.h"
+#include "WS2812_drv.h"
+#include "WS2812_flash.h"
+#include "WS2812_timing.h"
+#include "wstest.h"
+
+#define NUM_LED                 20
+#define SIM_CLOCK               50000000
+#define SIM_FRAME_LIMIT         1000000
+
+//
+// A channel below SSI1's, so it wins every default priority arbitration
+//
+#define HOG_CHANNEL             4
+
+//
+// The driver's handlers, otherwise only named in the vector table
+//
+extern void SSI1IntHandler(void);
+extern void uDMAErrorHandler(void);
+
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+
+//
+// A frame as it would be built at compile time for the legacy plan, and one
+// for the running plan, which needs a byte per WS bit of its own
+//
+#define FLASH_LED               10
+static const uint8_t g_pui8FlashLegacy[] =
+{
+    WS_FLASH_LED(0x00, 0x40, 0x00), WS_FLASH_LED(0x10, 0x10, 0x10),
+    WS_FLASH_OFF
+};
+static uint8_t g_pui8Flash[1025];
+
+//
+// Frames converted by tools/wsflash
+//
+#define TOOL_FRAMES             3
+#define RAW_FILE                "test_spi.raw"
+#define FLASH_FILE              "test_spi_flash.c"
+static uint8_t g_pui8Raw[TOOL_FRAMES][FLASH_LED][3];
+static uint8_t g_pui8Tool[TOOL_FRAMES][FLASH_LED * WS2812_SPI_LED_SIZE];
+
+static uint8_t g_ui8Done;
+static volatile uint32_t g_ui32Frames;
+
+//
+// The LED marked dirty at the end of each frame, or -1 for none
+//
+static volatile int32_t g_i32Mark = -1;
+
+static void
+frameDone(void)
+{
+    g_ui32Frames++;
+
+    //
+    // Mark one LED below too, which mustn't lower the mark
+    //
+    if(g_i32Mark >= 0)
+    {
+        SPIDirtyMark(g_i32Mark);
+        SPIDirtyMark(g_i32Mark / 2);
+    }
+}
+
+//*****************************************************************************
+//
+// Run until ui32Count more frames have been reported, or give up.
+//
+//*****************************************************************************
+static bool
+runFrames(uint32_t ui32Count)
+{
+    uint32_t ui32Target;
+    uint64_t ui64Start;
+
+    ui32Target = g_ui32Frames + ui32Count;
+    ui64Start = WSSimNow();
+    while(g_ui32Frames < ui32Target)
+    {
+        if((WSSimNow() - ui64Start) > (ui32Count * SIM_FRAME_LIMIT))
+        {
+            return(false);
+        }
+        WSSimRun(1000);
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Run ui32Count more frames from a clear recording, then long enough for
+// the last frame's data to leave the FIFO, so every frame but the one
+// already in the FIFO shows on the wire whole.
+//
+//*****************************************************************************
+static void
+recordFrames(uint32_t ui32Count)
+{
+    WSSimWireClear(1);
+    WS_CHECK(runFrames(ui32Count));
+    WSSimRun(((uint64_t)16 * WSTimingActive()->ui32BitNs *
+              (SIM_CLOCK / 1000000)) / 1000);
+}
+
+//*****************************************************************************
+//
+// Check every complete run of data on the wire, between two latches, is the
+// frame sent without a gap.  A WS bit is never an all zero byte, so the
+// data and the latch can be told apart.  Returns the number of runs.
+//
+//*****************************************************************************
+static uint32_t
+checkRuns(const uint8_t *pui8Frame, uint32_t ui32Size)
+{
+    const tWSSimWire *psWire;
+    uint32_t ui32Runs;
+    uint32_t ui32Pos;
+    uint32_t ui32End;
+    uint32_t ui32I;
+    bool bGap;
+
+    psWire = WSSimWireGet(1);
+    WS_CHECK(psWire->ui32Overflows == 0);
+
+    ui32Runs = 0;
+    ui32Pos = 0;
+    while(ui32Pos < psWire->ui32Len)
+    {
+        if(!psWire->pui8Data[ui32Pos])
+        {
+            ui32Pos++;
+            continue;
+        }
+        for(ui32End = ui32Pos;
+            (ui32End < psWire->ui32Len) && psWire->pui8Data[ui32End];
+            ui32End++)
+        {
+        }
+
+        //
+        // Skip runs cut off by the start or end of the recording
+        //
+        if((ui32Pos == 0) || (ui32End == psWire->ui32Len))
+        {
+            ui32Pos = ui32End;
+            continue;
+        }
+
+        WS_CHECK((ui32End - ui32Pos) == ui32Size);
+        WS_CHECK(!memcmp(psWire->pui8Data + ui32Pos, pui8Frame, ui32Size));
+        bGap = false;
+        for(ui32I = ui32Pos + 1; ui32I < ui32End; ui32I++)
+        {
+            if((psWire->pui64Start[ui32I] - psWire->pui64Start[ui32I - 1]) !=
+               psWire->ui32FrameCycles)
+            {
+                bGap = true;
+            }
+        }
+        WS_CHECK(!bGap);
+
+        ui32Runs++;
+        ui32Pos = ui32End;
+    }
+
+    return(ui32Runs);
+}
+
+//*****************************************************************************
+//
+// The uDMA settings can be made before anything has enabled the uDMA
+// controller, and are applied once the driver starts.  This has to come
+// first, while the controller is still off.  Without an SPI array or a
+// flash frame the driver doesn't start at all.
+//
+//*****************************************************************************
+static void
+checkConfigFirst(void)
+{
+    tWSSimConfig sConfig;
+    uint32_t ui32I;
+
+    sConfig.ui32Clock = SIM_CLOCK;
+    sConfig.ui32DMACycles = 4;
+    sConfig.ui32ISRLatency = 12;
+    sConfig.ui32ISRCycles = 200;
+    WSSimReset(&sConfig);
+    WSSimIntRegister(INT_SSI1, SSI1IntHandler);
+    WSSimIntRegister(INT_UDMAERR, uDMAErrorHandler);
+
+    g_ui8Done = 0x55;
+    InitSPITransfer(NULL, 0, &g_ui8Done);
+    WS_CHECK(g_ui8Done == 0x55);
+    WSSimRun(100000);
+    WS_CHECK(WSSimWireGet(1)->ui32Len == 0);
+
+    SPIDMAConfigSet(false, UDMA_ARB_4, false);
+    WS_CHECK(WSSimFaultsGet() == 0);
+
+    SPIFrameCallbackSet(frameDone);
+    InitSPITransfer(g_pui8SPI, sizeof(g_pui8SPI), &g_ui8Done);
+    WS_CHECK(g_ui8Done == 0);
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        WSGRBtoSPI(g_pui8SPI + (ui32I * WS2812_SPI_LED_SIZE), WSTestRand(),
+                   WSTestRand(), WSTestRand());
+    }
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// With the controller to itself the driver sends the array and a latch over
+// and over, without gaps in the data.
+//
+//*****************************************************************************
+static void
+checkFrames(void)
+{
+    WS_CHECK(runFrames(4));
+    WS_CHECK(g_ui8Done == 1);
+    WS_CHECK(checkRuns(g_pui8SPI, sizeof(g_pui8SPI)) == 3);
+    WS_CHECK(SPIUnderrunsGet() == 0);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// A lower numbered channel that always has a request starves the default
+// priority LED channel, which is seen as an underrun.  Making the LED channel
+// high priority with burst only requests while it runs gets the frames going
+// again with no more gaps.
+//
+//*****************************************************************************
+static void
+checkContention(void)
+{
+    const tWSTiming *psTiming;
+    uint32_t ui32Frames;
+    uint32_t ui32Underruns;
+
+    //
+    // Start hogging part way through the data, once the latch that follows
+    // the last reported frame has gone out.
+    //
+    psTiming = WSTimingActive();
+    WSSimRun((((uint64_t)psTiming->ui16LatchFrames + (NUM_LED * 12)) *
+              psTiming->ui32BitNs * (SIM_CLOCK / 1000000)) / 1000);
+    WSSimHogAdd(HOG_CHANNEL, UDMA_ARB_8, false);
+    ui32Frames = g_ui32Frames;
+    WSSimRun(3 * SIM_FRAME_LIMIT);
+    WS_CHECK(SPIUnderrunsGet() > 0);
+    WS_CHECK((g_ui32Frames - ui32Frames) <= 1);
+
+    SPIDMAConfigSet(true, UDMA_ARB_4, true);
+    WS_CHECK(runFrames(2));
+    ui32Underruns = SPIUnderrunsGet();
+
+    WSSimWireClear(1);
+    WS_CHECK(runFrames(4));
+    WS_CHECK(checkRuns(g_pui8SPI, sizeof(g_pui8SPI)) >= 3);
+    WS_CHECK(SPIUnderrunsGet() == ui32Underruns);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// A flash frame encoded for the running plan is sent in place of the SPI
+// array until the driver is pointed back at the array.  Frames encoded for
+// another plan, and frames too long for one uDMA transfer, are refused.
+//
+//*****************************************************************************
+static void
+checkFlash(void)
+{
+    uint32_t ui32I;
+
+    memset(g_pui8Flash, g_ui8WSSPILow, sizeof(g_pui8Flash));
+    WS_CHECK(!SPIFrameSourceSet(g_pui8Flash, sizeof(g_pui8Flash)));
+    WS_CHECK(!SPIFrameSourceSet(g_pui8Flash, 0));
+    WS_CHECK(WSTimingActive()->ui8High != WS2812_SPI_HIGH);
+    WS_CHECK(!SPIFrameSourceSet(g_pui8FlashLegacy,
+                                sizeof(g_pui8FlashLegacy)));
+
+    for(ui32I = 0; ui32I < FLASH_LED; ui32I++)
+    {
+        WSGRBtoSPI(g_pui8Flash + (ui32I * WS2812_SPI_LED_SIZE), WSTestRand(),
+                   WSTestRand(), WSTestRand());
+    }
+    WS_CHECK(SPIFrameSourceSet(g_pui8Flash, FLASH_LED * WS2812_SPI_LED_SIZE));
+    WS_CHECK(runFrames(2));
+    WSSimWireClear(1);
+    WS_CHECK(runFrames(4));
+    WS_CHECK(checkRuns(g_pui8Flash, FLASH_LED * WS2812_SPI_LED_SIZE) >= 3);
+
+    WS_CHECK(SPIFrameSourceSet(NULL, 0));
+    WS_CHECK(runFrames(2));
+    WSSimWireClear(1);
+    WS_CHECK(runFrames(4));
+    WS_CHECK(checkRuns(g_pui8SPI, sizeof(g_pui8SPI)) >= 3);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// With partial refresh on, marking LED k sends just the first k + 1 LEDs of
+// the array, and marking past the end sends all of it.  With nothing marked
+// each frame is only a latch, and frames are still reported.
+//
+//*****************************************************************************
+static void
+checkPartial(void)
+{
+    static const int32_t pi32Mark[4] = { 0, 7, NUM_LED - 1, NUM_LED + 5 };
+    const tWSSimWire *psWire;
+    uint32_t ui32Underruns;
+    uint32_t ui32Size;
+    uint32_t ui32I;
+    uint32_t ui32Data;
+
+    ui32Underruns = SPIUnderrunsGet();
+    SPIPartialRefreshSet(true, 0);
+    for(ui32I = 0; ui32I < 4; ui32I++)
+    {
+        g_i32Mark = pi32Mark[ui32I];
+        WS_CHECK(runFrames(2));
+        recordFrames(4);
+        ui32Size = (g_i32Mark < NUM_LED) ?
+                   ((uint32_t)(g_i32Mark + 1) * WS2812_SPI_LED_SIZE) :
+                   sizeof(g_pui8SPI);
+        WS_CHECK(checkRuns(g_pui8SPI, ui32Size) == 4);
+    }
+
+    g_i32Mark = -1;
+    WS_CHECK(runFrames(2));
+    g_ui8Done = 0;
+    recordFrames(4);
+    WS_CHECK(g_ui8Done == 1);
+
+    //
+    // Past the end of the last frame still in the FIFO, nothing but zeros
+    //
+    psWire = WSSimWireGet(1);
+    for(ui32I = 0; (ui32I < psWire->ui32Len) && psWire->pui8Data[ui32I];
+        ui32I++)
+    {
+    }
+    ui32Data = 0;
+    for(; ui32I < psWire->ui32Len; ui32I++)
+    {
+        ui32Data += (psWire->pui8Data[ui32I] != 0);
+    }
+    WS_CHECK(psWire->ui32Len > 0);
+    WS_CHECK(ui32Data == 0);
+    WS_CHECK(SPIUnderrunsGet() == ui32Underruns);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// With nothing marked, the whole array still goes out every N frames, and
+// a new source, flash or the array, is sent whole on the next frame.
+//
+//*****************************************************************************
+static void
+checkPartialFull(void)
+{
+    uint32_t ui32Underruns;
+    uint32_t ui32I;
+
+    ui32Underruns = SPIUnderrunsGet();
+    SPIPartialRefreshSet(true, 3);
+    recordFrames(12);
+    WS_CHECK(checkRuns(g_pui8SPI, sizeof(g_pui8SPI)) == 4);
+
+    SPIPartialRefreshSet(true, 0);
+    for(ui32I = 0; ui32I < FLASH_LED; ui32I++)
+    {
+        WSGRBtoSPI(g_pui8Flash + (ui32I * WS2812_SPI_LED_SIZE), WSTestRand(),
+                   WSTestRand(), WSTestRand());
+    }
+    WS_CHECK(runFrames(1));
+    WS_CHECK(SPIFrameSourceSet(g_pui8Flash, FLASH_LED * WS2812_SPI_LED_SIZE));
+    recordFrames(4);
+    WS_CHECK(checkRuns(g_pui8Flash, FLASH_LED * WS2812_SPI_LED_SIZE) == 1);
+
+    WS_CHECK(SPIFrameSourceSet(NULL, 0));
+    recordFrames(4);
+    WS_CHECK(checkRuns(g_pui8SPI, sizeof(g_pui8SPI)) == 1);
+
+    SPIPartialRefreshSet(false, 0);
+    recordFrames(4);
+    WS_CHECK(checkRuns(g_pui8SPI, sizeof(g_pui8SPI)) == 4);
+    WS_CHECK(SPIUnderrunsGet() == ui32Underruns);
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+//*****************************************************************************
+//
+// Convert the raw frames with tools/wsflash and pcOptions, and read the
+// bytes of the const array it writes back in.  Returns the frame count the
+// file declares, or 0 if the conversion failed.
+//
+//*****************************************************************************
+static uint32_t
+flashTool(const char *pcOptions)
+{
+    static char pcSource[65536];
+    char pcCmd[256];
+    const char *pcPos;
+    unsigned int uiByte;
+    unsigned long ulFrames;
+    uint32_t ui32I;
+    size_t szLen;
+    FILE *psFile;
+
+    psFile = fopen(RAW_FILE, "wb");
+    if(!psFile)
+    {
+        return(0);
+    }
+    fwrite(g_pui8Raw, 1, sizeof(g_pui8Raw), psFile);
+    fclose(psFile);
+
+    snprintf(pcCmd, sizeof(pcCmd), "./wsflash %s frames %d %s %s 2>/dev/null",
+             pcOptions, FLASH_LED, RAW_FILE, FLASH_FILE);
+    ui32I = system(pcCmd);
+    remove(RAW_FILE);
+    if(ui32I)
+    {
+        return(0);
+    }
+
+    psFile = fopen(FLASH_FILE, "r");
+    if(!psFile)
+    {
+        return(0);
+    }
+    szLen = fread(pcSource, 1, sizeof(pcSource) - 1, psFile);
+    pcSource[szLen] = 0;
+    fclose(psFile);
+    remove(FLASH_FILE);
+
+    //
+    // The bytes follow the array's declaration, after the comment that
+    // names the encoding
+    //
+    memset(g_pui8Tool, 0, sizeof(g_pui8Tool));
+    pcPos = strstr(pcSource, "] =");
+    for(ui32I = 0; pcPos && (ui32I < sizeof(g_pui8Tool)); ui32I++)
+    {
+        pcPos = strstr(pcPos, "0x");
+        if(!pcPos || (sscanf(pcPos, "0x%X,", &uiByte) != 1))
+        {
+            break;
+        }
+        ((uint8_t *)g_pui8Tool)[ui32I] = uiByte;
+        pcPos += 2;
+    }
+
+    pcPos = strstr(pcSource, "frames_frames = ");
+    if(!pcPos || (ui32I != sizeof(g_pui8Tool)) || strstr(pcPos, "0x") ||
+       (sscanf(pcPos, "frames_frames = %lu;", &ulFrames) != 1))
+    {
+        return(0);
+    }
+    return(ulFrames);
+}
+
+//*****************************************************************************
+//
+// Frames converted by tools/wsflash for the running plan's SPI bytes are
+// the frames encoded here, are accepted as the source, and go out on the
+// wire as they are.  Converted with the tool's default bytes they are
+// refused.
+//
+//*****************************************************************************
+static void
+checkFlashTool(void)
+{
+    const tWSTiming *psTiming;
+    uint8_t pui8LED[WS2812_SPI_LED_SIZE];
+    char pcOptions[32];
+    uint32_t ui32Frame;
+    uint32_t ui32I;
+
+    for(ui32Frame = 0; ui32Frame < TOOL_FRAMES; ui32Frame++)
+    {
+        for(ui32I = 0; ui32I < FLASH_LED; ui32I++)
+        {
+            g_pui8Raw[ui32Frame][ui32I][0] = WSTestRand();
+            g_pui8Raw[ui32Frame][ui32I][1] = WSTestRand();
+            g_pui8Raw[ui32Frame][ui32I][2] = WSTestRand();
+        }
+    }
+
+    psTiming = WSTimingActive();
+    snprintf(pcOptions, sizeof(pcOptions), "-s 0x%02X,0x%02X",
+             psTiming->ui8High, psTiming->ui8Low);
+    WS_CHECK(flashTool(pcOptions) == TOOL_FRAMES);
+    for(ui32Frame = 0; ui32Frame < TOOL_FRAMES; ui32Frame++)
+    {
+        for(ui32I = 0; ui32I < FLASH_LED; ui32I++)
+        {
+            WSGRBtoSPI(pui8LED, g_pui8Raw[ui32Frame][ui32I][0],
+                       g_pui8Raw[ui32Frame][ui32I][1],
+                       g_pui8Raw[ui32Frame][ui32I][2]);
+            WS_CHECK(!memcmp(g_pui8Tool[ui32Frame] +
+                             (ui32I * WS2812_SPI_LED_SIZE), pui8LED,
+                             WS2812_SPI_LED_SIZE));
+        }
+    }
+
+    for(ui32Frame = 0; ui32Frame < TOOL_FRAMES; ui32Frame++)
+    {
+        WS_CHECK(SPIFrameSourceSet(g_pui8Tool[ui32Frame],
+                                   sizeof(g_pui8Tool[0])));
+        WS_CHECK(runFrames(2));
+        WSSimWireClear(1);
+        WS_CHECK(runFrames(4));
+        WS_CHECK(checkRuns(g_pui8Tool[ui32Frame], sizeof(g_pui8Tool[0])) >=
+                 3);
+    }
+
+    WS_CHECK(flashTool("") == TOOL_FRAMES);
+    WS_CHECK(!SPIFrameSourceSet(g_pui8Tool[0], sizeof(g_pui8Tool[0])));
+
+    WS_CHECK(SPIFrameSourceSet(NULL, 0));
+    WS_CHECK(runFrames(2));
+    WS_CHECK(WSSimFaultsGet() == 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    checkConfigFirst();
+    checkFrames();
+    checkContention();
+    checkFlash();
+    checkFlashTool();
+    checkPartial();
+    checkPartialFull();
+
+    return(WSTestDone("test_spi"));
+}
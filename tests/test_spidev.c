@@ -0,0 +1,442 @@
+//*****************************************************************************
+//
+// test_spidev - the spidev backend writing to a pipe in place of the device:
+// the byte stream it sends, with writes interrupted by signals and cut
+// short, frames from a frame source, and how fast it can go.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "WS2812_drv.h"
+#include "SPI_uDMA_drv.h"
+#include "SPI_spidev_drv.h"
+#include "wstest.h"
+
+//
+// Enough LEDs that a frame takes more than one spidev message, with one
+// message holding the end of the data and the start of the latch
+//
+#define NUM_LED                 300
+#define NUM_FRAMES              200
+#define MAX_LED                 1000
+#define CAPTURE_SIZE            ((NUM_FRAMES + 50) * 8192)
+
+static uint8_t g_pui8SPI[MAX_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_pui8Frame[MAX_LED * WS2812_SPI_LED_SIZE];
+static uint8_t g_ui8Done;
+static volatile uint32_t g_ui32Frames;
+
+//
+// What the reader thread took out of the pipe
+//
+static uint8_t *g_pui8Capture;
+static uint32_t g_ui32CaptureLen;
+static uint64_t g_ui64Read;
+static int g_piPipe[2];
+static pthread_t g_sReader;
+
+//
+// Every third writev() fails with EINTR and every fifth writes only half of
+// what it was given, while g_bInject is set.  The test links with
+// --wrap=writev, so the backend's calls come here.
+//
+static bool g_bInject;
+static uint32_t g_ui32Writes;
+static uint32_t g_ui32Interrupted;
+static uint32_t g_ui32Short;
+
+extern ssize_t __real_writev(int iFd, const struct iovec *psIov, int iCount);
+
+ssize_t
+__wrap_writev(int iFd, const struct iovec *psIov, int iCount)
+{
+    struct iovec psHalf[4];
+    size_t szTotal;
+    size_t szLen;
+    int iI;
+
+    if(!g_bInject)
+    {
+        return(__real_writev(iFd, psIov, iCount));
+    }
+
+    g_ui32Writes++;
+    if((g_ui32Writes % 3) == 0)
+    {
+        g_ui32Interrupted++;
+        errno = EINTR;
+        return(-1);
+    }
+
+    szTotal = 0;
+    for(iI = 0; iI < iCount; iI++)
+    {
+        szTotal += psIov[iI].iov_len;
+    }
+    if(((g_ui32Writes % 5) != 0) || (szTotal < 2) || (iCount > 4))
+    {
+        return(__real_writev(iFd, psIov, iCount));
+    }
+
+    //
+    // Hand on the first half of the bytes, which may end part way through a
+    // buffer
+    //
+    g_ui32Short++;
+    szTotal /= 2;
+    for(iI = 0; szTotal; iI++)
+    {
+        szLen = (psIov[iI].iov_len < szTotal) ? psIov[iI].iov_len : szTotal;
+        psHalf[iI].iov_base = psIov[iI].iov_base;
+        psHalf[iI].iov_len = szLen;
+        szTotal -= szLen;
+    }
+    return(__real_writev(iFd, psHalf, iI));
+}
+
+static void
+frameDone(void)
+{
+    g_ui32Frames++;
+}
+
+//*****************************************************************************
+//
+// Drain the pipe until the write end is closed, keeping what fits in the
+// capture buffer if there is one.
+//
+//*****************************************************************************
+static void *
+readerThread(void *pvArg)
+{
+    uint8_t pui8Buf[65536];
+    ssize_t iRet;
+    size_t szCopy;
+    int iFd;
+
+    iFd = *(int *)pvArg;
+    while((iRet = read(iFd, pui8Buf, sizeof(pui8Buf))) != 0)
+    {
+        if(iRet < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        g_ui64Read += iRet;
+        if(g_pui8Capture != NULL)
+        {
+            szCopy = CAPTURE_SIZE - g_ui32CaptureLen;
+            szCopy = ((size_t)iRet < szCopy) ? (size_t)iRet : szCopy;
+            memcpy(g_pui8Capture + g_ui32CaptureLen, pui8Buf, szCopy);
+            g_ui32CaptureLen += szCopy;
+        }
+    }
+
+    return(NULL);
+}
+
+//*****************************************************************************
+//
+// Point the backend at a new pipe with a thread draining it, sending at
+// ui32Hz frames per second or back to back.
+//
+//*****************************************************************************
+static bool
+pipeOpen(uint32_t ui32Hz)
+{
+    if(pipe(g_piPipe) != 0)
+    {
+        return(false);
+    }
+    g_ui64Read = 0;
+    g_ui32CaptureLen = 0;
+    pthread_create(&g_sReader, NULL, readerThread, &g_piPipe[0]);
+
+    g_ui32Frames = 0;
+    SPIDevMockSet(g_piPipe[1]);
+    SPIDevFrameRateSet(ui32Hz);
+    SPIFrameCallbackSet(frameDone);
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Stop sending and wait for the reader to take everything sent.
+//
+//*****************************************************************************
+static void
+pipeClose(void)
+{
+    SPIDevStop();
+    close(g_piPipe[1]);
+    pthread_join(g_sReader, NULL);
+    close(g_piPipe[0]);
+    SPIDevMockSet(-1);
+}
+
+//*****************************************************************************
+//
+// Wait until at least ui32Count frames have been reported in all.
+//
+//*****************************************************************************
+static void
+waitFrames(uint32_t ui32Count)
+{
+    while((g_ui32Frames < ui32Count) && !SPIDevErrorGet())
+    {
+        usleep(1000);
+    }
+}
+
+//*****************************************************************************
+//
+// Find the next frame in the capture from *pui32Pos on: the data, which
+// never holds a zero byte, then the latch zeros.  Returns false at the end.
+//
+//*****************************************************************************
+static bool
+nextRun(uint32_t *pui32Pos, uint32_t *pui32Start, uint32_t *pui32Len,
+        uint32_t *pui32Latch)
+{
+    uint32_t ui32End;
+
+    if(*pui32Pos >= g_ui32CaptureLen)
+    {
+        return(false);
+    }
+
+    *pui32Start = *pui32Pos;
+    for(ui32End = *pui32Pos;
+        (ui32End < g_ui32CaptureLen) && g_pui8Capture[ui32End];
+        ui32End++)
+    {
+    }
+    *pui32Len = ui32End - *pui32Pos;
+
+    for(*pui32Pos = ui32End;
+        (*pui32Pos < g_ui32CaptureLen) && !g_pui8Capture[*pui32Pos];
+        (*pui32Pos)++)
+    {
+    }
+    *pui32Latch = *pui32Pos - ui32End;
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Send frames of ui32NumLED LEDs into a pipe at ui32Hz frames per second, or
+// back to back, until at least ui32Count have been reported, then stop.
+// Returns the time taken in nanoseconds.
+//
+//*****************************************************************************
+static uint64_t
+runPipe(uint32_t ui32NumLED, uint32_t ui32Hz, uint32_t ui32Count)
+{
+    uint64_t ui64Ns;
+    uint32_t ui32I;
+
+    if(!pipeOpen(ui32Hz))
+    {
+        WS_CHECK(false);
+        return(0);
+    }
+
+    for(ui32I = 0; ui32I < ui32NumLED; ui32I++)
+    {
+        WSGRBtoSPI(g_pui8Frame + (ui32I * WS2812_SPI_LED_SIZE), WSTestRand(),
+                   WSTestRand(), WSTestRand());
+    }
+
+    ui64Ns = WSTestNs();
+    InitSPITransfer(g_pui8SPI, ui32NumLED * WS2812_SPI_LED_SIZE, &g_ui8Done);
+    SPIDevDataSet(g_pui8Frame);
+    waitFrames(ui32Count);
+    SPIDevStop();
+    ui64Ns = WSTestNs() - ui64Ns;
+
+    pipeClose();
+    return(ui64Ns);
+}
+
+//*****************************************************************************
+//
+// With writes interrupted and cut short, the pipe still carries whole frames:
+// the SPI array then the same number of latch zeros, once per reported
+// frame.  The frames are paced so the test can stop them before the capture
+// buffer fills.  Frames sent before the switch to the filled array are all
+// zero bits, and every one after it is the filled array.
+//
+//*****************************************************************************
+static void
+checkStream(void)
+{
+    uint32_t ui32Size;
+    uint32_t ui32Latch;
+    uint32_t ui32Runs;
+    uint32_t ui32Pos;
+    uint32_t ui32Start;
+    uint32_t ui32Len;
+    uint32_t ui32Gap;
+    bool bSwitched;
+
+    WSArrayInit(g_pui8SPI, NUM_LED * WS2812_SPI_LED_SIZE);
+    g_bInject = true;
+    runPipe(NUM_LED, 1000, NUM_FRAMES);
+    g_bInject = false;
+
+    WS_CHECK(SPIDevErrorGet() == 0);
+    WS_CHECK(g_ui32Interrupted > 0);
+    WS_CHECK(g_ui32Short > 0);
+    WS_CHECK(g_ui32CaptureLen < CAPTURE_SIZE);
+
+    ui32Size = NUM_LED * WS2812_SPI_LED_SIZE;
+    ui32Latch = 0;
+    ui32Runs = 0;
+    ui32Pos = 0;
+    bSwitched = false;
+    while(nextRun(&ui32Pos, &ui32Start, &ui32Len, &ui32Gap))
+    {
+        WS_CHECK(ui32Len == ui32Size);
+        if(!bSwitched &&
+           memcmp(g_pui8Capture + ui32Start, g_pui8SPI, ui32Size))
+        {
+            bSwitched = true;
+        }
+        if(bSwitched)
+        {
+            WS_CHECK(!memcmp(g_pui8Capture + ui32Start, g_pui8Frame,
+                             ui32Size));
+        }
+
+        ui32Latch = ui32Runs++ ? ui32Latch : ui32Gap;
+        WS_CHECK((ui32Gap == ui32Latch) && (ui32Latch > 0));
+    }
+    WS_CHECK(bSwitched);
+    WS_CHECK(ui32Runs == g_ui32Frames);
+    WS_CHECK(g_ui32CaptureLen == (g_ui32Frames * (ui32Size + ui32Latch)));
+}
+
+//*****************************************************************************
+//
+// A frame source set before InitSPITransfer() is sent with no SPI array at
+// all, and one of another size set while running takes over from the next
+// frame.  Frames that aren't in the SPI bytes in use are refused, and
+// without a source or an array nothing starts.
+//
+//*****************************************************************************
+static void
+checkSource(void)
+{
+    static uint8_t pui8A[50 * WS2812_SPI_LED_SIZE];
+    static uint8_t pui8B[120 * WS2812_SPI_LED_SIZE];
+    uint32_t ui32Pos;
+    uint32_t ui32Start;
+    uint32_t ui32Len;
+    uint32_t ui32Latch;
+    uint32_t ui32RunsA;
+    uint32_t ui32RunsB;
+    uint32_t ui32I;
+
+    InitSPITransfer(NULL, 0, &g_ui8Done);
+    WS_CHECK(SPIDevErrorGet() == EINVAL);
+
+    memset(pui8A, 0x7C, sizeof(pui8A));
+    WS_CHECK(!SPIFrameSourceSet(pui8A, sizeof(pui8A)));
+    WS_CHECK(!SPIFrameSourceSet(pui8A, 0));
+
+    for(ui32I = 0; ui32I < (sizeof(pui8B) / WS2812_SPI_LED_SIZE); ui32I++)
+    {
+        WSGRBtoSPI(pui8B + (ui32I * WS2812_SPI_LED_SIZE), WSTestRand(),
+                   WSTestRand(), WSTestRand());
+    }
+    memcpy(pui8A, pui8B + sizeof(pui8A), sizeof(pui8A));
+
+    if(!pipeOpen(1000))
+    {
+        WS_CHECK(false);
+        return;
+    }
+    WS_CHECK(SPIFrameSourceSet(pui8A, sizeof(pui8A)));
+    InitSPITransfer(NULL, 0, &g_ui8Done);
+    WS_CHECK(SPIDevErrorGet() == 0);
+    waitFrames(20);
+    WS_CHECK(SPIFrameSourceSet(pui8B, sizeof(pui8B)));
+    waitFrames(g_ui32Frames + 20);
+    WS_CHECK(!SPIFrameSourceSet(NULL, 0));
+    pipeClose();
+    WS_CHECK(SPIDevErrorGet() == 0);
+
+    ui32RunsA = 0;
+    ui32RunsB = 0;
+    ui32Pos = 0;
+    while(nextRun(&ui32Pos, &ui32Start, &ui32Len, &ui32Latch))
+    {
+        if(!ui32RunsB && (ui32Len == sizeof(pui8A)))
+        {
+            WS_CHECK(!memcmp(g_pui8Capture + ui32Start, pui8A, ui32Len));
+            ui32RunsA++;
+        }
+        else
+        {
+            WS_CHECK(ui32Len == sizeof(pui8B));
+            WS_CHECK(!memcmp(g_pui8Capture + ui32Start, pui8B, ui32Len));
+            ui32RunsB++;
+        }
+    }
+    WS_CHECK(ui32RunsA >= 20);
+    WS_CHECK(ui32RunsB >= 20);
+    WS_CHECK((ui32RunsA + ui32RunsB) == g_ui32Frames);
+
+    //
+    // Back to the SPI array for whatever runs next
+    //
+    WS_CHECK(SPIFrameSourceSet(NULL, 0));
+}
+
+//*****************************************************************************
+//
+// Frames per second and bytes per second into a pipe, back to back.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    static const uint32_t pui32NumLED[2] = { 100, MAX_LED };
+    uint64_t ui64Ns;
+    uint32_t ui32I;
+
+    for(ui32I = 0; ui32I < 2; ui32I++)
+    {
+        ui64Ns = runPipe(pui32NumLED[ui32I], 0, 5000);
+        printf("%4u LEDs: %8.0f frames/s, %7.1f MB/s through a pipe\n",
+               pui32NumLED[ui32I], (g_ui32Frames * 1e9) / ui64Ns,
+               (g_ui64Read * 1e3) / ui64Ns);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    g_pui8Capture = malloc(CAPTURE_SIZE);
+    checkStream();
+    checkSource();
+    free(g_pui8Capture);
+    g_pui8Capture = NULL;
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_spidev"));
+}
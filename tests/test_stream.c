@@ -0,0 +1,399 @@
+//*****************************************************************************
+//
+// test_stream - Adalight and TPM2 parsing, fed in arbitrary pieces, from a
+// file and through a pseudo terminal, with the sustained frame rate.
+//
+//*****************************************************************************
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include "WS2812_drv.h"
+#include "WS2812_stream.h"
+#include "wstest.h"
+
+#define NUM_LED                 300
+#define FRAME_SIZE              (NUM_LED * 3)
+#define PTY_FRAMES              50
+#define BENCH_FRAMES            2000
+
+static uint8_t g_pui8Frame[FRAME_SIZE];
+static uint8_t g_pui8Expect[FRAME_SIZE];
+static uint8_t g_pui8Wire[(FRAME_SIZE * 8) + 64];
+
+//*****************************************************************************
+//
+// Append an Adalight packet for ui32Count LEDs of random colour, keeping the
+// pixel bytes in pui8Pixels.
+//
+//*****************************************************************************
+static uint32_t
+addAdalight(uint8_t *pui8Out, uint8_t *pui8Pixels, uint32_t ui32Count,
+            bool bBadCheck)
+{
+    uint32_t ui32I;
+
+    pui8Out[0] = 'A';
+    pui8Out[1] = 'd';
+    pui8Out[2] = 'a';
+    pui8Out[3] = (ui32Count - 1) >> 8;
+    pui8Out[4] = (ui32Count - 1) & 0xFF;
+    pui8Out[5] = pui8Out[3] ^ pui8Out[4] ^ 0x55 ^ (bBadCheck ? 1 : 0);
+    for(ui32I = 0; ui32I < (ui32Count * 3); ui32I++)
+    {
+        pui8Out[6 + ui32I] = WSTestRand();
+        if(pui8Pixels && (ui32I < FRAME_SIZE))
+        {
+            pui8Pixels[ui32I] = pui8Out[6 + ui32I];
+        }
+    }
+
+    return(6 + (ui32Count * 3));
+}
+
+//*****************************************************************************
+//
+// Append a TPM2 data packet of ui32Len random bytes.
+//
+//*****************************************************************************
+static uint32_t
+addTPM2(uint8_t *pui8Out, uint8_t *pui8Pixels, uint32_t ui32Len,
+        uint8_t ui8End)
+{
+    uint32_t ui32I;
+
+    pui8Out[0] = 0xC9;
+    pui8Out[1] = 0xDA;
+    pui8Out[2] = ui32Len >> 8;
+    pui8Out[3] = ui32Len & 0xFF;
+    for(ui32I = 0; ui32I < ui32Len; ui32I++)
+    {
+        pui8Out[4 + ui32I] = WSTestRand();
+        if(pui8Pixels && (ui32I < FRAME_SIZE))
+        {
+            pui8Pixels[ui32I] = pui8Out[4 + ui32I];
+        }
+    }
+    pui8Out[4 + ui32Len] = ui8End;
+
+    return(5 + ui32Len);
+}
+
+//*****************************************************************************
+//
+// Build a stream with line noise, good packets of both protocols, a bad
+// Adalight check byte, an oversized TPM2 packet and a bad TPM2 trailer.  The
+// last packet is a good Adalight frame whose pixels end up in g_pui8Expect.
+//
+//*****************************************************************************
+static uint32_t
+buildMixed(uint32_t *pui32Frames, uint32_t *pui32Errors)
+{
+    uint32_t ui32Len;
+
+    ui32Len = 0;
+    g_pui8Wire[ui32Len++] = 0x00;
+    g_pui8Wire[ui32Len++] = 'A';
+    g_pui8Wire[ui32Len++] = 0xC9;
+    ui32Len += addAdalight(g_pui8Wire + ui32Len, NULL, NUM_LED, false);
+    ui32Len += addAdalight(g_pui8Wire + ui32Len, NULL, 10, true);
+    ui32Len += addTPM2(g_pui8Wire + ui32Len, NULL, FRAME_SIZE, 0x36);
+    ui32Len += addTPM2(g_pui8Wire + ui32Len, NULL, FRAME_SIZE + 30, 0x36);
+    ui32Len += addTPM2(g_pui8Wire + ui32Len, NULL, 12, 0x35);
+    g_pui8Wire[ui32Len++] = 'A';
+    g_pui8Wire[ui32Len++] = 'd';
+    ui32Len += addAdalight(g_pui8Wire + ui32Len, g_pui8Expect, NUM_LED,
+                           false);
+
+    //
+    // Every packet but the bad check byte and bad trailer completes.  The
+    // payload after the bad Adalight header is skipped as noise.
+    //
+    *pui32Frames = 4;
+    *pui32Errors = 2;
+    return(ui32Len);
+}
+
+//*****************************************************************************
+//
+// Feed the mixed stream whole, a byte at a time and in random pieces.
+//
+//*****************************************************************************
+static void
+checkPieces(void)
+{
+    tWSStream sStream;
+    uint32_t ui32Frames;
+    uint32_t ui32Errors;
+    uint32_t ui32Len;
+    uint32_t ui32Pos;
+    uint32_t ui32Chunk;
+    uint32_t ui32Done;
+    int iWay;
+
+    for(iWay = 0; iWay < 3; iWay++)
+    {
+        //
+        // Keep the bad Adalight payload clear of header start bytes so the
+        // expected counts hold whatever the random sequence.
+        //
+        do
+        {
+            ui32Len = buildMixed(&ui32Frames, &ui32Errors);
+        }
+        while(memchr(g_pui8Wire + 3 + 6 + (NUM_LED * 3) + 6, 'A', 30) ||
+              memchr(g_pui8Wire + 3 + 6 + (NUM_LED * 3) + 6, 0xC9, 30));
+
+        memset(g_pui8Frame, 0, sizeof(g_pui8Frame));
+        WSStreamInit(&sStream, g_pui8Frame, FRAME_SIZE);
+
+        ui32Done = 0;
+        for(ui32Pos = 0; ui32Pos < ui32Len; ui32Pos += ui32Chunk)
+        {
+            if(iWay == 0)
+            {
+                ui32Chunk = ui32Len;
+            }
+            else if(iWay == 1)
+            {
+                ui32Chunk = 1;
+            }
+            else
+            {
+                ui32Chunk = 1 + (WSTestRand() % 97);
+            }
+            if(ui32Chunk > (ui32Len - ui32Pos))
+            {
+                ui32Chunk = ui32Len - ui32Pos;
+            }
+            ui32Done += WSStreamFeed(&sStream, g_pui8Wire + ui32Pos,
+                                     ui32Chunk);
+        }
+
+        WS_CHECK(ui32Done == ui32Frames);
+        WS_CHECK(sStream.ui32Frames == ui32Frames);
+        WS_CHECK(sStream.ui32Errors == ui32Errors);
+        WS_CHECK(!memcmp(g_pui8Frame, g_pui8Expect, FRAME_SIZE));
+    }
+}
+
+//*****************************************************************************
+//
+// The encoder swaps wire RGB into GRB.
+//
+//*****************************************************************************
+static void
+checkEncode(void)
+{
+    static uint8_t pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+    uint8_t pui8One[WS2812_SPI_LED_SIZE];
+    uint32_t ui32I;
+
+    WSStreamEncode(pui8SPI, g_pui8Expect, NUM_LED);
+    for(ui32I = 0; ui32I < NUM_LED; ui32I++)
+    {
+        WSGRBtoSPI(pui8One, g_pui8Expect[(ui32I * 3) + 1],
+                   g_pui8Expect[ui32I * 3], g_pui8Expect[(ui32I * 3) + 2]);
+        WS_CHECK(!memcmp(pui8SPI + (ui32I * WS2812_SPI_LED_SIZE), pui8One,
+                         WS2812_SPI_LED_SIZE));
+    }
+}
+
+//*****************************************************************************
+//
+// Stream ui32Count frames from a file descriptor, reading the way a host
+// daemon would, and return the frames parsed.
+//
+//*****************************************************************************
+static uint32_t
+readStream(int iFd, uint32_t ui32Count)
+{
+    uint8_t pui8Buf[4096];
+    tWSStream sStream;
+    uint32_t ui32Done;
+    ssize_t iLen;
+
+    WSStreamInit(&sStream, g_pui8Frame, FRAME_SIZE);
+    ui32Done = 0;
+    while(ui32Done < ui32Count)
+    {
+        iLen = read(iFd, pui8Buf, sizeof(pui8Buf));
+        if(iLen <= 0)
+        {
+            break;
+        }
+        ui32Done += WSStreamFeed(&sStream, pui8Buf, iLen);
+    }
+
+    return(ui32Done);
+}
+
+//*****************************************************************************
+//
+// Pseudo terminal writer, standing in for the PC side of a serial link.
+// Alternates the two protocols.
+//
+//*****************************************************************************
+static uint32_t g_ui32WriteFrames;
+
+static void *
+ptyWriter(void *pvArg)
+{
+    static uint8_t pui8Packet[FRAME_SIZE + 8];
+    uint32_t ui32Len;
+    uint32_t ui32Pos;
+    uint32_t ui32I;
+    ssize_t iLen;
+    int iFd;
+
+    iFd = *(int *)pvArg;
+    for(ui32I = 0; ui32I < g_ui32WriteFrames; ui32I++)
+    {
+        if(ui32I & 1)
+        {
+            ui32Len = addTPM2(pui8Packet, NULL, FRAME_SIZE, 0x36);
+        }
+        else
+        {
+            ui32Len = addAdalight(pui8Packet, NULL, NUM_LED, false);
+        }
+
+        for(ui32Pos = 0; ui32Pos < ui32Len; ui32Pos += iLen)
+        {
+            iLen = write(iFd, pui8Packet + ui32Pos, ui32Len - ui32Pos);
+            if(iLen <= 0)
+            {
+                return(NULL);
+            }
+        }
+    }
+
+    return(NULL);
+}
+
+//*****************************************************************************
+//
+// Send frames through a raw mode pseudo terminal and return the frames per
+// second received, or 0 if no pseudo terminal could be opened.
+//
+//*****************************************************************************
+static double
+ptyStream(uint32_t ui32Count, uint32_t *pui32Done)
+{
+    struct termios sTerm;
+    pthread_t sThread;
+    uint64_t ui64Ns;
+    int iMaster;
+    int iSlave;
+
+    *pui32Done = 0;
+    iMaster = posix_openpt(O_RDWR | O_NOCTTY);
+    if((iMaster < 0) || grantpt(iMaster) || unlockpt(iMaster))
+    {
+        return(0);
+    }
+    iSlave = open(ptsname(iMaster), O_RDWR | O_NOCTTY);
+    if(iSlave < 0)
+    {
+        close(iMaster);
+        return(0);
+    }
+    tcgetattr(iSlave, &sTerm);
+    cfmakeraw(&sTerm);
+    tcsetattr(iSlave, TCSANOW, &sTerm);
+
+    g_ui32WriteFrames = ui32Count;
+    ui64Ns = WSTestNs();
+    pthread_create(&sThread, NULL, ptyWriter, &iMaster);
+    *pui32Done = readStream(iSlave, ui32Count);
+    ui64Ns = WSTestNs() - ui64Ns;
+    pthread_join(sThread, NULL);
+
+    close(iSlave);
+    close(iMaster);
+
+    return((*pui32Done * 1e9) / ui64Ns);
+}
+
+//*****************************************************************************
+//
+// Parse frames recorded to a file, as a replay would.
+//
+//*****************************************************************************
+static double
+fileStream(uint32_t ui32Count, uint32_t *pui32Done)
+{
+    static uint8_t pui8Packet[FRAME_SIZE + 8];
+    uint64_t ui64Ns;
+    uint32_t ui32I;
+    FILE *psFile;
+
+    *pui32Done = 0;
+    psFile = tmpfile();
+    if(!psFile)
+    {
+        return(0);
+    }
+    for(ui32I = 0; ui32I < ui32Count; ui32I++)
+    {
+        fwrite(pui8Packet, 1,
+               (ui32I & 1) ? addTPM2(pui8Packet, NULL, FRAME_SIZE, 0x36) :
+                             addAdalight(pui8Packet, NULL, NUM_LED, false),
+               psFile);
+    }
+    fflush(psFile);
+    lseek(fileno(psFile), 0, SEEK_SET);
+
+    ui64Ns = WSTestNs();
+    *pui32Done = readStream(fileno(psFile), ui32Count);
+    ui64Ns = WSTestNs() - ui64Ns;
+    fclose(psFile);
+
+    return((*pui32Done * 1e9) / ui64Ns);
+}
+
+int
+main(int argc, char *argv[])
+{
+    uint32_t ui32Count;
+    uint32_t ui32Done;
+    double dRate;
+
+    checkPieces();
+    checkEncode();
+
+    ui32Count = WSTestBench(argc, argv) ? BENCH_FRAMES : PTY_FRAMES;
+
+    dRate = fileStream(ui32Count, &ui32Done);
+    WS_CHECK(ui32Done == ui32Count);
+    if(WSTestBench(argc, argv))
+    {
+        printf("file, %d LEDs                  %10.0f frames/s\n", NUM_LED,
+               dRate);
+    }
+
+    dRate = ptyStream(ui32Count, &ui32Done);
+    if(dRate == 0)
+    {
+        printf("test_stream: no pseudo terminal, skipping pty stream\n");
+    }
+    else
+    {
+        WS_CHECK(ui32Done == ui32Count);
+        if(WSTestBench(argc, argv))
+        {
+            printf("pty, %d LEDs                   %10.0f frames/s\n",
+                   NUM_LED, dRate);
+        }
+    }
+
+    return(WSTestDone("test_stream"));
+}
@@ -0,0 +1,311 @@
+//*****************************************************************************
+//
+// test_timing - SSI timing plans against an exhaustive search of the
+// dividers and frame shapes, checked against each chip's timing table, and
+// the dividers the plan leaves in the simulated SSI.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_drv.h"
+#include "WS2812_timing.h"
+#include "wstest.h"
+
+static const struct
+{
+    const char *pcName;
+    const tWSChipTiming *psChip;
+}
+g_psChips[3] =
+{
+    { "WS2812B", &g_sWSTimingWS2812B },
+    { "SK6812", &g_sWSTimingSK6812 },
+    { "WS2813", &g_sWSTimingWS2813 },
+};
+
+static const uint32_t g_pui32Clocks[] =
+{
+    4000000, 16000000, 20000000, 25000000, 40000000, 50000000, 66666666,
+    80000000
+};
+#define NUM_CLOCKS              (sizeof(g_pui32Clocks) / sizeof(uint32_t))
+
+//*****************************************************************************
+//
+// Whether ui32Bits SSI bits of ui32Div clocks last from ui16MinNs to
+// ui16MaxNs, as a fraction of a second compared without rounding.
+//
+//*****************************************************************************
+static bool
+inRange(uint32_t ui32Clock, uint32_t ui32Div, uint32_t ui32Bits,
+        uint32_t ui32MinNs, uint32_t ui32MaxNs)
+{
+    uint64_t ui64Clocks;
+
+    ui64Clocks = (uint64_t)ui32Bits * ui32Div;
+
+    return(((ui64Clocks * 1000000000) >= ((uint64_t)ui32MinNs * ui32Clock)) &&
+           ((ui64Clocks * 1000000000) <= ((uint64_t)ui32MaxNs * ui32Clock)));
+}
+
+//*****************************************************************************
+//
+// Whether an SSI divider can be made from an even prescaler and a serial
+// clock rate.
+//
+//*****************************************************************************
+static bool
+divOK(uint32_t ui32Div)
+{
+    uint32_t ui32Pre;
+
+    for(ui32Pre = 2; ui32Pre <= 254; ui32Pre += 2)
+    {
+        if(((ui32Div % ui32Pre) == 0) && ((ui32Div / ui32Pre) <= 256))
+        {
+            return(true);
+        }
+    }
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Whether a WS bit of ui32Bits frame bits with ui32K0 and ui32K1 high bits
+// for a zero and a one meets every line of the chip's table.
+//
+//*****************************************************************************
+static bool
+shapeOK(uint32_t ui32Clock, const tWSChipTiming *psChip, uint32_t ui32Div,
+        uint32_t ui32Bits, uint32_t ui32K0, uint32_t ui32K1)
+{
+    return(inRange(ui32Clock, ui32Div, ui32Bits, psChip->ui16BitMin,
+                   psChip->ui16BitMax) &&
+           inRange(ui32Clock, ui32Div, ui32K0, psChip->ui16T0HMin,
+                   psChip->ui16T0HMax) &&
+           inRange(ui32Clock, ui32Div, ui32K1, psChip->ui16T1HMin,
+                   psChip->ui16T1HMax) &&
+           inRange(ui32Clock, ui32Div, ui32Bits - ui32K0, psChip->ui16TLMin,
+                   UINT32_MAX / 4) &&
+           inRange(ui32Clock, ui32Div, ui32Bits - ui32K1, psChip->ui16TLMin,
+                   UINT32_MAX / 4));
+}
+
+//*****************************************************************************
+//
+// Shortest WS bit, in system clocks, of any divider and frame shape that
+// meets the chip's table, or 0 if none does.
+//
+//*****************************************************************************
+static uint32_t
+searchAll(uint32_t ui32Clock, const tWSChipTiming *psChip)
+{
+    uint32_t ui32Best;
+    uint32_t ui32Div;
+    uint32_t ui32Bits;
+    uint32_t ui32K0;
+    uint32_t ui32K1;
+
+    ui32Best = 0;
+    for(ui32Div = 2; ui32Div <= (254 * 256); ui32Div += 2)
+    {
+        if(!divOK(ui32Div))
+        {
+            continue;
+        }
+        for(ui32Bits = 4; ui32Bits <= 8; ui32Bits++)
+        {
+            if(ui32Best && ((ui32Bits * ui32Div) >= ui32Best))
+            {
+                continue;
+            }
+            for(ui32K0 = 1; ui32K0 < ui32Bits; ui32K0++)
+            {
+                for(ui32K1 = ui32K0 + 1; ui32K1 < ui32Bits; ui32K1++)
+                {
+                    if(shapeOK(ui32Clock, psChip, ui32Div, ui32Bits, ui32K0,
+                               ui32K1))
+                    {
+                        ui32Best = ui32Bits * ui32Div;
+                    }
+                }
+            }
+        }
+    }
+
+    return(ui32Best);
+}
+
+//
+// Number of high bits at the top of an SPI byte of ui32Bits bits, or 0 if
+// the byte isn't a run of ones followed by zeros.
+//
+static uint32_t
+highBits(uint8_t ui8Byte, uint32_t ui32Bits)
+{
+    uint32_t ui32K;
+
+    for(ui32K = 1; ui32K < ui32Bits; ui32K++)
+    {
+        if(ui8Byte == (((1 << ui32K) - 1) << (ui32Bits - ui32K)))
+        {
+            return(ui32K);
+        }
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Every plan is as fast as the exhaustive search allows, meets every line of
+// its chip's table, and latches for at least the chip's reset time.  Where
+// nothing fits, the planner says so.
+//
+//*****************************************************************************
+static void
+checkPlans(void)
+{
+    const tWSChipTiming *psChip;
+    tWSTiming sPlan;
+    uint32_t ui32Clock;
+    uint32_t ui32Best;
+    uint32_t ui32Div;
+    uint32_t ui32C;
+    uint32_t ui32I;
+    bool bPlanned;
+
+    for(ui32C = 0; ui32C < 3; ui32C++)
+    {
+        psChip = g_psChips[ui32C].psChip;
+        for(ui32I = 0; ui32I < NUM_CLOCKS; ui32I++)
+        {
+            ui32Clock = g_pui32Clocks[ui32I];
+            ui32Best = searchAll(ui32Clock, psChip);
+            bPlanned = WSTimingPlan(ui32Clock, psChip, &sPlan);
+
+            WS_CHECK(bPlanned == (ui32Best != 0));
+            if(!bPlanned)
+            {
+                continue;
+            }
+
+            ui32Div = sPlan.ui16Prescale * (sPlan.ui16SCR + 1);
+            WS_CHECK((sPlan.ui16Prescale >= 2) &&
+                     (sPlan.ui16Prescale <= 254) &&
+                     !(sPlan.ui16Prescale & 1) && (sPlan.ui16SCR <= 255));
+            WS_CHECK((ui32Div * sPlan.ui8FrameBits) == ui32Best);
+            WS_CHECK(sPlan.ui32BitRate == (ui32Clock / ui32Div));
+            WS_CHECK(shapeOK(ui32Clock, psChip, ui32Div, sPlan.ui8FrameBits,
+                             highBits(sPlan.ui8Low, sPlan.ui8FrameBits),
+                             highBits(sPlan.ui8High, sPlan.ui8FrameBits)));
+            WS_CHECK(sPlan.ui32BitNs ==
+                     (uint32_t)(((uint64_t)ui32Best * 1000000000) /
+                                ui32Clock));
+            WS_CHECK(((uint32_t)sPlan.ui16LatchFrames * sPlan.ui32BitNs) >=
+                     ((uint32_t)psChip->ui16ResetUs * 1000));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// The plan's dividers and frame size end up in the SSI registers, and the
+// active plan at a clock nothing fits falls back to the original timing.
+//
+//*****************************************************************************
+static void
+checkConfig(void)
+{
+    tWSSimConfig sConfig;
+    tWSTiming sPlan;
+
+    sConfig.ui32Clock = 50000000;
+    sConfig.ui32DMACycles = 4;
+    sConfig.ui32ISRLatency = 12;
+    sConfig.ui32ISRCycles = 100;
+    WSSimReset(&sConfig);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_SSI1);
+
+    WS_CHECK(WSTimingPlan(50000000, &g_sWSTimingWS2813, &sPlan));
+    WSTimingConfigSSI(SSI1_BASE, &sPlan);
+    WS_CHECK(HWREG(SSI1_BASE + SSI_O_CPSR) == sPlan.ui16Prescale);
+    WS_CHECK(((HWREG(SSI1_BASE + SSI_O_CR0) & SSI_CR0_SCR_M) >>
+              SSI_CR0_SCR_S) == sPlan.ui16SCR);
+    WS_CHECK(((HWREG(SSI1_BASE + SSI_O_CR0) & SSI_CR0_DSS_M) + 1) ==
+             sPlan.ui8FrameBits);
+    WS_CHECK(WSSimFaultsGet() == 0);
+
+    //
+    // Nothing fits a WS2812B at 4MHz, and this run hasn't selected a plan
+    // yet.
+    //
+    sConfig.ui32Clock = 4000000;
+    WSSimReset(&sConfig);
+    WS_CHECK(!WSTimingPlan(4000000, &g_sWSTimingWS2812B, &sPlan));
+    WS_CHECK(WSTimingActive()->ui32BitRate == 2500000);
+    WS_CHECK(WSTimingActive()->ui8FrameBits == 8);
+    WS_CHECK(WSTimingActive()->ui8High == WS2812_SPI_HIGH);
+    WS_CHECK(WSTimingActive()->ui8Low == WS2812_SPI_LOW);
+}
+
+//*****************************************************************************
+//
+// The plan for each chip and clock, and how long planning takes.
+//
+//*****************************************************************************
+static void
+bench(void)
+{
+    tWSTiming sPlan;
+    uint64_t ui64Ns;
+    uint32_t ui32C;
+    uint32_t ui32I;
+    uint32_t ui32N;
+
+    for(ui32C = 0; ui32C < 3; ui32C++)
+    {
+        for(ui32I = 0; ui32I < NUM_CLOCKS; ui32I++)
+        {
+            ui64Ns = WSTestNs();
+            for(ui32N = 0; ui32N < 100; ui32N++)
+            {
+                if(!WSTimingPlan(g_pui32Clocks[ui32I], g_psChips[ui32C].psChip,
+                                 &sPlan))
+                {
+                    break;
+                }
+            }
+            ui64Ns = WSTestNs() - ui64Ns;
+
+            if(ui32N < 100)
+            {
+                printf("%-8s %8.3f MHz  no plan\n", g_psChips[ui32C].pcName,
+                       g_pui32Clocks[ui32I] / 1e6);
+                continue;
+            }
+            printf("%-8s %8.3f MHz  %u bit frames, high 0x%02x low 0x%02x, "
+                   "%4u ns per bit, latch %3u frames, planned in %6.1f us\n",
+                   g_psChips[ui32C].pcName, g_pui32Clocks[ui32I] / 1e6,
+                   sPlan.ui8FrameBits, sPlan.ui8High, sPlan.ui8Low,
+                   sPlan.ui32BitNs, sPlan.ui16LatchFrames,
+                   (double)ui64Ns / 100000.0);
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    checkPlans();
+    checkConfig();
+
+    if(WSTestBench(argc, argv))
+    {
+        bench();
+    }
+
+    return(WSTestDone("test_timing"));
+}
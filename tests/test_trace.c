@@ -0,0 +1,243 @@
+//*****************************************************************************
+//
+// test_trace - round trip a synthetic trace dump through tools/wstrace: the
+// header, the timeline across a wrap of the cycle counter, and each
+// histogram, with render latency timed from the SSI1 latch.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "WS2812_trace.h"
+#include "wstest.h"
+
+#define DUMP_FILE               "test_trace.bin"
+#define TRACE_CLOCK             50000000
+#define CYCLES_PER_US           (TRACE_CLOCK / 1000000)
+#define NUM_FRAMES              10
+#define FRAME_US                1000
+#define MAX_RECORDS             (NUM_FRAMES * 10)
+
+//
+// Start the cycle counter 2.5 frames before it wraps
+//
+#define FIRST_CYCLES            (0u - ((FRAME_US * 5 / 2) * CYCLES_PER_US))
+
+static tWSTraceRecord g_psRecords[MAX_RECORDS];
+static uint32_t g_ui32Records;
+static char g_pcOut[65536];
+
+//*****************************************************************************
+//
+// Add a record ui32Us into the trace.
+//
+//*****************************************************************************
+static void
+addRecord(uint32_t ui32Us, uint8_t ui8Event, uint8_t ui8Id, uint16_t ui16Arg)
+{
+    tWSTraceRecord *psRec;
+
+    psRec = &g_psRecords[g_ui32Records++];
+    psRec->ui32Cycles = FIRST_CYCLES + (ui32Us * CYCLES_PER_US);
+    psRec->ui8Event = ui8Event;
+    psRec->ui8Id = ui8Id;
+    psRec->ui16Arg = ui16Arg;
+}
+
+//*****************************************************************************
+//
+// Write a dump of the trace as WSTraceDrain() sends it, after some console
+// text, with the last ui32Short records cut off.
+//
+//*****************************************************************************
+static bool
+writeDump(uint32_t ui32Short)
+{
+    uint32_t pui32Header[3];
+    FILE *psFile;
+
+    psFile = fopen(DUMP_FILE, "wb");
+    if(!psFile)
+    {
+        return(false);
+    }
+    fputs("boot\r\nWS trace:\r\n", psFile);
+    pui32Header[0] = TRACE_CLOCK;
+    pui32Header[1] = g_ui32Records;
+    pui32Header[2] = 17;
+    fwrite("WST1", 1, 4, psFile);
+    fwrite(pui32Header, 1, sizeof(pui32Header), psFile);
+    fwrite(g_psRecords, sizeof(tWSTraceRecord), g_ui32Records - ui32Short,
+           psFile);
+    fclose(psFile);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Run the decoder with pcOptions on the dump, collecting what it prints.
+// Returns its exit status.
+//
+//*****************************************************************************
+static int
+decode(const char *pcOptions)
+{
+    char pcCmd[256];
+    FILE *psPipe;
+    size_t szLen;
+
+    snprintf(pcCmd, sizeof(pcCmd), "./wstrace %s %s 2>&1", pcOptions,
+             DUMP_FILE);
+    psPipe = popen(pcCmd, "r");
+    if(!psPipe)
+    {
+        g_pcOut[0] = 0;
+        return(-1);
+    }
+    szLen = fread(g_pcOut, 1, sizeof(g_pcOut) - 1, psPipe);
+    g_pcOut[szLen] = 0;
+    return(pclose(psPipe));
+}
+
+//*****************************************************************************
+//
+// Count the lines of the output that contain pcText.
+//
+//*****************************************************************************
+static uint32_t
+countLines(const char *pcText)
+{
+    char pcLine[256];
+    const char *pcPos;
+    size_t szLen;
+    uint32_t ui32Count;
+
+    ui32Count = 0;
+    for(pcPos = g_pcOut; *pcPos; pcPos += szLen + (pcPos[szLen] != 0))
+    {
+        szLen = strcspn(pcPos, "\n");
+        snprintf(pcLine, sizeof(pcLine), "%.*s", (int)szLen, pcPos);
+        if(strstr(pcLine, pcText))
+        {
+            ui32Count++;
+        }
+    }
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+// Ten frames a millisecond apart.  Each starts with the SSI1 handler arming
+// the latch, 4us long, and the render job starting 8us after the latch
+// and taking 30us or 50us.  Half way through the frame the handler arms the
+// data, 3us long, which must not count as the end of a frame.
+//
+//*****************************************************************************
+static void
+buildTrace(void)
+{
+    uint32_t ui32Frame;
+    uint32_t ui32T;
+
+    g_ui32Records = 0;
+    for(ui32Frame = 0; ui32Frame < NUM_FRAMES; ui32Frame++)
+    {
+        ui32T = ui32Frame * FRAME_US;
+        addRecord(ui32T, WS_TRACE_ISR_ENTER, WS_TRACE_ID_SSI1, 0);
+        addRecord(ui32T + 2, WS_TRACE_LATCH, WS_TRACE_ID_SSI1, 0);
+        addRecord(ui32T + 4, WS_TRACE_ISR_EXIT, WS_TRACE_ID_SSI1, 0);
+        addRecord(ui32T + 10, WS_TRACE_RENDER_START, 0, 0);
+        addRecord(ui32T + 10 + ((ui32Frame & 1) ? 30 : 50),
+                  WS_TRACE_RENDER_END, 0, 0);
+        addRecord(ui32T + 500, WS_TRACE_ISR_ENTER, WS_TRACE_ID_SSI1, 0);
+        addRecord(ui32T + 501, WS_TRACE_ARMED, WS_TRACE_ID_SSI1, 480);
+        addRecord(ui32T + 503, WS_TRACE_ISR_EXIT, WS_TRACE_ID_SSI1, 0);
+    }
+    addRecord(ui32T + 600, WS_TRACE_USER + 2, 7, 1234);
+}
+
+//*****************************************************************************
+//
+// The decoded dump: the header, one timeline line per record with times
+// that carry on across the counter wrap, and the histograms.
+//
+//*****************************************************************************
+static void
+checkDecode(void)
+{
+    char pcLine[80];
+
+    buildTrace();
+    WS_CHECK(writeDump(0));
+
+    WS_CHECK(decode("") == 0);
+    snprintf(pcLine, sizeof(pcLine),
+             "%u records at %uHz, 17 older records overwritten",
+             g_ui32Records, TRACE_CLOCK);
+    WS_CHECK(countLines(pcLine) == 1);
+    WS_CHECK(countLines(".00us  ") == g_ui32Records);
+    WS_CHECK(countLines("LATCH        SSI1") == NUM_FRAMES);
+    WS_CHECK(countLines("ARMED        SSI1     480") == NUM_FRAMES);
+    WS_CHECK(countLines("RENDER_START job 0") == NUM_FRAMES);
+    WS_CHECK(countLines("USER2        7        1234") == 1);
+    snprintf(pcLine, sizeof(pcLine), "%.2fus %+10.2fus  USER2",
+             (double)(((NUM_FRAMES - 1) * FRAME_US) + 600), 97.0);
+    WS_CHECK(countLines(pcLine) == 1);
+
+    WS_CHECK(decode("-q") == 0);
+    WS_CHECK(countLines(".00us  ") == 0);
+    WS_CHECK(countLines("SSI1 handler run time: 20 samples, min 3.0us, "
+                        "avg 3.5us, max 4.0us") == 1);
+    WS_CHECK(countLines("SSI1 latch period: 9 samples, min 1000.0us, "
+                        "avg 1000.0us, max 1000.0us") == 1);
+    WS_CHECK(countLines("Render job 0 run time: 10 samples, min 30.0us, "
+                        "avg 40.0us, max 50.0us") == 1);
+    WS_CHECK(countLines("Frame done to render start latency: 10 samples, "
+                        "min 8.0us, avg 8.0us, max 8.0us") == 1);
+    WS_CHECK(countLines("2us-4us      10 |") == 1);
+    WS_CHECK(countLines("UART0") == 0);
+}
+
+//*****************************************************************************
+//
+// A dump cut short is decoded as far as it goes, and a dump without a
+// header, or with no such file, is an error.
+//
+//*****************************************************************************
+static void
+checkBadDumps(void)
+{
+    FILE *psFile;
+
+    buildTrace();
+    WS_CHECK(writeDump(8));
+    WS_CHECK(decode("-q") == 0);
+    WS_CHECK(countLines("dump truncated, 73 of 81 records") == 1);
+    WS_CHECK(countLines("Frame done to render start latency: 9 samples") ==
+             1);
+
+    psFile = fopen(DUMP_FILE, "wb");
+    WS_CHECK(psFile != NULL);
+    if(psFile)
+    {
+        fputs("no trace here, just console text\r\n", psFile);
+        fclose(psFile);
+    }
+    WS_CHECK(decode("-q") != 0);
+    WS_CHECK(countLines("no trace header found") == 1);
+
+    remove(DUMP_FILE);
+    WS_CHECK(decode("-q") != 0);
+}
+
+int
+main(void)
+{
+    checkDecode();
+    checkBadDumps();
+
+    return(WSTestDone("test_trace"));
+}
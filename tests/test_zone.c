@@ -0,0 +1,318 @@
+//*****************************************************************************
+//
+// test_zone - the zone manager: zones rendered on their period or on
+// request, encoded only when their render reports a change, overlapping
+// and out of range zones refused, and the encoded bytes against
+// WSGRBtoSPI().
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "WS2812_drv.h"
+#include "WS2812_zone.h"
+#include "wstest.h"
+
+#define NUM_LED                 60
+#define MAX_ZONES               4
+
+//*****************************************************************************
+//
+// A zone's render function state: whether the next render changes the
+// LEDs, and what the function saw.
+//
+//*****************************************************************************
+typedef struct
+{
+    bool bChange;
+    uint32_t ui32Renders;
+    uint8_t (*pui8Colors)[3];
+    uint16_t ui16NumLED;
+}
+tTestZone;
+
+static uint8_t g_pui8Colors[NUM_LED][3];
+static uint8_t g_pui8SPI[NUM_LED * WS2812_SPI_LED_SIZE];
+static tWSZone g_psZones[MAX_ZONES];
+static tWSZoneMap g_sMap;
+static tTestZone g_psTest[MAX_ZONES];
+
+//
+// The highest LED passed to SPIDirtyMark(), or -1 for none
+//
+static int32_t g_i32DirtyMax;
+
+//*****************************************************************************
+//
+// Stands in for the SSI driver's SPIDirtyMark(), keeping the high-water
+// mark the driver would send up to.
+//
+//*****************************************************************************
+void
+SPIDirtyMark(uint16_t ui16LED)
+{
+    if((int32_t)ui16LED > g_i32DirtyMax)
+    {
+        g_i32DirtyMax = ui16LED;
+    }
+}
+
+static bool
+testRender(uint8_t pui8Colors[][3], uint16_t ui16NumLED, void *pvData)
+{
+    tTestZone *psTest;
+    uint16_t ui16I;
+
+    psTest = (tTestZone *)pvData;
+    psTest->ui32Renders++;
+    psTest->pui8Colors = pui8Colors;
+    psTest->ui16NumLED = ui16NumLED;
+    if(psTest->bChange)
+    {
+        for(ui16I = 0; ui16I < ui16NumLED; ui16I++)
+        {
+            pui8Colors[ui16I][0] = WSTestRand();
+            pui8Colors[ui16I][1] = WSTestRand();
+            pui8Colors[ui16I][2] = WSTestRand();
+        }
+    }
+    return(psTest->bChange);
+}
+
+//*****************************************************************************
+//
+// Start over with an empty map, a black strip and an SPI array filled with
+// a pattern that no encoded LED leaves behind.
+//
+//*****************************************************************************
+static void
+resetMap(void)
+{
+    memset(g_pui8Colors, 0, sizeof(g_pui8Colors));
+    memset(g_pui8SPI, 0xA5, sizeof(g_pui8SPI));
+    memset(g_psTest, 0, sizeof(g_psTest));
+    g_i32DirtyMax = -1;
+    WSZoneInit(&g_sMap, g_psZones, MAX_ZONES, g_pui8Colors, g_pui8SPI,
+               NUM_LED);
+}
+
+//*****************************************************************************
+//
+// Check the SPI bytes of LEDs ui16First to ui16First + ui16NumLED - 1 are
+// the encoding of their colors, or are untouched.
+//
+//*****************************************************************************
+static bool
+spiMatches(uint16_t ui16First, uint16_t ui16NumLED, bool bEncoded)
+{
+    uint8_t pui8LED[WS2812_SPI_LED_SIZE];
+    uint8_t *pui8Out;
+    uint16_t ui16I;
+    uint32_t ui32B;
+
+    for(ui16I = ui16First; ui16I < (ui16First + ui16NumLED); ui16I++)
+    {
+        if(bEncoded)
+        {
+            WSGRBtoSPI(pui8LED, g_pui8Colors[ui16I][0],
+                       g_pui8Colors[ui16I][1], g_pui8Colors[ui16I][2]);
+        }
+        else
+        {
+            memset(pui8LED, 0xA5, sizeof(pui8LED));
+        }
+        pui8Out = g_pui8SPI + ((uint32_t)ui16I * WS2812_SPI_LED_SIZE);
+        for(ui32B = 0; ui32B < WS2812_SPI_LED_SIZE; ui32B++)
+        {
+            if(pui8Out[ui32B] != pui8LED[ui32B])
+            {
+                return(false);
+            }
+        }
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Zones that overlap one already added, run off the end of the strip or
+// hold no LEDs are refused, as is a zone past the size of the map.  Zones
+// that only touch are fine, and each LED is found in its own zone.
+//
+//*****************************************************************************
+static void
+checkAdd(void)
+{
+    uint16_t ui16I;
+
+    resetMap();
+    WS_CHECK(WSZoneAdd(&g_sMap, 10, 10, 1, testRender, &g_psTest[0]) == 0);
+
+    WS_CHECK(WSZoneAdd(&g_sMap, 10, 10, 1, testRender, NULL) ==
+             WS_ZONE_NONE);
+    WS_CHECK(WSZoneAdd(&g_sMap, 5, 6, 1, testRender, NULL) == WS_ZONE_NONE);
+    WS_CHECK(WSZoneAdd(&g_sMap, 19, 5, 1, testRender, NULL) == WS_ZONE_NONE);
+    WS_CHECK(WSZoneAdd(&g_sMap, 12, 2, 1, testRender, NULL) == WS_ZONE_NONE);
+    WS_CHECK(WSZoneAdd(&g_sMap, 0, NUM_LED, 1, testRender, NULL) ==
+             WS_ZONE_NONE);
+
+    WS_CHECK(WSZoneAdd(&g_sMap, 50, 11, 1, testRender, NULL) ==
+             WS_ZONE_NONE);
+    WS_CHECK(WSZoneAdd(&g_sMap, NUM_LED, 1, 1, testRender, NULL) ==
+             WS_ZONE_NONE);
+    WS_CHECK(WSZoneAdd(&g_sMap, 0xFFFF, 2, 1, testRender, NULL) ==
+             WS_ZONE_NONE);
+    WS_CHECK(WSZoneAdd(&g_sMap, 30, 0, 1, testRender, NULL) == WS_ZONE_NONE);
+
+    WS_CHECK(WSZoneAdd(&g_sMap, 0, 10, 1, testRender, &g_psTest[1]) == 1);
+    WS_CHECK(WSZoneAdd(&g_sMap, 20, 30, 1, testRender, &g_psTest[2]) == 2);
+    WS_CHECK(WSZoneAdd(&g_sMap, 50, 10, 1, testRender, &g_psTest[3]) == 3);
+    WS_CHECK(g_sMap.ui8NumZones == MAX_ZONES);
+
+    resetMap();
+    for(ui16I = 0; ui16I < MAX_ZONES; ui16I++)
+    {
+        WS_CHECK(WSZoneAdd(&g_sMap, ui16I * 5, 5, 1, testRender,
+                           &g_psTest[ui16I]) == ui16I);
+    }
+    WS_CHECK(WSZoneAdd(&g_sMap, 40, 5, 1, testRender, NULL) == WS_ZONE_NONE);
+
+    for(ui16I = 0; ui16I < NUM_LED; ui16I++)
+    {
+        WS_CHECK(WSZoneFind(&g_sMap, ui16I) ==
+                 ((ui16I < (MAX_ZONES * 5)) ? (ui16I / 5) : WS_ZONE_NONE));
+    }
+}
+
+//*****************************************************************************
+//
+// A zone is rendered on the first frame after it is added and then once
+// every period, counting from a period change.  A zone with no period is
+// only rendered the once.
+//
+//*****************************************************************************
+static void
+checkPeriod(void)
+{
+    uint32_t ui32Frame;
+
+    resetMap();
+    WS_CHECK(WSZoneAdd(&g_sMap, 0, 10, 3, testRender, &g_psTest[0]) == 0);
+    WS_CHECK(WSZoneAdd(&g_sMap, 10, 10, 1, testRender, &g_psTest[1]) == 1);
+    WS_CHECK(WSZoneAdd(&g_sMap, 20, 10, 0, testRender, &g_psTest[2]) == 2);
+
+    for(ui32Frame = 0; ui32Frame < 30; ui32Frame++)
+    {
+        WSZoneTick(&g_sMap);
+        WS_CHECK(g_psTest[0].ui32Renders == ((ui32Frame / 3) + 1));
+        WS_CHECK(g_psTest[1].ui32Renders == (ui32Frame + 1));
+        WS_CHECK(g_psTest[2].ui32Renders == 1);
+    }
+    WS_CHECK(g_psZones[0].ui32Renders == g_psTest[0].ui32Renders);
+
+    WSZonePeriodSet(&g_sMap, 0, 5);
+    WSZonePeriodSet(&g_sMap, 1, 0);
+    for(ui32Frame = 0; ui32Frame < 30; ui32Frame++)
+    {
+        WSZoneTick(&g_sMap);
+        WS_CHECK(g_psTest[0].ui32Renders == (10 + ((ui32Frame + 1) / 5)));
+        WS_CHECK(g_psTest[1].ui32Renders == 30);
+    }
+}
+
+//*****************************************************************************
+//
+// A zone is encoded on its first frame even if the render reports nothing
+// changed, and after that only on frames where it reports a change.
+// WSZoneDirtySet() has a zone with no period rendered and encoded on the
+// next frame whatever its render reports.
+//
+//*****************************************************************************
+static void
+checkDirty(void)
+{
+    resetMap();
+    WS_CHECK(WSZoneAdd(&g_sMap, 5, 10, 1, testRender, &g_psTest[0]) == 0);
+    WS_CHECK(WSZoneAdd(&g_sMap, 30, 10, 0, testRender, &g_psTest[1]) == 1);
+
+    WS_CHECK(WSZoneTick(&g_sMap) == 2);
+    WS_CHECK(g_i32DirtyMax == 39);
+    WS_CHECK(spiMatches(5, 10, true) && spiMatches(30, 10, true));
+
+    memset(g_pui8SPI, 0xA5, sizeof(g_pui8SPI));
+    g_i32DirtyMax = -1;
+    WS_CHECK(WSZoneTick(&g_sMap) == 0);
+    WS_CHECK(WSZoneTick(&g_sMap) == 0);
+    WS_CHECK(g_psTest[0].ui32Renders == 3);
+    WS_CHECK(g_psTest[1].ui32Renders == 1);
+    WS_CHECK(g_i32DirtyMax == -1);
+    WS_CHECK(spiMatches(0, NUM_LED, false));
+
+    g_psTest[0].bChange = true;
+    WS_CHECK(WSZoneTick(&g_sMap) == 1);
+    WS_CHECK(g_i32DirtyMax == 14);
+    WS_CHECK(spiMatches(5, 10, true) && spiMatches(30, 10, false));
+
+    g_psTest[0].bChange = false;
+    memset(g_pui8SPI, 0xA5, sizeof(g_pui8SPI));
+    g_i32DirtyMax = -1;
+    WSZoneDirtySet(&g_sMap, 1);
+    WS_CHECK(WSZoneTick(&g_sMap) == 1);
+    WS_CHECK(g_psTest[1].ui32Renders == 2);
+    WS_CHECK(g_i32DirtyMax == 39);
+    WS_CHECK(spiMatches(5, 10, false) && spiMatches(30, 10, true));
+
+    WS_CHECK(WSZoneTick(&g_sMap) == 0);
+    WS_CHECK(g_psTest[1].ui32Renders == 2);
+}
+
+//*****************************************************************************
+//
+// Each render function is handed its own first LED and length, and every
+// encoded zone gives the same SPI bytes as encoding its LEDs one at a time,
+// leaving the LEDs outside the zones alone.
+//
+//*****************************************************************************
+static void
+checkEncode(void)
+{
+    static const uint16_t pui16First[MAX_ZONES] = { 0, 7, 23, 41 };
+    static const uint16_t pui16Num[MAX_ZONES] = { 7, 13, 1, 19 };
+    uint32_t ui32Frame;
+    uint8_t ui8Z;
+
+    resetMap();
+    for(ui8Z = 0; ui8Z < MAX_ZONES; ui8Z++)
+    {
+        g_psTest[ui8Z].bChange = true;
+        WS_CHECK(WSZoneAdd(&g_sMap, pui16First[ui8Z], pui16Num[ui8Z],
+                           ui8Z + 1, testRender, &g_psTest[ui8Z]) == ui8Z);
+    }
+
+    for(ui32Frame = 0; ui32Frame < 20; ui32Frame++)
+    {
+        WSZoneTick(&g_sMap);
+    }
+
+    for(ui8Z = 0; ui8Z < MAX_ZONES; ui8Z++)
+    {
+        WS_CHECK(g_psTest[ui8Z].pui8Colors ==
+                 &g_pui8Colors[pui16First[ui8Z]]);
+        WS_CHECK(g_psTest[ui8Z].ui16NumLED == pui16Num[ui8Z]);
+        WS_CHECK(spiMatches(pui16First[ui8Z], pui16Num[ui8Z], true));
+    }
+    WS_CHECK(spiMatches(20, 3, false) && spiMatches(24, 17, false));
+    WS_CHECK(g_i32DirtyMax == (NUM_LED - 1));
+}
+
+int
+main(void)
+{
+    checkAdd();
+    checkPeriod();
+    checkDirty();
+    checkEncode();
+
+    return(WSTestDone("test_zone"));
+}
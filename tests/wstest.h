@@ -0,0 +1,115 @@
+
+
+#ifndef __WSTEST_H__
+#define __WSTEST_H__
+
+//*****************************************************************************
+//
+// Helpers shared by the host tests.
+//
+// Each test program runs its checks and exits non-zero if any failed.  Run
+// with "bench" as the first argument it also runs its benchmarks.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static uint32_t g_ui32WSTestFailures;
+
+//
+// Record a failed check without stopping the test
+//
+#define WS_CHECK(cond)                                                        \
+    do                                                                        \
+    {                                                                         \
+        if(!(cond))                                                           \
+        {                                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,  \
+                    #cond);                                                   \
+            g_ui32WSTestFailures++;                                           \
+        }                                                                     \
+    }                                                                         \
+    while(0)
+
+//*****************************************************************************
+//
+// A repeatable pseudo-random sequence (xorshift32)
+//
+//*****************************************************************************
+static uint32_t g_ui32WSTestSeed = 0x12345678;
+
+static inline uint32_t
+WSTestRand(void)
+{
+    g_ui32WSTestSeed ^= g_ui32WSTestSeed << 13;
+    g_ui32WSTestSeed ^= g_ui32WSTestSeed >> 17;
+    g_ui32WSTestSeed ^= g_ui32WSTestSeed << 5;
+    return(g_ui32WSTestSeed);
+}
+
+//*****************************************************************************
+//
+// Monotonic time in nanoseconds
+//
+//*****************************************************************************
+static inline uint64_t
+WSTestNs(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return(((uint64_t)sTime.tv_sec * 1000000000) + sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Processor time stamp counter, or 0 where there isn't one to read.  On x86
+// this counts at the nominal clock rate, which is close to core cycles with
+// frequency scaling off.
+//
+//*****************************************************************************
+static inline uint64_t
+WSTestCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// Whether the benchmarks were asked for
+//
+//*****************************************************************************
+static inline int
+WSTestBench(int argc, char *argv[])
+{
+    return((argc > 1) && !strcmp(argv[1], "bench"));
+}
+
+//*****************************************************************************
+//
+// Report the result of a test program, for returning from main()
+//
+//*****************************************************************************
+static inline int
+WSTestDone(const char *pcName)
+{
+    if(g_ui32WSTestFailures)
+    {
+        printf("%s: %u checks failed\n", pcName, g_ui32WSTestFailures);
+        return(1);
+    }
+
+    printf("%s: ok\n", pcName);
+    return(0);
+}
+
+#endif // __WSTEST_H__
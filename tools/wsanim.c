@@ -0,0 +1,304 @@
+//*****************************************************************************
+//
+// wsanim - convert raw frame dumps into the compressed animation format read
+// by lib/WS2812_anim.
+//
+// The input is a file of back to back frames, each ui16NumLED * 3 bytes of
+// GRB.  The output is either the binary animation, or with -c a C source file
+// holding it as a const array that the linker will place in flash.
+//
+// Build with any host C compiler:
+//
+//    cc -O2 -I../lib -o wsanim wsanim.c
+//
+// Usage:
+//
+//    wsanim [-c name] [-k interval] <leds> <period-ms> <in.raw> <out>
+//
+// -k forces a keyframe every interval frames (default 0, only the first).
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WS2812_anim.h"
+
+//
+// Output buffer, grown as needed
+//
+static uint8_t *g_pui8Out;
+static size_t g_szOutLen;
+static size_t g_szOutCap;
+
+static void
+put8(uint8_t ui8Val)
+{
+    if(g_szOutLen == g_szOutCap)
+    {
+        g_szOutCap = g_szOutCap ? (g_szOutCap * 2) : 4096;
+        g_pui8Out = realloc(g_pui8Out, g_szOutCap);
+        if(g_pui8Out == NULL)
+        {
+            fprintf(stderr, "wsanim: out of memory\n");
+            exit(1);
+        }
+    }
+    g_pui8Out[g_szOutLen++] = ui8Val;
+}
+
+static void
+put16(uint16_t ui16Val)
+{
+    put8(ui16Val & 0xFF);
+    put8(ui16Val >> 8);
+}
+
+static void
+putBytes(const uint8_t *pui8Data, size_t szLen)
+{
+    while(szLen--)
+    {
+        put8(*pui8Data++);
+    }
+}
+
+//*****************************************************************************
+//
+// Number of LEDs starting at ui32LED that share the color of ui32LED.
+//
+//*****************************************************************************
+static uint32_t
+fillRun(const uint8_t *pui8Cur, uint32_t ui32LED, uint32_t ui32NumLED)
+{
+    uint32_t ui32End;
+
+    for(ui32End = ui32LED + 1; (ui32End < ui32NumLED) &&
+        ((ui32End - ui32LED) < 0xFFFF) &&
+        !memcmp(pui8Cur + (ui32End * 3), pui8Cur + (ui32LED * 3), 3);
+        ui32End++)
+    {
+    }
+
+    return(ui32End - ui32LED);
+}
+
+//*****************************************************************************
+//
+// Append a delta frame taking pui8Prev to pui8Cur.
+//
+//*****************************************************************************
+static void
+encodeDelta(const uint8_t *pui8Prev, const uint8_t *pui8Cur,
+            uint32_t ui32NumLED)
+{
+    uint32_t ui32LED;
+    uint32_t ui32Run;
+
+    put8(WS_ANIM_DELTA);
+
+    for(ui32LED = 0; ui32LED < ui32NumLED; ui32LED += ui32Run)
+    {
+        //
+        // Unchanged LEDs are skipped
+        //
+        if(!memcmp(pui8Prev + (ui32LED * 3), pui8Cur + (ui32LED * 3), 3))
+        {
+            for(ui32Run = 1; ((ui32LED + ui32Run) < ui32NumLED) &&
+                (ui32Run < 0xFFFF) &&
+                !memcmp(pui8Prev + ((ui32LED + ui32Run) * 3),
+                        pui8Cur + ((ui32LED + ui32Run) * 3), 3); ui32Run++)
+            {
+            }
+
+            //
+            // A trailing skip is implied by the end of the frame
+            //
+            if((ui32LED + ui32Run) < ui32NumLED)
+            {
+                put8(WS_ANIM_OP_SKIP);
+                put16(ui32Run);
+            }
+            continue;
+        }
+
+        //
+        // Runs of one color are filled
+        //
+        ui32Run = fillRun(pui8Cur, ui32LED, ui32NumLED);
+        if(ui32Run >= 2)
+        {
+            put8(WS_ANIM_OP_FILL);
+            put16(ui32Run);
+            putBytes(pui8Cur + (ui32LED * 3), 3);
+            continue;
+        }
+
+        //
+        // Everything else is copied, up to the next unchanged LED or the
+        // next run worth filling
+        //
+        for(ui32Run = 1; ((ui32LED + ui32Run) < ui32NumLED) &&
+            (ui32Run < 0xFFFF) &&
+            memcmp(pui8Prev + ((ui32LED + ui32Run) * 3),
+                   pui8Cur + ((ui32LED + ui32Run) * 3), 3) &&
+            (fillRun(pui8Cur, ui32LED + ui32Run, ui32NumLED) < 3);
+            ui32Run++)
+        {
+        }
+
+        put8(WS_ANIM_OP_COPY);
+        put16(ui32Run);
+        putBytes(pui8Cur + (ui32LED * 3), ui32Run * 3);
+    }
+
+    put8(WS_ANIM_OP_END);
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *pcName;
+    uint32_t ui32KeyInt;
+    uint32_t ui32NumLED;
+    uint32_t ui32Period;
+    uint32_t ui32Frames;
+    uint32_t ui32FrameSize;
+    size_t szMark;
+    size_t szI;
+    uint8_t *pui8Prev;
+    uint8_t *pui8Cur;
+    uint8_t *pui8Tmp;
+    FILE *psIn;
+    FILE *psOut;
+    int iArg;
+
+    pcName = NULL;
+    ui32KeyInt = 0;
+
+    for(iArg = 1; (iArg < argc) && (argv[iArg][0] == '-'); iArg++)
+    {
+        if(!strcmp(argv[iArg], "-c") && ((iArg + 1) < argc))
+        {
+            pcName = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-k") && ((iArg + 1) < argc))
+        {
+            ui32KeyInt = strtoul(argv[++iArg], NULL, 0);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if((argc - iArg) != 4)
+    {
+        fprintf(stderr, "usage: wsanim [-c name] [-k interval] <leds> "
+                "<period-ms> <in.raw> <out>\n");
+        return(1);
+    }
+
+    ui32NumLED = strtoul(argv[iArg], NULL, 0);
+    ui32Period = strtoul(argv[iArg + 1], NULL, 0);
+    if((ui32NumLED == 0) || (ui32NumLED > 0xFFFF) || (ui32Period > 0xFFFF))
+    {
+        fprintf(stderr, "wsanim: bad LED count or period\n");
+        return(1);
+    }
+
+    psIn = fopen(argv[iArg + 2], "rb");
+    if(psIn == NULL)
+    {
+        perror(argv[iArg + 2]);
+        return(1);
+    }
+
+    ui32FrameSize = ui32NumLED * 3;
+    pui8Prev = calloc(1, ui32FrameSize);
+    pui8Cur = calloc(1, ui32FrameSize);
+    if((pui8Prev == NULL) || (pui8Cur == NULL))
+    {
+        fprintf(stderr, "wsanim: out of memory\n");
+        return(1);
+    }
+
+    //
+    // Header, with the frame count patched in at the end
+    //
+    putBytes((const uint8_t *)"WSA1", 4);
+    put16(ui32NumLED);
+    put16(0);
+    put16(ui32Period);
+    put16(0);
+
+    for(ui32Frames = 0;
+        fread(pui8Cur, 1, ui32FrameSize, psIn) == ui32FrameSize;
+        ui32Frames++)
+    {
+        if(ui32Frames == 0xFFFF)
+        {
+            fprintf(stderr, "wsanim: too many frames, truncating\n");
+            break;
+        }
+
+        //
+        // Try a delta first and fall back to a keyframe if it came out
+        // bigger, or if a keyframe is due.
+        //
+        szMark = g_szOutLen;
+        if((ui32Frames != 0) &&
+           ((ui32KeyInt == 0) || (ui32Frames % ui32KeyInt)))
+        {
+            encodeDelta(pui8Prev, pui8Cur, ui32NumLED);
+        }
+        if((g_szOutLen == szMark) ||
+           ((g_szOutLen - szMark) > (ui32FrameSize + 1)))
+        {
+            g_szOutLen = szMark;
+            put8(WS_ANIM_KEY);
+            putBytes(pui8Cur, ui32FrameSize);
+        }
+
+        pui8Tmp = pui8Prev;
+        pui8Prev = pui8Cur;
+        pui8Cur = pui8Tmp;
+    }
+    fclose(psIn);
+
+    g_pui8Out[6] = ui32Frames & 0xFF;
+    g_pui8Out[7] = ui32Frames >> 8;
+
+    psOut = fopen(argv[iArg + 3], pcName ? "w" : "wb");
+    if(psOut == NULL)
+    {
+        perror(argv[iArg + 3]);
+        return(1);
+    }
+
+    if(pcName)
+    {
+        fprintf(psOut, "#include <stdint.h>\n\n");
+        fprintf(psOut, "const uint8_t %s[%lu] =\n{", pcName,
+                (unsigned long)g_szOutLen);
+        for(szI = 0; szI < g_szOutLen; szI++)
+        {
+            fprintf(psOut, "%s0x%02X,", (szI % 12) ? " " : "\n    ",
+                    g_pui8Out[szI]);
+        }
+        fprintf(psOut, "\n};\n");
+    }
+    else
+    {
+        fwrite(g_pui8Out, 1, g_szOutLen, psOut);
+    }
+    fclose(psOut);
+
+    fprintf(stderr, "wsanim: %lu frames, %lu bytes (%lu raw)\n",
+            (unsigned long)ui32Frames, (unsigned long)g_szOutLen,
+            (unsigned long)ui32Frames * ui32FrameSize);
+
+    return(0);
+}
@@ -0,0 +1,156 @@
+//*****************************************************************************
+//
+// wsflash - convert raw frame dumps into pre-encoded const frames for flash.
+//
+// The input is a file of back to back frames, each <leds> * 3 bytes of GRB.
+// The output is a C source file holding every frame as SPI bytes, ready to
+// be passed to SPIFrameSourceSet() straight from flash.  -s picks the SPI
+// bytes for a one and a zero (the default is WS2812_SPI_HIGH and
+// WS2812_SPI_LOW); they must match the timing plan the target runs with,
+// for example -s 0x7C,0x60 for a WS2812B at 50MHz.  SPIFrameSourceSet()
+// refuses frames encoded for another plan.
+//
+// Build with any host C compiler:
+//
+//    cc -O2 -I../lib -o wsflash wsflash.c ../lib/WS2812_drv.c
+//
+// Usage:
+//
+//    wsflash [-s high,low] <name> <leds> <in.raw> <out.c>
+//
+// The file declares
+//
+//    const uint8_t name[frames][leds * WS2812_SPI_LED_SIZE];
+//    const uint16_t name_frames;
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WS2812_drv.h"
+
+int
+main(int argc, char *argv[])
+{
+    const char *pcName;
+    uint32_t ui32NumLED;
+    uint32_t ui32Frames;
+    uint32_t ui32Size;
+    uint32_t ui32LED;
+    uint32_t ui32I;
+    unsigned int uiHigh;
+    unsigned int uiLow;
+    uint8_t *pui8In;
+    uint8_t *pui8SPI;
+    FILE *psIn;
+    FILE *psOut;
+    int iArg;
+
+    for(iArg = 1; (iArg < argc) && (argv[iArg][0] == '-'); iArg++)
+    {
+        if(!strcmp(argv[iArg], "-s") && ((iArg + 1) < argc) &&
+           (sscanf(argv[iArg + 1], "%i,%i", &uiHigh, &uiLow) == 2) &&
+           (uiHigh <= 0xFF) && (uiLow <= 0xFF))
+        {
+            WSEncodingSet(uiHigh, uiLow);
+            iArg++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if((argc - iArg) != 4)
+    {
+        fprintf(stderr, "usage: wsflash [-s high,low] <name> <leds> "
+                "<in.raw> <out.c>\n");
+        return(1);
+    }
+
+    pcName = argv[iArg];
+    ui32NumLED = strtoul(argv[iArg + 1], NULL, 0);
+    ui32Size = ui32NumLED * WS2812_SPI_LED_SIZE;
+
+    //
+    // A uDMA transfer moves at most 1024 bytes.
+    //
+    if((ui32NumLED == 0) || (ui32Size > 1024))
+    {
+        fprintf(stderr, "wsflash: LED count must be 1 to %u\n",
+                1024 / WS2812_SPI_LED_SIZE);
+        return(1);
+    }
+
+    psIn = fopen(argv[iArg + 2], "rb");
+    if(psIn == NULL)
+    {
+        perror(argv[iArg + 2]);
+        return(1);
+    }
+    psOut = fopen(argv[iArg + 3], "w");
+    if(psOut == NULL)
+    {
+        perror(argv[iArg + 3]);
+        return(1);
+    }
+
+    pui8In = malloc(ui32NumLED * 3);
+    pui8SPI = malloc(ui32Size);
+    if((pui8In == NULL) || (pui8SPI == NULL))
+    {
+        fprintf(stderr, "wsflash: out of memory\n");
+        return(1);
+    }
+
+    fprintf(psOut, "#include <stdint.h>\n\n");
+    fprintf(psOut, "//\n// Encoded with 0x%02X for a one and 0x%02X for a "
+            "zero\n//\n", g_ui8WSSPIHigh, g_ui8WSSPILow);
+    fprintf(psOut, "const uint8_t %s[][%lu] =\n{\n", pcName,
+            (unsigned long)ui32Size);
+
+    for(ui32Frames = 0;
+        fread(pui8In, 1, ui32NumLED * 3, psIn) == (ui32NumLED * 3);
+        ui32Frames++)
+    {
+        if(ui32Frames == 0xFFFF)
+        {
+            fprintf(stderr, "wsflash: too many frames, truncating\n");
+            break;
+        }
+
+        for(ui32LED = 0; ui32LED < ui32NumLED; ui32LED++)
+        {
+            WSGRBtoSPI(pui8SPI + (ui32LED * WS2812_SPI_LED_SIZE),
+                       pui8In[ui32LED * 3], pui8In[(ui32LED * 3) + 1],
+                       pui8In[(ui32LED * 3) + 2]);
+        }
+
+        fprintf(psOut, "    {");
+        for(ui32I = 0; ui32I < ui32Size; ui32I++)
+        {
+            fprintf(psOut, "%s0x%02X,", (ui32I % 12) ? " " : "\n        ",
+                    pui8SPI[ui32I]);
+        }
+        fprintf(psOut, "\n    },\n");
+    }
+    fclose(psIn);
+
+    fprintf(psOut, "};\n\nconst uint16_t %s_frames = %lu;\n", pcName,
+            (unsigned long)ui32Frames);
+    fclose(psOut);
+
+    if(ui32Frames == 0)
+    {
+        fprintf(stderr, "wsflash: no complete frames in %s\n",
+                argv[iArg + 2]);
+        return(1);
+    }
+
+    fprintf(stderr, "wsflash: %lu frames, %lu bytes of flash\n",
+            (unsigned long)ui32Frames, (unsigned long)(ui32Frames * ui32Size));
+    return(0);
+}
@@ -0,0 +1,237 @@
+//*****************************************************************************
+//
+// wsshow - convert raw frame dumps into the show file format replayed by
+// lib/WS2812_show.
+//
+// The input is a file of back to back frames.  Each frame holds every
+// strip's GRB bytes in turn, LEDs * 3 bytes per strip.  With -e the strips
+// are stored pre-encoded as SPI arrays so the replay only has to point the
+// output at them; -s picks the SPI bytes for a one and a zero (the default
+// is WS2812_SPI_HIGH and WS2812_SPI_LOW).
+//
+// Build with any host C compiler:
+//
+//    cc -O2 -I../lib -o wsshow wsshow.c ../lib/WS2812_drv.c
+//
+// Usage:
+//
+//    wsshow [-e] [-s high,low] <period-us> <leds>[,<leds>...] <in.raw> <out>
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WS2812_drv.h"
+#include "WS2812_show.h"
+
+//
+// Each strip's slice of a frame starts on a cache line
+//
+#define STRIP_ALIGN             64
+
+#define ALIGN(x, a)             ((((x) + (a) - 1) / (a)) * (a))
+
+static void
+put16(uint8_t *pui8Data, uint16_t ui16Val)
+{
+    pui8Data[0] = ui16Val & 0xFF;
+    pui8Data[1] = ui16Val >> 8;
+}
+
+static void
+put32(uint8_t *pui8Data, uint32_t ui32Val)
+{
+    put16(pui8Data, ui32Val & 0xFFFF);
+    put16(pui8Data + 2, ui32Val >> 16);
+}
+
+int
+main(int argc, char *argv[])
+{
+    bool bEncode;
+    char *pcList;
+    char *pcEnd;
+    uint16_t *pui16Leds;
+    uint32_t *pui32Offs;
+    uint32_t ui32Strips;
+    uint32_t ui32Period;
+    uint32_t ui32InSize;
+    uint32_t ui32Stride;
+    uint32_t ui32DataOffs;
+    uint32_t ui32Frames;
+    uint32_t ui32Offs;
+    uint32_t ui32Strip;
+    uint32_t ui32LED;
+    unsigned int uiHigh;
+    unsigned int uiLow;
+    uint8_t *pui8In;
+    uint8_t *pui8Out;
+    uint8_t *pui8Hdr;
+    const uint8_t *pui8Src;
+    FILE *psIn;
+    FILE *psOut;
+    int iArg;
+
+    bEncode = false;
+
+    for(iArg = 1; (iArg < argc) && (argv[iArg][0] == '-'); iArg++)
+    {
+        if(!strcmp(argv[iArg], "-e"))
+        {
+            bEncode = true;
+        }
+        else if(!strcmp(argv[iArg], "-s") && ((iArg + 1) < argc) &&
+                (sscanf(argv[iArg + 1], "%i,%i", &uiHigh, &uiLow) == 2) &&
+                (uiHigh <= 0xFF) && (uiLow <= 0xFF))
+        {
+            WSEncodingSet(uiHigh, uiLow);
+            iArg++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if((argc - iArg) != 4)
+    {
+        fprintf(stderr, "usage: wsshow [-e] [-s high,low] <period-us> "
+                "<leds>[,<leds>...] <in.raw> <out>\n");
+        return(1);
+    }
+
+    ui32Period = strtoul(argv[iArg], NULL, 0);
+
+    //
+    // Count the strips, then read their lengths and lay them out.
+    //
+    ui32Strips = 1;
+    for(pcList = argv[iArg + 1]; *pcList; pcList++)
+    {
+        ui32Strips += (*pcList == ',');
+    }
+    if(ui32Strips > 0xFFFF)
+    {
+        fprintf(stderr, "wsshow: too many strips\n");
+        return(1);
+    }
+    pui16Leds = calloc(ui32Strips, sizeof(uint16_t));
+    pui32Offs = calloc(ui32Strips, sizeof(uint32_t));
+    if((pui16Leds == NULL) || (pui32Offs == NULL))
+    {
+        fprintf(stderr, "wsshow: out of memory\n");
+        return(1);
+    }
+
+    pcList = argv[iArg + 1];
+    ui32InSize = 0;
+    ui32Offs = 0;
+    for(ui32Strip = 0; ui32Strip < ui32Strips; ui32Strip++)
+    {
+        ui32LED = strtoul(pcList, &pcEnd, 0);
+        if((pcEnd == pcList) || (ui32LED == 0) || (ui32LED > 0xFFFF) ||
+           ((*pcEnd != ',') && (*pcEnd != '\0')))
+        {
+            fprintf(stderr, "wsshow: bad LED count list\n");
+            return(1);
+        }
+        pcList = pcEnd + 1;
+
+        pui16Leds[ui32Strip] = ui32LED;
+        pui32Offs[ui32Strip] = ui32Offs;
+        ui32InSize += ui32LED * 3;
+        ui32Offs = ALIGN(ui32Offs + (ui32LED * (bEncode ? WS2812_SPI_LED_SIZE :
+                                                3)), STRIP_ALIGN);
+    }
+    ui32Stride = ALIGN(ui32Offs, WS_SHOW_ALIGN);
+    ui32DataOffs = ALIGN(WS_SHOW_HDR_SIZE + (ui32Strips * WS_SHOW_STRIP_SIZE),
+                         WS_SHOW_ALIGN);
+
+    psIn = fopen(argv[iArg + 2], "rb");
+    if(psIn == NULL)
+    {
+        perror(argv[iArg + 2]);
+        return(1);
+    }
+    psOut = fopen(argv[iArg + 3], "wb");
+    if(psOut == NULL)
+    {
+        perror(argv[iArg + 3]);
+        return(1);
+    }
+
+    pui8Hdr = calloc(1, ui32DataOffs);
+    pui8In = malloc(ui32InSize);
+    pui8Out = malloc(ui32Stride);
+    if((pui8Hdr == NULL) || (pui8In == NULL) || (pui8Out == NULL))
+    {
+        fprintf(stderr, "wsshow: out of memory\n");
+        return(1);
+    }
+
+    //
+    // Header and strip table, with the frame count patched in at the end
+    //
+    memcpy(pui8Hdr, "WSS1", 4);
+    put16(pui8Hdr + 4, ui32Strips);
+    put16(pui8Hdr + 6, bEncode ? WS_SHOW_ENCODED : 0);
+    put32(pui8Hdr + 12, ui32Period);
+    put32(pui8Hdr + 16, ui32Stride);
+    put32(pui8Hdr + 20, ui32DataOffs);
+    pui8Hdr[24] = g_ui8WSSPIHigh;
+    pui8Hdr[25] = g_ui8WSSPILow;
+    for(ui32Strip = 0; ui32Strip < ui32Strips; ui32Strip++)
+    {
+        put16(pui8Hdr + WS_SHOW_HDR_SIZE + (ui32Strip * WS_SHOW_STRIP_SIZE),
+              pui16Leds[ui32Strip]);
+        put32(pui8Hdr + WS_SHOW_HDR_SIZE + (ui32Strip * WS_SHOW_STRIP_SIZE) +
+              4, pui32Offs[ui32Strip]);
+    }
+    fwrite(pui8Hdr, 1, ui32DataOffs, psOut);
+
+    for(ui32Frames = 0;
+        fread(pui8In, 1, ui32InSize, psIn) == ui32InSize;
+        ui32Frames++)
+    {
+        memset(pui8Out, 0, ui32Stride);
+        pui8Src = pui8In;
+        for(ui32Strip = 0; ui32Strip < ui32Strips; ui32Strip++)
+        {
+            if(bEncode)
+            {
+                for(ui32LED = 0; ui32LED < pui16Leds[ui32Strip]; ui32LED++)
+                {
+                    WSGRBtoSPI(pui8Out + pui32Offs[ui32Strip] +
+                               (ui32LED * WS2812_SPI_LED_SIZE),
+                               pui8Src[0], pui8Src[1], pui8Src[2]);
+                    pui8Src += 3;
+                }
+            }
+            else
+            {
+                memcpy(pui8Out + pui32Offs[ui32Strip], pui8Src,
+                       pui16Leds[ui32Strip] * 3);
+                pui8Src += pui16Leds[ui32Strip] * 3;
+            }
+        }
+        if(fwrite(pui8Out, 1, ui32Stride, psOut) != ui32Stride)
+        {
+            perror(argv[iArg + 3]);
+            return(1);
+        }
+    }
+    fclose(psIn);
+
+    put32(pui8Hdr + 8, ui32Frames);
+    fseek(psOut, 0, SEEK_SET);
+    fwrite(pui8Hdr, 1, WS_SHOW_HDR_SIZE, psOut);
+    fclose(psOut);
+
+    fprintf(stderr, "wsshow: %lu strips, %lu frames, %lu bytes per frame\n",
+            (unsigned long)ui32Strips, (unsigned long)ui32Frames,
+            (unsigned long)ui32Stride);
+    return(0);
+}
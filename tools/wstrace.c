@@ -0,0 +1,426 @@
+//*****************************************************************************
+//
+// wstrace - decode a trace dump written by WSTraceDrain() in lib/WS2812_trace.
+//
+// Prints a timeline of every event followed by latency histograms: how long
+// each interrupt handler ran, the period between latches on each output, how
+// long each render job took, and how long after the SPI driver flagged the
+// end of a frame the first render job started.
+//
+// Build with any host C compiler:
+//
+//    cc -O2 -I../lib -o wstrace wstrace.c
+//
+// Usage:
+//
+//    wstrace [-q] <dump>
+//
+// The dump is the raw bytes captured from the UART; anything in front of the
+// 'WST1' header, such as console text, is skipped.  -q leaves out the
+// timeline.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WS2812_trace.h"
+
+//
+// Histogram buckets are powers of two microseconds: below 1us, 1-2us, 2-4us
+// and so on
+//
+#define NUM_BUCKETS             24
+
+typedef struct
+{
+    const char *pcName;
+    uint32_t pui32Bucket[NUM_BUCKETS];
+    uint32_t ui32Count;
+    double dMin;
+    double dMax;
+    double dSum;
+}
+tHist;
+
+static const char *g_ppcEvents[] =
+{
+    "?", "ISR_ENTER", "ISR_EXIT", "ARMED", "LATCH", "COMMIT", "RENDER_START",
+    "RENDER_END", "DMA_ERROR", "UNDERRUN"
+};
+
+static const char *g_ppcIds[] =
+{
+    "SSI1", "UART0", "TIMER0A", "PENDSV", "UDMAERR", "ADC0SS3"
+};
+
+#define NUM_IDS                 (sizeof(g_ppcIds) / sizeof(g_ppcIds[0]))
+#define NUM_JOBS                8
+
+static uint32_t
+get32(const uint8_t *pui8Data)
+{
+    return(pui8Data[0] | ((uint32_t)pui8Data[1] << 8) |
+           ((uint32_t)pui8Data[2] << 16) | ((uint32_t)pui8Data[3] << 24));
+}
+
+static const char *
+idName(uint8_t ui8Id)
+{
+    static char pcBuf[8];
+
+    if(ui8Id < NUM_IDS)
+    {
+        return(g_ppcIds[ui8Id]);
+    }
+    snprintf(pcBuf, sizeof(pcBuf), "%u", ui8Id);
+    return(pcBuf);
+}
+
+static void
+histAdd(tHist *psHist, double dUs)
+{
+    int iBucket;
+
+    for(iBucket = 0; (iBucket < (NUM_BUCKETS - 1)) &&
+        (dUs >= (double)(1u << iBucket)); iBucket++)
+    {
+    }
+
+    psHist->pui32Bucket[iBucket]++;
+    if(!psHist->ui32Count || (dUs < psHist->dMin))
+    {
+        psHist->dMin = dUs;
+    }
+    if(!psHist->ui32Count || (dUs > psHist->dMax))
+    {
+        psHist->dMax = dUs;
+    }
+    psHist->dSum += dUs;
+    psHist->ui32Count++;
+}
+
+static void
+histPrint(const tHist *psHist)
+{
+    char pcLabel[32];
+    uint32_t ui32Peak;
+    int iFirst;
+    int iLast;
+    int i;
+
+    if(!psHist->ui32Count)
+    {
+        return;
+    }
+
+    printf("\n%s: %u samples, min %.1fus, avg %.1fus, max %.1fus\n",
+           psHist->pcName, psHist->ui32Count, psHist->dMin,
+           psHist->dSum / psHist->ui32Count, psHist->dMax);
+
+    ui32Peak = 0;
+    iFirst = -1;
+    iLast = 0;
+    for(i = 0; i < NUM_BUCKETS; i++)
+    {
+        if(psHist->pui32Bucket[i])
+        {
+            if(iFirst < 0)
+            {
+                iFirst = i;
+            }
+            iLast = i;
+            if(psHist->pui32Bucket[i] > ui32Peak)
+            {
+                ui32Peak = psHist->pui32Bucket[i];
+            }
+        }
+    }
+
+    for(i = iFirst; i <= iLast; i++)
+    {
+        if(i == 0)
+        {
+            snprintf(pcLabel, sizeof(pcLabel), "<1us");
+        }
+        else
+        {
+            snprintf(pcLabel, sizeof(pcLabel), "%uus-%uus", 1u << (i - 1),
+                     1u << i);
+        }
+        printf("  %20s %7u |%.*s\n", pcLabel, psHist->pui32Bucket[i],
+               (int)((psHist->pui32Bucket[i] * 50 + ui32Peak - 1) / ui32Peak),
+               "##################################################");
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    static tHist psIsr[NUM_IDS];
+    static tHist psLatch[NUM_IDS];
+    static tHist psRender[NUM_JOBS];
+    static tHist sLatency;
+    static char ppcNames[(NUM_IDS * 2) + NUM_JOBS][40];
+    uint64_t pui64Enter[NUM_IDS];
+    uint64_t pui64Latch[NUM_IDS];
+    uint64_t pui64Render[NUM_JOBS];
+    uint64_t ui64FrameDone;
+    uint64_t ui64Now;
+    uint64_t ui64Prev;
+    uint32_t ui32Clock;
+    uint32_t ui32Records;
+    uint32_t ui32Dropped;
+    uint32_t ui32Last;
+    uint32_t ui32I;
+    uint8_t *pui8Data;
+    uint8_t *pui8Rec;
+    uint8_t ui8Event;
+    uint8_t ui8Id;
+    uint16_t ui16Arg;
+    double dUsPerCycle;
+    size_t szLen;
+    size_t szCap;
+    size_t szOffs;
+    size_t szRead;
+    bool bQuiet;
+    FILE *psIn;
+    int iArg;
+
+    bQuiet = false;
+    iArg = 1;
+    if((iArg < argc) && !strcmp(argv[iArg], "-q"))
+    {
+        bQuiet = true;
+        iArg++;
+    }
+    if((argc - iArg) != 1)
+    {
+        fprintf(stderr, "usage: wstrace [-q] <dump>\n");
+        return(1);
+    }
+
+    psIn = fopen(argv[iArg], "rb");
+    if(psIn == NULL)
+    {
+        perror(argv[iArg]);
+        return(1);
+    }
+
+    pui8Data = NULL;
+    szLen = 0;
+    szCap = 0;
+    do
+    {
+        if(szLen == szCap)
+        {
+            szCap = szCap ? (szCap * 2) : 65536;
+            pui8Data = realloc(pui8Data, szCap);
+            if(pui8Data == NULL)
+            {
+                fprintf(stderr, "wstrace: out of memory\n");
+                return(1);
+            }
+        }
+        szRead = fread(pui8Data + szLen, 1, szCap - szLen, psIn);
+        szLen += szRead;
+    }
+    while(szRead);
+    fclose(psIn);
+
+    //
+    // Find the header
+    //
+    for(szOffs = 0; (szOffs + 16) <= szLen; szOffs++)
+    {
+        if(!memcmp(pui8Data + szOffs, "WST1", 4))
+        {
+            break;
+        }
+    }
+    if((szOffs + 16) > szLen)
+    {
+        fprintf(stderr, "wstrace: no trace header found\n");
+        return(1);
+    }
+
+    ui32Clock = get32(pui8Data + szOffs + 4);
+    ui32Records = get32(pui8Data + szOffs + 8);
+    ui32Dropped = get32(pui8Data + szOffs + 12);
+    szOffs += 16;
+
+    if(ui32Clock == 0)
+    {
+        fprintf(stderr, "wstrace: bad clock rate\n");
+        return(1);
+    }
+    if(((szLen - szOffs) / sizeof(tWSTraceRecord)) < ui32Records)
+    {
+        fprintf(stderr, "wstrace: dump truncated, %lu of %u records\n",
+                (unsigned long)((szLen - szOffs) / sizeof(tWSTraceRecord)),
+                ui32Records);
+        ui32Records = (szLen - szOffs) / sizeof(tWSTraceRecord);
+    }
+
+    dUsPerCycle = 1000000.0 / ui32Clock;
+    printf("%u records at %uHz, %u older records overwritten\n", ui32Records,
+           ui32Clock, ui32Dropped);
+
+    for(ui32I = 0; ui32I < NUM_IDS; ui32I++)
+    {
+        snprintf(ppcNames[ui32I], 40, "%s handler run time", g_ppcIds[ui32I]);
+        psIsr[ui32I].pcName = ppcNames[ui32I];
+        snprintf(ppcNames[NUM_IDS + ui32I], 40, "%s latch period",
+                 g_ppcIds[ui32I]);
+        psLatch[ui32I].pcName = ppcNames[NUM_IDS + ui32I];
+        pui64Enter[ui32I] = UINT64_MAX;
+        pui64Latch[ui32I] = UINT64_MAX;
+    }
+    for(ui32I = 0; ui32I < NUM_JOBS; ui32I++)
+    {
+        snprintf(ppcNames[(NUM_IDS * 2) + ui32I], 40, "Render job %u run time",
+                 ui32I);
+        psRender[ui32I].pcName = ppcNames[(NUM_IDS * 2) + ui32I];
+        pui64Render[ui32I] = UINT64_MAX;
+    }
+    sLatency.pcName = "Frame done to render start latency";
+    ui64FrameDone = UINT64_MAX;
+
+    //
+    // The cycle counter wraps every few tens of seconds, so time is built up
+    // from the difference between consecutive records.
+    //
+    ui64Now = 0;
+    ui64Prev = 0;
+    ui32Last = 0;
+    for(ui32I = 0; ui32I < ui32Records; ui32I++)
+    {
+        pui8Rec = pui8Data + szOffs + (ui32I * sizeof(tWSTraceRecord));
+        if(ui32I)
+        {
+            ui64Now += (uint32_t)(get32(pui8Rec) - ui32Last);
+        }
+        ui32Last = get32(pui8Rec);
+        ui8Event = pui8Rec[4];
+        ui8Id = pui8Rec[5];
+        ui16Arg = pui8Rec[6] | (pui8Rec[7] << 8);
+
+        if(!bQuiet)
+        {
+            printf("%12.2fus %+10.2fus  ", ui64Now * dUsPerCycle,
+                   (ui64Now - ui64Prev) * dUsPerCycle);
+            if(ui8Event >= WS_TRACE_USER)
+            {
+                printf("USER%-8u %-8u %u\n", ui8Event - WS_TRACE_USER, ui8Id,
+                       ui16Arg);
+            }
+            else if((ui8Event == WS_TRACE_RENDER_START) ||
+                    (ui8Event == WS_TRACE_RENDER_END))
+            {
+                printf("%-12s job %-4u\n", g_ppcEvents[ui8Event], ui8Id);
+            }
+            else
+            {
+                printf("%-12s %-8s %u\n",
+                       g_ppcEvents[(ui8Event <= WS_TRACE_UNDERRUN) ?
+                                   ui8Event : 0], idName(ui8Id), ui16Arg);
+            }
+        }
+        ui64Prev = ui64Now;
+
+        switch(ui8Event)
+        {
+            case WS_TRACE_ISR_ENTER:
+            {
+                if(ui8Id < NUM_IDS)
+                {
+                    pui64Enter[ui8Id] = ui64Now;
+                }
+                break;
+            }
+
+            case WS_TRACE_ISR_EXIT:
+            {
+                if((ui8Id < NUM_IDS) && (pui64Enter[ui8Id] != UINT64_MAX))
+                {
+                    histAdd(&psIsr[ui8Id],
+                            (ui64Now - pui64Enter[ui8Id]) * dUsPerCycle);
+                    pui64Enter[ui8Id] = UINT64_MAX;
+                }
+                break;
+            }
+
+            case WS_TRACE_LATCH:
+            {
+                //
+                // The SPI driver flags a finished frame once the last data
+                // byte is in the FIFO and it arms the latch, which is what
+                // wakes the scheduler.
+                //
+                if(ui8Id == WS_TRACE_ID_SSI1)
+                {
+                    ui64FrameDone = ui64Now;
+                }
+                if(ui8Id < NUM_IDS)
+                {
+                    if(pui64Latch[ui8Id] != UINT64_MAX)
+                    {
+                        histAdd(&psLatch[ui8Id],
+                                (ui64Now - pui64Latch[ui8Id]) * dUsPerCycle);
+                    }
+                    pui64Latch[ui8Id] = ui64Now;
+                }
+                break;
+            }
+
+            case WS_TRACE_RENDER_START:
+            {
+                if(ui8Id < NUM_JOBS)
+                {
+                    pui64Render[ui8Id] = ui64Now;
+                }
+                if(ui64FrameDone != UINT64_MAX)
+                {
+                    histAdd(&sLatency, (ui64Now - ui64FrameDone) *
+                            dUsPerCycle);
+                    ui64FrameDone = UINT64_MAX;
+                }
+                break;
+            }
+
+            case WS_TRACE_RENDER_END:
+            {
+                if((ui8Id < NUM_JOBS) && (pui64Render[ui8Id] != UINT64_MAX))
+                {
+                    histAdd(&psRender[ui8Id],
+                            (ui64Now - pui64Render[ui8Id]) * dUsPerCycle);
+                    pui64Render[ui8Id] = UINT64_MAX;
+                }
+                break;
+            }
+
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    for(ui32I = 0; ui32I < NUM_IDS; ui32I++)
+    {
+        histPrint(&psIsr[ui32I]);
+    }
+    for(ui32I = 0; ui32I < NUM_IDS; ui32I++)
+    {
+        histPrint(&psLatch[ui32I]);
+    }
+    for(ui32I = 0; ui32I < NUM_JOBS; ui32I++)
+    {
+        histPrint(&psRender[ui32I]);
+    }
+    histPrint(&sLatency);
+
+    return(0);
+}